@@ -25,6 +25,9 @@ const App : Component<{wrapper : WrapperModule}> = (props) =>
         sky_intensity: 1.0,
         render_resolution: 1024,
         render_rate: 1000,
+        render_drop_stale_frames: "Disabled",
+        render_latency_budget: 100,
+        render_split_layer_response: "Disabled",
         layer_depth_base_threshold: default_mesh_config.layer.depth_base_threshold,
         layer_depth_slope_threshold: default_mesh_config.layer.depth_slope_threshold,
         layer_use_object_ids: default_mesh_config.layer.use_object_ids ? "Enabled" : "Disabled",
@@ -42,6 +45,7 @@ const App : Component<{wrapper : WrapperModule}> = (props) =>
         loop_layer_config: "Dual-Layer",
         loop_use_normals: default_mesh_config.mesh.loop?.use_normals ? "Enabled" : "Disabled",
         loop_use_object_ids: default_mesh_config.mesh.loop?.use_object_ids ? "Enabled" : "Disabled",
+        loop_use_sweep_line_profile: default_mesh_config.mesh.loop?.use_sweep_line_profile ? "Enabled" : "Disabled",
         video_mode: "Constant Quality",
         video_framerate: default_video_config.framerate,
         video_bitrate: default_video_config.bitrate,
@@ -198,7 +202,8 @@ const App : Component<{wrapper : WrapperModule}> = (props) =>
                 triangle_scale: config.loop_triangle_scale,
                 loop_length_min: config.loop_loop_length_min,
                 use_normals: convert_boolean(config.loop_use_normals) ? 1 : 0,
-                use_object_ids: convert_boolean(config.loop_use_object_ids) ? 1 : 0
+                use_object_ids: convert_boolean(config.loop_use_object_ids) ? 1 : 0,
+                use_sweep_line_profile: convert_boolean(config.loop_use_sweep_line_profile) ? 1 : 0
             };
         }
 
@@ -210,6 +215,9 @@ const App : Component<{wrapper : WrapperModule}> = (props) =>
             resolution: config.render_resolution,
             layer_count,
             render_request_rate: config.render_rate,
+            render_drop_stale_frames: convert_boolean(config.render_drop_stale_frames),
+            render_latency_budget: config.render_latency_budget,
+            render_split_layer_response: convert_boolean(config.render_split_layer_response),
             mesh_generator,
             mesh_settings:
             {
@@ -278,6 +286,17 @@ const App : Component<{wrapper : WrapperModule}> = (props) =>
                                 <h4 class="border-bottom my-4">Server Settings</h4>
                                 <SettingNumber label="Render Resolution" value={config.render_resolution} set_value={value => set_config("render_resolution", value)} min_value={256} max_value={1024} step={256}></SettingNumber>
                                 <SettingNumber label="Request Rate" value={config.render_rate} set_value={value => set_config("render_rate", value)} min_value={100} max_value={2000}></SettingNumber>
+                                <SettingDropdown label="Drop Stale Frames" value={config.render_drop_stale_frames} set_value={value => set_config("render_drop_stale_frames", value)}>
+                                    <option>Enabled</option>
+                                    <option>Disabled</option>
+                                </SettingDropdown>
+                                <Show when={config.render_drop_stale_frames == "Enabled"}>
+                                    <SettingNumber label="Latency Budget" value={config.render_latency_budget} set_value={value => set_config("render_latency_budget", value)} min_value={0} max_value={2000}></SettingNumber>
+                                </Show>
+                                <SettingDropdown label="Split Layer Responses" value={config.render_split_layer_response} set_value={value => set_config("render_split_layer_response", value)}>
+                                    <option>Enabled</option>
+                                    <option>Disabled</option>
+                                </SettingDropdown>
                             </div>
                             <div>
                                 <h4 class="border-bottom my-4">Layer Settings</h4>
@@ -322,6 +341,10 @@ const App : Component<{wrapper : WrapperModule}> = (props) =>
                                         <option>Enabled</option>
                                         <option>Disabled</option>
                                     </SettingDropdown>
+                                    <SettingDropdown label="Sweep Line Profile" value={config.loop_use_sweep_line_profile} set_value={value => set_config("loop_use_sweep_line_profile", value)}>
+                                        <option>Enabled</option>
+                                        <option>Disabled</option>
+                                    </SettingDropdown>
                                 </Show>
                             </div>
                             <div>
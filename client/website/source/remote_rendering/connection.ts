@@ -88,7 +88,7 @@ export async function send_image(file_path : string, width : number, height : nu
 }
 
 export type OnConnectionOpen = () => void;
-export type OnConnectionLayerResponse = (form : LayerResponseForm, geometry_data : Uint8Array, image_data : Uint8Array) => void;
+export type OnConnectionLayerResponse = (form : LayerResponseForm, geometry_data : Uint8Array | null, image_data : Uint8Array | null) => void; //The geometry or the image is null if it is sent with a separate layer response
 export type OnConnectionClose = () => void;
 
 export class Connection
@@ -257,11 +257,21 @@ export class Connection
     {
         let form = this.wrapper.parse_layer_response_packet(data);
 
-        const image_offset = data.length - form.image_bytes;
-        const geometry_offset = image_offset - form.geometry_bytes;
+        if(form == undefined) //The header is malformed or has a version that is not supported
+        {
+            this.on_close?.();
+
+            return;
+        }
+
+        const image_bytes = form.image_omitted ? 0 : form.image_bytes;
+        const geometry_bytes = form.geometry_omitted ? 0 : form.geometry_bytes;
+
+        const image_offset = data.length - image_bytes;
+        const geometry_offset = image_offset - geometry_bytes;
 
-        const image_data = data.subarray(image_offset, image_offset + form.image_bytes);
-        const geometry_data = data.subarray(geometry_offset, geometry_offset + form.geometry_bytes)
+        const image_data = form.image_omitted ? null : data.subarray(image_offset, image_offset + image_bytes);
+        const geometry_data = form.geometry_omitted ? null : data.subarray(geometry_offset, geometry_offset + geometry_bytes);
 
         this.on_layer_response?.(form, geometry_data, image_data);
     }
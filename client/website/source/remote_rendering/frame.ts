@@ -16,9 +16,11 @@ export class Layer
     time_point_response : number = 0.0; //Absolute time points
 
     image_frame : ImageFrame;
+    image_received : boolean = false; //The image and the geometry can arrive with separate responses
     image_complete : boolean = false;
 
     geometry_frame : GeometryFrame;
+    geometry_received : boolean = false;
     geometry_complete : boolean = false;
 
     vertex_arrays : WebGLVertexArrayObject[];
@@ -220,7 +222,9 @@ export class Frame
             layer.image_frame.clear();
             layer.geometry_frame.clear();
             
+            layer.image_received = false;
             layer.image_complete = false;
+            layer.geometry_received = false;
             layer.geometry_complete = false;
 
             layer.form = null;
@@ -235,6 +239,11 @@ export class Frame
             {
                 return false;   
             }
+
+            if(layer.form != null && layer.form.geometry_dropped) //The frame can't be displayed without the geometry
+            {
+                return false;
+            }
         }
 
         return true;
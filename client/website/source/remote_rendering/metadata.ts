@@ -14,6 +14,7 @@ interface MetadataEntry
 
     image_bytes: number;
     geometry_bytes: number;
+    dropped_frames: number;
     vertex_counts: CountArray;
     index_counts: CountArray;
 
@@ -86,6 +87,7 @@ export class Metadata
             request_id: form.request_id,
             image_bytes: form.image_bytes,
             geometry_bytes: form.geometry_bytes,
+            dropped_frames: form.dropped_frames,
             vertex_counts: form.vertex_counts,
             index_counts: form.index_counts,
             time_point_request: request[0].time_point_request,
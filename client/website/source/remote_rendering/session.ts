@@ -32,6 +32,9 @@ export interface SessionConfig
     resolution: number,
     layer_count: number,
     render_request_rate: number,
+    render_drop_stale_frames: boolean,
+    render_latency_budget: number,
+    render_split_layer_response: boolean,
 
     mesh_generator: MeshGeneratorType,
     mesh_settings : MeshSettingsForm,
@@ -360,6 +363,24 @@ export class Session
         let layer_count = this.config.layer_count;
         let view_count = LAYER_VIEW_COUNT;
         let export_enabled = false;
+        let drop_stale_frames = false;
+        let view_metadata_enabled = false;
+        let split_layer_response = false;
+
+        if(this.config.mode == SessionMode.Capture || this.config.mode == SessionMode.Benchmark) //All other modes need the geometry of every frame
+        {
+            drop_stale_frames = this.config.render_drop_stale_frames;
+        }
+
+        if(this.config.mode == SessionMode.Benchmark) //Only benchmarks store the metadata of the server
+        {
+            view_metadata_enabled = true;
+        }
+
+        if(this.config.mode == SessionMode.Capture || this.config.mode == SessionMode.Benchmark) //All other modes wait for the complete response of each frame anyway
+        {
+            split_layer_response = this.config.render_split_layer_response;
+        }
 
         if(this.config.mode == SessionMode.ReplayMethod)
         {
@@ -394,7 +415,11 @@ export class Session
             scene_indirect_intensity: this.config.scene_indirect_intensity,
             sky_file_name: this.config.sky_file_name,
             sky_intensity: this.config.sky_intensity,
-            export_enabled
+            export_enabled,
+            drop_stale_frames,
+            latency_budget: this.config.render_latency_budget,
+            view_metadata_enabled,
+            split_layer_response
         };
 
         if(!this.connection.send_session_create(session_create))
@@ -593,7 +618,7 @@ export class Session
         }
     }
 
-    private async on_response(form : LayerResponseForm, geometry_data : Uint8Array, image_data : Uint8Array)
+    private async on_response(form : LayerResponseForm, geometry_data : Uint8Array | null, image_data : Uint8Array | null)
     {
         if(this.gl == null)
         {
@@ -677,18 +702,34 @@ export class Session
         layer.geometry_frame.request_id = form.request_id;
         layer.time_point_response = performance.now();
 
-        if(!this.image_decoders[layer_index].submit_frame(layer.image_frame, image_data))
+        if(image_data != null) //With split responses the image and the geometry are submitted as soon as each of them arrived
         {
-            log_error("[Session] Can't submit image frame!");
+            layer.image_received = true;
 
-            return this.on_shutdown();
+            if(!this.image_decoders[layer_index].submit_frame(layer.image_frame, image_data))
+            {
+                log_error("[Session] Can't submit image frame!");
+
+                return this.on_shutdown();
+            }
         }
 
-        if(!this.geometry_decoders[layer_index].submit_frame(layer.geometry_frame, geometry_data))
+        if(form.geometry_dropped) //The server only sent the image, which still needs to be decoded since the images of a layer form a single video stream
         {
-            log_error("[Session] Can't submit geometry frame!");   
+            layer.geometry_received = true;
+            layer.geometry_complete = true;
+        }
 
-            return this.on_shutdown();
+        else if(geometry_data != null)
+        {
+            layer.geometry_received = true;
+
+            if(!this.geometry_decoders[layer_index].submit_frame(layer.geometry_frame, geometry_data))
+            {
+                log_error("[Session] Can't submit geometry frame!");   
+
+                return this.on_shutdown();
+            }
         }
 
         if(this.config.mode == SessionMode.ReplayMethod || this.config.mode == SessionMode.RenderTime)
@@ -697,7 +738,7 @@ export class Session
 
             for(const layer of frame.layers)
             {
-                if(layer.form == null)
+                if(!layer.image_received || !layer.geometry_received)
                 {
                     response_complete = false;
                     
@@ -770,6 +811,7 @@ export class Session
             if(frame.is_complete())
             {
                 this.frame_queue.splice(frame_index, 1);
+                this.recycle_frames(required_id);
     
                 if(!frame.setup())
                 {
@@ -819,6 +861,27 @@ export class Session
         }
     }
 
+    //Frames older than the given request id can never be completed if the server dropped one of their layers.
+    //Since the server and the decoders process the frames of each layer in order, these frames are not used anymore.
+    private recycle_frames(request_id : number)
+    {
+        this.frame_queue = this.frame_queue.filter(frame =>
+        {
+            for(const layer of frame.layers)
+            {
+                if(layer.form != null && layer.form.request_id < request_id)
+                {
+                    frame.clear();
+                    this.frame_pool.push(frame);
+
+                    return false;
+                }
+            }
+
+            return true;
+        });
+    }
+
     private on_render()
     {
         if(this.display == null || this.renderer == null)
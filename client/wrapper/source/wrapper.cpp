@@ -5,6 +5,7 @@
 #include <string>
 #include "../../shared/source/protocol.hpp"
 #include "../../shared/source/geometry_codec.hpp"
+#include "../../shared/source/layer_response_codec.hpp"
 
 struct MeshSettings
 {
@@ -47,6 +48,10 @@ struct SessionCreateForm
     float sky_intensity;
 
     bool export_enabled;
+    bool drop_stale_frames;
+    float latency_budget;
+    bool view_metadata_enabled;
+    bool split_layer_response;
 };
 
 struct SessionDestroyForm
@@ -79,10 +84,17 @@ struct LayerResponseForm
 {
     uint32_t request_id;
     uint32_t layer_index;
+    uint32_t view_count;
 
     uint32_t geometry_bytes;
     uint32_t image_bytes;
 
+    bool geometry_dropped;
+    uint32_t dropped_frames;
+
+    bool geometry_omitted;
+    bool image_omitted;
+
     std::array<ViewMetadata, SHARED_VIEW_COUNT_MAX> view_metadata;
     std::array<shared::Matrix, SHARED_VIEW_COUNT_MAX> view_matrices;
     std::array<uint32_t, SHARED_VIEW_COUNT_MAX> vertex_counts;
@@ -164,7 +176,11 @@ emscripten::val build_session_create_packet(SessionCreateForm form)
     packet.scene_indirect_intensity = form.scene_indirect_intensity;
     packet.sky_file_name = build_string(form.sky_file_name);
     packet.sky_intensity = form.sky_intensity;
-    packet.export_enabled = form.export_enabled;    
+    packet.export_enabled = form.export_enabled;
+    packet.drop_stale_frames = form.drop_stale_frames;
+    packet.latency_budget = form.latency_budget;
+    packet.view_metadata_enabled = form.view_metadata_enabled;
+    packet.split_layer_response = form.split_layer_response;
 
     return build_array(packet);
 }
@@ -249,31 +265,70 @@ shared::PacketType parse_packet_type(emscripten::val data)
 }
 
 //Assumes that data is an Uint8Array
-LayerResponseForm parse_layer_response_packet(emscripten::val data)
+std::optional<LayerResponseForm> parse_layer_response_packet(emscripten::val data)
 {
-    const std::vector<uint8_t> packet_data = build_vector<uint8_t>(data, 0, sizeof(shared::LayerResponsePacket));
-    const shared::LayerResponsePacket* packet = (const shared::LayerResponsePacket*)packet_data.data();
+    uint32_t data_bytes = data["length"].as<uint32_t>();
+    uint32_t header_bytes = 0;
+
+    //Only copy the header, since its size is not known before it is parsed
+    const std::vector<uint8_t> packet_data = build_vector<uint8_t>(data, 0, std::min(data_bytes, shared::LayerResponseCodec::get_header_bytes_max()));
+    shared::LayerResponsePacket packet;
+
+    if (!shared::LayerResponseCodec::decode(packet_data, packet, header_bytes))
+    {
+        return std::optional<LayerResponseForm>();
+    }
+
+    uint32_t geometry_bytes = packet.geometry_omitted ? 0 : packet.geometry_bytes;
+    uint32_t image_bytes = packet.image_omitted ? 0 : packet.image_bytes;
+
+    if (header_bytes + geometry_bytes + image_bytes != data_bytes)
+    {
+        return std::optional<LayerResponseForm>();
+    }
 
     LayerResponseForm form;
-    form.request_id = packet->request_id;
-    form.layer_index = packet->layer_index;
-    form.geometry_bytes = packet->geometry_bytes;
-    form.image_bytes = packet->image_bytes;
-    form.view_matrices = packet->view_matrices;
-    form.vertex_counts = packet->vertex_counts;
-    form.index_counts = packet->index_counts; 
+    form.request_id = packet.request_id;
+    form.layer_index = packet.layer_index;
+    form.view_count = packet.view_count;
+    form.geometry_bytes = packet.geometry_bytes;
+    form.image_bytes = packet.image_bytes;
+    form.geometry_dropped = packet.geometry_dropped;
+    form.dropped_frames = packet.dropped_frames;
+    form.geometry_omitted = packet.geometry_omitted;
+    form.image_omitted = packet.image_omitted;
+    form.view_matrices = packet.view_matrices;
+    form.vertex_counts = packet.vertex_counts;
+    form.index_counts = packet.index_counts; 
 
     for(uint32_t index = 0; index < SHARED_VIEW_COUNT_MAX; index++)
     {
-        const shared::ViewMetadata& packet_metadata = packet->view_metadata[index];
+        const shared::ViewMetadata& packet_metadata = packet.view_metadata[index];
         ViewMetadata& form_metadata = form.view_metadata[index];
 
         form_metadata.time_layer = packet_metadata.time_layer;
         form_metadata.time_image_encode = packet_metadata.time_image_encode;
         form_metadata.time_geometry_encode = packet_metadata.time_geometry_encode;
-        form_metadata.quad = packet_metadata.quad; // Don't know which one is correct so use both
-        form_metadata.line = packet_metadata.line; // Don't know which one is correct so use both
-        form_metadata.loop = packet_metadata.loop; // Don't know which one is correct so use both
+
+        if (!packet.view_metadata_enabled || index >= packet.view_count)
+        {
+            continue;
+        }
+
+        switch (packet.mesh_generator)
+        {
+        case shared::MESH_GENERATOR_TYPE_QUAD:
+            form_metadata.quad = packet_metadata.quad;
+            break;
+        case shared::MESH_GENERATOR_TYPE_LINE:
+            form_metadata.line = packet_metadata.line;
+            break;
+        case shared::MESH_GENERATOR_TYPE_LOOP:
+            form_metadata.loop = packet_metadata.loop;
+            break;
+        default:
+            break;
+        }
     }
 
     return form;
@@ -400,7 +455,8 @@ EMSCRIPTEN_BINDINGS(wrapper)
         .field("triangle_scale", &shared::LoopSettings::triangle_scale)
         .field("loop_length_min", &shared::LoopSettings::loop_length_min)
         .field("use_normals", &shared::LoopSettings::use_normals)
-        .field("use_object_ids", &shared::LoopSettings::use_object_ids);
+        .field("use_object_ids", &shared::LoopSettings::use_object_ids)
+        .field("use_sweep_line_profile", &shared::LoopSettings::use_sweep_line_profile);
 
     emscripten::register_optional<shared::QuadSettings>();
     emscripten::register_optional<shared::LineSettings>();
@@ -417,7 +473,11 @@ EMSCRIPTEN_BINDINGS(wrapper)
         .field("time_delta", &shared::QuadViewMetadata::time_delta)
         .field("time_refine", &shared::QuadViewMetadata::time_refine)
         .field("time_corner", &shared::QuadViewMetadata::time_corner)
-        .field("time_write", &shared::QuadViewMetadata::time_write);
+        .field("time_write", &shared::QuadViewMetadata::time_write)
+        .field("vertex_count", &shared::QuadViewMetadata::vertex_count)
+        .field("index_count", &shared::QuadViewMetadata::index_count)
+        .field("vertex_capacity", &shared::QuadViewMetadata::vertex_capacity)
+        .field("index_capacity", &shared::QuadViewMetadata::index_capacity);
 
     emscripten::value_object<shared::LineViewMetadata>("LineViewMetadata")
         .field("time_edge_detection", &shared::LineViewMetadata::time_edge_detection)
@@ -498,7 +558,11 @@ EMSCRIPTEN_BINDINGS(wrapper)
         .field("scene_indirect_intensity", &SessionCreateForm::scene_indirect_intensity)
         .field("sky_file_name", &SessionCreateForm::sky_file_name)
         .field("sky_intensity", &SessionCreateForm::sky_intensity)
-        .field("export_enabled", &SessionCreateForm::export_enabled);
+        .field("export_enabled", &SessionCreateForm::export_enabled)
+        .field("drop_stale_frames", &SessionCreateForm::drop_stale_frames)
+        .field("latency_budget", &SessionCreateForm::latency_budget)
+        .field("view_metadata_enabled", &SessionCreateForm::view_metadata_enabled)
+        .field("split_layer_response", &SessionCreateForm::split_layer_response);
 
     emscripten::value_object<SessionDestroyForm>("SessionDestroyForm");
 
@@ -520,13 +584,20 @@ EMSCRIPTEN_BINDINGS(wrapper)
     emscripten::value_object<LayerResponseForm>("LayerResponseForm")
         .field("request_id", &LayerResponseForm::request_id)
         .field("layer_index", &LayerResponseForm::layer_index)
+        .field("view_count", &LayerResponseForm::view_count)
         .field("geometry_bytes", &LayerResponseForm::geometry_bytes)
         .field("image_bytes", &LayerResponseForm::image_bytes)
+        .field("geometry_dropped", &LayerResponseForm::geometry_dropped)
+        .field("dropped_frames", &LayerResponseForm::dropped_frames)
+        .field("geometry_omitted", &LayerResponseForm::geometry_omitted)
+        .field("image_omitted", &LayerResponseForm::image_omitted)
         .field("view_metadata", &LayerResponseForm::view_metadata)
         .field("view_matrices", &LayerResponseForm::view_matrices)
         .field("vertex_counts", &LayerResponseForm::vertex_counts)
         .field("index_counts", &LayerResponseForm::index_counts);
 
+    emscripten::register_optional<LayerResponseForm>();
+
     emscripten::value_object<Geometry>("Geometry")
         .field("indices", &Geometry::indices)
         .field("vertices", &Geometry::vertices);
@@ -31,6 +31,10 @@
 #define LOOP_GENERATOR_WRITE_WORK_GROUP_SIZE_X 12
 #define LOOP_GENERATOR_WRITE_WORK_GROUP_SIZE_Y 8
 
+#define LINE_GENERATOR_MASK_BUCKET_COUNT   4   //Number of edge strength classes of the edge mask
+#define LINE_GENERATOR_MASK_TILE_SIZE      256 //Needs to be a multiple of 64
+#define LINE_GENERATOR_MASK_TILE_ROW_WORDS (LINE_GENERATOR_MASK_TILE_SIZE / 64)
+
 #define LINE_GENERATOR_EDGE_WORK_GROUP_SIZE_X 32
 #define LINE_GENERATOR_EDGE_WORK_GROUP_SIZE_Y 24
 #define LINE_GENERATOR_QUAD_TREE_WORK_GROUP_SIZE_X 32
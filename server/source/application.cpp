@@ -2,6 +2,7 @@
 
 #include <glm/gtc/type_ptr.hpp>
 #include <spdlog/spdlog.h>
+#include <algorithm>
 
 bool Application::create(uint32_t argument_count, const char** argument_list)
 {
@@ -10,6 +11,18 @@ bool Application::create(uint32_t argument_count, const char** argument_list)
         return false;
     }
 
+    if (!this->thread_placement.create(this->command_parser.get_thread_placement(), this->command_parser.get_numa_node(), this->command_parser.get_thread_report_interval()))
+    {
+        return false;
+    }
+
+    this->thread_placement.place_thread(THREAD_ROLE_RENDER, "Render");
+
+    if (!this->scheduler.create(&this->thread_placement))
+    {
+        return false;
+    }
+
     if (!this->create_window())
     {
         return false;
@@ -42,6 +55,14 @@ bool Application::create(uint32_t argument_count, const char** argument_list)
 
 void Application::destroy()
 {
+    //The sessions return their layer data to the server while they are destroyed. Therefore the server has to outlive all sessions.
+    while (!this->clients.empty())
+    {
+        this->destroy_client(this->clients.begin()->first);
+    }
+
+    this->scheduler.destroy();
+
     if (this->server != nullptr)
     {
         this->server->destroy();
@@ -50,14 +71,6 @@ void Application::destroy()
         this->server = nullptr;
     }
 
-    if (this->session != nullptr)
-    {
-        this->session->destroy();
-
-        delete this->session;
-        this->session = nullptr;
-    }
-
     if (this->scene != nullptr)
     {
         this->scene->destroy();
@@ -72,6 +85,9 @@ void Application::destroy()
     glfwDestroyWindow(this->window);
 
     this->window = nullptr;
+
+    this->thread_placement.remove_thread();
+    this->thread_placement.destroy();
 }
 
 bool Application::run()
@@ -85,14 +101,25 @@ bool Application::run()
             return false;
         }
 
-        if (this->scene != nullptr)
+        //Preview the scene of the first client or the scene given on the command line if no client is connected
+        Scene* preview_scene = this->scene;
+        Camera* preview_camera = &this->camera;
+
+        if (!this->clients.empty())
+        {
+            preview_scene = this->clients.begin()->second->scene->scene;
+            preview_camera = &this->clients.begin()->second->camera;
+        }
+
+        else
         {
-            if (this->session == nullptr)
-            {
-                bool window_focused = glfwGetWindowAttrib(this->window, GLFW_FOCUSED);
+            bool window_focused = glfwGetWindowAttrib(this->window, GLFW_FOCUSED);
 
-                this->camera.update(window, window_focused);
-            }
+            this->camera.update(window, window_focused);
+        }
+
+        if (preview_scene != nullptr)
+        {
 
             glm::ivec2 window_size = glm::uvec2(0);
             glfwGetWindowSize(this->window, &window_size.x, &window_size.y);
@@ -108,10 +135,10 @@ bool Application::run()
             glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
             this->preview_shader.use_shader();
-            this->preview_shader["camera_view_projection_matrix"] = this->camera.get_projection_matrix() * this->camera.get_view_matrix();
-            this->preview_shader["camera_position"] = this->camera.get_position();
+            this->preview_shader["camera_view_projection_matrix"] = preview_camera->get_projection_matrix() * preview_camera->get_view_matrix();
+            this->preview_shader["camera_position"] = preview_camera->get_position();
 
-            this->scene->render(this->preview_shader);
+            preview_scene->render(this->preview_shader);
 
             this->preview_shader.use_default();
 
@@ -121,6 +148,8 @@ bool Application::run()
         }
         
         glfwSwapBuffers(this->window);
+
+        this->thread_placement.report();
     }
 
     return true;
@@ -188,32 +217,32 @@ bool Application::create_server()
 {
     this->server = new Server(this->command_parser.get_scene_directory(), this->command_parser.get_study_directory());
 
-    this->server->set_on_session_create([this](const shared::SessionCreatePacket& session_create)
+    this->server->set_on_session_create([this](uint32_t connection, const shared::SessionCreatePacket& session_create)
     {
-        this->on_session_create(session_create);
+        this->on_session_create(connection, session_create);
     });
 
-    this->server->set_on_session_destroy([this](const shared::SessionDestroyPacket& session_destroy)
+    this->server->set_on_session_destroy([this](uint32_t connection, const shared::SessionDestroyPacket& session_destroy)
     {
-        this->on_session_destroy(session_destroy);
+        this->on_session_destroy(connection, session_destroy);
     });
 
-    this->server->set_on_render_request([this](const shared::RenderRequestPacket& render_request)
+    this->server->set_on_render_request([this](uint32_t connection, const shared::RenderRequestPacket& render_request)
     {
-        this->on_render_request(render_request);
+        this->on_render_request(connection, render_request);
     });
 
-    this->server->set_on_mesh_settings_change([this](const shared::MeshSettingsPacket& mesh_settings)
+    this->server->set_on_mesh_settings_change([this](uint32_t connection, const shared::MeshSettingsPacket& mesh_settings)
     {
-        this->on_mesh_settings_change(mesh_settings);
+        this->on_mesh_settings_change(connection, mesh_settings);
     });
 
-    this->server->set_on_video_settings_change([this](const shared::VideoSettingsPacket& video_settings)
+    this->server->set_on_video_settings_change([this](uint32_t connection, const shared::VideoSettingsPacket& video_settings)
     {
-        this->on_video_settings_change(video_settings);
+        this->on_video_settings_change(connection, video_settings);
     });
 
-    if (!this->server->create())
+    if (!this->server->create(&this->thread_placement, this->command_parser.get_connection_limit()))
     {
         return false;
     }
@@ -228,163 +257,69 @@ bool Application::process_session()
     messages.swap(this->server_messages);
     lock.unlock();
 
-    if (this->session != nullptr)
+    for (const auto& [connection, client] : this->clients)
     {
-        this->session->check_frames();
+        client->session->check_frames();
     }
 
-    std::optional<ServerMessage> latest_request;
+    std::map<uint32_t, ServerMessage> latest_requests; //Indexed by the connection of the client
 
     for (const ServerMessage& message : messages)
     {
         if (message.type == SERVER_MESSAGE_SESSION_CREATE)
         {
-            const shared::SessionCreatePacket& session_create = message.data.session_create;
-
-            if (this->session != nullptr)
-            {
-                spdlog::error("Application: Session already open!");
-
-                return false;
-            }
-
-            if (this->scene != nullptr)
-            {
-                this->scene->destroy();
-
-                delete this->scene;
-                this->scene = nullptr;
-            }
-
-            std::string scene_file_name;
-            std::optional<std::string> sky_file_name;
-
-            uint32_t scene_file_length = strnlen(session_create.scene_file_name.data(), SHARED_STRING_LENGTH_MAX);
-            uint32_t sky_file_length = strnlen(session_create.sky_file_name.data(), SHARED_STRING_LENGTH_MAX);
-
-            if (scene_file_length > 0)
-            {
-                scene_file_name = this->server->get_scene_directory() + std::string(session_create.scene_file_name.data(), scene_file_length);
-            }
-
-            else
-            {
-                spdlog::error("Application: No scene specified!");
-
-                return false;
-            }
-
-            if (sky_file_length > 0)
-            {
-                sky_file_name = this->server->get_scene_directory() + std::string(session_create.sky_file_name.data(), sky_file_length);
-            }
-
-            this->scene = new Scene();
-
-            if (!this->scene->create(scene_file_name, session_create.scene_scale, session_create.scene_exposure, session_create.scene_indirect_intensity, sky_file_name, session_create.sky_intensity, this->command_parser.get_sky_rotation()))
+            if (this->clients.contains(message.connection))
             {
-                spdlog::error("Application: Can't create scene!");
-
-                return false;
-            }
-
-            glm::uvec2 resolution = glm::uvec2(0);
-            resolution.x = session_create.resolution_width;
-            resolution.y = session_create.resolution_height;
-
-            MeshGeneratorType mesh_generator_type = MESH_GENERATOR_TYPE_LINE_BASED;
-
-            switch (session_create.mesh_generator)
-            {
-            case shared::MESH_GENERATOR_TYPE_QUAD:
-                mesh_generator_type = MESH_GENERATOR_TYPE_QUAD_BASED;
-                break;
-            case shared::MESH_GENERATOR_TYPE_LINE:
-                mesh_generator_type = MESH_GENERATOR_TYPE_LINE_BASED;
-                break;
-            case shared::MESH_GENERATOR_TYPE_LOOP:
-                mesh_generator_type = MESH_GENERATOR_TYPE_LOOP_BASED;
-                break;
-            default:
-                spdlog::error("Application: Unknown mesh generation method!");
-                return false;
-            }
+                spdlog::error("Application: Session of connection {} already open!", message.connection);
 
-            EncoderCodec codec = ENCODER_CODEC_H264;
-
-            switch (session_create.video_codec)
-            {
-            case shared::VIDEO_CODEC_TYPE_H264:
-                codec = ENCODER_CODEC_H264;
-                break;
-            case shared::VIDEO_CODEC_TYPE_H265:
-                codec = ENCODER_CODEC_H265;
-                break;
-            case shared::VIDEO_CODEC_TYPE_AV1:
-                codec = ENCODER_CODEC_AV1;
-                break;
-            default:
-                spdlog::error("Application: Unknown encoding!");
-                return false;
+                continue; //Ignore Message
             }
 
-            this->session = new Session();
-
-            if (!this->session->create(this->server, mesh_generator_type, codec, resolution, session_create.layer_count, session_create.view_count, session_create.video_use_chroma_subsampling, session_create.export_enabled))
+            if (!this->create_client(message.connection, message.data.session_create))
             {
-                spdlog::error("Application: Can't create session!");
-
-                return false;
-            }
+                spdlog::error("Application: Can't create session of connection {}!", message.connection);
 
-            glm::mat4 view_matrix = glm::mat4(1.0f);
-            glm::mat4 projection_matrix = glm::make_mat4(session_create.projection_matrix.data());
+                //Only the affected client is disconnected, the other clients are served as before
+                this->server->close_connection(message.connection);
 
-            for (uint32_t index = 0; index < SHARED_VIEW_COUNT_MAX; index++)
-            {
-                this->camera.set_view_matrix(index, view_matrix);
+                continue;
             }
-
-            this->camera.set_projection_matrix(projection_matrix);
         }
 
         else if (message.type == SERVER_MESSAGE_SESSION_DESTROY)
         {
-            if (this->session == nullptr)
+            if (!this->clients.contains(message.connection))
             {
                 continue; //Ignore Message
             }
 
-            this->session->destroy();
+            this->destroy_client(message.connection);
 
-            delete this->session;
-            this->session = nullptr;
-
-            this->camera.update(this->window, true);
-
-            latest_request.reset();
+            latest_requests.erase(message.connection);
         }
 
         else if (message.type == SERVER_MESSAGE_RENDER_REQUEST)
         {
             const shared::RenderRequestPacket& render_request = message.data.render_request;
 
-            if (this->session == nullptr)
+            if (!this->clients.contains(message.connection))
             {
                 continue; //Ignore Message
             }
 
-            if (latest_request.has_value())
+            auto latest_request = latest_requests.find(message.connection);
+
+            if (latest_request != latest_requests.end())
             {
-                if (latest_request->data.render_request.request_id < render_request.request_id)
+                if (latest_request->second.data.render_request.request_id < render_request.request_id)
                 {
-                    latest_request = message;
+                    latest_request->second = message;
                 }
             }
 
             else
             {
-                latest_request = message;
+                latest_requests[message.connection] = message;
             }
         }
 
@@ -392,43 +327,52 @@ bool Application::process_session()
         {
             const shared::MeshSettingsPacket& mesh_settings = message.data.mesh_settings;
 
-            if (this->session == nullptr)
+            if (!this->clients.contains(message.connection))
             {
                 continue; //Ignore Message
             }
 
-            this->session->set_layer_depth_base_threshold(mesh_settings.layer.depth_base_threshold);
-            this->session->set_layer_depth_slope_threshold(mesh_settings.layer.depth_slope_threshold);
-            this->session->set_layer_use_object_ids(mesh_settings.layer.use_object_ids);
+            Session* session = this->clients[message.connection]->session;
+            session->set_layer_depth_base_threshold(mesh_settings.layer.depth_base_threshold);
+            session->set_layer_depth_slope_threshold(mesh_settings.layer.depth_slope_threshold);
+            session->set_layer_use_object_ids(mesh_settings.layer.use_object_ids);
 
-            this->session->set_mesh_settings(mesh_settings.mesh);
+            session->set_mesh_settings(mesh_settings.mesh);
         }
 
         else if (message.type == SERVER_MESSAGE_VIDEO_SETTINGS)
         {
             const shared::VideoSettingsPacket video_settings = message.data.video_settings;
 
-            if (this->session == nullptr)
+            if (!this->clients.contains(message.connection))
             {
                 continue; //Ignore Message
             }
 
+            Session* session = this->clients[message.connection]->session;
+
             switch (video_settings.mode)
             {
             case shared::VIDEO_CODEC_MODE_CONSTANT_BITRATE:
-                this->session->set_encoder_mode(ENCODER_MODE_CONSTANT_BITRATE);
+                session->set_encoder_mode(ENCODER_MODE_CONSTANT_BITRATE);
                 break;
             case shared::VIDEO_CODEC_MODE_CONSTANT_QUALITY:
-                this->session->set_encoder_mode(ENCODER_MODE_CONSTANT_QUALITY);
+                session->set_encoder_mode(ENCODER_MODE_CONSTANT_QUALITY);
                 break;
             default:
-                spdlog::error("Application: Unknown video mode!");
-                return false;
+                spdlog::error("Application: Unknown video mode of connection {}!", message.connection);
+
+                this->destroy_client(message.connection);
+                this->server->close_connection(message.connection);
+
+                latest_requests.erase(message.connection);
+
+                continue;
             }
 
-            this->session->set_encoder_frame_rate(video_settings.framerate);
-            this->session->set_encoder_bitrate(video_settings.bitrate);
-            this->session->set_encoder_quality(video_settings.quality);
+            session->set_encoder_frame_rate(video_settings.framerate);
+            session->set_encoder_bitrate(video_settings.bitrate);
+            session->set_encoder_quality(video_settings.quality);
         }
 
         else
@@ -439,104 +383,323 @@ bool Application::process_session()
         }
     }
 
-    if (latest_request.has_value())
-    {
-        const shared::RenderRequestPacket& render_request = latest_request->data.render_request;
+    std::vector<ServerMessage> deferred_requests;
 
-        if (this->session == nullptr)
+    //Only the latest request of each client is rendered, so that a slow client does not delay the requests of the other clients
+    for (const auto& [connection, latest_request] : latest_requests)
+    {
+        if (!this->process_render_request(connection, latest_request.data.render_request))
         {
-            return true; //Ignore Message
+            deferred_requests.push_back(latest_request);
         }
+    }
 
-        std::array<std::optional<std::string>, SHARED_EXPORT_COUNT_MAX> export_file_names;
+    if (!deferred_requests.empty())
+    {
+        lock.lock(); //Reinsert render requests
+        this->server_messages.insert(this->server_messages.begin(), deferred_requests.begin(), deferred_requests.end());
+        lock.unlock();
+    }
 
-        for (uint32_t index = 0; index < SHARED_EXPORT_COUNT_MAX; index++)
-        {
-            uint32_t file_name_length = strnlen(render_request.export_file_names[index].data(), SHARED_STRING_LENGTH_MAX);
+    return true;
+}
 
-            if (file_name_length > 0)
-            {
-                export_file_names[index] = std::string(render_request.export_file_names[index].data(), file_name_length);
-            }
-        }
+bool Application::process_render_request(uint32_t connection, const shared::RenderRequestPacket& render_request)
+{
+    ApplicationClient* client = this->clients[connection];
 
-        ExportRequest export_request;
-        export_request.color_file_name = export_file_names[shared::EXPORT_TYPE_COLOR];
-        export_request.depth_file_name = export_file_names[shared::EXPORT_TYPE_DEPTH];
-        export_request.mesh_file_name = export_file_names[shared::EXPORT_TYPE_MESH];
-        export_request.feature_lines_file_name = export_file_names[shared::EXPORT_TYPE_FEATURE_LINES];
+    //Defer the request while the connection is saturated. Requests that arrive in the meantime replace the deferred request, so that only the latest one is rendered once the socket drained.
+    if (this->server->get_buffered_amount(connection) > APPLICATION_BACKPRESSURE_LIMIT)
+    {
+        return false;
+    }
 
-        for (uint32_t view = 0; view < SHARED_VIEW_COUNT_MAX; view++)
-        {
-            glm::mat4 view_matrix = glm::make_mat4(render_request.view_matrices[view].data());
+    std::array<std::optional<std::string>, SHARED_EXPORT_COUNT_MAX> export_file_names;
+
+    for (uint32_t index = 0; index < SHARED_EXPORT_COUNT_MAX; index++)
+    {
+        uint32_t file_name_length = strnlen(render_request.export_file_names[index].data(), SHARED_STRING_LENGTH_MAX);
 
-            this->camera.set_view_matrix(view, view_matrix);
+        if (file_name_length > 0)
+        {
+            export_file_names[index] = std::string(render_request.export_file_names[index].data(), file_name_length);
         }
+    }
+
+    ExportRequest export_request;
+    export_request.color_file_name = export_file_names[shared::EXPORT_TYPE_COLOR];
+    export_request.depth_file_name = export_file_names[shared::EXPORT_TYPE_DEPTH];
+    export_request.mesh_file_name = export_file_names[shared::EXPORT_TYPE_MESH];
+    export_request.feature_lines_file_name = export_file_names[shared::EXPORT_TYPE_FEATURE_LINES];
+
+    for (uint32_t view = 0; view < SHARED_VIEW_COUNT_MAX; view++)
+    {
+        glm::mat4 view_matrix = glm::make_mat4(render_request.view_matrices[view].data());
+
+        client->camera.set_view_matrix(view, view_matrix);
+    }
+
+    glm::mat4 view_matrix = glm::make_mat4(render_request.view_matrices[0].data());
+    client->camera.set_position(glm::inverse(view_matrix) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+    if (!client->session->render_frame(client->camera, *client->scene->scene, render_request.request_id, export_request))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool Application::create_client(uint32_t connection, const shared::SessionCreatePacket& session_create)
+{
+    //The scene given on the command line is only used for the preview until the first client connects
+    if (this->scene != nullptr)
+    {
+        this->scene->destroy();
+
+        delete this->scene;
+        this->scene = nullptr;
+    }
+
+    glm::uvec2 resolution = glm::uvec2(0);
+    resolution.x = session_create.resolution_width;
+    resolution.y = session_create.resolution_height;
+
+    MeshGeneratorType mesh_generator_type = MESH_GENERATOR_TYPE_LINE_BASED;
+
+    switch (session_create.mesh_generator)
+    {
+    case shared::MESH_GENERATOR_TYPE_QUAD:
+        mesh_generator_type = this->command_parser.get_quad_reference() ? MESH_GENERATOR_TYPE_QUAD_REFERENCE : MESH_GENERATOR_TYPE_QUAD_BASED;
+        break;
+    case shared::MESH_GENERATOR_TYPE_LINE:
+        mesh_generator_type = MESH_GENERATOR_TYPE_LINE_BASED;
+        break;
+    case shared::MESH_GENERATOR_TYPE_LOOP:
+        mesh_generator_type = this->command_parser.get_loop_reference() ? MESH_GENERATOR_TYPE_LOOP_REFERENCE : MESH_GENERATOR_TYPE_LOOP_BASED;
+        break;
+    default:
+        spdlog::error("Application: Unknown mesh generation method!");
+        return false;
+    }
+
+    EncoderCodec codec = ENCODER_CODEC_H264;
+
+    switch (session_create.video_codec)
+    {
+    case shared::VIDEO_CODEC_TYPE_H264:
+        codec = ENCODER_CODEC_H264;
+        break;
+    case shared::VIDEO_CODEC_TYPE_H265:
+        codec = ENCODER_CODEC_H265;
+        break;
+    case shared::VIDEO_CODEC_TYPE_AV1:
+        codec = ENCODER_CODEC_AV1;
+        break;
+    default:
+        spdlog::error("Application: Unknown encoding!");
+        return false;
+    }
+
+    ApplicationScene* scene = this->acquire_scene(session_create);
+
+    if (scene == nullptr)
+    {
+        return false;
+    }
+
+    ApplicationClient* client = new ApplicationClient;
+    client->scene = scene;
+    client->session = new Session();
+
+    if (!client->session->create(this->server, connection, &this->thread_placement, &this->scheduler, mesh_generator_type, codec, resolution, session_create.layer_count, session_create.view_count, session_create.video_use_chroma_subsampling, session_create.export_enabled, session_create.drop_stale_frames, session_create.latency_budget, session_create.view_metadata_enabled, session_create.split_layer_response))
+    {
+        spdlog::error("Application: Can't create session!");
+
+        client->session->destroy();
+        delete client->session;
+
+        this->release_scene(client->scene);
+        delete client;
+
+        return false;
+    }
+
+    glm::mat4 view_matrix = glm::mat4(1.0f);
+    glm::mat4 projection_matrix = glm::make_mat4(session_create.projection_matrix.data());
+
+    for (uint32_t index = 0; index < SHARED_VIEW_COUNT_MAX; index++)
+    {
+        client->camera.set_view_matrix(index, view_matrix);
+    }
+
+    client->camera.set_projection_matrix(projection_matrix);
+
+    this->clients[connection] = client;
+
+    return true;
+}
+
+void Application::destroy_client(uint32_t connection)
+{
+    ApplicationClient* client = this->clients[connection];
+    this->clients.erase(connection);
+
+    client->session->destroy();
+    delete client->session;
+
+    this->release_scene(client->scene);
+    delete client;
+
+    if (this->clients.empty())
+    {
+        this->camera.update(this->window, true);
+    }
+}
+
+ApplicationScene* Application::acquire_scene(const shared::SessionCreatePacket& session_create)
+{
+    std::string scene_file_name;
+    std::optional<std::string> sky_file_name;
+
+    uint32_t scene_file_length = strnlen(session_create.scene_file_name.data(), SHARED_STRING_LENGTH_MAX);
+    uint32_t sky_file_length = strnlen(session_create.sky_file_name.data(), SHARED_STRING_LENGTH_MAX);
+
+    if (scene_file_length > 0)
+    {
+        scene_file_name = this->server->get_scene_directory() + std::string(session_create.scene_file_name.data(), scene_file_length);
+    }
+
+    else
+    {
+        spdlog::error("Application: No scene specified!");
+
+        return nullptr;
+    }
 
-        glm::mat4 view_matrix = glm::make_mat4(render_request.view_matrices[0].data());
-        this->camera.set_position(glm::inverse(view_matrix) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    if (sky_file_length > 0)
+    {
+        sky_file_name = this->server->get_scene_directory() + std::string(session_create.sky_file_name.data(), sky_file_length);
+    }
 
-        if (!this->session->render_frame(this->camera, *this->scene, render_request.request_id, export_request))
+    //Clients that view the same scene with the same settings share the scene, so that it is only loaded once
+    for (ApplicationScene* scene : this->scenes)
+    {
+        if (scene->scene_file_name != scene_file_name || scene->sky_file_name != sky_file_name)
         {
-            lock.lock(); //Reinsert render request
-            this->server_messages.insert(this->server_messages.begin(), latest_request.value());
-            lock.unlock();
+            continue;
         }
+
+        if (scene->scene_scale != session_create.scene_scale || scene->scene_exposure != session_create.scene_exposure || scene->scene_indirect_intensity != session_create.scene_indirect_intensity || scene->sky_intensity != session_create.sky_intensity)
+        {
+            continue;
+        }
+
+        scene->client_count++;
+
+        return scene;
     }
 
-    return true;
+    ApplicationScene* scene = new ApplicationScene;
+    scene->scene = new Scene();
+    scene->client_count = 1;
+    scene->scene_file_name = scene_file_name;
+    scene->scene_scale = session_create.scene_scale;
+    scene->scene_exposure = session_create.scene_exposure;
+    scene->scene_indirect_intensity = session_create.scene_indirect_intensity;
+    scene->sky_file_name = sky_file_name;
+    scene->sky_intensity = session_create.sky_intensity;
+
+    if (!scene->scene->create(scene_file_name, session_create.scene_scale, session_create.scene_exposure, session_create.scene_indirect_intensity, sky_file_name, session_create.sky_intensity, this->command_parser.get_sky_rotation()))
+    {
+        spdlog::error("Application: Can't create scene!");
+
+        scene->scene->destroy();
+
+        delete scene->scene;
+        delete scene;
+
+        return nullptr;
+    }
+
+    //Only share scenes that were loaded successfully
+    this->scenes.push_back(scene);
+
+    return scene;
+}
+
+void Application::release_scene(ApplicationScene* scene)
+{
+    scene->client_count--;
+
+    if (scene->client_count > 0)
+    {
+        return;
+    }
+
+    this->scenes.erase(std::find(this->scenes.begin(), this->scenes.end(), scene));
+
+    scene->scene->destroy();
+
+    delete scene->scene;
+    delete scene;
 }
 
-void Application::on_session_create(const shared::SessionCreatePacket& session_create)
+void Application::on_session_create(uint32_t connection, const shared::SessionCreatePacket& session_create)
 {
     std::unique_lock<std::mutex> lock(this->server_mutex);
 
     ServerMessage message;
     message.type = SERVER_MESSAGE_SESSION_CREATE;
+    message.connection = connection;
     message.data.session_create = session_create;
 
     this->server_messages.push_back(message);
 }
 
-void Application::on_session_destroy(const shared::SessionDestroyPacket& session_destroy)
+void Application::on_session_destroy(uint32_t connection, const shared::SessionDestroyPacket& session_destroy)
 {
     std::unique_lock<std::mutex> lock(this->server_mutex);
 
     ServerMessage message;
     message.type = SERVER_MESSAGE_SESSION_DESTROY;
+    message.connection = connection;
     message.data.session_destroy = session_destroy;
 
     this->server_messages.push_back(message);
 }
 
-void Application::on_render_request(const shared::RenderRequestPacket& render_request)
+void Application::on_render_request(uint32_t connection, const shared::RenderRequestPacket& render_request)
 {
     std::unique_lock<std::mutex> lock(this->server_mutex);
 
     ServerMessage message;
     message.type = SERVER_MESSAGE_RENDER_REQUEST;
+    message.connection = connection;
     message.data.render_request = render_request;
 
     this->server_messages.push_back(message);
 }
 
-void Application::on_mesh_settings_change(const shared::MeshSettingsPacket& mesh_settings)
+void Application::on_mesh_settings_change(uint32_t connection, const shared::MeshSettingsPacket& mesh_settings)
 {
     std::unique_lock<std::mutex> lock(this->server_mutex);
 
     ServerMessage message;
     message.type = SERVER_MESSAGE_MESH_SETTINGS;
+    message.connection = connection;
     message.data.mesh_settings = mesh_settings;
 
     this->server_messages.push_back(message);
 }
 
-void Application::on_video_settings_change(const shared::VideoSettingsPacket& video_settings)
+void Application::on_video_settings_change(uint32_t connection, const shared::VideoSettingsPacket& video_settings)
 {
     std::unique_lock<std::mutex> lock(this->server_mutex);
 
     ServerMessage message;
     message.type = SERVER_MESSAGE_VIDEO_SETTINGS;
+    message.connection = connection;
     message.data.video_settings = video_settings;
 
     this->server_messages.push_back(message);
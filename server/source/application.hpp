@@ -4,14 +4,20 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <protocol.hpp>
+#include <optional>
+#include <string>
+#include <map>
 
 #include "command_parser.hpp"
 #include "server.hpp"
 #include "camera.hpp"
 #include "scene.hpp"
 #include "session.hpp"
+#include "scheduler.hpp"
 #include "shader.hpp"
 
+#define APPLICATION_BACKPRESSURE_LIMIT (4 * 1024 * 1024) // Number of bytes waiting in the send queue of a socket above which the render requests of that client are deferred
+
 enum ServerMessageType
 {
     SERVER_MESSAGE_SESSION_CREATE,
@@ -40,19 +46,46 @@ public:
 struct ServerMessage
 {
     ServerMessageType type;
+    uint32_t connection = 0;
     ServerMessageData data;
 };
 
+// Scene that is shared by all clients that requested the same scene file with the same settings
+struct ApplicationScene
+{
+    Scene* scene = nullptr;
+    uint32_t client_count = 0;
+
+    std::string scene_file_name;
+    float scene_scale = 1.0f;
+    float scene_exposure = 1.0f;
+    float scene_indirect_intensity = 1.0f;
+    std::optional<std::string> sky_file_name;
+    float sky_intensity = 1.0f;
+};
+
+// Each connected client has its own session and camera, while the scene can be shared with other clients
+struct ApplicationClient
+{
+    Session* session = nullptr;
+    ApplicationScene* scene = nullptr;
+    Camera camera;
+};
+
 class Application
 {
 private:
     GLFWwindow* window = nullptr;
 
     CommandParser command_parser;
-    Camera camera;
+    ThreadPlacement thread_placement;
+    Scheduler scheduler;   // Shared by the sessions of all clients, so that their worker threads are not placed on the same cores
+    Camera camera;         // Camera of the preview window
     Server* server = nullptr;
-    Scene* scene = nullptr;
-    Session* session = nullptr;
+    Scene* scene = nullptr; // Scene of the preview window, which is only loaded while no client is connected
+
+    std::map<uint32_t, ApplicationClient*> clients; // Indexed by the connection of the client
+    std::vector<ApplicationScene*> scenes;
 
     std::mutex server_mutex;
     std::vector<ServerMessage> server_messages; //Protected by server_mutex
@@ -72,12 +105,18 @@ private:
     bool create_server();
 
     bool process_session();
-
-    void on_session_create(const shared::SessionCreatePacket& session_create);
-    void on_session_destroy(const shared::SessionDestroyPacket& session_destroy);
-    void on_render_request(const shared::RenderRequestPacket& render_request);
-    void on_mesh_settings_change(const shared::MeshSettingsPacket& mesh_settings);
-    void on_video_settings_change(const shared::VideoSettingsPacket& video_settings);
+    bool process_render_request(uint32_t connection, const shared::RenderRequestPacket& render_request); // Returns false if the request has to be deferred
+
+    bool create_client(uint32_t connection, const shared::SessionCreatePacket& session_create);
+    void destroy_client(uint32_t connection);
+    ApplicationScene* acquire_scene(const shared::SessionCreatePacket& session_create);
+    void release_scene(ApplicationScene* scene);
+
+    void on_session_create(uint32_t connection, const shared::SessionCreatePacket& session_create);
+    void on_session_destroy(uint32_t connection, const shared::SessionDestroyPacket& session_destroy);
+    void on_render_request(uint32_t connection, const shared::RenderRequestPacket& render_request);
+    void on_mesh_settings_change(uint32_t connection, const shared::MeshSettingsPacket& mesh_settings);
+    void on_video_settings_change(uint32_t connection, const shared::VideoSettingsPacket& video_settings);
 
     static void GLAPIENTRY on_opengl_error(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam);
 };
@@ -0,0 +1,38 @@
+#ifndef HEADER_CANCEL_TOKEN
+#define HEADER_CANCEL_TOKEN
+
+#include <atomic>
+
+// Flag that is set by the owner of a long running operation to ask the operation to stop as soon as possible.
+// The operation polls the token at points where it can stop safely and discards its partial result.
+class CancelToken
+{
+private:
+    std::atomic<bool> cancelled = false;
+
+public:
+    CancelToken() = default;
+
+    void cancel()
+    {
+        this->cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    void reset()
+    {
+        this->cancelled.store(false, std::memory_order_relaxed);
+    }
+
+    bool is_cancelled() const
+    {
+        return this->cancelled.load(std::memory_order_relaxed);
+    }
+
+    // Operations that can be cancelled take an optional token, which is never cancelled if it is missing
+    static bool check(const CancelToken* token)
+    {
+        return token != nullptr && token->is_cancelled();
+    }
+};
+
+#endif
\ No newline at end of file
@@ -59,9 +59,22 @@ bool CommandParser::parse(uint32_t argument_count, const char** argument_list)
 
     for (const std::string& flag : flags)
     {
-        spdlog::error("Invalid flag: {}", flag);
+        if (flag == "quad_reference")
+        {
+            this->quad_reference = true;
+        }
+
+        else if (flag == "loop_reference")
+        {
+            this->loop_reference = true;
+        }
+
+        else
+        {
+            spdlog::error("Invalid flag: {}", flag);
 
-        return false;
+            return false;
+        }
     }
 
     for (const Parameter& parameter : parameters)
@@ -106,6 +119,53 @@ bool CommandParser::parse(uint32_t argument_count, const char** argument_list)
             this->study_directory = parameter.value;
         }
 
+        else if (parameter.name == "thread_placement")
+        {
+            if (parameter.value == "none")
+            {
+                this->thread_placement = THREAD_PLACEMENT_POLICY_NONE;
+            }
+
+            else if (parameter.value == "compact")
+            {
+                this->thread_placement = THREAD_PLACEMENT_POLICY_COMPACT;
+            }
+
+            else if (parameter.value == "scatter")
+            {
+                this->thread_placement = THREAD_PLACEMENT_POLICY_SCATTER;
+            }
+
+            else
+            {
+                spdlog::error("Invalid thread placement: {}", parameter.value);
+
+                return false;
+            }
+        }
+
+        else if (parameter.name == "numa_node")
+        {
+            this->numa_node = std::atoi(parameter.value.c_str());
+        }
+
+        else if (parameter.name == "thread_report_interval")
+        {
+            this->thread_report_interval = std::atof(parameter.value.c_str());
+        }
+
+        else if (parameter.name == "connection_limit")
+        {
+            this->connection_limit = std::atoi(parameter.value.c_str());
+
+            if (this->connection_limit == 0)
+            {
+                spdlog::error("Invalid connection limit: {}", parameter.value);
+
+                return false;
+            }
+        }
+
         else
         {
             spdlog::error("Invalid parameter: {}", parameter.name);
@@ -160,4 +220,34 @@ float CommandParser::get_sky_intensity() const
 float CommandParser::get_sky_rotation() const
 {
     return this->sky_rotation;
+}
+
+bool CommandParser::get_quad_reference() const
+{
+    return this->quad_reference;
+}
+
+bool CommandParser::get_loop_reference() const
+{
+    return this->loop_reference;
+}
+
+ThreadPlacementPolicy CommandParser::get_thread_placement() const
+{
+    return this->thread_placement;
+}
+
+std::optional<uint32_t> CommandParser::get_numa_node() const
+{
+    return this->numa_node;
+}
+
+float CommandParser::get_thread_report_interval() const
+{
+    return this->thread_report_interval;
+}
+
+uint32_t CommandParser::get_connection_limit() const
+{
+    return this->connection_limit;
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <string>
 #include <cstdint>
 
+#include "thread_placement.hpp"
+
 class CommandParser
 {
 private:
@@ -20,6 +22,15 @@ private:
     float sky_intensity = 1.0f;
     float sky_rotation = 0.0f;
 
+    bool quad_reference = false; // Use the cpu implementation of the quad based mesh generator
+    bool loop_reference = false; // Use the cpu implementation of the loop based mesh generator
+
+    ThreadPlacementPolicy thread_placement = THREAD_PLACEMENT_POLICY_NONE;
+    std::optional<uint32_t> numa_node;  // Restrict all threads to the cores of this node
+    float thread_report_interval = 0.0f; // Time in seconds between the reports of the cpu utilisation of each thread. Zero disables the reports.
+
+    uint32_t connection_limit = 4; // Maximum number of clients that can be connected at the same time
+
 public:
     CommandParser() = default;
 
@@ -36,6 +47,15 @@ public:
     std::optional<std::string> get_sky_file_name() const;
     float get_sky_intensity() const;
     float get_sky_rotation() const;
+
+    bool get_quad_reference() const;
+    bool get_loop_reference() const;
+
+    ThreadPlacementPolicy get_thread_placement() const;
+    std::optional<uint32_t> get_numa_node() const;
+    float get_thread_report_interval() const;
+
+    uint32_t get_connection_limit() const;
 };
 
 #endif
\ No newline at end of file
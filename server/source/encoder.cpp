@@ -8,15 +8,17 @@
 #include <dlfcn.h>
 #endif
 
-bool EncoderWorker::create(EncoderContext* context, void* nvenc_session)
+bool EncoderWorker::create(EncoderContext* context, ThreadPlacement* thread_placement, void* nvenc_session)
 {
     this->nvenc_session = nvenc_session;
     this->context = context;
     this->state = ENCODER_WORKER_STATE_ACTIVE;
 
-    this->thread = std::thread([this]()
+    this->thread = std::thread([this, thread_placement]()
     {
+        thread_placement->place_thread(THREAD_ROLE_ENCODER, "Encoder");
         this->worker();
+        thread_placement->remove_thread();
     });
 
     return true;
@@ -24,8 +26,17 @@ bool EncoderWorker::create(EncoderContext* context, void* nvenc_session)
 
 void EncoderWorker::destroy()
 {
+    if (!this->thread.joinable())
+    {
+        return;
+    }
+
+    //Discard the frames that are not yet waited for, so that the worker only finishes the frame it is currently waiting for
+    std::unique_lock<std::mutex> lock(this->mutex);
     this->state = ENCODER_WORKER_STATE_INACTIVE;
+    this->input_queue.clear();
     this->condition.notify_one();
+    lock.unlock();
 
     this->thread.join();
 }
@@ -423,7 +434,7 @@ void EncoderContext::shutdown_nvenc()
     this->nvenc_NvEncodeAPICreateInstance = nullptr;
 }
 
-bool Encoder::create(EncoderContext* context, EncoderCodec codec, const glm::uvec2& resolution, bool chroma_subsampling)
+bool Encoder::create(EncoderContext* context, ThreadPlacement* thread_placement, EncoderCodec codec, const glm::uvec2& resolution, bool chroma_subsampling)
 {
     this->context = context;
     this->codec = codec;
@@ -435,7 +446,7 @@ bool Encoder::create(EncoderContext* context, EncoderCodec codec, const glm::uve
         return false;
     }
 
-    if (!this->worker.create(this->context, this->nvenc_session))
+    if (!this->worker.create(this->context, thread_placement, this->nvenc_session))
     {
         return false;
     }
@@ -443,6 +454,11 @@ bool Encoder::create(EncoderContext* context, EncoderCodec codec, const glm::uve
     return true;
 }
 
+void Encoder::cancel()
+{
+    this->worker.destroy();
+}
+
 void Encoder::destroy()
 {
     this->worker.destroy();
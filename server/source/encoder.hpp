@@ -14,6 +14,8 @@
 #include <vector>
 #include <chrono>
 
+#include "thread_placement.hpp"
+
 #if defined(_WIN32)
 typedef PFN_vkGetMemoryWin32HandleKHR vkGetMemoryWin32HandleKHRType;
 typedef PFN_vkGetSemaphoreWin32HandleKHR vkGetSemaphoreWin32HandleKHRType;
@@ -129,7 +131,8 @@ private:
 public:
     EncoderWorker() = default;
 
-    bool create(EncoderContext* context, void* nvenc_session);
+    bool create(EncoderContext* context, ThreadPlacement* thread_placement, void* nvenc_session);
+    // Can be called more than once. Outputs that are not yet waited for are discarded.
     void destroy();
 
     void submit_input(const EncoderWorkerInput& input);
@@ -202,7 +205,9 @@ private:
 public:
     Encoder() = default;
 
-    bool create(EncoderContext* context, EncoderCodec codec, const glm::uvec2& resolution, bool chroma_subsampling);
+    bool create(EncoderContext* context, ThreadPlacement* thread_placement, EncoderCodec codec, const glm::uvec2& resolution, bool chroma_subsampling);
+    // Stops waiting for the output of submitted frames, so that the encoder can be destroyed without waiting for the remaining frames
+    void cancel();
     void destroy();
 
     EncoderFrame* create_frame();
@@ -134,7 +134,7 @@ bool export_depth_image(const std::string& file_name, const glm::uvec2& resoluti
 	return true;
 }
 
-bool export_mesh(const std::string& file_name, const std::vector<shared::Vertex>& vertices, const std::vector<shared::Index>& indices, const glm::mat4& view_matrix, const glm::mat4& projection_matrix, const glm::uvec2& resolution)
+bool export_mesh(const std::string& file_name, std::span<const shared::Vertex> vertices, std::span<const shared::Index> indices, const glm::mat4& view_matrix, const glm::mat4& projection_matrix, const glm::uvec2& resolution)
 {
 	if (!file_name.ends_with(".obj"))
 	{
@@ -183,14 +183,14 @@ bool export_mesh(const std::string& file_name, const std::vector<shared::Vertex>
 
 	for (const shared::Vertex& vertex : vertices)
 	{
-		file << "v " << vertex.x << " " << vertex.y << " " << vertex.z << std::endl;
+		file << "v " << vertex.x << " " << vertex.y << " " << vertex.z << "\n"; //Don't flush after each line
 	}
 
 	file << "o layer_mesh" << std::endl;
 
 	for (uint32_t index = 0; index < indices.size(); index += 3)
 	{
-		file << "f " << (indices[index] + 1) << " " << (indices[index + 1] + 1) << " " << (indices[index + 2] + 1) << std::endl;
+		file << "f " << (indices[index] + 1) << " " << (indices[index + 1] + 1) << " " << (indices[index + 2] + 1) << "\n";
 	}
 
 	file.close();
@@ -227,16 +227,147 @@ bool export_feature_lines(const std::string& file_name, const std::vector<MeshFe
 
 	for (const MeshFeatureLine& feature_line : feature_lines)
 	{
-		file << "v " << feature_line.start.x << " " << feature_line.start.y << " " << feature_line.id << std::endl;
-		file << "v " << feature_line.end.x << " " << feature_line.end.y << " " << feature_line.id << std::endl;
+		file << "v " << feature_line.start.x << " " << feature_line.start.y << " " << feature_line.id << "\n"; //Don't flush after each line
+		file << "v " << feature_line.end.x << " " << feature_line.end.y << " " << feature_line.id << "\n";
 	}
 
 	for (uint32_t index = 0; index < feature_lines.size(); index++)
 	{
-		file << "l " << (index * 2 + 1) << " " << (index * 2 + 2) << std::endl;
+		file << "l " << (index * 2 + 1) << " " << (index * 2 + 2) << "\n";
 	}
 
 	file.close();
 
 	return true;
+}
+
+bool ExportPool::create(ThreadPlacement* thread_placement, uint32_t thread_count)
+{
+	this->active = true;
+
+	for (uint32_t index = 0; index < EXPORT_POOL_JOB_COUNT; index++)
+	{
+		ExportJob* job = new ExportJob;
+
+		this->jobs.push_back(job);
+		this->free_jobs.push_back(job);
+	}
+
+	for (uint32_t index = 0; index < thread_count; index++)
+	{
+		std::thread thread = std::thread([this, thread_placement, index]()
+		{
+			thread_placement->place_thread(THREAD_ROLE_EXPORT, "Export " + std::to_string(index));
+			this->worker();
+			thread_placement->remove_thread();
+		});
+
+		this->threads.push_back(std::move(thread));
+	}
+
+	return true;
+}
+
+void ExportPool::destroy()
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->active = false;
+	this->input_condition.notify_all();
+	lock.unlock();
+
+	for (std::thread& thread : this->threads)
+	{
+		thread.join();
+	}
+
+	for (ExportJob* job : this->jobs)
+	{
+		delete job;
+	}
+
+	this->threads.clear();
+	this->jobs.clear();
+	this->input_queue.clear();
+	this->free_jobs.clear();
+}
+
+ExportJob* ExportPool::allocate_job()
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+
+	if (this->free_jobs.empty())
+	{
+		spdlog::error("ExportPool: All export jobs are in use, skipping export!");
+
+		return nullptr;
+	}
+
+	ExportJob* job = this->free_jobs.back();
+	this->free_jobs.pop_back();
+
+	return job;
+}
+
+void ExportPool::submit_job(ExportJob* job)
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+
+	this->input_queue.push_back(job);
+	this->input_condition.notify_one();
+}
+
+void ExportPool::worker()
+{
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+
+		while (this->input_queue.empty())
+		{
+			if (!this->active)
+			{
+				return;
+			}
+
+			this->input_condition.wait(lock);
+		}
+
+		//Take the oldest job first. With more than one thread, jobs can still finish in any order, which is fine since each job writes its own file
+		ExportJob* job = this->input_queue.front();
+		this->input_queue.erase(this->input_queue.begin());
+		lock.unlock();
+
+		this->write_job(job);
+
+		//Keep the capacity of the buffers for the next export
+		job->image.clear();
+		job->vertices.clear();
+		job->indices.clear();
+		job->feature_lines.clear();
+
+		lock.lock();
+		this->free_jobs.push_back(job);
+	}
+}
+
+void ExportPool::write_job(ExportJob* job)
+{
+	switch (job->type)
+	{
+	case EXPORT_JOB_TYPE_COLOR_IMAGE:
+		export_color_image(job->file_name, job->resolution, job->image.data(), job->image.size());
+		break;
+	case EXPORT_JOB_TYPE_DEPTH_IMAGE:
+		export_depth_image(job->file_name, job->resolution, job->image.data(), job->image.size());
+		break;
+	case EXPORT_JOB_TYPE_MESH:
+		export_mesh(job->file_name, job->vertices, job->indices, job->view_matrix, job->projection_matrix, job->resolution);
+		break;
+	case EXPORT_JOB_TYPE_FEATURE_LINES:
+		export_feature_lines(job->file_name, job->feature_lines, job->resolution);
+		break;
+	default:
+		spdlog::error("Export: Unknown export job!");
+		break;
+	}
 }
\ No newline at end of file
@@ -5,14 +5,79 @@
 #include <types.hpp>
 #include <vector>
 #include <string>
+#include <span>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <cstdint>
 
 #include "mesh_generator/mesh_generator.hpp"
+#include "thread_placement.hpp"
+
+#define EXPORT_POOL_THREAD_COUNT 2 // Number of threads that write the exported files
+#define EXPORT_POOL_JOB_COUNT    32 // Maximum number of exports that can wait for their file to be written
 
 bool prevent_override(const std::string& file_name);
 bool export_color_image(const std::string& file_name, const glm::uvec2& resolution, uint8_t* data, uint32_t size);
 bool export_depth_image(const std::string& file_name, const glm::uvec2& resolution, uint8_t* data, uint32_t size);
-bool export_mesh(const std::string& file_name, const std::vector<shared::Vertex>& vertices, const std::vector<shared::Index>& indices, const glm::mat4& view_matrix, const glm::mat4& projection_matrix, const glm::uvec2& resolution);
+bool export_mesh(const std::string& file_name, std::span<const shared::Vertex> vertices, std::span<const shared::Index> indices, const glm::mat4& view_matrix, const glm::mat4& projection_matrix, const glm::uvec2& resolution);
 bool export_feature_lines(const std::string& file_name, const std::vector<MeshFeatureLine>& feature_lines, const glm::uvec2& resolution);
 
+enum ExportJobType
+{
+	EXPORT_JOB_TYPE_COLOR_IMAGE,
+	EXPORT_JOB_TYPE_DEPTH_IMAGE,
+	EXPORT_JOB_TYPE_MESH,
+	EXPORT_JOB_TYPE_FEATURE_LINES
+};
+
+// Snapshot of the data of an export, so that the file can be written after the frame was reused
+class ExportJob
+{
+public:
+	ExportJobType type = EXPORT_JOB_TYPE_COLOR_IMAGE;
+	std::string file_name;
+	glm::uvec2 resolution = glm::uvec2(0);
+
+	std::vector<uint8_t> image;
+	std::vector<shared::Vertex> vertices;
+	std::vector<shared::Index> indices;
+	std::vector<MeshFeatureLine> feature_lines;
+	glm::mat4 view_matrix = glm::mat4(1.0f);
+	glm::mat4 projection_matrix = glm::mat4(1.0f);
+
+public:
+	ExportJob() = default;
+};
+
+// Writes the exported files on dedicated threads, so that the threads that process the frames don't wait for the disk.
+// The number of jobs is bounded, so that a slow disk only causes further exports to be skipped instead of consuming all memory.
+class ExportPool
+{
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable input_condition;
+
+	std::vector<ExportJob*> jobs;
+	std::vector<ExportJob*> input_queue; //Protected by mutex
+	std::vector<ExportJob*> free_jobs;   //Protected by mutex
+	bool active = false;                 //Protected by mutex
+
+public:
+	ExportPool() = default;
+
+	bool create(ThreadPlacement* thread_placement, uint32_t thread_count = EXPORT_POOL_THREAD_COUNT);
+	// Writes all files that are already submitted and stops the threads
+	void destroy();
+
+	// Returns nullptr if the maximum number of jobs is in use, since the jobs are allocated by tasks of the scheduler which must not wait for the disk
+	ExportJob* allocate_job();
+	void submit_job(ExportJob* job);
+
+private:
+	void worker();
+	void write_job(ExportJob* job);
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,769 @@
+#include "line_delaunay.hpp"
+
+void LineDelaunay::clear(const glm::ivec2& domain_min, const glm::ivec2& domain_max)
+{
+    this->points.clear();
+    this->point_edges.clear();
+    this->edge_points.clear();
+    this->edge_twins.clear();
+    this->edge_constraints.clear();
+    this->legalize_stack.clear();
+
+    this->domain_min = domain_min;
+    this->domain_max = domain_max;
+    this->last_edge = 0;
+    this->walk_seed = 0;
+
+    this->points.push_back(glm::ivec2(domain_min.x, domain_min.y));
+    this->points.push_back(glm::ivec2(domain_max.x, domain_min.y));
+    this->points.push_back(glm::ivec2(domain_max.x, domain_max.y));
+    this->points.push_back(glm::ivec2(domain_min.x, domain_max.y));
+    this->point_edges.resize(4, LINE_DELAUNAY_INVALID_INDEX);
+
+    uint32_t triangle1 = this->create_triangle();
+    uint32_t triangle2 = this->create_triangle();
+
+    this->set_triangle(triangle1, 0, 1, 2);
+    this->set_triangle(triangle2, 0, 2, 3);
+
+    //Border edges have no twin and are always constrained
+    this->link_external(3 * triangle1 + 0, LINE_DELAUNAY_INVALID_INDEX);
+    this->link_external(3 * triangle1 + 1, LINE_DELAUNAY_INVALID_INDEX);
+    this->link_external(3 * triangle2 + 1, LINE_DELAUNAY_INVALID_INDEX);
+    this->link_external(3 * triangle2 + 2, LINE_DELAUNAY_INVALID_INDEX);
+    this->link(3 * triangle1 + 2, 3 * triangle2 + 0, false);
+}
+
+uint32_t LineDelaunay::insert_point(const glm::ivec2& point)
+{
+    glm::ivec2 position = glm::clamp(point, this->domain_min, this->domain_max);
+
+    uint32_t edge = LINE_DELAUNAY_INVALID_INDEX;
+    LineDelaunayLocation location = this->locate(position, edge);
+
+    if (location == LINE_DELAUNAY_LOCATION_POINT)
+    {
+        return this->edge_points[edge];
+    }
+
+    uint32_t point_index = this->points.size();
+    this->points.push_back(position);
+    this->point_edges.push_back(LINE_DELAUNAY_INVALID_INDEX);
+
+    if (location == LINE_DELAUNAY_LOCATION_EDGE)
+    {
+        this->split_edge(edge, point_index);
+    }
+
+    else
+    {
+        this->split_triangle(edge / 3, point_index);
+    }
+
+    this->legalize();
+
+    return point_index;
+}
+
+bool LineDelaunay::insert_constraint(uint32_t point_index1, uint32_t point_index2)
+{
+    this->split_count = 0;
+    this->split_depth = 0;
+
+    return this->insert_constraint_parts(point_index1, point_index2);
+}
+
+const std::vector<glm::ivec2>& LineDelaunay::get_points() const
+{
+    return this->points;
+}
+
+uint32_t LineDelaunay::get_triangle_count() const
+{
+    return this->edge_points.size() / 3;
+}
+
+glm::uvec3 LineDelaunay::get_triangle(uint32_t triangle_index) const
+{
+    glm::uvec3 triangle;
+    triangle.x = this->edge_points[3 * triangle_index + 0];
+    triangle.y = this->edge_points[3 * triangle_index + 1];
+    triangle.z = this->edge_points[3 * triangle_index + 2];
+
+    return triangle;
+}
+
+bool LineDelaunay::insert_constraint_parts(uint32_t point_index1, uint32_t point_index2)
+{
+    uint32_t current_point = point_index1;
+
+    while (current_point != point_index2)
+    {
+        uint32_t reached_point = LINE_DELAUNAY_INVALID_INDEX;
+
+        if (!this->insert_constraint_part(current_point, point_index2, reached_point))
+        {
+            return false;
+        }
+
+        current_point = reached_point;
+    }
+
+    return true;
+}
+
+LineDelaunayLocation LineDelaunay::locate(const glm::ivec2& point, uint32_t& edge)
+{
+    LineDelaunayLocation location = LINE_DELAUNAY_LOCATION_TRIANGLE;
+    uint32_t triangle_count = this->get_triangle_count();
+    uint32_t current_edge = this->last_edge;
+
+    //Visibility walk starting at the triangle of the last insertion.
+    //The order in which the edges are tested is randomized so that the walk can not cycle.
+    for (uint32_t step = 0; step < triangle_count; step++)
+    {
+        uint32_t triangle = current_edge / 3;
+        uint32_t next_edge = LINE_DELAUNAY_INVALID_INDEX;
+
+        this->walk_seed = this->walk_seed * 1103515245 + 12345;
+        uint32_t offset = (this->walk_seed >> 16) % 3;
+
+        for (uint32_t index = 0; index < 3; index++)
+        {
+            uint32_t test_edge = 3 * triangle + (offset + index) % 3;
+            const glm::ivec2& point1 = this->points[this->edge_points[test_edge]];
+            const glm::ivec2& point2 = this->points[this->edge_points[LineDelaunay::next_edge(test_edge)]];
+
+            if (LineDelaunay::orientation(point1, point2, point) < 0)
+            {
+                next_edge = this->edge_twins[test_edge];
+
+                break;
+            }
+        }
+
+        if (next_edge == LINE_DELAUNAY_INVALID_INDEX)
+        {
+            if (this->classify(triangle, point, location, edge))
+            {
+                this->last_edge = 3 * triangle;
+
+                return location;
+            }
+
+            break;
+        }
+
+        current_edge = next_edge;
+    }
+
+    //Fallback in case the walk left the domain or did not terminate
+    for (uint32_t triangle = 0; triangle < triangle_count; triangle++)
+    {
+        if (this->classify(triangle, point, location, edge))
+        {
+            this->last_edge = 3 * triangle;
+
+            return location;
+        }
+    }
+
+    edge = 0;
+
+    return LINE_DELAUNAY_LOCATION_TRIANGLE;
+}
+
+bool LineDelaunay::classify(uint32_t triangle, const glm::ivec2& point, LineDelaunayLocation& location, uint32_t& edge) const
+{
+    uint32_t zero_count = 0;
+    uint32_t zero_edge = LINE_DELAUNAY_INVALID_INDEX;
+
+    for (uint32_t index = 0; index < 3; index++)
+    {
+        uint32_t test_edge = 3 * triangle + index;
+        const glm::ivec2& point1 = this->points[this->edge_points[test_edge]];
+        const glm::ivec2& point2 = this->points[this->edge_points[LineDelaunay::next_edge(test_edge)]];
+
+        int64_t side = LineDelaunay::orientation(point1, point2, point);
+
+        if (side < 0)
+        {
+            return false;
+        }
+
+        else if (side == 0)
+        {
+            zero_count++;
+            zero_edge = test_edge;
+        }
+    }
+
+    if (zero_count == 0)
+    {
+        location = LINE_DELAUNAY_LOCATION_TRIANGLE;
+        edge = 3 * triangle;
+    }
+
+    else if (zero_count == 1)
+    {
+        location = LINE_DELAUNAY_LOCATION_EDGE;
+        edge = zero_edge;
+    }
+
+    else
+    {
+        location = LINE_DELAUNAY_LOCATION_POINT;
+        edge = 3 * triangle;
+
+        for (uint32_t index = 0; index < 3; index++)
+        {
+            if (glm::all(glm::equal(this->points[this->edge_points[3 * triangle + index]], point)))
+            {
+                edge = 3 * triangle + index;
+
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+void LineDelaunay::split_triangle(uint32_t triangle, uint32_t point_index)
+{
+    uint32_t point1 = this->edge_points[3 * triangle + 0];
+    uint32_t point2 = this->edge_points[3 * triangle + 1];
+    uint32_t point3 = this->edge_points[3 * triangle + 2];
+
+    uint32_t twin1 = this->edge_twins[3 * triangle + 0];
+    uint32_t twin2 = this->edge_twins[3 * triangle + 1];
+    uint32_t twin3 = this->edge_twins[3 * triangle + 2];
+
+    uint32_t triangle1 = triangle;
+    uint32_t triangle2 = this->create_triangle();
+    uint32_t triangle3 = this->create_triangle();
+
+    this->set_triangle(triangle1, point1, point2, point_index);
+    this->set_triangle(triangle2, point2, point3, point_index);
+    this->set_triangle(triangle3, point3, point1, point_index);
+
+    this->link_external(3 * triangle1 + 0, twin1);
+    this->link_external(3 * triangle2 + 0, twin2);
+    this->link_external(3 * triangle3 + 0, twin3);
+
+    this->link(3 * triangle1 + 1, 3 * triangle2 + 2, false);
+    this->link(3 * triangle2 + 1, 3 * triangle3 + 2, false);
+    this->link(3 * triangle3 + 1, 3 * triangle1 + 2, false);
+
+    this->legalize_stack.push_back(3 * triangle1 + 0);
+    this->legalize_stack.push_back(3 * triangle2 + 0);
+    this->legalize_stack.push_back(3 * triangle3 + 0);
+
+    this->last_edge = 3 * triangle1;
+}
+
+void LineDelaunay::split_edge(uint32_t edge, uint32_t point_index)
+{
+    //The edge goes from point1 to point2 and has the triangles (point1, point2, point3) and (point2, point1, point4) on each side
+    uint32_t twin = this->edge_twins[edge];
+    bool constraint = this->edge_constraints[edge] != 0;
+
+    uint32_t point1 = this->edge_points[edge];
+    uint32_t point2 = this->edge_points[LineDelaunay::next_edge(edge)];
+    uint32_t point3 = this->edge_points[LineDelaunay::previous_edge(edge)];
+
+    uint32_t twin23 = this->edge_twins[LineDelaunay::next_edge(edge)];
+    uint32_t twin31 = this->edge_twins[LineDelaunay::previous_edge(edge)];
+
+    uint32_t triangle1 = edge / 3;
+    uint32_t triangle2 = this->create_triangle();
+
+    this->set_triangle(triangle1, point1, point_index, point3);
+    this->set_triangle(triangle2, point_index, point2, point3);
+
+    this->link_external(3 * triangle1 + 2, twin31);
+    this->link_external(3 * triangle2 + 1, twin23);
+    this->link(3 * triangle1 + 1, 3 * triangle2 + 2, false);
+
+    this->legalize_stack.push_back(3 * triangle1 + 2);
+    this->legalize_stack.push_back(3 * triangle2 + 1);
+
+    if (twin == LINE_DELAUNAY_INVALID_INDEX)
+    {
+        this->link_external(3 * triangle1 + 0, LINE_DELAUNAY_INVALID_INDEX);
+        this->link_external(3 * triangle2 + 0, LINE_DELAUNAY_INVALID_INDEX);
+    }
+
+    else
+    {
+        uint32_t point4 = this->edge_points[LineDelaunay::previous_edge(twin)];
+
+        uint32_t twin14 = this->edge_twins[LineDelaunay::next_edge(twin)];
+        uint32_t twin42 = this->edge_twins[LineDelaunay::previous_edge(twin)];
+
+        uint32_t triangle3 = twin / 3;
+        uint32_t triangle4 = this->create_triangle();
+
+        this->set_triangle(triangle3, point2, point_index, point4);
+        this->set_triangle(triangle4, point_index, point1, point4);
+
+        this->link_external(3 * triangle3 + 2, twin42);
+        this->link_external(3 * triangle4 + 1, twin14);
+        this->link(3 * triangle3 + 1, 3 * triangle4 + 2, false);
+
+        //Both halfs of a split constraint remain constrained
+        this->link(3 * triangle1 + 0, 3 * triangle4 + 0, constraint);
+        this->link(3 * triangle2 + 0, 3 * triangle3 + 0, constraint);
+
+        this->legalize_stack.push_back(3 * triangle3 + 2);
+        this->legalize_stack.push_back(3 * triangle4 + 1);
+    }
+
+    this->last_edge = 3 * triangle1;
+}
+
+void LineDelaunay::legalize()
+{
+    while (!this->legalize_stack.empty())
+    {
+        uint32_t edge = this->legalize_stack.back();
+        this->legalize_stack.pop_back();
+
+        if (this->edge_twins[edge] == LINE_DELAUNAY_INVALID_INDEX || this->edge_constraints[edge] != 0)
+        {
+            continue;
+        }
+
+        if (this->is_delaunay(edge))
+        {
+            continue;
+        }
+
+        uint32_t diagonal = this->flip(edge);
+
+        //The new point is the start point of the diagonal, so check the two edges that are now opposite of it
+        this->legalize_stack.push_back(LineDelaunay::next_edge(diagonal));
+        this->legalize_stack.push_back(LineDelaunay::previous_edge(this->edge_twins[diagonal]));
+    }
+}
+
+void LineDelaunay::restore_delaunay(uint32_t start_edge)
+{
+    this->legalize_stack.push_back(start_edge);
+
+    while (!this->legalize_stack.empty())
+    {
+        uint32_t edge = this->legalize_stack.back();
+        this->legalize_stack.pop_back();
+
+        if (this->edge_twins[edge] == LINE_DELAUNAY_INVALID_INDEX || this->edge_constraints[edge] != 0)
+        {
+            continue;
+        }
+
+        if (this->is_delaunay(edge))
+        {
+            continue;
+        }
+
+        uint32_t diagonal = this->flip(edge);
+        uint32_t twin = this->edge_twins[diagonal];
+
+        //All four edges of the flipped quadrilateral have a new opposite point
+        this->legalize_stack.push_back(LineDelaunay::next_edge(diagonal));
+        this->legalize_stack.push_back(LineDelaunay::previous_edge(diagonal));
+        this->legalize_stack.push_back(LineDelaunay::next_edge(twin));
+        this->legalize_stack.push_back(LineDelaunay::previous_edge(twin));
+    }
+}
+
+uint32_t LineDelaunay::flip(uint32_t edge)
+{
+    //Flip the edge between the triangles (point1, point2, point3) and (point2, point1, point4)
+    //The resulting triangles are (point3, point4, point2) and (point4, point3, point1)
+    uint32_t twin = this->edge_twins[edge];
+
+    uint32_t point1 = this->edge_points[edge];
+    uint32_t point2 = this->edge_points[LineDelaunay::next_edge(edge)];
+    uint32_t point3 = this->edge_points[LineDelaunay::previous_edge(edge)];
+    uint32_t point4 = this->edge_points[LineDelaunay::previous_edge(twin)];
+
+    uint32_t twin23 = this->edge_twins[LineDelaunay::next_edge(edge)];
+    uint32_t twin31 = this->edge_twins[LineDelaunay::previous_edge(edge)];
+    uint32_t twin14 = this->edge_twins[LineDelaunay::next_edge(twin)];
+    uint32_t twin42 = this->edge_twins[LineDelaunay::previous_edge(twin)];
+
+    uint32_t triangle1 = edge / 3;
+    uint32_t triangle2 = twin / 3;
+
+    this->set_triangle(triangle1, point3, point4, point2);
+    this->set_triangle(triangle2, point4, point3, point1);
+
+    this->link(3 * triangle1 + 0, 3 * triangle2 + 0, false);
+    this->link_external(3 * triangle1 + 1, twin42);
+    this->link_external(3 * triangle1 + 2, twin23);
+    this->link_external(3 * triangle2 + 1, twin31);
+    this->link_external(3 * triangle2 + 2, twin14);
+
+    return 3 * triangle1;
+}
+
+bool LineDelaunay::insert_constraint_part(uint32_t start_point, uint32_t end_point, uint32_t& reached_point)
+{
+    const glm::ivec2& start = this->points[start_point];
+    const glm::ivec2& end = this->points[end_point];
+
+    this->collect_outgoing(start_point);
+
+    //Check if the constraint already exists as edge or if an other point lies on the constraint.
+    //The incoming edges are checked as well, since the incoming border edge of a point on the border has no outgoing twin.
+    for (uint32_t edge : this->outgoing_edges)
+    {
+        uint32_t neighbour_edges[2] = { edge, LineDelaunay::previous_edge(edge) };
+        uint32_t neighbour_points[2] = { this->edge_points[LineDelaunay::next_edge(edge)], this->edge_points[LineDelaunay::previous_edge(edge)] };
+
+        for (uint32_t index = 0; index < 2; index++)
+        {
+            uint32_t point_index = neighbour_points[index];
+            const glm::ivec2& point = this->points[point_index];
+
+            if (point_index == end_point || (LineDelaunay::orientation(start, end, point) == 0 && glm::dot(glm::vec2(point - start), glm::vec2(end - start)) > 0.0f))
+            {
+                this->set_constraint(neighbour_edges[index]);
+                reached_point = point_index;
+
+                return true;
+            }
+        }
+    }
+
+    //Find the triangle around the start point through which the constraint leaves
+    uint32_t crossing_edge = LINE_DELAUNAY_INVALID_INDEX;
+
+    for (uint32_t edge : this->outgoing_edges)
+    {
+        const glm::ivec2& point1 = this->points[this->edge_points[LineDelaunay::next_edge(edge)]];
+        const glm::ivec2& point2 = this->points[this->edge_points[LineDelaunay::previous_edge(edge)]];
+
+        if (LineDelaunay::orientation(start, point1, end) > 0 && LineDelaunay::orientation(start, point2, end) < 0)
+        {
+            crossing_edge = LineDelaunay::next_edge(edge);
+
+            break;
+        }
+    }
+
+    if (crossing_edge == LINE_DELAUNAY_INVALID_INDEX)
+    {
+        return false;
+    }
+
+    //Walk along the constraint and collect all edges that intersect it
+    //Every crossing edge starts on the right side of the constraint and ends on the left side
+    this->crossing_edges.clear();
+
+    while (true)
+    {
+        //Nothing was changed so far, so the other constraint can be split before the walk is continued from the intersection
+        if (this->edge_constraints[crossing_edge] != 0)
+        {
+            return this->split_constraint(crossing_edge, start_point, end_point, reached_point);
+        }
+
+        this->crossing_edges.push_back(glm::uvec2(this->edge_points[crossing_edge], this->edge_points[LineDelaunay::next_edge(crossing_edge)]));
+
+        uint32_t twin = this->edge_twins[crossing_edge];
+        uint32_t point_index = this->edge_points[LineDelaunay::previous_edge(twin)];
+        int64_t side = LineDelaunay::orientation(start, end, this->points[point_index]);
+
+        if (point_index == end_point || side == 0)
+        {
+            reached_point = point_index;
+
+            break;
+        }
+
+        else if (side > 0)
+        {
+            crossing_edge = LineDelaunay::next_edge(twin);
+        }
+
+        else
+        {
+            crossing_edge = LineDelaunay::previous_edge(twin);
+        }
+    }
+
+    //Remove the crossing edges by flipping them as long as they form a convex quadrilateral
+    const glm::ivec2& reached = this->points[reached_point];
+    this->created_edges.clear();
+
+    for (uint32_t index = 0; index < this->crossing_edges.size(); index++)
+    {
+        glm::uvec2 crossing = this->crossing_edges[index];
+        uint32_t edge = this->find_edge(crossing.x, crossing.y);
+
+        if (edge == LINE_DELAUNAY_INVALID_INDEX)
+        {
+            return false;
+        }
+
+        const glm::ivec2& point1 = this->points[this->edge_points[edge]];
+        const glm::ivec2& point2 = this->points[this->edge_points[LineDelaunay::next_edge(edge)]];
+        const glm::ivec2& point3 = this->points[this->edge_points[LineDelaunay::previous_edge(edge)]];
+        const glm::ivec2& point4 = this->points[this->edge_points[LineDelaunay::previous_edge(this->edge_twins[edge])]];
+
+        int64_t side1 = LineDelaunay::orientation(point3, point4, point1);
+        int64_t side2 = LineDelaunay::orientation(point3, point4, point2);
+
+        if ((side1 > 0 && side2 < 0) || (side1 < 0 && side2 > 0))
+        {
+            uint32_t diagonal = this->flip(edge);
+            glm::uvec2 diagonal_points = glm::uvec2(this->edge_points[diagonal], this->edge_points[LineDelaunay::next_edge(diagonal)]);
+
+            int64_t diagonal_side1 = LineDelaunay::orientation(start, reached, this->points[diagonal_points.x]);
+            int64_t diagonal_side2 = LineDelaunay::orientation(start, reached, this->points[diagonal_points.y]);
+
+            if ((diagonal_side1 > 0 && diagonal_side2 < 0) || (diagonal_side1 < 0 && diagonal_side2 > 0))
+            {
+                this->crossing_edges.push_back(diagonal_points);
+            }
+
+            else
+            {
+                this->created_edges.push_back(diagonal_points);
+            }
+        }
+
+        else
+        {
+            this->crossing_edges.push_back(crossing);
+        }
+    }
+
+    uint32_t constraint_edge = this->find_edge(start_point, reached_point);
+
+    if (constraint_edge == LINE_DELAUNAY_INVALID_INDEX)
+    {
+        return false;
+    }
+
+    this->set_constraint(constraint_edge);
+
+    //Restore the delaunay property for the newly created edges
+    for (const glm::uvec2& created : this->created_edges)
+    {
+        uint32_t edge = this->find_edge(created.x, created.y);
+
+        if (edge != LINE_DELAUNAY_INVALID_INDEX)
+        {
+            this->restore_delaunay(edge);
+        }
+    }
+
+    return true;
+}
+
+bool LineDelaunay::split_constraint(uint32_t edge, uint32_t start_point, uint32_t end_point, uint32_t& reached_point)
+{
+    //The parts of a crossed constraint get additional splits, since the crossed constraint would be lost otherwise
+    uint32_t split_count_max = (this->split_depth > 0) ? 2 * LINE_DELAUNAY_SPLIT_COUNT_MAX : LINE_DELAUNAY_SPLIT_COUNT_MAX;
+
+    if (this->split_count >= split_count_max)
+    {
+        return false;
+    }
+
+    this->split_count++;
+
+    //Copy the points, since the inserted intersection can reallocate the points
+    uint32_t point_index1 = this->edge_points[edge];
+    uint32_t point_index2 = this->edge_points[LineDelaunay::next_edge(edge)];
+
+    glm::ivec2 point1 = this->points[point_index1];
+    glm::ivec2 point2 = this->points[point_index2];
+    glm::ivec2 start = this->points[start_point];
+    glm::ivec2 end = this->points[end_point];
+
+    //The start and the end of the constraint lie on different sides of the crossed constraint
+    int64_t start_side = LineDelaunay::orientation(point1, point2, start);
+    int64_t end_side = LineDelaunay::orientation(point1, point2, end);
+
+    double factor = (double)start_side / (double)(start_side - end_side);
+    glm::ivec2 intersection = glm::ivec2(glm::round(glm::dvec2(start) + glm::dvec2(end - start) * factor));
+
+    //Release the crossed constraint, so that the intersection can be inserted like any other point.
+    //Due to the rounding the intersection can coincide with an existing point, in which case both constraints are routed through that point.
+    this->link(edge, this->edge_twins[edge], false);
+    this->restore_delaunay(edge);
+
+    uint32_t intersection_point = this->insert_point(intersection);
+
+    this->split_depth++;
+    bool crossed_inserted = this->insert_constraint_parts(point_index1, intersection_point) && this->insert_constraint_parts(intersection_point, point_index2);
+    this->split_depth--;
+
+    if (!crossed_inserted)
+    {
+        return false;
+    }
+
+    if (!this->insert_constraint_parts(start_point, intersection_point))
+    {
+        return false;
+    }
+
+    reached_point = intersection_point;
+
+    return true;
+}
+
+bool LineDelaunay::is_delaunay(uint32_t edge) const
+{
+    uint32_t twin = this->edge_twins[edge];
+
+    const glm::ivec2& point1 = this->points[this->edge_points[edge]];
+    const glm::ivec2& point2 = this->points[this->edge_points[LineDelaunay::next_edge(edge)]];
+    const glm::ivec2& point3 = this->points[this->edge_points[LineDelaunay::previous_edge(edge)]];
+    const glm::ivec2& point4 = this->points[this->edge_points[LineDelaunay::previous_edge(twin)]];
+
+    return LineDelaunay::in_circle(point1, point2, point3, point4) <= 0;
+}
+
+uint32_t LineDelaunay::create_triangle()
+{
+    uint32_t triangle = this->edge_points.size() / 3;
+
+    this->edge_points.resize(this->edge_points.size() + 3, LINE_DELAUNAY_INVALID_INDEX);
+    this->edge_twins.resize(this->edge_twins.size() + 3, LINE_DELAUNAY_INVALID_INDEX);
+    this->edge_constraints.resize(this->edge_constraints.size() + 3, 0);
+
+    return triangle;
+}
+
+void LineDelaunay::set_triangle(uint32_t triangle, uint32_t point1, uint32_t point2, uint32_t point3)
+{
+    this->edge_points[3 * triangle + 0] = point1;
+    this->edge_points[3 * triangle + 1] = point2;
+    this->edge_points[3 * triangle + 2] = point3;
+
+    this->point_edges[point1] = 3 * triangle + 0;
+    this->point_edges[point2] = 3 * triangle + 1;
+    this->point_edges[point3] = 3 * triangle + 2;
+}
+
+void LineDelaunay::link(uint32_t edge, uint32_t twin, bool constraint)
+{
+    this->edge_twins[edge] = twin;
+    this->edge_constraints[edge] = constraint;
+
+    if (twin != LINE_DELAUNAY_INVALID_INDEX)
+    {
+        this->edge_twins[twin] = edge;
+        this->edge_constraints[twin] = constraint;
+    }
+}
+
+void LineDelaunay::link_external(uint32_t edge, uint32_t twin)
+{
+    //Keep the constraint of the neighbouring triangle. Edges on the border are always constrained.
+    if (twin == LINE_DELAUNAY_INVALID_INDEX)
+    {
+        this->link(edge, twin, true);
+    }
+
+    else
+    {
+        this->link(edge, twin, this->edge_constraints[twin] != 0);
+    }
+}
+
+void LineDelaunay::set_constraint(uint32_t edge)
+{
+    this->link(edge, this->edge_twins[edge], true);
+}
+
+void LineDelaunay::collect_outgoing(uint32_t point_index)
+{
+    this->outgoing_edges.clear();
+
+    uint32_t start_edge = this->point_edges[point_index];
+    uint32_t edge = start_edge;
+
+    //Rotate counter-clockwise around the point until the start edge or the border is reached
+    while (true)
+    {
+        this->outgoing_edges.push_back(edge);
+
+        uint32_t twin = this->edge_twins[LineDelaunay::previous_edge(edge)];
+
+        if (twin == start_edge)
+        {
+            return;
+        }
+
+        if (twin == LINE_DELAUNAY_INVALID_INDEX)
+        {
+            break;
+        }
+
+        edge = twin;
+    }
+
+    //Points on the border also need to be rotated clockwise
+    edge = start_edge;
+
+    while (true)
+    {
+        uint32_t twin = this->edge_twins[edge];
+
+        if (twin == LINE_DELAUNAY_INVALID_INDEX)
+        {
+            break;
+        }
+
+        edge = LineDelaunay::next_edge(twin);
+        this->outgoing_edges.push_back(edge);
+    }
+}
+
+uint32_t LineDelaunay::find_edge(uint32_t point_index1, uint32_t point_index2)
+{
+    this->collect_outgoing(point_index1);
+
+    for (uint32_t edge : this->outgoing_edges)
+    {
+        if (this->edge_points[LineDelaunay::next_edge(edge)] == point_index2)
+        {
+            return edge;
+        }
+    }
+
+    return LINE_DELAUNAY_INVALID_INDEX;
+}
+
+int64_t LineDelaunay::orientation(const glm::ivec2& point1, const glm::ivec2& point2, const glm::ivec2& point3)
+{
+    int64_t delta1_x = point2.x - point1.x;
+    int64_t delta1_y = point2.y - point1.y;
+    int64_t delta2_x = point3.x - point1.x;
+    int64_t delta2_y = point3.y - point1.y;
+
+    return delta1_x * delta2_y - delta1_y * delta2_x;
+}
+
+int64_t LineDelaunay::in_circle(const glm::ivec2& point1, const glm::ivec2& point2, const glm::ivec2& point3, const glm::ivec2& point4)
+{
+    int64_t delta1_x = point1.x - point4.x;
+    int64_t delta1_y = point1.y - point4.y;
+    int64_t delta2_x = point2.x - point4.x;
+    int64_t delta2_y = point2.y - point4.y;
+    int64_t delta3_x = point3.x - point4.x;
+    int64_t delta3_y = point3.y - point4.y;
+
+    int64_t length1 = delta1_x * delta1_x + delta1_y * delta1_y;
+    int64_t length2 = delta2_x * delta2_x + delta2_y * delta2_y;
+    int64_t length3 = delta3_x * delta3_x + delta3_y * delta3_y;
+
+    return delta1_x * (delta2_y * length3 - length2 * delta3_y) - delta1_y * (delta2_x * length3 - length2 * delta3_x) + length1 * (delta2_x * delta3_y - delta2_y * delta3_x);
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef HEADER_LINE_DELAUNAY
+#define HEADER_LINE_DELAUNAY
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+#define LINE_DELAUNAY_INVALID_INDEX   0xFFFFFFFF
+#define LINE_DELAUNAY_SPLIT_COUNT_MAX 64 // Maximum number of intersections with other constraints that are resolved while inserting a single constraint
+
+enum LineDelaunayLocation
+{
+    LINE_DELAUNAY_LOCATION_TRIANGLE,
+    LINE_DELAUNAY_LOCATION_EDGE,
+    LINE_DELAUNAY_LOCATION_POINT
+};
+
+// Constrained Delaunay triangulation specialised for integer pixel coordinates inside a rectangle.
+// All predicates are evaluated exactly using 64-bit integer arithmetic, which is sufficient for coordinates up to 8192.
+// The triangulation is stored as half-edges, where the half-edges 3 * t, 3 * t + 1 and 3 * t + 2 form the counter-clockwise triangle t.
+// Constraints that intersect each other are split at their intersection, which is rounded to the integer grid and inserted as additional point.
+// All buffers are kept between calls of clear() so that the memory can be reused for every frame.
+class LineDelaunay
+{
+private:
+    std::vector<glm::ivec2> points;
+    std::vector<uint32_t> point_edges;      // One outgoing half-edge for each point
+
+    std::vector<uint32_t> edge_points;      // Start point of each half-edge
+    std::vector<uint32_t> edge_twins;       // Opposite half-edge or invalid index if the half-edge lies on the border
+    std::vector<uint8_t> edge_constraints;  // Marks half-edges that are not allowed to be flipped
+
+    std::vector<uint32_t> legalize_stack;
+    std::vector<uint32_t> outgoing_edges;
+    std::vector<glm::uvec2> crossing_edges;
+    std::vector<glm::uvec2> created_edges;
+
+    glm::ivec2 domain_min = glm::ivec2(0);
+    glm::ivec2 domain_max = glm::ivec2(0);
+    uint32_t last_edge = 0;
+    uint32_t walk_seed = 0;
+    uint32_t split_count = 0; // Number of intersections that were resolved for the current constraint
+    uint32_t split_depth = 0; // Number of crossed constraints that are currently reinserted
+
+public:
+    LineDelaunay() = default;
+
+    void clear(const glm::ivec2& domain_min, const glm::ivec2& domain_max);
+
+    uint32_t insert_point(const glm::ivec2& point);                // Returns the index of the point. Duplicates are merged.
+    bool insert_constraint(uint32_t point_index1, uint32_t point_index2); // Returns false if the constraint could not be inserted completely, in which case the triangulation stays valid
+
+    const std::vector<glm::ivec2>& get_points() const;
+    uint32_t get_triangle_count() const;
+    glm::uvec3 get_triangle(uint32_t triangle_index) const;
+
+private:
+    LineDelaunayLocation locate(const glm::ivec2& point, uint32_t& edge);
+    bool classify(uint32_t triangle, const glm::ivec2& point, LineDelaunayLocation& location, uint32_t& edge) const;
+    void split_triangle(uint32_t triangle, uint32_t point_index);
+    void split_edge(uint32_t edge, uint32_t point_index);
+    void legalize();
+    void restore_delaunay(uint32_t start_edge); // Unlike legalize(), the edge does not need to be opposite of a new point
+    uint32_t flip(uint32_t edge);
+
+    bool insert_constraint_parts(uint32_t point_index1, uint32_t point_index2);
+    bool insert_constraint_part(uint32_t start_point, uint32_t end_point, uint32_t& reached_point);
+    bool split_constraint(uint32_t edge, uint32_t start_point, uint32_t end_point, uint32_t& reached_point);
+    bool is_delaunay(uint32_t edge) const;
+
+    uint32_t create_triangle();
+    void set_triangle(uint32_t triangle, uint32_t point1, uint32_t point2, uint32_t point3);
+    void link(uint32_t edge, uint32_t twin, bool constraint);
+    void link_external(uint32_t edge, uint32_t twin);
+    void set_constraint(uint32_t edge);
+
+    void collect_outgoing(uint32_t point_index);
+    uint32_t find_edge(uint32_t point_index1, uint32_t point_index2);
+
+    static inline uint32_t next_edge(uint32_t edge)
+    {
+        return (edge % 3 == 2) ? edge - 2 : edge + 1;
+    }
+
+    static inline uint32_t previous_edge(uint32_t edge)
+    {
+        return (edge % 3 == 0) ? edge + 2 : edge - 1;
+    }
+
+    static int64_t orientation(const glm::ivec2& point1, const glm::ivec2& point2, const glm::ivec2& point3);
+    static int64_t in_circle(const glm::ivec2& point1, const glm::ivec2& point2, const glm::ivec2& point3, const glm::ivec2& point4);
+};
+
+#endif
\ No newline at end of file
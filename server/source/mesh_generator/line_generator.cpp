@@ -1,233 +1,220 @@
 #include "line_generator.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <chrono>
+#include <bit>
 
-bool LineQuadTreeLevel::create(const glm::uvec2& resolution)
+bool LineQuadTree::create(const glm::uvec2& resolution)
 {
-    uint32_t level_buffser_size = resolution.x * resolution.y * sizeof(uint8_t);
+    uint32_t mask_buffer_size = LineQuadTree::compute_mask_buffer_size(resolution);
+
+    glGenBuffers(1, &this->mask_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, this->mask_buffer);
 
-    glGenBuffers(1, &this->level_buffer);
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, this->level_buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, mask_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    this->mask_pointer = (const uint32_t*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, mask_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
 
-    glBufferStorage(GL_PIXEL_PACK_BUFFER, level_buffser_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-    this->level_pointer = (uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, level_buffser_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
 
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (this->mask_pointer == nullptr)
+    {
+        return false;
+    }
 
     this->resolution = resolution;
+    this->tile_resolution = LineQuadTree::compute_tile_resolution(resolution);
 
-    return true;
-}
+    //Only the parts of the offset and depth buffer that are actually written by the gpu are transferred
+    uint32_t edge_offset_buffer_size = this->get_tile_count() * LINE_GENERATOR_MASK_TILE_SIZE * (LINE_GENERATOR_MASK_TILE_SIZE / 32) * sizeof(uint32_t);
+    uint32_t edge_depth_buffer_size = (2 * resolution.x + 2 * resolution.y + resolution.x * resolution.y) * sizeof(float);
 
-void LineQuadTreeLevel::destroy()
-{
-    glDeleteBuffers(1, &this->level_buffer);
+    glGenBuffers(1, &this->edge_offset_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->edge_offset_buffer);
 
-    this->level_buffer = 0;
-    this->level_pointer = nullptr;
-}
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, edge_offset_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    this->edge_offset_pointer = (const uint32_t*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, edge_offset_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
 
-inline bool LineQuadTreeLevel::set_pixel(const glm::ivec2& coord, uint8_t value)
-{
-    if (coord.x < 0 || coord.x >= this->resolution.x)
-    {
-        return false;
-    }
+    glGenBuffers(1, &this->edge_depth_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->edge_depth_buffer);
 
-    if (coord.y < 0 || coord.y >= this->resolution.y)
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, edge_depth_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    this->edge_depth_pointer = (const float*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, edge_depth_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    if (this->edge_offset_pointer == nullptr || this->edge_depth_pointer == nullptr)
     {
         return false;
     }
 
-    uint32_t offset = coord.y * this->resolution.x + coord.x;
-    this->level_pointer[offset] = value;
+    this->mask_levels.clear();
+    this->mask_word_counts.clear();
 
-    return true;
-}
+    uint32_t word_count = LINE_GENERATOR_MASK_TILE_SIZE * LINE_GENERATOR_MASK_TILE_ROW_WORDS;
 
-inline bool LineQuadTreeLevel::get_pixel(const glm::ivec2& coord, uint8_t& value) const
-{
-    if (coord.x < 0 || coord.x >= this->resolution.x)
+    while (true)
     {
-        return false;
-    }
+        this->mask_levels.push_back(std::vector<uint64_t>(this->get_tile_count() * LINE_GENERATOR_MASK_BUCKET_COUNT * word_count, 0));
+        this->mask_word_counts.push_back(word_count);
 
-    if (coord.y < 0 || coord.y >= this->resolution.y)
-    {
-        return false;
-    }
+        if (word_count <= 1)
+        {
+            break;
+        }
 
-    uint32_t offset = coord.y * this->resolution.x + coord.x;
-    value = this->level_pointer[offset];
+        word_count = (word_count + 63) / 64;
+    }
 
     return true;
 }
 
-const glm::uvec2& LineQuadTreeLevel::get_resolution() const
+void LineQuadTree::destroy()
 {
-    return this->resolution;
+    glDeleteBuffers(1, &this->mask_buffer);
+    glDeleteBuffers(1, &this->edge_offset_buffer);
+    glDeleteBuffers(1, &this->edge_depth_buffer);
+
+    this->mask_buffer = 0;
+    this->mask_pointer = nullptr;
+    this->edge_offset_buffer = 0;
+    this->edge_offset_pointer = nullptr;
+    this->edge_depth_buffer = 0;
+    this->edge_depth_pointer = nullptr;
+
+    this->mask_levels.clear();
+    this->mask_word_counts.clear();
 }
 
-GLuint LineQuadTreeLevel::get_level_buffer() const
+bool LineQuadTree::fill(GLuint edge_mask_buffer)
 {
-    return this->level_buffer;
-}
+    glBindBuffer(GL_COPY_READ_BUFFER, edge_mask_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, this->mask_buffer);
 
-bool LineQuadTree::create(const glm::uvec2& resolution)
-{
-    glm::uvec2 level_resolution = resolution;
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, LineQuadTree::compute_mask_buffer_size(this->resolution));
 
-    while (level_resolution.x > 1 && level_resolution.y > 1)
-    {
-        LineQuadTreeLevel level;
-
-        if (!level.create(level_resolution))
-        {
-            return false;
-        }
-
-        this->levels.push_back(level);
-
-        level_resolution = (level_resolution + glm::uvec2(1)) / glm::uvec2(2);
-    }
-
-    LineQuadTreeLevel level;
-
-    if (!level.create(level_resolution))
-    {
-        return false;
-    }
-
-    this->levels.push_back(level);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
 
     return true;
 }
 
-void LineQuadTree::destroy()
+bool LineQuadTree::update_tile(uint32_t tile)
 {
-    for (LineQuadTreeLevel& level : this->levels)
+    if (tile >= this->get_tile_count())
     {
-        level.destroy();
+        return false;
     }
 
-    this->levels.clear();
-}
-
-bool LineQuadTree::fill(GLuint buffer)
-{
-    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    //Copy the mask of the tile once so that the persistent mapped memory is not accessed randomly during the line trace
+    uint32_t tile_offset = this->get_word_offset(0, tile, 0);
+    uint32_t tile_word_count = LINE_GENERATOR_MASK_BUCKET_COUNT * this->mask_word_counts.front();
 
-    glBindTexture(GL_TEXTURE_2D, buffer);
+    std::memcpy(this->mask_levels.front().data() + tile_offset, this->mask_pointer + 2 * tile_offset, tile_word_count * sizeof(uint64_t));
 
-    for(uint32_t index = 0; index < this->levels.size(); index++)
+    for (uint32_t level = 1; level < this->mask_levels.size(); level++)
     {
-        const LineQuadTreeLevel& level = this->levels[index];
+        const std::vector<uint64_t>& src_level = this->mask_levels[level - 1];
+        std::vector<uint64_t>& dst_level = this->mask_levels[level];
 
-        glBindBuffer(GL_PIXEL_PACK_BUFFER, level.get_level_buffer());
+        for (uint32_t bucket = 0; bucket < LINE_GENERATOR_MASK_BUCKET_COUNT; bucket++)
+        {
+            uint32_t src_offset = this->get_word_offset(level - 1, tile, bucket);
+            uint32_t dst_offset = this->get_word_offset(level, tile, bucket);
 
-        glGetTexImage(GL_TEXTURE_2D, index, GL_RED, GL_UNSIGNED_BYTE, nullptr);  
-    }
+            std::fill(dst_level.begin() + dst_offset, dst_level.begin() + dst_offset + this->mask_word_counts[level], 0);
 
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    
-    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            for (uint32_t index = 0; index < this->mask_word_counts[level - 1]; index++)
+            {
+                if (src_level[src_offset + index] != 0)
+                {
+                    dst_level[dst_offset + index / 64] |= 1ull << (index % 64);
+                }
+            }
+        }
+    }
 
     return true;
 }
 
 bool LineQuadTree::remove(const glm::ivec2& coord)
 {
-    LineQuadTreeLevel& base_level = this->levels.front();
-
-    if (!base_level.set_pixel(coord, 0))
+    if (coord.x < 0 || coord.x >= this->resolution.x)
     {
         return false;
     }
 
-    for (uint32_t index = 1; index < this->levels.size(); index++)
+    if (coord.y < 0 || coord.y >= this->resolution.y)
     {
-        LineQuadTreeLevel& src_level = this->levels[index - 1];
-        LineQuadTreeLevel& dst_level = this->levels[index];
+        return false;
+    }
+
+    uint32_t tile = this->get_tile(coord);
 
-        glm::ivec2 dst_coord = coord >> (int32_t)index;
-        uint8_t dst_value = 0;
+    glm::ivec2 local_coord = coord % glm::ivec2(LINE_GENERATOR_MASK_TILE_SIZE);
+    uint32_t word_index = local_coord.y * LINE_GENERATOR_MASK_TILE_ROW_WORDS + local_coord.x / 64;
+    uint32_t word_bit = local_coord.x % 64;
 
-        for (uint32_t offset_y = 0; offset_y < 2; offset_y++)
+    for (uint32_t bucket = 0; bucket < LINE_GENERATOR_MASK_BUCKET_COUNT; bucket++)
+    {
+        if ((this->mask_levels.front()[this->get_word_offset(0, tile, bucket) + word_index] & (1ull << word_bit)) == 0)
         {
-            for (uint32_t offset_x = 0; offset_x < 2; offset_x++)
-            {
-                glm::ivec2 src_coord = dst_coord * 2 + glm::ivec2(offset_x, offset_y);
-                uint8_t src_value = 0;
+            continue;
+        }
 
-                if (!src_level.get_pixel(src_coord, src_value))
-                {
-                    continue;
-                }
+        //Clear the bit and propagate upwards as long as the words become empty
+        uint32_t index = word_index;
+        uint32_t bit = word_bit;
 
-                dst_value = glm::max(dst_value, src_value);
+        for (uint32_t level = 0; level < this->mask_levels.size(); level++)
+        {
+            uint64_t& word = this->mask_levels[level][this->get_word_offset(level, tile, bucket) + index];
+            word &= ~(1ull << bit);
+
+            if (word != 0)
+            {
+                break;
             }
-        }
 
-        if (!dst_level.set_pixel(dst_coord, dst_value))
-        {
-            return false;
+            bit = index % 64;
+            index = index / 64;
         }
+
+        break;
     }
 
     return true;
 }
 
-bool LineQuadTree::find_global(glm::ivec2& coord) const
+bool LineQuadTree::find_global(uint32_t tile, glm::ivec2& coord) const
 {
-    const LineQuadTreeLevel& root_level = this->levels.back();
-
-    glm::ivec2 global_coord = glm::ivec2(0);
-    uint8_t global_value = 0;
-
-    if (!root_level.get_pixel(global_coord, global_value))
+    if (tile >= this->get_tile_count())
     {
         return false;
     }
 
-    for (int32_t index = this->levels.size() - 1; index >= 1; index--)
-    {
-        const LineQuadTreeLevel& level = this->levels[index - 1];
-
-        glm::ivec2 seach_coord = glm::ivec2(0);
-        uint8_t search_value = 0;
+    uint32_t top_level = this->mask_levels.size() - 1;
 
-        for (uint32_t offset_y = 0; offset_y < 2; offset_y++)
+    for (int32_t bucket = LINE_GENERATOR_MASK_BUCKET_COUNT - 1; bucket >= 0; bucket--)
+    {
+        if (this->mask_levels[top_level][this->get_word_offset(top_level, tile, bucket)] == 0)
         {
-            for (uint32_t offset_x = 0; offset_x < 2; offset_x++)
-            {
-                glm::ivec2 level_coord = global_coord * 2 + glm::ivec2(offset_x, offset_y);
-                uint8_t level_value = 0;
-
-                if (!level.get_pixel(level_coord, level_value))
-                {
-                    continue;
-                }
-
-                if (level_value > search_value)
-                {
-                    seach_coord = level_coord;
-                    search_value = level_value;
-                }
-            }
+            continue;
         }
 
-        if (search_value != global_value)
+        uint32_t index = 0;
+
+        for (int32_t level = top_level; level >= 0; level--)
         {
-            return false;
+            uint64_t word = this->mask_levels[level][this->get_word_offset(level, tile, bucket) + index];
+            index = index * 64 + std::countr_zero(word);
         }
 
-        global_coord = seach_coord;
-    }
+        //At the mask level the index combines the word index and the bit
+        uint32_t word_index = index / 64;
 
-    if (global_value > 0)
-    {
-        coord = global_coord;
+        coord.x = (tile % this->tile_resolution.x) * LINE_GENERATOR_MASK_TILE_SIZE + (word_index % LINE_GENERATOR_MASK_TILE_ROW_WORDS) * 64 + index % 64;
+        coord.y = (tile / this->tile_resolution.x) * LINE_GENERATOR_MASK_TILE_SIZE + word_index / LINE_GENERATOR_MASK_TILE_ROW_WORDS;
 
         return true;
     }
@@ -237,8 +224,6 @@ bool LineQuadTree::find_global(glm::ivec2& coord) const
 
 bool LineQuadTree::find_local(const glm::ivec2& center_coord, std::vector<glm::ivec2>& coords) const
 {
-    const LineQuadTreeLevel& base_level = this->levels.front();
-
     std::vector<glm::ivec2> local_coords;
 
     for (int32_t offset_y = -1; offset_y <= 1; offset_y++)
@@ -253,7 +238,7 @@ bool LineQuadTree::find_local(const glm::ivec2& center_coord, std::vector<glm::i
             glm::ivec2 base_coord = center_coord + glm::ivec2(offset_x, offset_y);
             uint8_t base_value = 0;
 
-            if (!base_level.get_pixel(base_coord, base_value))
+            if (!this->get_pixel(base_coord, base_value))
             {
                 continue;
             }
@@ -275,10 +260,8 @@ bool LineQuadTree::find_local(const glm::ivec2& center_coord, std::vector<glm::i
     return false;
 }
 
-bool LineQuadTree::find_local_max(const glm::ivec2& center_coord, glm::ivec2& coord) const
+bool LineQuadTree::find_local_max(uint32_t tile, const glm::ivec2& center_coord, glm::ivec2& coord) const
 {
-    const LineQuadTreeLevel& base_level = this->levels.front();
-
     glm::ivec2 local_coord = glm::ivec2(0);
     uint8_t local_value = 0;
 
@@ -294,7 +277,13 @@ bool LineQuadTree::find_local_max(const glm::ivec2& center_coord, glm::ivec2& co
             glm::ivec2 base_coord = center_coord + glm::ivec2(offset_x, offset_y);
             uint8_t base_value = 0;
 
-            if (!base_level.get_pixel(base_coord, base_value))
+            //Check the tile first, since pixels of other tiles can be modified concurrently
+            if (base_coord.x < 0 || base_coord.y < 0 || this->get_tile(base_coord) != tile)
+            {
+                continue;
+            }
+
+            if (!this->get_pixel(base_coord, base_value))
             {
                 continue;
             }
@@ -319,17 +308,151 @@ bool LineQuadTree::find_local_max(const glm::ivec2& center_coord, glm::ivec2& co
 
 bool LineQuadTree::get_pixel(const glm::ivec2& coord, uint8_t& value) const
 {
-    const LineQuadTreeLevel& base_level = this->levels.front();
+    if (coord.x < 0 || coord.x >= this->resolution.x)
+    {
+        return false;
+    }
+
+    if (coord.y < 0 || coord.y >= this->resolution.y)
+    {
+        return false;
+    }
+
+    uint32_t tile = this->get_tile(coord);
+
+    glm::ivec2 local_coord = coord % glm::ivec2(LINE_GENERATOR_MASK_TILE_SIZE);
+    uint32_t word_index = local_coord.y * LINE_GENERATOR_MASK_TILE_ROW_WORDS + local_coord.x / 64;
+    uint64_t word_mask = 1ull << (local_coord.x % 64);
+
+    value = 0;
+
+    for (uint32_t bucket = 0; bucket < LINE_GENERATOR_MASK_BUCKET_COUNT; bucket++)
+    {
+        if ((this->mask_levels.front()[this->get_word_offset(0, tile, bucket) + word_index] & word_mask) != 0)
+        {
+            value = bucket + 1;
+
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool LineQuadTree::get_depth(const glm::ivec2& coord, float& depth) const
+{
+    if (coord.x < 0 || coord.x >= this->resolution.x)
+    {
+        return false;
+    }
+
+    if (coord.y < 0 || coord.y >= this->resolution.y)
+    {
+        return false;
+    }
+
+    if (coord.y == 0)
+    {
+        depth = this->edge_depth_pointer[coord.x];
+
+        return true;
+    }
+
+    if (coord.y == this->resolution.y - 1)
+    {
+        depth = this->edge_depth_pointer[this->resolution.x + coord.x];
+
+        return true;
+    }
+
+    if (coord.x == 0)
+    {
+        depth = this->edge_depth_pointer[2 * this->resolution.x + coord.y];
+
+        return true;
+    }
+
+    if (coord.x == this->resolution.x - 1)
+    {
+        depth = this->edge_depth_pointer[2 * this->resolution.x + this->resolution.y + coord.y];
+
+        return true;
+    }
+
+    //Use the unmodified mask of the gpu, since the cpu side mask is cleared during the line trace
+    uint32_t tile = this->get_tile(coord);
+
+    glm::ivec2 local_coord = coord % glm::ivec2(LINE_GENERATOR_MASK_TILE_SIZE);
+    uint32_t word_index = local_coord.y * LINE_GENERATOR_MASK_TILE_ROW_WORDS + local_coord.x / 64;
+    uint32_t word_half = (local_coord.x % 64) / 32;
+    uint32_t bit = local_coord.x % 32;
+
+    uint32_t run_mask = 0;
+
+    for (uint32_t bucket = 0; bucket < LINE_GENERATOR_MASK_BUCKET_COUNT; bucket++)
+    {
+        run_mask |= this->mask_pointer[2 * (this->get_word_offset(0, tile, bucket) + word_index) + word_half];
+    }
+
+    if ((run_mask & (1u << bit)) == 0)
+    {
+        return false;
+    }
+
+    uint32_t run_index = (tile * LINE_GENERATOR_MASK_TILE_SIZE + local_coord.y) * (LINE_GENERATOR_MASK_TILE_SIZE / 32) + local_coord.x / 32;
+    uint32_t depth_index = this->edge_offset_pointer[run_index] + std::popcount(run_mask & ((1u << bit) - 1));
+
+    depth = this->edge_depth_pointer[depth_index];
+
+    return true;
+}
+
+uint32_t LineQuadTree::get_tile(const glm::ivec2& coord) const
+{
+    glm::uvec2 tile_coord = glm::uvec2(coord) / glm::uvec2(LINE_GENERATOR_MASK_TILE_SIZE);
 
-    return base_level.get_pixel(coord, value);
+    return tile_coord.y * this->tile_resolution.x + tile_coord.x;
+}
+
+uint32_t LineQuadTree::get_tile_count() const
+{
+    return this->tile_resolution.x * this->tile_resolution.y;
 }
 
 uint32_t LineQuadTree::get_level_count() const
 {
-    return this->levels.size();
+    return this->mask_levels.size();
+}
+
+GLuint LineQuadTree::get_edge_offset_buffer() const
+{
+    return this->edge_offset_buffer;
+}
+
+GLuint LineQuadTree::get_edge_depth_buffer() const
+{
+    return this->edge_depth_buffer;
+}
+
+glm::uvec2 LineQuadTree::compute_tile_resolution(const glm::uvec2& resolution)
+{
+    return (resolution + glm::uvec2(LINE_GENERATOR_MASK_TILE_SIZE - 1)) / glm::uvec2(LINE_GENERATOR_MASK_TILE_SIZE);
+}
+
+uint32_t LineQuadTree::compute_mask_buffer_size(const glm::uvec2& resolution)
+{
+    glm::uvec2 tile_resolution = LineQuadTree::compute_tile_resolution(resolution);
+    uint32_t tile_word_count = LINE_GENERATOR_MASK_BUCKET_COUNT * LINE_GENERATOR_MASK_TILE_SIZE * LINE_GENERATOR_MASK_TILE_ROW_WORDS;
+
+    return tile_resolution.x * tile_resolution.y * tile_word_count * sizeof(uint64_t);
+}
+
+uint32_t LineQuadTree::get_word_offset(uint32_t level, uint32_t tile, uint32_t bucket) const
+{
+    return (tile * LINE_GENERATOR_MASK_BUCKET_COUNT + bucket) * this->mask_word_counts[level];
 }
 
-bool LineGeneratorFrame::triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines)
+bool LineGeneratorFrame::triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines, const CancelToken* cancel_token, Scheduler* scheduler)
 {
     metadata.line.time_cpu = 0.0f;
     metadata.line.time_line_trace = 0.0f;
@@ -340,11 +463,11 @@ bool LineGeneratorFrame::triangulate(std::vector<shared::Vertex>& vertices, std:
     metadata.line.time_quad_tree = this->time_quad_tree;
 
     std::chrono::high_resolution_clock::time_point cpu_start = std::chrono::high_resolution_clock::now();
-    this->triangulation.process(this->resolution, this->depth_max, this->line_length_min, this->depth_copy_pointer, this->quad_tree, vertices, indices, metadata, feature_lines, export_feature_lines);
+    bool complete = this->triangulation.process(this->resolution, this->depth_max, this->line_length_min, this->quad_tree, vertices, indices, metadata, feature_lines, export_feature_lines, cancel_token, scheduler);
     std::chrono::high_resolution_clock::time_point cpu_end = std::chrono::high_resolution_clock::now();
     metadata.line.time_cpu = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(cpu_end - cpu_start).count();
 
-    return true;
+    return complete;
 }
 
 GLuint LineGeneratorFrame::get_depth_buffer() const
@@ -387,6 +510,20 @@ void LineGenerator::destroy()
     }
 
     this->edge_buffer = 0;
+
+    if (this->edge_mask_buffer != 0)
+    {
+        glDeleteBuffers(1, &this->edge_mask_buffer);
+    }
+
+    this->edge_mask_buffer = 0;
+
+    if (this->edge_count_buffer != 0)
+    {
+        glDeleteBuffers(1, &this->edge_count_buffer);
+    }
+
+    this->edge_count_buffer = 0;
 }
 
 void LineGenerator::apply(const shared::MeshSettings& settings)
@@ -461,26 +598,12 @@ MeshGeneratorFrame* LineGenerator::create_frame()
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    uint32_t depth_copy_buffer_size = this->resolution.x * this->resolution.y * sizeof(float);
-
-    GLuint depth_copy_buffer = 0;
-   
-    glGenBuffers(1, &depth_copy_buffer);
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, depth_copy_buffer);
-
-    glBufferStorage(GL_PIXEL_PACK_BUFFER, depth_copy_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-    float* depth_copy_pointer = (float*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, depth_copy_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-
     LineGeneratorFrame* line_frame = new LineGeneratorFrame;
     line_frame->quad_tree = quad_tree;
     line_frame->resolution = this->resolution;
     line_frame->depth_buffer = depth_buffer;
     line_frame->normal_buffer = normal_buffer;
     line_frame->object_id_buffer = object_id_buffer;
-    line_frame->depth_copy_buffer = depth_copy_buffer;
-    line_frame->depth_copy_pointer = depth_copy_pointer;
     line_frame->edge_timer = edge_timer;
     line_frame->quad_tree_timer = quad_tree_timer;
 
@@ -494,13 +617,10 @@ void LineGenerator::destroy_frame(MeshGeneratorFrame* frame)
     glDeleteTextures(1, &line_frame->depth_buffer);
     glDeleteTextures(1, &line_frame->normal_buffer);
     glDeleteTextures(1, &line_frame->object_id_buffer);
-    glDeleteBuffers(1, &line_frame->depth_copy_buffer);
 
     line_frame->depth_buffer = 0;
     line_frame->normal_buffer = 0;
     line_frame->object_id_buffer = 0;
-    line_frame->depth_copy_buffer = 0;
-    line_frame->depth_copy_pointer = nullptr;
 
     glDeleteSync(line_frame->fence);
 
@@ -525,17 +645,9 @@ bool LineGenerator::submit_frame(MeshGeneratorFrame* frame)
 
     this->perform_quad_tree_pass(line_frame);
 
-    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
-
-    glBindTexture(GL_TEXTURE_2D, line_frame->depth_buffer);
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, line_frame->depth_copy_buffer);
-
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT | GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
 
-    line_frame->quad_tree.fill(this->edge_buffer);
+    line_frame->quad_tree.fill(this->edge_mask_buffer);
 
     line_frame->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
@@ -581,20 +693,10 @@ bool LineGenerator::unmap_frame(MeshGeneratorFrame* frame)
 
 bool LineGenerator::create_buffers(const glm::uvec2& resolution)
 {
-    glm::uvec2 level_resolution = resolution;
-    this->edge_buffer_levels = 1;
-
-    while (level_resolution.x > 1 || level_resolution.y > 1)
-    {
-        this->edge_buffer_levels++;
-
-        level_resolution = glm::max(glm::uvec2(1), level_resolution / glm::uvec2(2));
-    }
-
     glGenTextures(1, &this->edge_buffer);
     glBindTexture(GL_TEXTURE_2D, this->edge_buffer);
 
-    glTexStorage2D(GL_TEXTURE_2D, this->edge_buffer_levels, GL_R8, resolution.x, resolution.y);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, resolution.x, resolution.y);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -603,6 +705,20 @@ bool LineGenerator::create_buffers(const glm::uvec2& resolution)
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
+    glGenBuffers(1, &this->edge_mask_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->edge_mask_buffer);
+
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, LineQuadTree::compute_mask_buffer_size(resolution), nullptr, 0);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glGenBuffers(1, &this->edge_count_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->edge_count_buffer);
+
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, sizeof(uint32_t), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
     return true;
 }
 
@@ -678,23 +794,46 @@ void LineGenerator::perform_quad_tree_pass(LineGeneratorFrame* line_frame)
 
     line_frame->quad_tree_timer.begin();
 
-    this->quad_tree_shader.use_shader();
+    glm::uvec2 tile_resolution = LineQuadTree::compute_tile_resolution(this->resolution);
 
-    for (uint32_t index = 0; index < this->edge_buffer_levels; index++)
-    {
-        glBindImageTexture(0, this->edge_buffer, index, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
-        glBindImageTexture(1, this->edge_buffer, index + 1, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
+    //The depth of the border pixels is stored in front of the depth of the edge pixels
+    uint32_t edge_count = 2 * this->resolution.x + 2 * this->resolution.y;
 
-        glm::uvec2 work_group_size = glm::uvec2(LINE_GENERATOR_QUAD_TREE_WORK_GROUP_SIZE_X, LINE_GENERATOR_QUAD_TREE_WORK_GROUP_SIZE_Y);
-        glm::uvec2 work_group_count = (this->resolution + work_group_size - glm::uvec2(1)) / work_group_size;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->edge_count_buffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &edge_count);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
-        glDispatchCompute(work_group_count.x, work_group_count.y, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
-        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, line_frame->depth_buffer);
+
+    glBindImageTexture(0, this->edge_buffer, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, this->edge_mask_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, line_frame->quad_tree.get_edge_offset_buffer());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, line_frame->quad_tree.get_edge_depth_buffer());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, this->edge_count_buffer);
+
+    this->quad_tree_shader.use_shader();
+    this->quad_tree_shader["tile_count_x"] = tile_resolution.x;
+    this->quad_tree_shader["tile_count_y"] = tile_resolution.y;
+
+    //Each invocation packs 32 pixels of a row, including the padding of the tiles at the border of the image
+    glm::uvec2 work_group_size = glm::uvec2(LINE_GENERATOR_QUAD_TREE_WORK_GROUP_SIZE_X, LINE_GENERATOR_QUAD_TREE_WORK_GROUP_SIZE_Y);
+    glm::uvec2 run_count = tile_resolution * glm::uvec2(LINE_GENERATOR_MASK_TILE_SIZE / 32, LINE_GENERATOR_MASK_TILE_SIZE);
+    glm::uvec2 work_group_count = (run_count + work_group_size - glm::uvec2(1)) / work_group_size;
+
+    glDispatchCompute(work_group_count.x, work_group_count.y, 1);
 
     this->quad_tree_shader.use_default();
 
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, 0);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
     line_frame->quad_tree_timer.end();
 
     glPopDebugGroup();
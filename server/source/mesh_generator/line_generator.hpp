@@ -15,30 +15,27 @@ namespace glsl
 #include "../shaders/shared_defines.glsl"
 }
 
-class LineQuadTreeLevel
+// The edge mask is packed on the gpu and read back with a single copy.
+// The depth is only transferred for edge pixels and pixels at the border of the image, since only these can become vertices.
+// Each bit of the mask marks an edge pixel and each bit of a summary level marks a non-empty word of the level below.
+// In order to prefer strong edges, the mask is split into buckets based on the edge strength.
+// The mask is stored tile by tile, so that the line trace of different tiles can be performed in parallel.
+class LineQuadTree
 {
 private:
-    glm::uvec2 resolution = glm::uvec2(0);
-    GLuint level_buffer = 0;
-    uint8_t* level_pointer = nullptr;
-
-public:
-    LineQuadTreeLevel() = default;
-    
-    bool create(const glm::uvec2& resolution);
-    void destroy();
+    GLuint mask_buffer = 0;
+    const uint32_t* mask_pointer = nullptr;         // Persistent mapped copy of the packed edge mask
 
-    bool set_pixel(const glm::ivec2& coord, uint8_t value);
-    bool get_pixel(const glm::ivec2& coord, uint8_t& value) const;
+    GLuint edge_offset_buffer = 0;
+    const uint32_t* edge_offset_pointer = nullptr;  // Offset into the edge depth for each run of 32 pixels
+    GLuint edge_depth_buffer = 0;
+    const float* edge_depth_pointer = nullptr;      // Depth of the border pixels followed by the depth of the edge pixels
 
-    const glm::uvec2& get_resolution() const;
-    GLuint get_level_buffer() const;
-};
+    glm::uvec2 resolution = glm::uvec2(0);
+    glm::uvec2 tile_resolution = glm::uvec2(0);     // Number of tiles in x and y direction
 
-class LineQuadTree
-{
-private:
-    std::vector<LineQuadTreeLevel> levels;
+    std::vector<std::vector<uint64_t>> mask_levels; // Level 0 is the mask, all other levels are summary levels
+    std::vector<uint32_t> mask_word_counts;         // Number of words per tile and bucket for each mask level
 
 public:
     LineQuadTree() = default;
@@ -46,16 +43,29 @@ public:
     bool create(const glm::uvec2& resolution);
     void destroy();
 
-    bool fill(GLuint buffer);
+    bool fill(GLuint edge_mask_buffer);
+    bool update_tile(uint32_t tile); // Needs to be called after the readback of fill() is completed and before a tile is searched
     bool remove(const glm::ivec2& coord);
 
-    bool find_global(glm::ivec2& coord) const;
+    bool find_global(uint32_t tile, glm::ivec2& coord) const;
     bool find_local(const glm::ivec2& center_coord, std::vector<glm::ivec2>& coords) const;
-    bool find_local_max(const glm::ivec2& center_coord, glm::ivec2& coord) const;
+    bool find_local_max(uint32_t tile, const glm::ivec2& center_coord, glm::ivec2& coord) const; // Only pixels inside of the tile are considered
 
-    bool get_pixel(const glm::ivec2& coord, uint8_t& value) const;
+    bool get_pixel(const glm::ivec2& coord, uint8_t& value) const; // Returns the bucket of the pixel plus one or zero if the pixel is not set
+    bool get_depth(const glm::ivec2& coord, float& depth) const;   // Only available for edge pixels and pixels at the border of the image
 
+    uint32_t get_tile(const glm::ivec2& coord) const;
+    uint32_t get_tile_count() const;
     uint32_t get_level_count() const;
+
+    GLuint get_edge_offset_buffer() const;
+    GLuint get_edge_depth_buffer() const;
+
+    static glm::uvec2 compute_tile_resolution(const glm::uvec2& resolution);
+    static uint32_t compute_mask_buffer_size(const glm::uvec2& resolution);
+
+private:
+    uint32_t get_word_offset(uint32_t level, uint32_t tile, uint32_t bucket) const;
 };
 
 class LineGeneratorFrame : public MeshGeneratorFrame
@@ -72,9 +82,6 @@ public:
     GLuint normal_buffer = 0;
     GLuint object_id_buffer = 0;
 
-    GLuint depth_copy_buffer = 0;
-    const float* depth_copy_pointer = nullptr;
-
     GLsync fence = 0;
 
     Timer edge_timer;
@@ -87,7 +94,7 @@ public:
 public:
     LineGeneratorFrame() = default;
 
-    bool triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines);
+    bool triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines, const CancelToken* cancel_token, Scheduler* scheduler);
 
     GLuint get_depth_buffer() const;
     GLuint get_normal_buffer() const;
@@ -101,7 +108,8 @@ private:
     Shader quad_tree_shader = { "Line Generator Quad Tree Shader" };
 
     GLuint edge_buffer = 0;
-    uint32_t edge_buffer_levels = 0;
+    GLuint edge_mask_buffer = 0;
+    GLuint edge_count_buffer = 0;
 
     glm::uvec2 resolution = glm::uvec2(0);
     float depth_max = 0.995f;
@@ -1,11 +1,18 @@
 #include "line_triangulation.hpp"
 #include "line_generator.hpp"
+#include "../scheduler.hpp"
 
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
 #include <CGAL/Triangulation_vertex_base_with_info_2.h>
 #include <CGAL/Triangulation_face_base_with_info_2.h>
 #include <CGAL/Constrained_Delaunay_triangulation_2.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <iterator>
+#include <utility>
 #include <chrono>
+#include <array>
+#include <atomic>
 
 typedef CGAL::Exact_predicates_inexact_constructions_kernel Kernel;
 typedef CGAL::Triangulation_vertex_base_with_info_2<uint32_t, Kernel> VertexBase;
@@ -18,88 +25,77 @@ typedef ConstrainedTriangulation::Edge Edge;
 typedef ConstrainedTriangulation::Vertex_handle VertexHandle;
 typedef ConstrainedTriangulation::Face_handle FaceHandle;
 
-void LineTriangulation::process(const glm::uvec2& resolution, float depth_max, uint32_t line_length_min, const float* depth_copy_pointer, LineQuadTree& quad_tree, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines)
+bool LineTriangulation::process(const glm::uvec2& resolution, float depth_max, uint32_t line_length_min, LineQuadTree& quad_tree, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines, const CancelToken* cancel_token, Scheduler* scheduler)
 {
     this->line_coords.clear();
     this->line_segments.clear();
 
     std::chrono::high_resolution_clock::time_point line_trace_start = std::chrono::high_resolution_clock::now();
-    while (true)
-    {
-        glm::ivec2 current_coord = glm::ivec2(0);
 
-        if (!quad_tree.find_global(current_coord))
-        {
-            break;
-        }
+    //Trace the lines of each tile in parallel and join the lines that cross the border of a tile afterwards
+    uint32_t tile_count = quad_tree.get_tile_count();
+    this->trace_tiles.resize(tile_count);
 
-        if (!quad_tree.remove(current_coord))
-        {
-            return;
-        }
+    uint32_t task_count = LINE_TRIANGULATION_TRACE_TASK_COUNT;
+
+    if (task_count == 0 && scheduler != nullptr)
+    {
+        task_count = scheduler->get_thread_count();
+    }
 
-        this->line_coords.clear();
-        this->line_coords.push_back(current_coord);
+    task_count = glm::clamp(task_count, 1u, glm::max(tile_count, 1u));
 
-        glm::ivec2 direction = glm::ivec2(0);
+    std::atomic<uint32_t> next_tile = 0;
+    std::atomic<bool> trace_failed = false;
 
+    auto trace_worker = [&]()
+    {
         while (true)
         {
-            glm::ivec2 next_coord = glm::ivec2(0);
+            uint32_t tile = next_tile.fetch_add(1);
 
-            if (!quad_tree.find_local_max(current_coord, next_coord))
+            if (tile >= tile_count)
             {
                 break;
             }
 
-            glm::ivec2 next_direction = next_coord - current_coord;
-
-            if (direction.x == 0)
+            if (CancelToken::check(cancel_token))
             {
-                direction.x = next_direction.x;
-            }
+                trace_failed = true;
 
-            else if (next_direction.x != 0 && next_direction.x != direction.x)
-            {
                 break;
             }
 
-            if (direction.y == 0)
+            if (!this->trace_tile(tile, resolution, quad_tree))
             {
-                direction.y = next_direction.y;
-            }
-
-            else if (next_direction.y != 0 && next_direction.y != direction.y)
-            {
-                break;
-            }
-
-            if (!quad_tree.remove(next_coord))
-            {
-                return;
-            }
-
-            current_coord = next_coord;
-            this->line_coords.push_back(current_coord);
-
-            if (next_coord.x == 0 || next_coord.y == 0)
-            {
-                break;
-            }
-
-            if (next_coord.x == resolution.x - 1 || next_coord.y == resolution.y - 1)
-            {
-                break;
+                trace_failed = true;
             }
         }
+    };
 
-        if (this->line_coords.size() < line_length_min)
+    //Each task takes the next tile that is not traced yet, so that large tiles don't stall the other tasks
+    if (scheduler != nullptr)
+    {
+        scheduler->run_parallel(task_count, [&](uint32_t)
         {
-            continue;
-        }
+            trace_worker();
+        });
+    }
 
-        this->compute_line_segments();
+    else
+    {
+        trace_worker();
+    }
+
+    if (trace_failed || CancelToken::check(cancel_token))
+    {
+        vertices.clear();
+        indices.clear();
+
+        return false;
     }
+
+    this->stitch_traces(resolution, line_length_min, quad_tree);
     std::chrono::high_resolution_clock::time_point line_trace_end = std::chrono::high_resolution_clock::now();
     metadata.line.time_line_trace = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(line_trace_end - line_trace_start).count();
 
@@ -156,11 +152,7 @@ void LineTriangulation::process(const glm::uvec2& resolution, float depth_max, u
         }
     }
 
-    std::chrono::high_resolution_clock::time_point triangulation_start = std::chrono::high_resolution_clock::now();
-    ConstrainedTriangulation triangulation;
-
-    VertexHandle broder_start_vertex = nullptr;
-    VertexHandle border_last_vertex = nullptr;
+    this->border_points.clear();
 
     for (uint32_t border = 0; border < 4; border++)
     {
@@ -168,34 +160,163 @@ void LineTriangulation::process(const glm::uvec2& resolution, float depth_max, u
         {
             glm::ivec2 position = broder_start[border] + (glm::ivec2(index * resolution) / (LINE_TRIANGULATION_BORDER_POINTS - 1)) * broder_direction[border];
 
-            VertexHandle border_vertex = triangulation.insert(Point(position.x, position.y));
+            this->border_points.push_back(position);
+        }
+    }
+
+    std::chrono::high_resolution_clock::time_point triangulation_start = std::chrono::high_resolution_clock::now();
+#if LINE_TRIANGULATION_USE_CGAL
+    bool complete = this->triangulate_cgal(resolution, depth_max, quad_tree, vertices, indices, cancel_token);
+#else
+    bool complete = this->triangulate_delaunay(resolution, depth_max, quad_tree, vertices, indices, cancel_token);
+#endif
+    std::chrono::high_resolution_clock::time_point triangulation_end = std::chrono::high_resolution_clock::now();
+    metadata.line.time_triangulation = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(triangulation_end - triangulation_start).count();
+    metadata.line.line_count = this->line_segments.size();
+
+    if (!complete)
+    {
+        vertices.clear();
+        indices.clear();
+
+        return false;
+    }
+
+#if LINE_TRIANGULATION_VALIDATE_CGAL && !LINE_TRIANGULATION_USE_CGAL
+    this->validate_cgal(resolution, depth_max, quad_tree, vertices, indices, metadata.line.time_triangulation);
+#endif
+
+    return true;
+}
+
+bool LineTriangulation::triangulate_delaunay(const glm::uvec2& resolution, float depth_max, const LineQuadTree& quad_tree, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, const CancelToken* cancel_token)
+{
+    this->delaunay.clear(glm::ivec2(0), glm::ivec2(resolution));
+
+    //The border of the domain is always constrained, so the border points need no additional constraints
+    for (const glm::ivec2& position : this->border_points)
+    {
+        this->delaunay.insert_point(position);
+    }
+
+    uint32_t last_point = LINE_DELAUNAY_INVALID_INDEX;
+
+    //Constraints that intersect an other constraint are split at the intersection
+    for (const LineSegment& line_segment : this->line_segments)
+    {
+        //Only check the token once per line, since most lines consist of many short segments
+        if (line_segment.is_end && CancelToken::check(cancel_token))
+        {
+            return false;
+        }
+
+        uint32_t point = this->delaunay.insert_point(line_segment.start);
+
+        if (line_segment.is_end)
+        {
+            uint32_t end_point = this->delaunay.insert_point(line_segment.end);
 
-            if (broder_start_vertex == nullptr)
+            if (last_point != LINE_DELAUNAY_INVALID_INDEX)
             {
-                broder_start_vertex = border_vertex;
+                this->delaunay.insert_constraint(last_point, point);
             }
 
-            else
+            this->delaunay.insert_constraint(point, end_point);
+
+            last_point = LINE_DELAUNAY_INVALID_INDEX;
+        }
+
+        else
+        {
+            if (last_point != LINE_DELAUNAY_INVALID_INDEX)
             {
-                triangulation.insert_constraint(border_last_vertex, border_vertex);
+                this->delaunay.insert_constraint(last_point, point);
             }
 
-            border_last_vertex = border_vertex;
+            last_point = point;
         }
     }
 
-    triangulation.insert_constraint(border_last_vertex, broder_start_vertex);
+    vertices.clear();
+    indices.clear();
 
+    for (glm::ivec2 position : this->delaunay.get_points())
+    {
+        position = glm::clamp(position, glm::ivec2(0), glm::ivec2(resolution) - 1);
+
+        shared::Vertex vertex;
+        vertex.x = position.x;
+        vertex.y = position.y;
+        vertex.z = LineTriangulation::sample_depth(position, depth_max, quad_tree);
+
+        vertices.push_back(vertex);
+    }
+
+    for (uint32_t triangle_index = 0; triangle_index < this->delaunay.get_triangle_count(); triangle_index++)
+    {
+        glm::uvec3 triangle = this->delaunay.get_triangle(triangle_index);
+
+        indices.push_back(triangle.x);
+        indices.push_back(triangle.y);
+        indices.push_back(triangle.z);
+    }
+
+    return true;
+}
+
+bool LineTriangulation::triangulate_cgal(const glm::uvec2& resolution, float depth_max, const LineQuadTree& quad_tree, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, const CancelToken* cancel_token)
+{
+    ConstrainedTriangulation triangulation;
+
+    //Insert all points with a single range call, which sorts the points spatially before inserting them.
+    //The info of each vertex is the index of the unique point so that the vertex handles can be looked up for the constraints.
+    this->collect_points();
+
+    std::vector<std::pair<Point, uint32_t>> sorted_points;
+    sorted_points.reserve(this->unique_points.size());
+
+    for (uint32_t index = 0; index < this->unique_points.size(); index++)
+    {
+        const glm::ivec2& position = this->unique_points[index];
+
+        sorted_points.push_back(std::make_pair(Point(position.x, position.y), index));
+    }
+
+    triangulation.insert(sorted_points.begin(), sorted_points.end());
+
+    std::vector<VertexHandle> vertex_handles;
+    vertex_handles.resize(this->unique_points.size(), nullptr);
+
+    for (VertexHandle vertex_handle : triangulation.finite_vertex_handles())
+    {
+        vertex_handles[vertex_handle->info()] = vertex_handle;
+    }
+
+    uint32_t border_count = this->border_points.size();
+
+    for (uint32_t index = 0; index < border_count; index++)
+    {
+        VertexHandle border_vertex = vertex_handles[this->point_ids[index]];
+        VertexHandle border_next_vertex = vertex_handles[this->point_ids[(index + 1) % border_count]];
+
+        triangulation.insert_constraint(border_vertex, border_next_vertex);
+    }
+
+    uint32_t point_index = border_count;
     VertexHandle last_vertex = nullptr;
-    glm::ivec2 last_end = glm::ivec2(0);
 
     for (const LineSegment& line_segment : this->line_segments)
     {
-        VertexHandle vertex = triangulation.insert(Point(line_segment.start.x, line_segment.start.y));
+        if (line_segment.is_end && CancelToken::check(cancel_token))
+        {
+            return false;
+        }
+
+        VertexHandle vertex = vertex_handles[this->point_ids[point_index++]];
 
         if (line_segment.is_end)
         {
-            VertexHandle end_vertex = triangulation.insert(Point(line_segment.end.x, line_segment.end.y));
+            VertexHandle end_vertex = vertex_handles[this->point_ids[point_index++]];
 
             if (last_vertex != nullptr)
             {
@@ -205,7 +326,6 @@ void LineTriangulation::process(const glm::uvec2& resolution, float depth_max, u
             triangulation.insert_constraint(vertex, end_vertex);
 
             last_vertex = nullptr;
-            last_end = glm::ivec2(0);
         }
 
         else
@@ -216,7 +336,6 @@ void LineTriangulation::process(const glm::uvec2& resolution, float depth_max, u
             }
 
             last_vertex = vertex;
-            last_end = line_segment.end;
         }
     }
 
@@ -236,7 +355,7 @@ void LineTriangulation::process(const glm::uvec2& resolution, float depth_max, u
         shared::Vertex vertex;
         vertex.x = position.x;
         vertex.y = position.y;
-        vertex.z = glm::min(depth_copy_pointer[position.y * resolution.x + position.x], depth_max);
+        vertex.z = LineTriangulation::sample_depth(position, depth_max, quad_tree);
 
         vertices.push_back(vertex);
 
@@ -254,9 +373,424 @@ void LineTriangulation::process(const glm::uvec2& resolution, float depth_max, u
         indices.push_back(vertex2->info());
         indices.push_back(vertex3->info());
     }
-    std::chrono::high_resolution_clock::time_point triangulation_end = std::chrono::high_resolution_clock::now();
-    metadata.line.time_triangulation = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(triangulation_end - triangulation_start).count();
-    metadata.line.line_count = this->line_segments.size();
+
+    return true;
+}
+
+void LineTriangulation::collect_points()
+{
+    //Gather the border points and all segment points in the order in which they are used by the constraints
+    this->points.clear();
+    this->points.insert(this->points.end(), this->border_points.begin(), this->border_points.end());
+
+    for (const LineSegment& line_segment : this->line_segments)
+    {
+        this->points.push_back(line_segment.start);
+
+        if (line_segment.is_end)
+        {
+            this->points.push_back(line_segment.end);
+        }
+    }
+
+    //Merge duplicated points so that every point is only inserted once
+    this->point_order.resize(this->points.size());
+
+    for (uint32_t index = 0; index < this->points.size(); index++)
+    {
+        this->point_order[index] = index;
+    }
+
+    std::sort(this->point_order.begin(), this->point_order.end(), [this](uint32_t index1, uint32_t index2)
+    {
+        const glm::ivec2& point1 = this->points[index1];
+        const glm::ivec2& point2 = this->points[index2];
+
+        return (point1.y < point2.y) || (point1.y == point2.y && point1.x < point2.x);
+    });
+
+    this->point_ids.resize(this->points.size());
+    this->unique_points.clear();
+
+    for (uint32_t index = 0; index < this->point_order.size(); index++)
+    {
+        const glm::ivec2& point = this->points[this->point_order[index]];
+
+        if (this->unique_points.empty() || glm::any(glm::notEqual(this->unique_points.back(), point)))
+        {
+            this->unique_points.push_back(point);
+        }
+
+        this->point_ids[this->point_order[index]] = this->unique_points.size() - 1;
+    }
+}
+
+#if LINE_TRIANGULATION_VALIDATE_CGAL
+void LineTriangulation::validate_cgal(const glm::uvec2& resolution, float depth_max, const LineQuadTree& quad_tree, const std::vector<shared::Vertex>& vertices, const std::vector<shared::Index>& indices, double time_delaunay)
+{
+    std::vector<shared::Vertex> cgal_vertices;
+    std::vector<shared::Index> cgal_indices;
+
+    std::chrono::high_resolution_clock::time_point cgal_start = std::chrono::high_resolution_clock::now();
+    this->triangulate_cgal(resolution, depth_max, quad_tree, cgal_vertices, cgal_indices, nullptr);
+    std::chrono::high_resolution_clock::time_point cgal_end = std::chrono::high_resolution_clock::now();
+    double time_cgal = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(cgal_end - cgal_start).count();
+
+    //Compare the triangles by position, since the vertex order of both triangulations differ.
+    //Each triangle is rotated so that it starts with its smallest vertex, which keeps the winding order intact.
+    auto collect_triangles = [](const std::vector<shared::Vertex>& vertices, const std::vector<shared::Index>& indices)
+    {
+        std::vector<std::array<uint32_t, 3>> triangles;
+
+        for (uint32_t index = 0; index + 2 < indices.size(); index += 3)
+        {
+            std::array<uint32_t, 3> triangle;
+
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                const shared::Vertex& vertex = vertices[indices[index + corner]];
+                triangle[corner] = (vertex.y << 16) | vertex.x;
+            }
+
+            std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+            triangles.push_back(triangle);
+        }
+
+        std::sort(triangles.begin(), triangles.end());
+
+        return triangles;
+    };
+
+    std::vector<std::array<uint32_t, 3>> delaunay_triangles = collect_triangles(vertices, indices);
+    std::vector<std::array<uint32_t, 3>> cgal_triangles = collect_triangles(cgal_vertices, cgal_indices);
+    std::vector<std::array<uint32_t, 3>> matching_triangles;
+
+    std::set_intersection(delaunay_triangles.begin(), delaunay_triangles.end(), cgal_triangles.begin(), cgal_triangles.end(), std::back_inserter(matching_triangles));
+
+    //Cocircular points on the integer grid have no unique delaunay triangulation, so small differences are expected
+    uint32_t mismatch_count = delaunay_triangles.size() + cgal_triangles.size() - 2 * matching_triangles.size();
+
+    spdlog::info("LineTriangulation: Delaunay {} ms, CGAL {} ms, Triangles {} / {}, Mismatches {}", time_delaunay, time_cgal, delaunay_triangles.size(), cgal_triangles.size(), mismatch_count);
+}
+#endif
+
+bool LineTriangulation::trace_tile(uint32_t tile, const glm::uvec2& resolution, LineQuadTree& quad_tree)
+{
+    LineTraceTile& line_tile = this->trace_tiles[tile];
+    line_tile.coords.clear();
+    line_tile.traces.clear();
+
+    if (!quad_tree.update_tile(tile))
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        glm::ivec2 current_coord = glm::ivec2(0);
+
+        if (!quad_tree.find_global(tile, current_coord))
+        {
+            break;
+        }
+
+        if (!quad_tree.remove(current_coord))
+        {
+            return false;
+        }
+
+        LineTrace trace;
+        trace.tile = tile;
+        trace.coord_offset = line_tile.coords.size();
+
+        line_tile.coords.push_back(current_coord);
+
+        glm::ivec2 direction = glm::ivec2(0);
+
+        while (true)
+        {
+            glm::ivec2 next_coord = glm::ivec2(0);
+
+            if (!quad_tree.find_local_max(tile, current_coord, next_coord))
+            {
+                break;
+            }
+
+            glm::ivec2 next_direction = next_coord - current_coord;
+
+            if (direction.x == 0)
+            {
+                direction.x = next_direction.x;
+            }
+
+            else if (next_direction.x != 0 && next_direction.x != direction.x)
+            {
+                break;
+            }
+
+            if (direction.y == 0)
+            {
+                direction.y = next_direction.y;
+            }
+
+            else if (next_direction.y != 0 && next_direction.y != direction.y)
+            {
+                break;
+            }
+
+            if (!quad_tree.remove(next_coord))
+            {
+                return false;
+            }
+
+            current_coord = next_coord;
+            line_tile.coords.push_back(current_coord);
+
+            if (next_coord.x == 0 || next_coord.y == 0)
+            {
+                break;
+            }
+
+            if (next_coord.x == resolution.x - 1 || next_coord.y == resolution.y - 1)
+            {
+                break;
+            }
+        }
+
+        trace.coord_count = line_tile.coords.size() - trace.coord_offset;
+        trace.direction = direction;
+
+        line_tile.traces.push_back(trace);
+    }
+
+    return true;
+}
+
+void LineTriangulation::stitch_traces(const glm::uvec2& resolution, uint32_t line_length_min, const LineQuadTree& quad_tree)
+{
+    this->traces.clear();
+
+    for (const LineTraceTile& line_tile : this->trace_tiles)
+    {
+        this->traces.insert(this->traces.end(), line_tile.traces.begin(), line_tile.traces.end());
+    }
+
+    //Register all traces that start or end at the border of a tile
+    this->seam_traces.clear();
+
+    for (uint32_t index = 0; index < this->traces.size(); index++)
+    {
+        for (uint32_t side = 0; side < 2; side++)
+        {
+            glm::ivec2 coord = this->get_trace_endpoint(index, side);
+
+            if (LineTriangulation::is_tile_border(coord))
+            {
+                this->seam_traces[LineTriangulation::get_coord_key(coord)] = index;
+            }
+        }
+    }
+
+    //Connect the endpoints of traces that are neighbours across the border of a tile
+    for (uint32_t index = 0; index < this->traces.size(); index++)
+    {
+        for (uint32_t side = 0; side < 2; side++)
+        {
+            LineTrace& trace = this->traces[index];
+            glm::ivec2 coord = this->get_trace_endpoint(index, side);
+
+            if (trace.links[side] != LINE_TRIANGULATION_INVALID_LINK || !LineTriangulation::is_tile_border(coord))
+            {
+                continue;
+            }
+
+            //Direction in which the trace leaves this endpoint
+            glm::ivec2 direction = (side == 1) ? trace.direction : -trace.direction;
+
+            for (uint32_t neighbour = 0; neighbour < 9 && trace.links[side] == LINE_TRIANGULATION_INVALID_LINK; neighbour++)
+            {
+                glm::ivec2 neighbour_coord = coord + glm::ivec2(neighbour % 3, neighbour / 3) - glm::ivec2(1);
+
+                if (glm::any(glm::lessThan(neighbour_coord, glm::ivec2(0))) || glm::any(glm::greaterThanEqual(neighbour_coord, glm::ivec2(resolution))))
+                {
+                    continue;
+                }
+
+                if (quad_tree.get_tile(neighbour_coord) == trace.tile)
+                {
+                    continue;
+                }
+
+                std::unordered_map<uint64_t, uint32_t>::const_iterator iterator = this->seam_traces.find(LineTriangulation::get_coord_key(neighbour_coord));
+
+                if (iterator == this->seam_traces.end() || iterator->second == index)
+                {
+                    continue;
+                }
+
+                uint32_t other_index = iterator->second;
+                LineTrace& other_trace = this->traces[other_index];
+
+                for (uint32_t other_side = 0; other_side < 2; other_side++)
+                {
+                    if (other_trace.links[other_side] != LINE_TRIANGULATION_INVALID_LINK)
+                    {
+                        continue;
+                    }
+
+                    if (glm::any(glm::notEqual(this->get_trace_endpoint(other_index, other_side), neighbour_coord)))
+                    {
+                        continue;
+                    }
+
+                    //Direction in which the other trace continues after this endpoint
+                    glm::ivec2 other_direction = (other_side == 0) ? other_trace.direction : -other_trace.direction;
+                    glm::ivec2 step_direction = neighbour_coord - coord;
+
+                    if (!LineTriangulation::is_direction_compatible(direction, step_direction) || !LineTriangulation::is_direction_compatible(direction, other_direction) || !LineTriangulation::is_direction_compatible(step_direction, other_direction))
+                    {
+                        continue;
+                    }
+
+                    trace.links[side] = 2 * other_index + other_side;
+                    other_trace.links[other_side] = 2 * index + side;
+
+                    break;
+                }
+            }
+        }
+    }
+
+    //Walk along the connected traces starting at open ends. Closed loops of traces are handled in a second pass.
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        for (uint32_t index = 0; index < this->traces.size(); index++)
+        {
+            const LineTrace& trace = this->traces[index];
+
+            if (trace.visited)
+            {
+                continue;
+            }
+
+            uint32_t side = 0;
+
+            if (pass == 0)
+            {
+                if (trace.links[0] == LINE_TRIANGULATION_INVALID_LINK)
+                {
+                    side = 0;
+                }
+
+                else if (trace.links[1] == LINE_TRIANGULATION_INVALID_LINK)
+                {
+                    side = 1;
+                }
+
+                else
+                {
+                    continue;
+                }
+            }
+
+            this->line_coords.clear();
+
+            uint32_t current_index = index;
+
+            while (true)
+            {
+                LineTrace& current_trace = this->traces[current_index];
+                current_trace.visited = true;
+
+                const std::vector<glm::ivec2>& coords = this->trace_tiles[current_trace.tile].coords;
+
+                if (side == 0)
+                {
+                    this->line_coords.insert(this->line_coords.end(), coords.begin() + current_trace.coord_offset, coords.begin() + current_trace.coord_offset + current_trace.coord_count);
+                }
+
+                else
+                {
+                    this->line_coords.insert(this->line_coords.end(), std::make_reverse_iterator(coords.begin() + current_trace.coord_offset + current_trace.coord_count), std::make_reverse_iterator(coords.begin() + current_trace.coord_offset));
+                }
+
+                uint32_t link = current_trace.links[1 - side];
+
+                if (link == LINE_TRIANGULATION_INVALID_LINK || this->traces[link / 2].visited)
+                {
+                    break;
+                }
+
+                current_index = link / 2;
+                side = link % 2;
+            }
+
+            if (this->line_coords.size() < line_length_min)
+            {
+                continue;
+            }
+
+            this->compute_line_segments();
+        }
+    }
+}
+
+glm::ivec2 LineTriangulation::get_trace_endpoint(uint32_t trace_index, uint32_t side) const
+{
+    const LineTrace& trace = this->traces[trace_index];
+    const std::vector<glm::ivec2>& coords = this->trace_tiles[trace.tile].coords;
+
+    if (side == 0)
+    {
+        return coords[trace.coord_offset];
+    }
+
+    return coords[trace.coord_offset + trace.coord_count - 1];
+}
+
+float LineTriangulation::sample_depth(const glm::ivec2& coord, float depth_max, const LineQuadTree& quad_tree)
+{
+    float depth = depth_max;
+
+    if (quad_tree.get_depth(coord, depth))
+    {
+        return glm::min(depth, depth_max);
+    }
+
+    //Intersection points of the constraints are not necessarily edge pixels, so use the depth of a neighbouring edge pixel
+    for (int32_t offset_y = -1; offset_y <= 1; offset_y++)
+    {
+        for (int32_t offset_x = -1; offset_x <= 1; offset_x++)
+        {
+            if (quad_tree.get_depth(coord + glm::ivec2(offset_x, offset_y), depth))
+            {
+                return glm::min(depth, depth_max);
+            }
+        }
+    }
+
+    return depth_max;
+}
+
+bool LineTriangulation::is_tile_border(const glm::ivec2& coord)
+{
+    glm::ivec2 local_coord = coord % glm::ivec2(LINE_GENERATOR_MASK_TILE_SIZE);
+
+    return local_coord.x == 0 || local_coord.y == 0 || local_coord.x == LINE_GENERATOR_MASK_TILE_SIZE - 1 || local_coord.y == LINE_GENERATOR_MASK_TILE_SIZE - 1;
+}
+
+bool LineTriangulation::is_direction_compatible(const glm::ivec2& direction1, const glm::ivec2& direction2)
+{
+    //Lines are monotonic in x and y, so the directions are not allowed to point into opposite directions along an axis
+    glm::ivec2 sign1 = glm::sign(direction1);
+    glm::ivec2 sign2 = glm::sign(direction2);
+
+    return sign1.x * sign2.x >= 0 && sign1.y * sign2.y >= 0;
+}
+
+uint64_t LineTriangulation::get_coord_key(const glm::ivec2& coord)
+{
+    return ((uint64_t)coord.y << 32) | (uint32_t)coord.x;
 }
 
 void LineTriangulation::compute_line_segments()
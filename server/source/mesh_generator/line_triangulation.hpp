@@ -3,11 +3,17 @@
 
 #include <glm/glm.hpp>
 #include <vector>
+#include <unordered_map>
 #include <types.hpp>
 
 #include "mesh_generator.hpp"
+#include "line_delaunay.hpp"
 
-#define LINE_TRIANGULATION_BORDER_POINTS 10
+#define LINE_TRIANGULATION_BORDER_POINTS    10
+#define LINE_TRIANGULATION_USE_CGAL         0 // Use CGAL instead of the integer triangulation
+#define LINE_TRIANGULATION_VALIDATE_CGAL    0 // Compare the integer triangulation against CGAL and log the timings of both
+#define LINE_TRIANGULATION_TRACE_TASK_COUNT 0 // Number of tasks used for the line trace. If zero, one task for each thread of the scheduler is used.
+#define LINE_TRIANGULATION_INVALID_LINK     0xFFFFFFFF
 
 class LineQuadTree;
 
@@ -26,6 +32,24 @@ struct LineSegment
     bool is_end = false;
 };
 
+// Line that was traced inside of a single tile
+struct LineTrace
+{
+    uint32_t tile = 0;
+    uint32_t coord_offset = 0;
+    uint32_t coord_count = 0;
+    glm::ivec2 direction = glm::ivec2(0);
+
+    uint32_t links[2] = { LINE_TRIANGULATION_INVALID_LINK, LINE_TRIANGULATION_INVALID_LINK }; // Connected endpoint of an other trace for the start and the end of the trace. Stored as 2 * trace + side.
+    bool visited = false;
+};
+
+struct LineTraceTile
+{
+    std::vector<glm::ivec2> coords;
+    std::vector<LineTrace> traces;
+};
+
 class LineTriangulation
 {
 private:
@@ -33,13 +57,45 @@ private:
     std::vector<LineSegment> line_segments;
     std::vector<PointSequence> point_sequences;
 
+    std::vector<LineTraceTile> trace_tiles;
+    std::vector<LineTrace> traces;
+    std::unordered_map<uint64_t, uint32_t> seam_traces; // Traces with an endpoint at the border of a tile
+    std::vector<glm::ivec2> border_points;
+
+    std::vector<glm::ivec2> points;         // Border points and segment points in the order of the constraints
+    std::vector<uint32_t> point_ids;        // Index of the unique point for each point
+    std::vector<uint32_t> point_order;
+    std::vector<glm::ivec2> unique_points;
+
+    LineDelaunay delaunay;
+
 public:
     LineTriangulation() = default;
 
-    void process(const glm::uvec2& resolution, float depth_max, uint32_t line_length_min, const float* depth_copy_pointer, LineQuadTree& quad_tree, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines);
+    // Returns false if the triangulation failed or was cancelled, in which case the mesh is empty.
+    // The tiles are traced by tasks of the given scheduler. If no scheduler is given, the tiles are traced on the calling thread.
+    bool process(const glm::uvec2& resolution, float depth_max, uint32_t line_length_min, LineQuadTree& quad_tree, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines, const CancelToken* cancel_token, Scheduler* scheduler);
 
 private:
+    bool trace_tile(uint32_t tile, const glm::uvec2& resolution, LineQuadTree& quad_tree);
+    void stitch_traces(const glm::uvec2& resolution, uint32_t line_length_min, const LineQuadTree& quad_tree);
+    glm::ivec2 get_trace_endpoint(uint32_t trace_index, uint32_t side) const;
+
     void compute_line_segments();
+
+    void collect_points();
+
+    bool triangulate_delaunay(const glm::uvec2& resolution, float depth_max, const LineQuadTree& quad_tree, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, const CancelToken* cancel_token);
+    bool triangulate_cgal(const glm::uvec2& resolution, float depth_max, const LineQuadTree& quad_tree, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, const CancelToken* cancel_token);
+
+#if LINE_TRIANGULATION_VALIDATE_CGAL
+    void validate_cgal(const glm::uvec2& resolution, float depth_max, const LineQuadTree& quad_tree, const std::vector<shared::Vertex>& vertices, const std::vector<shared::Index>& indices, double time_delaunay);
+#endif
+
+    static float sample_depth(const glm::ivec2& coord, float depth_max, const LineQuadTree& quad_tree);
+    static bool is_tile_border(const glm::ivec2& coord);
+    static bool is_direction_compatible(const glm::ivec2& direction1, const glm::ivec2& direction2);
+    static uint64_t get_coord_key(const glm::ivec2& coord);
 };
 
 #endif
\ No newline at end of file
@@ -1,8 +1,9 @@
 #include "loop_generator.hpp"
 
+#include <spdlog/spdlog.h>
 #include <chrono>
 
-bool LoopGeneratorFrame::triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines, bool export_feature_lines)
+bool LoopGeneratorFrame::triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines, bool export_feature_lines, const CancelToken* cancel_token, Scheduler* scheduler)
 {
     metadata.loop.time_cpu = 0.0f;
     metadata.loop.time_loop_simplification = 0.0f;
@@ -29,14 +30,42 @@ bool LoopGeneratorFrame::triangulate(std::vector<shared::Vertex>& vertices, std:
     metadata.loop.time_discard = this->time_discard;
     metadata.loop.time_write = this->time_write;
 
+#if LOOP_GENERATOR_VALIDATE_REFERENCE
+    this->validate_reference();
+#endif
+
     std::chrono::high_resolution_clock::time_point cpu_start = std::chrono::high_resolution_clock::now();
-    this->triangulation.process(this->resolution, this->triangle_scale, this->loop_pointer, this->loop_count_pointer, this->loop_segment_pointer, vertices, indices, metadata, features_lines, export_feature_lines);
+    bool complete = this->triangulation.process(this->resolution, this->triangle_scale, this->loop_pointer, this->loop_count_pointer, this->loop_segment_pointer, vertices, indices, metadata, features_lines, export_feature_lines, this->sweep_line_profile, cancel_token);
     std::chrono::high_resolution_clock::time_point cpu_end = std::chrono::high_resolution_clock::now();
     metadata.loop.time_cpu = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(cpu_end - cpu_start).count();
 
-    return true;
+    return complete;
 }
 
+#if LOOP_GENERATOR_VALIDATE_REFERENCE
+void LoopGeneratorFrame::validate_reference()
+{
+    shared::LoopViewMetadata reference_metadata;
+
+    this->reference.process(this->depth_copy_pointer, this->normal_copy_pointer, this->object_id_copy_pointer, reference_metadata, nullptr);
+
+    const glsl::LoopCount* reference_count = this->reference.get_loop_count_pointer();
+    std::span<const glsl::Loop> reference_loops(this->reference.get_loop_pointer(), reference_count->loop_counter);
+    std::span<const glsl::LoopSegment> reference_segments(this->reference.get_loop_segment_pointer(), reference_count->segment_counter);
+
+    //The buffers of the frame only hold a limited number of loops and segments
+    uint32_t loop_count = glm::min(this->loop_count_pointer->loop_counter, (uint32_t)LOOP_GENERATOR_MAX_LOOP_COUNT);
+    uint32_t segment_count = glm::min(this->loop_count_pointer->segment_counter, (uint32_t)LOOP_GENERATOR_MAX_LOOP_SEGMENT_COUNT);
+    std::span<const glsl::Loop> loops(this->loop_pointer, loop_count);
+    std::span<const glsl::LoopSegment> segments(this->loop_segment_pointer, segment_count);
+
+    if (!LoopReference::compare(reference_loops, reference_segments, loops, segments))
+    {
+        spdlog::error("LoopGeneratorFrame: Output of the shaders does not match the reference implementation!");
+    }
+}
+#endif
+
 GLuint LoopGeneratorFrame::get_depth_buffer() const
 {
     return this->depth_buffer;
@@ -84,6 +113,11 @@ void LoopGenerator::apply(const shared::MeshSettings& settings)
     this->loop_length_min = settings.loop.loop_length_min;
     this->use_normals = settings.loop.use_normals;
     this->use_object_ids = settings.loop.use_object_ids;
+    this->use_sweep_line_profile = settings.loop.use_sweep_line_profile;
+
+#if LOOP_GENERATOR_VALIDATE_REFERENCE
+    this->reference_settings = settings;
+#endif
 }
 
 MeshGeneratorFrame* LoopGenerator::create_frame()
@@ -224,6 +258,37 @@ MeshGeneratorFrame* LoopGenerator::create_frame()
     loop_frame->discard_timer = discard_timer;
     loop_frame->write_timer = write_timer;
 
+#if LOOP_GENERATOR_VALIDATE_REFERENCE
+    if (!loop_frame->reference.create(this->resolution))
+    {
+        return nullptr;
+    }
+
+    uint32_t depth_copy_buffer_size = this->resolution.x * this->resolution.y * sizeof(float);
+    uint32_t normal_copy_buffer_size = this->resolution.x * this->resolution.y * sizeof(glm::vec2);
+    uint32_t object_id_copy_buffer_size = this->resolution.x * this->resolution.y * sizeof(uint32_t);
+
+    glGenBuffers(1, &loop_frame->depth_copy_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, loop_frame->depth_copy_buffer);
+
+    glBufferStorage(GL_PIXEL_PACK_BUFFER, depth_copy_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    loop_frame->depth_copy_pointer = (const float*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, depth_copy_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+    glGenBuffers(1, &loop_frame->normal_copy_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, loop_frame->normal_copy_buffer);
+
+    glBufferStorage(GL_PIXEL_PACK_BUFFER, normal_copy_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    loop_frame->normal_copy_pointer = (const glm::vec2*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, normal_copy_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+    glGenBuffers(1, &loop_frame->object_id_copy_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, loop_frame->object_id_copy_buffer);
+
+    glBufferStorage(GL_PIXEL_PACK_BUFFER, object_id_copy_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    loop_frame->object_id_copy_pointer = (const uint32_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, object_id_copy_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#endif
+
     return loop_frame;
 }
 
@@ -247,6 +312,20 @@ void LoopGenerator::destroy_frame(MeshGeneratorFrame* frame)
     loop_frame->loop_count_buffer = 0;
     loop_frame->loop_segment_buffer = 0;
 
+#if LOOP_GENERATOR_VALIDATE_REFERENCE
+    glDeleteBuffers(1, &loop_frame->depth_copy_buffer);
+    glDeleteBuffers(1, &loop_frame->normal_copy_buffer);
+    glDeleteBuffers(1, &loop_frame->object_id_copy_buffer);
+
+    loop_frame->depth_copy_buffer = 0;
+    loop_frame->normal_copy_buffer = 0;
+    loop_frame->object_id_copy_buffer = 0;
+    loop_frame->depth_copy_pointer = nullptr;
+    loop_frame->normal_copy_pointer = nullptr;
+    loop_frame->object_id_copy_pointer = nullptr;
+    loop_frame->reference.destroy();
+#endif
+
     glDeleteSync(loop_frame->fence);
 
     loop_frame->fence = 0;
@@ -266,6 +345,7 @@ bool LoopGenerator::submit_frame(MeshGeneratorFrame* frame)
 {
     LoopGeneratorFrame* loop_frame = (LoopGeneratorFrame*)frame;
     loop_frame->triangle_scale = this->triangle_scale;
+    loop_frame->sweep_line_profile = this->use_sweep_line_profile;
         
     glClearTexImage(this->vector_buffer, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
     glClearTexImage(this->closed_buffer, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
@@ -326,6 +406,28 @@ bool LoopGenerator::submit_frame(MeshGeneratorFrame* frame)
     glBindBuffer(GL_COPY_READ_BUFFER, 0);
     glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
 
+#if LOOP_GENERATOR_VALIDATE_REFERENCE
+    loop_frame->reference.apply(this->reference_settings);
+
+    glBindTexture(GL_TEXTURE_2D, loop_frame->depth_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, loop_frame->depth_copy_buffer);
+
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+
+    glBindTexture(GL_TEXTURE_2D, loop_frame->normal_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, loop_frame->normal_copy_buffer);
+
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_FLOAT, nullptr);
+
+    glBindTexture(GL_TEXTURE_2D, loop_frame->object_id_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, loop_frame->object_id_copy_buffer);
+
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#endif
+
     loop_frame->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
     return true;
@@ -11,6 +11,12 @@
 #include "shader.hpp"
 #include "timer.hpp"
 
+#define LOOP_GENERATOR_VALIDATE_REFERENCE 0 // Compare the output of the shaders against the cpu reference implementation
+
+#if LOOP_GENERATOR_VALIDATE_REFERENCE
+#include "loop_reference.hpp"
+#endif
+
 namespace glsl
 {
     using namespace glm;
@@ -33,6 +39,7 @@ public:
     LoopTriangulation triangulation;
     glm::uvec2 resolution = glm::uvec2(0);
     float triangle_scale = 0.0f;
+    bool sweep_line_profile = false;
 
     GLuint depth_buffer = 0;
     GLuint normal_buffer = 0;
@@ -48,6 +55,16 @@ public:
 
     GLsync fence = 0;
 
+#if LOOP_GENERATOR_VALIDATE_REFERENCE
+    LoopReference reference;
+    GLuint depth_copy_buffer = 0;
+    GLuint normal_copy_buffer = 0;
+    GLuint object_id_copy_buffer = 0;
+    const float* depth_copy_pointer = nullptr;
+    const glm::vec2* normal_copy_pointer = nullptr;
+    const uint32_t* object_id_copy_pointer = nullptr;
+#endif
+
     Timer vector_timer;
     Timer split_timer;
     Timer base_timer;
@@ -68,11 +85,16 @@ public:
 public:
     LoopGeneratorFrame() = default;
 
-    bool triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines, bool export_feature_lines = false);
+    bool triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines, bool export_feature_lines = false, const CancelToken* cancel_token = nullptr, Scheduler* scheduler = nullptr);
 
     GLuint get_depth_buffer() const;
     GLuint get_normal_buffer() const;
     GLuint get_object_id_buffer() const;
+
+#if LOOP_GENERATOR_VALIDATE_REFERENCE
+private:
+    void validate_reference();
+#endif
 };
 
 class LoopGenerator : public MeshGenerator
@@ -102,6 +124,11 @@ private:
     uint32_t loop_length_min = 100;
     bool use_normals = true;
     bool use_object_ids = true;
+    bool use_sweep_line_profile = false;
+
+#if LOOP_GENERATOR_VALIDATE_REFERENCE
+    shared::MeshSettings reference_settings = shared::MeshSettings(shared::MESH_GENERATOR_TYPE_LOOP);
+#endif
 
 public:
     LoopGenerator() = default;
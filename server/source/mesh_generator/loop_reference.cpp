@@ -0,0 +1,1247 @@
+#include "loop_reference.hpp"
+#include "../scheduler.hpp"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <array>
+
+//Constants of the vector and split shader
+static const glm::ivec2 vector_offsets[4] = { glm::ivec2(0, 0), glm::ivec2(1, 0), glm::ivec2(1, 1), glm::ivec2(0, 1) };
+static const glm::ivec2 split_offsets[4] = { glm::ivec2(-1, 0), glm::ivec2(0, -1), glm::ivec2(1, 0), glm::ivec2(0, 1) };
+
+static const uint32_t forward_mask[4] = { 0x08, 0x01, 0x02, 0x04 };
+static const glm::ivec2 forward_open[4] = { glm::ivec2(0, 1), glm::ivec2(-1, 0), glm::ivec2(0, -1), glm::ivec2(1, 0) };
+static const glm::ivec2 forward_closed[4] = { glm::ivec2(-1, 0), glm::ivec2(0, -1), glm::ivec2(1, 0), glm::ivec2(0, 1) };
+
+static const uint32_t backward_mask[4] = { 0x01, 0x02, 0x04, 0x08 };
+static const glm::ivec2 backward_open[4] = { glm::ivec2(1, 0), glm::ivec2(0, 1), glm::ivec2(-1, 0), glm::ivec2(0, -1) };
+static const glm::ivec2 backward_closed[4] = { glm::ivec2(0, -1), glm::ivec2(1, 0), glm::ivec2(0, 1), glm::ivec2(-1, 0) };
+
+static const uint32_t opposite_mask[4] = { 0x02, 0x04, 0x08, 0x01 };
+static const uint32_t bridge_mask[4] = { 0x04, 0x08, 0x01, 0x02 };
+
+static const uint32_t delta_depth_mask = (LOOP_GENERATOR_DELTA_DEPTH << 0) | (LOOP_GENERATOR_DELTA_DEPTH << 3) | (LOOP_GENERATOR_DELTA_DEPTH << 6) | (LOOP_GENERATOR_DELTA_DEPTH << 9);
+static const uint32_t delta_object_id_mask = (LOOP_GENERATOR_DELTA_OBJECT_ID << 0) | (LOOP_GENERATOR_DELTA_OBJECT_ID << 3) | (LOOP_GENERATOR_DELTA_OBJECT_ID << 6) | (LOOP_GENERATOR_DELTA_OBJECT_ID << 9);
+static const uint32_t cut_loop_mask = delta_depth_mask | delta_object_id_mask;
+
+bool LoopReference::create(const glm::uvec2& resolution)
+{
+    this->resolution = resolution;
+    this->vector_resolution = resolution * glm::uvec2(2);
+
+    glm::uvec2 level_resolution = (resolution * glm::uvec2(2)) / glm::uvec2(LOOP_GENERATOR_BASE_CELL_SIZE);
+
+    while (true)
+    {
+        LoopReferenceLevel level;
+        level.resolution = level_resolution;
+        level.cell_ranges.resize(level_resolution.x * level_resolution.y);
+
+        this->levels.push_back(std::move(level));
+
+        if (level_resolution.x <= 1 && level_resolution.y <= 1)
+        {
+            break;
+        }
+
+        level_resolution = (level_resolution + glm::uvec2(1)) / glm::uvec2(2);
+    }
+
+    this->vector_buffer.resize(this->vector_resolution.x * this->vector_resolution.y);
+    this->closed_buffer.resize((resolution.x + 1) * (resolution.y + 1));
+
+    this->thread_count = LOOP_REFERENCE_THREAD_COUNT;
+
+    if (this->thread_count == 0)
+    {
+        this->thread_count = glm::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    this->thread_loops.resize(this->thread_count);
+
+    this->loop_count.loop_counter = 0;
+    this->loop_count.segment_counter = 0;
+
+    return true;
+}
+
+void LoopReference::destroy()
+{
+    this->levels.clear();
+    this->vector_buffer.clear();
+    this->closed_buffer.clear();
+    this->loops.clear();
+    this->loop_segments.clear();
+    this->thread_loops.clear();
+}
+
+void LoopReference::apply(const shared::MeshSettings& settings)
+{
+    this->depth_max = settings.depth_max;
+    this->depth_base_threshold = settings.loop.depth_base_threshold;
+    this->depth_slope_threshold = settings.loop.depth_slope_threshold;
+    this->normal_threshold = settings.loop.normal_threshold;
+    this->loop_length_min = settings.loop.loop_length_min;
+    this->use_normals = settings.loop.use_normals;
+    this->use_object_ids = settings.loop.use_object_ids;
+}
+
+void LoopReference::process(const float* depth_pointer, const glm::vec2* normal_pointer, const uint32_t* object_id_pointer, shared::LoopViewMetadata& metadata, Scheduler* scheduler)
+{
+    this->scheduler = scheduler;
+
+    this->loops.clear();
+    this->loop_count.loop_counter = 0;
+    this->loop_count.segment_counter = 0;
+
+    std::chrono::high_resolution_clock::time_point vector_start = std::chrono::high_resolution_clock::now();
+    this->perform_vector_pass(depth_pointer, normal_pointer, object_id_pointer);
+    std::chrono::high_resolution_clock::time_point split_start = std::chrono::high_resolution_clock::now();
+    this->perform_split_pass();
+    std::chrono::high_resolution_clock::time_point base_start = std::chrono::high_resolution_clock::now();
+    this->perform_base_pass();
+    std::chrono::high_resolution_clock::time_point combine_start = std::chrono::high_resolution_clock::now();
+    this->perform_combine_pass();
+    std::chrono::high_resolution_clock::time_point distribute_start = std::chrono::high_resolution_clock::now();
+    this->perform_distribute_pass();
+    std::chrono::high_resolution_clock::time_point discard_start = std::chrono::high_resolution_clock::now();
+    this->perform_discard_pass();
+    std::chrono::high_resolution_clock::time_point write_start = std::chrono::high_resolution_clock::now();
+    this->perform_write_pass(depth_pointer);
+    std::chrono::high_resolution_clock::time_point write_end = std::chrono::high_resolution_clock::now();
+
+    metadata.time_vector = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(split_start - vector_start).count();
+    metadata.time_split = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(base_start - split_start).count();
+    metadata.time_base = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(combine_start - base_start).count();
+    metadata.time_combine = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(distribute_start - combine_start).count();
+    metadata.time_distribute = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(discard_start - distribute_start).count();
+    metadata.time_discard = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(write_start - discard_start).count();
+    metadata.time_write = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(write_end - write_start).count();
+
+    this->scheduler = nullptr;
+}
+
+const glsl::Loop* LoopReference::get_loop_pointer() const
+{
+    return this->loops.data();
+}
+
+const glsl::LoopCount* LoopReference::get_loop_count_pointer() const
+{
+    return &this->loop_count;
+}
+
+const glsl::LoopSegment* LoopReference::get_loop_segment_pointer() const
+{
+    return this->loop_segments.data();
+}
+
+const uint8_t* LoopReference::get_vector_pointer() const
+{
+    return this->vector_buffer.data();
+}
+
+const glm::uvec2& LoopReference::get_vector_resolution() const
+{
+    return this->vector_resolution;
+}
+
+bool LoopReference::compare(std::span<const glsl::Loop> reference_loops, std::span<const glsl::LoopSegment> reference_segments, std::span<const glsl::Loop> loops, std::span<const glsl::LoopSegment> segments)
+{
+    if (reference_loops.size() != loops.size())
+    {
+        spdlog::error("LoopReference: Loop count differs! Expected {} but got {}.", reference_loops.size(), loops.size());
+
+        return false;
+    }
+
+    //Identify loops by their properties and their segments, since neither the order of the loops nor the first segment of a loop is defined on the gpu
+    typedef std::pair<std::array<uint32_t, 3>, std::vector<std::pair<uint32_t, float>>> LoopKey;
+
+    auto collect_loops = [](std::span<const glsl::Loop> loops, std::span<const glsl::LoopSegment> segments, std::vector<LoopKey>& loop_keys)
+    {
+        loop_keys.reserve(loops.size());
+
+        for (const glsl::Loop& loop : loops)
+        {
+            if ((uint64_t)loop.segment_offset + loop.segment_count > segments.size())
+            {
+                return false;
+            }
+
+            LoopKey loop_key;
+            loop_key.first = { loop.segment_count, loop.loop_length, loop.loop_flag };
+            loop_key.second.reserve(loop.segment_count);
+
+            for (uint32_t index = 0; index < loop.segment_count; index++)
+            {
+                const glsl::LoopSegment& segment = segments[loop.segment_offset + index];
+                loop_key.second.push_back(std::make_pair((segment.end_coord.y << 16) | segment.end_coord.x, segment.end_coord_depth));
+            }
+
+            //Rotate the segments so that the loop starts at its smallest coordinate while the orientation is kept
+            std::rotate(loop_key.second.begin(), std::min_element(loop_key.second.begin(), loop_key.second.end()), loop_key.second.end());
+
+            loop_keys.push_back(std::move(loop_key));
+        }
+
+        std::sort(loop_keys.begin(), loop_keys.end());
+
+        return true;
+    };
+
+    std::vector<LoopKey> reference_loop_keys;
+    std::vector<LoopKey> loop_keys;
+
+    if (!collect_loops(reference_loops, reference_segments, reference_loop_keys) || !collect_loops(loops, segments, loop_keys))
+    {
+        spdlog::error("LoopReference: Segment out of range!");
+
+        return false;
+    }
+
+    if (reference_loop_keys != loop_keys)
+    {
+        spdlog::error("LoopReference: Loops differ!");
+
+        return false;
+    }
+
+    return true;
+}
+
+void LoopReference::perform_vector_pass(const float* depth_pointer, const glm::vec2* normal_pointer, const uint32_t* object_id_pointer)
+{
+    std::fill(this->vector_buffer.begin(), this->vector_buffer.end(), 0);
+    std::fill(this->closed_buffer.begin(), this->closed_buffer.end(), 0);
+
+    //The vector pass covers one more row and column than the depth image, since the vectors are located between the pixels
+    this->run_parallel(this->resolution.y + 1, [&](uint32_t thread, uint32_t row_begin, uint32_t row_end)
+    {
+        for (uint32_t coord_y = row_begin; coord_y < row_end; coord_y++)
+        {
+            for (uint32_t coord_x = 0; coord_x <= this->resolution.x; coord_x++)
+            {
+                glm::ivec2 base_coord = glm::ivec2(coord_x, coord_y);
+
+                float first_depth = 0.0f;
+                glm::vec3 first_normal = glm::vec3(0.0f);
+                uint32_t first_object_id = 0;
+
+                float last_depth = 0.0f;
+                glm::vec3 last_normal = glm::vec3(0.0f);
+                uint32_t last_object_id = 0;
+
+                uint32_t delta_bitfield = 0;
+
+                for (uint32_t index = 0; index < 4; index++)
+                {
+                    glm::ivec2 adjacent_coord = (base_coord - glm::ivec2(1)) + vector_offsets[index];
+                    float adjacent_depth = 0.0f;
+                    glm::vec3 adjacent_normal = glm::vec3(0.0f);
+                    uint32_t adjacent_object_id = 0;
+
+                    this->load_sample(adjacent_coord, depth_pointer, normal_pointer, object_id_pointer, adjacent_depth, adjacent_normal, adjacent_object_id);
+
+                    if (index == 0)
+                    {
+                        first_depth = adjacent_depth;
+                        first_normal = adjacent_normal;
+                        first_object_id = adjacent_object_id;
+                    }
+
+                    else
+                    {
+                        delta_bitfield |= this->compare_samples(last_depth, last_normal, last_object_id, adjacent_depth, adjacent_normal, adjacent_object_id);
+                        delta_bitfield <<= 3;
+                    }
+
+                    last_depth = adjacent_depth;
+                    last_normal = adjacent_normal;
+                    last_object_id = adjacent_object_id;
+                }
+
+                delta_bitfield |= this->compare_samples(last_depth, last_normal, last_object_id, first_depth, first_normal, first_object_id);
+
+                if (delta_bitfield == 0)
+                {
+                    continue;
+                }
+
+                bool is_cut_loop = ((delta_bitfield & cut_loop_mask) != 0);
+                uint32_t bridge_bitfield = 0;
+                uint32_t closed_bitfield = 0;
+
+                for (uint32_t index = 0; index < 4; index++)
+                {
+                    uint32_t side_bitfield = delta_bitfield & 0x07;
+
+                    if ((side_bitfield & (LOOP_GENERATOR_DELTA_DEPTH | LOOP_GENERATOR_DELTA_OBJECT_ID)) != 0)
+                    {
+                        closed_bitfield |= 1;
+                    }
+
+                    else if ((side_bitfield & LOOP_GENERATOR_DELTA_NORMAL) != 0)
+                    {
+                        if (is_cut_loop)
+                        {
+                            bridge_bitfield |= 1;
+                        }
+
+                        else
+                        {
+                            closed_bitfield |= 1;
+                        }
+                    }
+
+                    if (index < 3)
+                    {
+                        delta_bitfield >>= 3;
+                        closed_bitfield <<= 1;
+                        bridge_bitfield <<= 1;
+                    }
+                }
+
+                for (uint32_t index = 0; index < 4; index++)
+                {
+                    glm::ivec2 vector_coord = (base_coord * 2 - glm::ivec2(1)) + vector_offsets[index];
+
+                    if (glm::any(glm::lessThan(vector_coord, glm::ivec2(0))) || glm::any(glm::greaterThanEqual(vector_coord, glm::ivec2(this->vector_resolution))))
+                    {
+                        continue;
+                    }
+
+                    glm::ivec2 forward_direction = forward_open[index];
+                    glm::ivec2 backward_direction = backward_open[index];
+
+                    if ((closed_bitfield & forward_mask[index]) != 0)
+                    {
+                        forward_direction = forward_closed[index];
+                    }
+
+                    if ((closed_bitfield & backward_mask[index]) != 0)
+                    {
+                        backward_direction = backward_closed[index];
+                    }
+
+                    uint32_t encoded_direction = 0;
+                    encoded_direction |= LoopReference::encode_direction(forward_direction);
+                    encoded_direction |= LoopReference::encode_direction(backward_direction) << 2;
+
+                    if (is_cut_loop)
+                    {
+                        encoded_direction |= LOOP_GENERATOR_VECTOR_CUT;
+                    }
+
+                    else
+                    {
+                        encoded_direction |= LOOP_GENERATOR_VECTOR_EDGE;
+                    }
+
+                    if ((bridge_bitfield & forward_mask[index]) != 0)
+                    {
+                        encoded_direction |= LOOP_GENERATOR_VECTOR_BRIDGE;
+                    }
+
+                    this->vector_buffer[vector_coord.y * this->vector_resolution.x + vector_coord.x] = encoded_direction;
+                }
+
+                uint32_t closed_buffer_value = closed_bitfield;
+
+                if (!is_cut_loop)
+                {
+                    closed_buffer_value |= 0x10;
+                }
+
+                this->closed_buffer[coord_y * (this->resolution.x + 1) + coord_x] = closed_buffer_value;
+            }
+        }
+    });
+}
+
+void LoopReference::perform_split_pass()
+{
+    this->run_parallel(this->resolution.y + 1, [&](uint32_t thread, uint32_t row_begin, uint32_t row_end)
+    {
+        for (uint32_t coord_y = row_begin; coord_y < row_end; coord_y++)
+        {
+            for (uint32_t coord_x = 0; coord_x <= this->resolution.x; coord_x++)
+            {
+                glm::ivec2 base_coord = glm::ivec2(coord_x, coord_y);
+
+                uint32_t closed_buffer_value = this->fetch_closed(base_coord);
+                bool is_edge_loop = (closed_buffer_value & 0x10) != 0;
+
+                if (!is_edge_loop)
+                {
+                    continue; //Already handeld by the vector pass
+                }
+
+                uint32_t closed_bitfield = closed_buffer_value & 0x0F;
+                uint32_t bridge_bitfield = 0;
+
+                for (uint32_t index = 0; index < 4; index++)
+                {
+                    uint32_t adjacent_closed_bitfield = this->fetch_closed(base_coord + split_offsets[index]);
+
+                    if (adjacent_closed_bitfield == 0)
+                    {
+                        continue;
+                    }
+
+                    if ((closed_bitfield & forward_mask[index]) != 0 && (adjacent_closed_bitfield & opposite_mask[index]) == 0)
+                    {
+                        closed_bitfield &= ~forward_mask[index];
+                        bridge_bitfield |= bridge_mask[index];
+                    }
+                }
+
+                if (bridge_bitfield == 0)
+                {
+                    continue;
+                }
+
+                for (uint32_t index = 0; index < 4; index++)
+                {
+                    glm::ivec2 vector_coord = (base_coord * 2 - glm::ivec2(1)) + vector_offsets[index];
+
+                    if (glm::any(glm::lessThan(vector_coord, glm::ivec2(0))) || glm::any(glm::greaterThanEqual(vector_coord, glm::ivec2(this->vector_resolution))))
+                    {
+                        continue;
+                    }
+
+                    glm::ivec2 forward_direction = forward_open[index];
+                    glm::ivec2 backward_direction = backward_open[index];
+
+                    if ((closed_bitfield & forward_mask[index]) != 0)
+                    {
+                        forward_direction = forward_closed[index];
+                    }
+
+                    if ((closed_bitfield & backward_mask[index]) != 0)
+                    {
+                        backward_direction = backward_closed[index];
+                    }
+
+                    uint32_t encoded_direction = 0;
+                    encoded_direction |= LoopReference::encode_direction(forward_direction);
+                    encoded_direction |= LoopReference::encode_direction(backward_direction) << 2;
+                    encoded_direction |= LOOP_GENERATOR_VECTOR_EDGE;
+
+                    if ((bridge_bitfield & forward_mask[index]) != 0)
+                    {
+                        encoded_direction |= LOOP_GENERATOR_VECTOR_BRIDGE;
+                    }
+
+                    this->vector_buffer[vector_coord.y * this->vector_resolution.x + vector_coord.x] = encoded_direction;
+                }
+            }
+        }
+    });
+}
+
+void LoopReference::perform_base_pass()
+{
+    LoopReferenceLevel& level = this->levels.front();
+
+    this->run_parallel(level.resolution.y, [&](uint32_t thread, uint32_t row_begin, uint32_t row_end)
+    {
+        for (uint32_t coord_y = row_begin; coord_y < row_end; coord_y++)
+        {
+            for (uint32_t coord_x = 0; coord_x < level.resolution.x; coord_x++)
+            {
+                uint32_t cell_index = coord_y * level.resolution.x + coord_x;
+                std::vector<glsl::LoopRange>& ranges = level.cell_ranges[cell_index];
+                ranges.clear();
+
+                glm::ivec2 cell_coord = glm::ivec2(coord_x, coord_y) * LOOP_GENERATOR_BASE_CELL_SIZE;
+                uint64_t flag_buffer = ((uint64_t)0x2A55AA55 << 32) | 0xAA55AA54; //Same pattern as in the base shader
+
+                for (uint32_t local_y = 0; local_y < LOOP_GENERATOR_BASE_CELL_SIZE; local_y++)
+                {
+                    for (uint32_t local_x = 0; local_x < LOOP_GENERATOR_BASE_CELL_SIZE; local_x++)
+                    {
+                        uint32_t flag_offset = local_y * LOOP_GENERATOR_BASE_CELL_SIZE + local_x;
+
+                        if (((flag_buffer >> flag_offset) & 0x01) != 0)
+                        {
+                            continue;
+                        }
+
+                        glm::ivec2 global_coord = cell_coord + glm::ivec2(local_x, local_y);
+                        uint32_t encoded_direction = this->fetch_vector(global_coord);
+
+                        if (encoded_direction == 0)
+                        {
+                            continue;
+                        }
+
+                        glm::ivec2 start_forward_direction = LoopReference::decode_direction(encoded_direction);
+                        glm::ivec2 start_backward_direction = LoopReference::decode_direction(encoded_direction >> 2);
+
+                        glm::ivec2 previous_coord = global_coord;
+                        glm::ivec2 start_coord = global_coord;
+                        uint32_t segment_count = 0;
+                        uint32_t segment_length = 0;
+                        uint32_t vector_bitfield = 0;
+
+                        glsl::LoopRange range;
+
+                        if (this->trace_backwards(cell_coord, global_coord, flag_buffer, previous_coord, start_coord, start_forward_direction, segment_count, segment_length, vector_bitfield))
+                        {
+                            if ((vector_bitfield & LOOP_GENERATOR_VECTOR_CUT) != 0 || segment_length >= this->loop_length_min)
+                            {
+                                LoopReferenceEntry entry;
+                                entry.cell_index = cell_index;
+                                entry.range_index = ranges.size();
+                                entry.loop.segment_count = segment_count;
+                                entry.loop.segment_offset = LOOP_GENERATOR_INVALID_SEGMENT_OFFSET;
+                                entry.loop.loop_length = segment_length;
+                                entry.loop.loop_flag = vector_bitfield >> 4;
+
+                                this->thread_loops[thread].push_back(entry);
+                            }
+
+                            range.previous_coord = glm::u16vec2(global_coord + start_backward_direction);
+                            range.start_coord = glm::u16vec2(global_coord);
+                            range.end_coord = glm::u16vec2(global_coord);
+                            range.flag = (vector_bitfield >> 4) | LOOP_GENERATOR_LOOP_RANGE_PROCESSED;
+                            range.segment_count = segment_count;
+                            range.segment_offset = LOOP_GENERATOR_INVALID_SEGMENT_OFFSET;
+                            range.segment_length = segment_length;
+                        }
+
+                        else
+                        {
+                            glm::ivec2 end_coord = global_coord;
+
+                            this->trace_forward(cell_coord, flag_buffer, end_coord, start_forward_direction, segment_count, segment_length, vector_bitfield);
+
+                            if ((encoded_direction & LOOP_GENERATOR_VECTOR_BRIDGE) != 0)
+                            {
+                                segment_count--;
+                            }
+
+                            range.previous_coord = glm::u16vec2(previous_coord);
+                            range.start_coord = glm::u16vec2(start_coord);
+                            range.end_coord = glm::u16vec2(end_coord);
+                            range.flag = (vector_bitfield >> 4);
+                            range.segment_count = segment_count;
+                            range.segment_offset = LOOP_GENERATOR_INVALID_SEGMENT_OFFSET;
+                            range.segment_length = segment_length;
+                        }
+
+                        ranges.push_back(range);
+                    }
+                }
+            }
+        }
+    });
+
+    this->emit_loops(0);
+}
+
+void LoopReference::perform_combine_pass()
+{
+    for (uint32_t index = 0; index + 1 < this->levels.size(); index++)
+    {
+        LoopReferenceLevel& dst_level = this->levels[index + 1];
+
+        glm::ivec2 src_cell_size = glm::ivec2(LOOP_GENERATOR_BASE_CELL_SIZE << index);
+        glm::ivec2 cell_size = src_cell_size * 2;
+
+        //Each cell of the destination level only accesses the ranges of its four source cells, so that the cells can be processed independently
+        this->run_parallel(dst_level.resolution.y, [&](uint32_t thread, uint32_t row_begin, uint32_t row_end)
+        {
+            for (uint32_t coord_y = row_begin; coord_y < row_end; coord_y++)
+            {
+                for (uint32_t coord_x = 0; coord_x < dst_level.resolution.x; coord_x++)
+                {
+                    uint32_t cell_index = coord_y * dst_level.resolution.x + coord_x;
+                    std::vector<glsl::LoopRange>& dst_ranges = dst_level.cell_ranges[cell_index];
+                    dst_ranges.clear();
+
+                    glm::ivec2 cell_coord = glm::ivec2(coord_x, coord_y);
+                    glm::ivec2 cell_min = cell_coord * cell_size;
+
+                    //Ranges that enter the cell from the outside
+                    for (uint32_t quadrant = 0; quadrant < 4; quadrant++)
+                    {
+                        glm::ivec2 src_offset = glm::ivec2(quadrant % 2, quadrant / 2);
+                        std::vector<glsl::LoopRange>* src_ranges = this->fetch_ranges(index, cell_coord * 2 + src_offset);
+
+                        if (src_ranges == nullptr)
+                        {
+                            continue;
+                        }
+
+                        for (uint32_t range_index = 0; range_index < src_ranges->size(); range_index++)
+                        {
+                            glsl::LoopRange& src_range = (*src_ranges)[range_index];
+                            glm::ivec2 previous_coord = glm::ivec2(src_range.previous_coord);
+
+                            if (!glm::any(glm::lessThan(previous_coord, cell_min)) && !glm::any(glm::greaterThanEqual(previous_coord, cell_min + cell_size)))
+                            {
+                                continue;
+                            }
+
+                            uint32_t segment_flag = src_range.flag;
+                            src_range.flag = segment_flag | LOOP_GENERATOR_LOOP_RANGE_PROCESSED;
+
+                            glm::ivec2 end_coord = glm::ivec2(src_range.end_coord);
+                            uint32_t segment_count = src_range.segment_count;
+                            uint32_t segment_length = src_range.segment_length;
+                            uint32_t segment_bitfield = segment_flag;
+
+                            this->trace_line(index, cell_coord, cell_min, cell_size, end_coord, segment_count, segment_length, segment_bitfield);
+
+                            glsl::LoopRange dst_range;
+                            dst_range.previous_coord = glm::u16vec2(previous_coord);
+                            dst_range.start_coord = src_range.start_coord;
+                            dst_range.end_coord = glm::u16vec2(end_coord);
+                            dst_range.flag = segment_bitfield;
+                            dst_range.segment_count = segment_count;
+                            dst_range.segment_offset = LOOP_GENERATOR_INVALID_SEGMENT_OFFSET;
+                            dst_range.segment_length = segment_length;
+
+                            dst_ranges.push_back(dst_range);
+                        }
+                    }
+
+                    //Ranges that were not reached from the outside belong to loops that are closed inside of the cell
+                    for (uint32_t quadrant = 0; quadrant < 4; quadrant++)
+                    {
+                        glm::ivec2 src_offset = glm::ivec2(quadrant % 2, quadrant / 2);
+                        const std::vector<glsl::LoopRange>* src_ranges = this->fetch_ranges(index, cell_coord * 2 + src_offset);
+
+                        if (src_ranges == nullptr)
+                        {
+                            continue;
+                        }
+
+                        for (uint32_t range_index = 0; range_index < src_ranges->size(); range_index++)
+                        {
+                            const glsl::LoopRange& src_range = (*src_ranges)[range_index];
+
+                            if ((src_range.flag & LOOP_GENERATOR_LOOP_RANGE_PROCESSED) != 0)
+                            {
+                                continue;
+                            }
+
+                            glm::ivec2 start_coord = glm::ivec2(src_range.start_coord);
+                            glm::ivec2 end_coord = glm::ivec2(src_range.end_coord);
+                            uint32_t segment_count = src_range.segment_count;
+                            uint32_t segment_length = src_range.segment_length;
+                            uint32_t segment_bitfield = src_range.flag;
+
+                            if (!this->trace_loop(index, cell_coord, cell_min, cell_size, src_offset, range_index, start_coord, end_coord, segment_count, segment_length, segment_bitfield))
+                            {
+                                continue; //Loop already processed
+                            }
+
+                            if ((segment_bitfield & LOOP_GENERATOR_LOOP_CUT) != 0 || segment_length >= this->loop_length_min)
+                            {
+                                LoopReferenceEntry entry;
+                                entry.cell_index = cell_index;
+                                entry.range_index = dst_ranges.size();
+                                entry.loop.segment_count = segment_count;
+                                entry.loop.segment_offset = LOOP_GENERATOR_INVALID_SEGMENT_OFFSET;
+                                entry.loop.loop_length = segment_length;
+                                entry.loop.loop_flag = segment_bitfield;
+
+                                this->thread_loops[thread].push_back(entry);
+
+                                glsl::LoopRange dst_range;
+                                dst_range.previous_coord = glm::u16vec2(start_coord);
+                                dst_range.start_coord = glm::u16vec2(start_coord);
+                                dst_range.end_coord = glm::u16vec2(start_coord);
+                                dst_range.flag = segment_bitfield | LOOP_GENERATOR_LOOP_RANGE_PROCESSED;
+                                dst_range.segment_count = segment_count;
+                                dst_range.segment_offset = LOOP_GENERATOR_INVALID_SEGMENT_OFFSET;
+                                dst_range.segment_length = segment_length;
+
+                                dst_ranges.push_back(dst_range);
+                            }
+                        }
+                    }
+                }
+            }
+        });
+
+        this->emit_loops(index + 1);
+    }
+}
+
+void LoopReference::perform_distribute_pass()
+{
+    for (int32_t index = this->levels.size() - 2; index >= 0; index--)
+    {
+        const LoopReferenceLevel& dst_level = this->levels[index + 1];
+
+        this->run_parallel(dst_level.resolution.y, [&](uint32_t thread, uint32_t row_begin, uint32_t row_end)
+        {
+            for (uint32_t coord_y = row_begin; coord_y < row_end; coord_y++)
+            {
+                for (uint32_t coord_x = 0; coord_x < dst_level.resolution.x; coord_x++)
+                {
+                    glm::ivec2 cell_coord = glm::ivec2(coord_x, coord_y);
+
+                    for (const glsl::LoopRange& dst_range : dst_level.cell_ranges[coord_y * dst_level.resolution.x + coord_x])
+                    {
+                        if (dst_range.segment_count == 0 || dst_range.segment_offset == LOOP_GENERATOR_INVALID_SEGMENT_OFFSET)
+                        {
+                            continue;
+                        }
+
+                        this->distribute(index, cell_coord, glm::ivec2(dst_range.start_coord), glm::ivec2(dst_range.end_coord), dst_range.segment_offset);
+                    }
+                }
+            }
+        });
+    }
+}
+
+void LoopReference::perform_discard_pass()
+{
+    const LoopReferenceLevel& level = this->levels.front();
+
+    this->run_parallel(level.resolution.y, [&](uint32_t thread, uint32_t row_begin, uint32_t row_end)
+    {
+        uint32_t begin = row_begin * level.resolution.x;
+        uint32_t end = row_end * level.resolution.x;
+
+        for (uint32_t cell_index = begin; cell_index < end; cell_index++)
+        {
+            for (const glsl::LoopRange& range : level.cell_ranges[cell_index])
+            {
+                if (range.segment_count == 0 || range.segment_offset != LOOP_GENERATOR_INVALID_SEGMENT_OFFSET) //Only if the loop is not long enough and was therefore discarded
+                {
+                    continue;
+                }
+
+                glm::ivec2 current_coord = glm::ivec2(range.start_coord);
+                glm::ivec2 end_coord = glm::ivec2(range.end_coord);
+
+                while (true)
+                {
+                    uint32_t encoded_direction = this->fetch_vector(current_coord);
+                    glm::ivec2 direction = LoopReference::decode_direction(encoded_direction);
+
+                    if ((encoded_direction & LOOP_GENERATOR_VECTOR_BRIDGE) != 0)
+                    {
+                        //The range only covers vectors inside of its cell, which is owned by this thread
+                        this->vector_buffer[current_coord.y * this->vector_resolution.x + current_coord.x] = encoded_direction & ~LOOP_GENERATOR_VECTOR_BRIDGE;
+                    }
+
+                    current_coord += direction;
+
+                    if (current_coord == end_coord)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+    });
+}
+
+void LoopReference::perform_write_pass(const float* depth_pointer)
+{
+    const LoopReferenceLevel& level = this->levels.front();
+    this->loop_segments.resize(this->loop_count.segment_counter);
+
+    this->run_parallel(level.resolution.y, [&](uint32_t thread, uint32_t row_begin, uint32_t row_end)
+    {
+        uint32_t begin = row_begin * level.resolution.x;
+        uint32_t end = row_end * level.resolution.x;
+
+        for (uint32_t cell_index = begin; cell_index < end; cell_index++)
+        {
+            for (const glsl::LoopRange& range : level.cell_ranges[cell_index])
+            {
+                uint32_t segment_offset = range.segment_offset;
+
+                if (range.segment_count == 0 || segment_offset == LOOP_GENERATOR_INVALID_SEGMENT_OFFSET)
+                {
+                    continue;
+                }
+
+                glm::ivec2 end_coord = glm::ivec2(range.end_coord);
+                glm::ivec2 current_coord = glm::ivec2(range.start_coord);
+                uint32_t current_direction = this->fetch_vector(glm::ivec2(range.previous_coord));
+
+                while (true)
+                {
+                    uint32_t encoded_direction = this->fetch_vector(current_coord);
+                    glm::ivec2 direction = LoopReference::decode_direction(encoded_direction);
+
+                    bool is_bridge = (encoded_direction & LOOP_GENERATOR_VECTOR_BRIDGE) != 0;
+
+                    if ((encoded_direction & 0x03) != (current_direction & 0x03) || is_bridge)
+                    {
+                        glm::ivec2 depth_coord = current_coord / 2;
+                        float end_coord_depth = glm::min(depth_pointer[depth_coord.y * this->resolution.x + depth_coord.x], this->depth_max);
+
+                        if (is_bridge)
+                        {
+                            bool is_edge = (encoded_direction & LOOP_GENERATOR_VECTOR_EDGE) != 0;
+
+                            //Same as get_bridge_neighbour_offset of the write shader
+                            glm::ivec2 local_coord = (current_coord + glm::ivec2(1)) % 2;
+                            uint32_t local_index = (local_coord.y > 0) ? (3 - local_coord.x) : local_coord.x;
+                            glm::ivec2 neighbour_offset = is_edge ? forward_closed[(local_index + 1) % 4] : forward_closed[local_index];
+
+                            uint32_t neighbour_value = this->fetch_vector(current_coord + neighbour_offset);
+
+                            bool is_neighbour_bridge = (neighbour_value & LOOP_GENERATOR_VECTOR_BRIDGE) != 0;
+                            bool is_neighbour_edge = (neighbour_value & LOOP_GENERATOR_VECTOR_EDGE) != 0;
+
+                            if (is_neighbour_bridge && (is_edge != is_neighbour_edge))
+                            {
+                                end_coord_depth = -end_coord_depth; //Encode bridge coord using [-1.0, 0.0]
+                            }
+
+                            else if ((encoded_direction & 0x03) == (current_direction & 0x03))
+                            {
+                                end_coord_depth = -2.0f; //Encode invalid coord using ]-infinity, -1.0[
+                            }
+                        }
+
+                        if (segment_offset < this->loop_segments.size())
+                        {
+                            glsl::LoopSegment& segment = this->loop_segments[segment_offset];
+                            segment.end_coord = glm::u16vec2(current_coord);
+                            segment.end_coord_depth = end_coord_depth;
+                        }
+
+                        current_direction = encoded_direction;
+                        segment_offset++;
+                    }
+
+                    current_coord += direction;
+
+                    if (current_coord == end_coord)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+    });
+}
+
+void LoopReference::load_sample(const glm::ivec2& coord, const float* depth_pointer, const glm::vec2* normal_pointer, const uint32_t* object_id_pointer, float& depth, glm::vec3& normal, uint32_t& object_id) const
+{
+    if (glm::any(glm::lessThan(coord, glm::ivec2(0))) || glm::any(glm::greaterThanEqual(coord, glm::ivec2(this->resolution))))
+    {
+        depth = -1.0f;
+        normal = glm::vec3(0.0f, 0.0f, 1.0f);
+        object_id = LOOP_GENERATOR_INVALID_OBJECT_ID;
+
+        return;
+    }
+
+    uint32_t index = coord.y * this->resolution.x + coord.x;
+    depth = depth_pointer[index];
+
+    if (depth < this->depth_max)
+    {
+        if (this->use_normals) //Normal still required for the depth decision
+        {
+            normal = LoopReference::decode_normal(normal_pointer[index]);
+        }
+
+        else
+        {
+            normal = glm::vec3(0.0f, 0.0f, 1.0f);
+        }
+
+        if (this->use_object_ids)
+        {
+            object_id = object_id_pointer[index];
+        }
+
+        else
+        {
+            object_id = LOOP_GENERATOR_INVALID_OBJECT_ID;
+        }
+    }
+
+    else
+    {
+        depth = this->depth_max;
+        normal = glm::vec3(0.0f, 0.0f, 1.0f);
+        object_id = LOOP_GENERATOR_INVALID_OBJECT_ID;
+    }
+}
+
+uint32_t LoopReference::compare_samples(float depth1, const glm::vec3& normal1, uint32_t object_id1, float depth2, const glm::vec3& normal2, uint32_t object_id2) const
+{
+    float slope = 1.0f - glm::max(normal1.z, normal2.z);
+
+    float delta_depth = glm::abs(depth1 - depth2);
+    float delta_normal = glm::acos(glm::dot(normal1, normal2));
+
+    uint32_t delta_bitfield = 0;
+
+    if (delta_depth >= this->depth_base_threshold + slope * this->depth_slope_threshold)
+    {
+        delta_bitfield |= LOOP_GENERATOR_DELTA_DEPTH;
+    }
+
+    if (delta_normal >= this->normal_threshold)
+    {
+        delta_bitfield |= LOOP_GENERATOR_DELTA_NORMAL;
+    }
+
+    if (object_id1 != object_id2)
+    {
+        delta_bitfield |= LOOP_GENERATOR_DELTA_OBJECT_ID;
+    }
+
+    return delta_bitfield;
+}
+
+bool LoopReference::trace_backwards(const glm::ivec2& cell_coord, const glm::ivec2& global_coord, uint64_t& flag_buffer, glm::ivec2& previous_coord, glm::ivec2& start_coord, const glm::ivec2& start_direction, uint32_t& segment_count, uint32_t& segment_length, uint32_t& vector_bitfield) const
+{
+    glm::ivec2 current_direction = -start_direction;
+
+    while (true)
+    {
+        uint32_t encoded_direction = this->fetch_vector(start_coord);
+        glm::ivec2 direction = LoopReference::decode_direction(encoded_direction >> 2);
+        previous_coord = start_coord + direction;
+
+        if (current_direction != direction || (encoded_direction & LOOP_GENERATOR_VECTOR_BRIDGE) != 0)
+        {
+            current_direction = direction;
+
+            segment_count++;
+        }
+
+        if (glm::any(glm::lessThan(previous_coord, cell_coord)) || glm::any(glm::greaterThanEqual(previous_coord, cell_coord + LOOP_GENERATOR_BASE_CELL_SIZE)))
+        {
+            break;
+        }
+
+        start_coord = previous_coord;
+
+        glm::ivec2 local_coord = start_coord - cell_coord;
+        flag_buffer |= (uint64_t)0x01 << (local_coord.y * LOOP_GENERATOR_BASE_CELL_SIZE + local_coord.x);
+
+        vector_bitfield |= encoded_direction;
+        segment_length++;
+
+        if (start_coord == global_coord)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void LoopReference::trace_forward(const glm::ivec2& cell_coord, uint64_t& flag_buffer, glm::ivec2& end_coord, const glm::ivec2& start_direction, uint32_t& segment_count, uint32_t& segment_length, uint32_t& vector_bitfield) const
+{
+    glm::ivec2 current_direction = start_direction;
+
+    while (true)
+    {
+        if (glm::any(glm::lessThan(end_coord, cell_coord)) || glm::any(glm::greaterThanEqual(end_coord, cell_coord + LOOP_GENERATOR_BASE_CELL_SIZE)))
+        {
+            break;
+        }
+
+        glm::ivec2 local_coord = end_coord - cell_coord;
+        flag_buffer |= (uint64_t)0x01 << (local_coord.y * LOOP_GENERATOR_BASE_CELL_SIZE + local_coord.x);
+
+        uint32_t encoded_direction = this->fetch_vector(end_coord);
+        glm::ivec2 direction = LoopReference::decode_direction(encoded_direction);
+        end_coord = end_coord + direction;
+
+        vector_bitfield |= encoded_direction;
+        segment_length++;
+
+        if (current_direction != direction || (encoded_direction & LOOP_GENERATOR_VECTOR_BRIDGE) != 0)
+        {
+            current_direction = direction;
+
+            segment_count++;
+        }
+    }
+}
+
+void LoopReference::trace_line(uint32_t src_level, const glm::ivec2& cell_coord, const glm::ivec2& cell_min, const glm::ivec2& cell_size, glm::ivec2& end_coord, uint32_t& segment_count, uint32_t& segment_length, uint32_t& segment_bitfield)
+{
+    glm::ivec2 src_cell_size = cell_size / 2;
+
+    while (true)
+    {
+        if (glm::any(glm::lessThan(end_coord, cell_min)) || glm::any(glm::greaterThanEqual(end_coord, cell_min + cell_size)))
+        {
+            break;
+        }
+
+        glm::ivec2 src_offset = (end_coord - cell_min) / src_cell_size;
+        std::vector<glsl::LoopRange>* src_ranges = this->fetch_ranges(src_level, cell_coord * 2 + src_offset);
+
+        if (src_ranges == nullptr)
+        {
+            break;
+        }
+
+        bool found = false;
+
+        for (glsl::LoopRange& src_range : *src_ranges)
+        {
+            if (end_coord == glm::ivec2(src_range.start_coord))
+            {
+                uint32_t segment_flag = src_range.flag;
+                src_range.flag = segment_flag | LOOP_GENERATOR_LOOP_RANGE_PROCESSED;
+
+                segment_bitfield |= segment_flag;
+                segment_count += src_range.segment_count;
+                segment_length += src_range.segment_length;
+                end_coord = glm::ivec2(src_range.end_coord);
+
+                found = true;
+
+                break;
+            }
+        }
+
+        if (!found)
+        {
+            break;
+        }
+    }
+}
+
+bool LoopReference::trace_loop(uint32_t src_level, const glm::ivec2& cell_coord, const glm::ivec2& cell_min, const glm::ivec2& cell_size, const glm::ivec2& quadrant_offset, uint32_t quadrant_index, const glm::ivec2& start_coord, glm::ivec2& end_coord, uint32_t& segment_count, uint32_t& segment_length, uint32_t& segment_bitfield) const
+{
+    glm::ivec2 src_cell_size = cell_size / 2;
+
+    while (true)
+    {
+        glm::ivec2 src_offset = (end_coord - cell_min) / src_cell_size;
+
+        if (src_offset.x + src_offset.y * 2 < quadrant_offset.x + quadrant_offset.y * 2)
+        {
+            return false; //Loop already processed
+        }
+
+        const std::vector<glsl::LoopRange>* src_ranges = this->fetch_ranges(src_level, cell_coord * 2 + src_offset);
+
+        if (src_ranges == nullptr)
+        {
+            break;
+        }
+
+        bool found = false;
+
+        for (uint32_t index = 0; index < src_ranges->size(); index++)
+        {
+            const glsl::LoopRange& src_range = (*src_ranges)[index];
+            glm::ivec2 current_start_coord = glm::ivec2(src_range.start_coord);
+
+            if (end_coord == current_start_coord)
+            {
+                if (start_coord == current_start_coord)
+                {
+                    return true; //Loop closed
+                }
+
+                if (src_offset == quadrant_offset && index < quadrant_index)
+                {
+                    return false; //Loop already processed
+                }
+
+                segment_bitfield |= src_range.flag;
+                segment_count += src_range.segment_count;
+                segment_length += src_range.segment_length;
+                end_coord = glm::ivec2(src_range.end_coord);
+
+                found = true;
+
+                break;
+            }
+        }
+
+        if (!found)
+        {
+            break;
+        }
+    }
+
+    return false;
+}
+
+void LoopReference::distribute(uint32_t src_level, const glm::ivec2& cell_coord, const glm::ivec2& start_coord, const glm::ivec2& end_coord, uint32_t segment_offset)
+{
+    glm::ivec2 src_cell_size = glm::ivec2(LOOP_GENERATOR_BASE_CELL_SIZE << src_level);
+    glm::ivec2 cell_min = cell_coord * (src_cell_size * 2);
+
+    glm::ivec2 current_coord = start_coord;
+    uint32_t current_segment_offset = segment_offset;
+
+    while (true)
+    {
+        glm::ivec2 src_offset = (current_coord - cell_min) / src_cell_size;
+        std::vector<glsl::LoopRange>* src_ranges = this->fetch_ranges(src_level, cell_coord * 2 + src_offset);
+
+        bool found = false;
+
+        if (src_ranges != nullptr)
+        {
+            for (glsl::LoopRange& src_range : *src_ranges)
+            {
+                if (current_coord == glm::ivec2(src_range.start_coord))
+                {
+                    src_range.segment_offset = current_segment_offset;
+
+                    current_segment_offset += src_range.segment_count;
+                    current_coord = glm::ivec2(src_range.end_coord);
+                    found = true;
+
+                    break;
+                }
+            }
+        }
+
+        if (current_coord == end_coord)
+        {
+            break; //End reached
+        }
+
+        if (!found)
+        {
+            spdlog::error("LoopReference: Can't distribute segments of loop range!"); //The shader would not terminate in this case
+
+            break;
+        }
+    }
+}
+
+void LoopReference::emit_loops(uint32_t level)
+{
+    LoopReferenceLevel& loop_level = this->levels[level];
+
+    for (std::vector<LoopReferenceEntry>& entries : this->thread_loops)
+    {
+        for (LoopReferenceEntry& entry : entries)
+        {
+            entry.loop.segment_offset = this->loop_count.segment_counter;
+            loop_level.cell_ranges[entry.cell_index][entry.range_index].segment_offset = entry.loop.segment_offset;
+
+            this->loops.push_back(entry.loop);
+            this->loop_count.loop_counter++;
+            this->loop_count.segment_counter += entry.loop.segment_count;
+        }
+
+        entries.clear();
+    }
+}
+
+template<typename Function>
+void LoopReference::run_parallel(uint32_t count, const Function& function)
+{
+    //Without a scheduler, the first part covers the whole range
+    if (this->scheduler == nullptr)
+    {
+        function(0, 0, count);
+
+        return;
+    }
+
+    uint32_t thread_count = glm::clamp(count, 1u, this->thread_count);
+
+    //Capture the function by reference and the counts by value, so that the lambda fits into the std::function without an allocation
+    this->scheduler->run_parallel(thread_count, [&function, count, thread_count](uint32_t thread)
+    {
+        uint32_t begin = ((uint64_t)count * thread) / thread_count;
+        uint32_t end = ((uint64_t)count * (thread + 1)) / thread_count;
+
+        function(thread, begin, end);
+    });
+}
+
+uint32_t LoopReference::fetch_vector(const glm::ivec2& coord) const
+{
+    if (glm::any(glm::lessThan(coord, glm::ivec2(0))) || glm::any(glm::greaterThanEqual(coord, glm::ivec2(this->vector_resolution))))
+    {
+        return 0;
+    }
+
+    return this->vector_buffer[coord.y * this->vector_resolution.x + coord.x];
+}
+
+uint32_t LoopReference::fetch_closed(const glm::ivec2& coord) const
+{
+    if (glm::any(glm::lessThan(coord, glm::ivec2(0))) || glm::any(glm::greaterThanEqual(coord, glm::ivec2(this->resolution + glm::uvec2(1)))))
+    {
+        return 0;
+    }
+
+    return this->closed_buffer[coord.y * (this->resolution.x + 1) + coord.x];
+}
+
+std::vector<glsl::LoopRange>* LoopReference::fetch_ranges(uint32_t level, const glm::ivec2& cell_coord)
+{
+    LoopReferenceLevel& range_level = this->levels[level];
+
+    if (glm::any(glm::lessThan(cell_coord, glm::ivec2(0))) || glm::any(glm::greaterThanEqual(cell_coord, glm::ivec2(range_level.resolution))))
+    {
+        return nullptr;
+    }
+
+    return &range_level.cell_ranges[cell_coord.y * range_level.resolution.x + cell_coord.x];
+}
+
+const std::vector<glsl::LoopRange>* LoopReference::fetch_ranges(uint32_t level, const glm::ivec2& cell_coord) const
+{
+    const LoopReferenceLevel& range_level = this->levels[level];
+
+    if (glm::any(glm::lessThan(cell_coord, glm::ivec2(0))) || glm::any(glm::greaterThanEqual(cell_coord, glm::ivec2(range_level.resolution))))
+    {
+        return nullptr;
+    }
+
+    return &range_level.cell_ranges[cell_coord.y * range_level.resolution.x + cell_coord.x];
+}
+
+glm::vec3 LoopReference::decode_normal(const glm::vec2& vector)
+{
+    glm::vec2 coord = vector * 2.0f - 1.0f;
+    glm::vec3 normal = glm::vec3(coord.x, coord.y, 1.0f - glm::abs(coord.x) - glm::abs(coord.y));
+
+    if (normal.z < 0.0f)
+    {
+        float normal_x = (1.0f - glm::abs(normal.y)) * ((normal.x >= 0.0f) ? 1.0f : -1.0f);
+        float normal_y = (1.0f - glm::abs(normal.x)) * ((normal.y >= 0.0f) ? 1.0f : -1.0f);
+
+        normal.x = normal_x;
+        normal.y = normal_y;
+    }
+
+    return glm::normalize(normal);
+}
+
+uint32_t LoopReference::encode_direction(const glm::ivec2& direction)
+{
+    glm::ivec2 rotated_direction = glm::ivec2(direction.x + direction.y, direction.y - direction.x);
+    glm::uvec2 unit_direction = glm::uvec2(rotated_direction + 1) / 2u;
+
+    return unit_direction.x | (unit_direction.y << 1);
+}
+
+glm::ivec2 LoopReference::decode_direction(uint32_t encoded_direction)
+{
+    glm::uvec2 unit_direction = glm::uvec2(encoded_direction & 0x01, (encoded_direction >> 1) & 0x01);
+
+    glm::ivec2 rotated_direction = glm::ivec2(unit_direction) * 2 - 1;
+    glm::ivec2 direction = rotated_direction + glm::ivec2(-rotated_direction.y, rotated_direction.x);
+
+    return direction / 2;
+}
\ No newline at end of file
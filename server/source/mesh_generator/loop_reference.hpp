@@ -0,0 +1,124 @@
+#ifndef HEADER_LOOP_REFERENCE
+#define HEADER_LOOP_REFERENCE
+
+#include <glm/gtc/constants.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+#include <span>
+#include <types.hpp>
+
+class Scheduler;
+
+#define LOOP_REFERENCE_THREAD_COUNT 0 // Number of parts into which each pass of the reference implementation is split. If zero, one part for each hardware thread is used.
+
+namespace glsl
+{
+    using namespace glm;
+    typedef uint32_t uint;
+#include "../shaders/shared_defines.glsl"
+}
+
+struct LoopReferenceLevel
+{
+    glm::uvec2 resolution = glm::uvec2(0);
+
+    std::vector<std::vector<glsl::LoopRange>> cell_ranges; // Equivalent to the loop range buffer and the loop range count buffer
+};
+
+struct LoopReferenceEntry // Loop that was closed by a thread and still needs its index and segment offset
+{
+    uint32_t cell_index = 0;
+    uint32_t range_index = 0;
+    glsl::Loop loop;
+};
+
+// CPU implementation of the vector, split, base, combine, distribute, discard and write pass of the loop generator.
+// The result matches the output of the compute shaders except for the order of the loops, which is deterministic here.
+// Can be used as fallback if no compute capable gpu is available and as reference for the output of the shaders.
+class LoopReference
+{
+private:
+    std::vector<LoopReferenceLevel> levels;
+    std::vector<uint8_t> vector_buffer;
+    std::vector<uint8_t> closed_buffer;
+
+    std::vector<glsl::Loop> loops;
+    std::vector<glsl::LoopSegment> loop_segments;
+    glsl::LoopCount loop_count;
+
+    std::vector<std::vector<LoopReferenceEntry>> thread_loops; // Loops that are closed by each thread during the base and combine pass
+
+    glm::uvec2 resolution = glm::uvec2(0);
+    glm::uvec2 vector_resolution = glm::uvec2(0);
+    uint32_t thread_count = 1;
+    Scheduler* scheduler = nullptr; // Only set during the processing
+
+    float depth_max = 0.995f;
+    float depth_base_threshold = 0.005f;
+    float depth_slope_threshold = 0.005f;
+    float normal_threshold = glm::pi<float>() / 4.0f;
+    uint32_t loop_length_min = 100;
+    bool use_normals = true;
+    bool use_object_ids = true;
+
+public:
+    LoopReference() = default;
+
+    bool create(const glm::uvec2& resolution);
+    void destroy();
+    void apply(const shared::MeshSettings& settings);
+
+    // The images are expected to be stored row by row, starting with the row at coordinate zero.
+    // The normals are expected in the encoded form of the normal buffer. Normals and object ids are only accessed if enabled by the settings.
+    // The time measurements of the passes are written to the metadata.
+    // The passes are split into tasks of the given scheduler. If no scheduler is given, the passes run on the calling thread.
+    void process(const float* depth_pointer, const glm::vec2* normal_pointer, const uint32_t* object_id_pointer, shared::LoopViewMetadata& metadata, Scheduler* scheduler);
+
+    // The pointers remain valid until the next call to process
+    const glsl::Loop* get_loop_pointer() const;
+    const glsl::LoopCount* get_loop_count_pointer() const;
+    const glsl::LoopSegment* get_loop_segment_pointer() const;
+    // The vector buffer has twice the resolution of the depth image and contains the encoded vectors after the discard pass
+    const uint8_t* get_vector_pointer() const;
+    const glm::uvec2& get_vector_resolution() const;
+
+    // Returns true if both results contain the same loops independent of the order of the loops and the segment at which each loop starts
+    static bool compare(std::span<const glsl::Loop> reference_loops, std::span<const glsl::LoopSegment> reference_segments, std::span<const glsl::Loop> loops, std::span<const glsl::LoopSegment> segments);
+    static glm::ivec2 decode_direction(uint32_t encoded_direction);
+
+private:
+    void perform_vector_pass(const float* depth_pointer, const glm::vec2* normal_pointer, const uint32_t* object_id_pointer);
+    void perform_split_pass();
+    void perform_base_pass();
+    void perform_combine_pass();
+    void perform_distribute_pass();
+    void perform_discard_pass();
+    void perform_write_pass(const float* depth_pointer);
+
+    void load_sample(const glm::ivec2& coord, const float* depth_pointer, const glm::vec2* normal_pointer, const uint32_t* object_id_pointer, float& depth, glm::vec3& normal, uint32_t& object_id) const;
+    uint32_t compare_samples(float depth1, const glm::vec3& normal1, uint32_t object_id1, float depth2, const glm::vec3& normal2, uint32_t object_id2) const;
+
+    bool trace_backwards(const glm::ivec2& cell_coord, const glm::ivec2& global_coord, uint64_t& flag_buffer, glm::ivec2& previous_coord, glm::ivec2& start_coord, const glm::ivec2& start_direction, uint32_t& segment_count, uint32_t& segment_length, uint32_t& vector_bitfield) const;
+    void trace_forward(const glm::ivec2& cell_coord, uint64_t& flag_buffer, glm::ivec2& end_coord, const glm::ivec2& start_direction, uint32_t& segment_count, uint32_t& segment_length, uint32_t& vector_bitfield) const;
+    void trace_line(uint32_t src_level, const glm::ivec2& cell_coord, const glm::ivec2& cell_min, const glm::ivec2& cell_size, glm::ivec2& end_coord, uint32_t& segment_count, uint32_t& segment_length, uint32_t& segment_bitfield);
+    bool trace_loop(uint32_t src_level, const glm::ivec2& cell_coord, const glm::ivec2& cell_min, const glm::ivec2& cell_size, const glm::ivec2& quadrant_offset, uint32_t quadrant_index, const glm::ivec2& start_coord, glm::ivec2& end_coord, uint32_t& segment_count, uint32_t& segment_length, uint32_t& segment_bitfield) const;
+    void distribute(uint32_t src_level, const glm::ivec2& cell_coord, const glm::ivec2& start_coord, const glm::ivec2& end_coord, uint32_t segment_offset);
+
+    // Assigns the loop indices and segment offsets in the order of the threads, so that the result does not depend on the scheduling
+    void emit_loops(uint32_t level);
+
+    // Splits the range [0, count) into one continuous part for each thread and calls function(thread, begin, end) for each part as a task of the scheduler
+    template<typename Function>
+    void run_parallel(uint32_t count, const Function& function);
+
+    // Out of bounds accesses return zero like image loads on the gpu
+    uint32_t fetch_vector(const glm::ivec2& coord) const;
+    uint32_t fetch_closed(const glm::ivec2& coord) const;
+    std::vector<glsl::LoopRange>* fetch_ranges(uint32_t level, const glm::ivec2& cell_coord);
+    const std::vector<glsl::LoopRange>* fetch_ranges(uint32_t level, const glm::ivec2& cell_coord) const;
+
+    static glm::vec3 decode_normal(const glm::vec2& vector);
+    static uint32_t encode_direction(const glm::ivec2& direction);
+};
+
+#endif
\ No newline at end of file
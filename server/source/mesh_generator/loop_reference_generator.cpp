@@ -0,0 +1,263 @@
+#include "loop_reference_generator.hpp"
+#include <spdlog/spdlog.h>
+#include <chrono>
+
+bool LoopReferenceGeneratorFrame::triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines, const CancelToken* cancel_token, Scheduler* scheduler)
+{
+    metadata.loop.time_cpu = 0.0f;
+    metadata.loop.time_loop_simplification = 0.0f;
+    metadata.loop.time_triangulation = 0.0f;
+    metadata.loop.time_loop_info = 0.0f;
+    metadata.loop.time_loop_sort = 0.0f;
+    metadata.loop.time_sweep_line = 0.0f;
+    metadata.loop.time_adjacent_two = 0.0f;
+    metadata.loop.time_adjacent_one = 0.0f;
+    metadata.loop.time_interval_search = 0.0f;
+    metadata.loop.time_interval_update = 0.0f;
+    metadata.loop.time_inside_outside = 0.0f;
+    metadata.loop.time_contour_split = 0.0f;
+    metadata.loop.time_contour = 0.0f;
+    metadata.loop.loop_count = 0;
+    metadata.loop.segment_count = 0;
+    metadata.loop.point_count = 0;
+
+    //The time of the passes is reported in place of the gpu time, while the time of the triangulation is reported as cpu time like for the loop generator
+    this->reference.process(this->depth_copy_pointer, this->normal_copy_pointer, this->object_id_copy_pointer, metadata.loop, scheduler);
+
+    std::chrono::high_resolution_clock::time_point cpu_start = std::chrono::high_resolution_clock::now();
+    bool complete = this->triangulation.process(this->resolution, this->triangle_scale, this->reference.get_loop_pointer(), this->reference.get_loop_count_pointer(), this->reference.get_loop_segment_pointer(), vertices, indices, metadata, feature_lines, export_feature_lines, this->sweep_line_profile, cancel_token);
+    std::chrono::high_resolution_clock::time_point cpu_end = std::chrono::high_resolution_clock::now();
+    metadata.loop.time_cpu = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(cpu_end - cpu_start).count();
+
+    return complete;
+}
+
+GLuint LoopReferenceGeneratorFrame::get_depth_buffer() const
+{
+    return this->depth_buffer;
+}
+
+GLuint LoopReferenceGeneratorFrame::get_normal_buffer() const
+{
+    return this->normal_buffer;
+}
+
+GLuint LoopReferenceGeneratorFrame::get_object_id_buffer() const
+{
+    return this->object_id_buffer;
+}
+
+bool LoopReferenceGenerator::create(const glm::uvec2& resolution)
+{
+    this->resolution = resolution;
+
+    return true;
+}
+
+void LoopReferenceGenerator::destroy()
+{
+    this->resolution = glm::uvec2(0);
+}
+
+void LoopReferenceGenerator::apply(const shared::MeshSettings& settings)
+{
+    this->settings = settings;
+}
+
+MeshGeneratorFrame* LoopReferenceGenerator::create_frame()
+{
+    LoopReference reference;
+
+    if (!reference.create(this->resolution))
+    {
+        return nullptr;
+    }
+
+    GLuint depth_buffer = 0;
+
+    glGenTextures(1, &depth_buffer);
+    glBindTexture(GL_TEXTURE_2D, depth_buffer);
+
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32, this->resolution.x, this->resolution.y);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLuint normal_buffer = 0;
+
+    glGenTextures(1, &normal_buffer);
+    glBindTexture(GL_TEXTURE_2D, normal_buffer);
+
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG8, this->resolution.x, this->resolution.y);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLuint object_id_buffer = 0;
+
+    glGenTextures(1, &object_id_buffer);
+    glBindTexture(GL_TEXTURE_2D, object_id_buffer);
+
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, this->resolution.x, this->resolution.y);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    //The normals are read back as floats, which is exact for the normalized values of the normal buffer and avoids padding between the rows
+    uint32_t depth_copy_buffer_size = this->resolution.x * this->resolution.y * sizeof(float);
+    uint32_t normal_copy_buffer_size = this->resolution.x * this->resolution.y * sizeof(glm::vec2);
+    uint32_t object_id_copy_buffer_size = this->resolution.x * this->resolution.y * sizeof(uint32_t);
+
+    GLuint depth_copy_buffer = 0;
+    GLuint normal_copy_buffer = 0;
+    GLuint object_id_copy_buffer = 0;
+
+    glGenBuffers(1, &depth_copy_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, depth_copy_buffer);
+
+    glBufferStorage(GL_PIXEL_PACK_BUFFER, depth_copy_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    const float* depth_copy_pointer = (const float*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, depth_copy_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+    glGenBuffers(1, &normal_copy_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, normal_copy_buffer);
+
+    glBufferStorage(GL_PIXEL_PACK_BUFFER, normal_copy_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    const glm::vec2* normal_copy_pointer = (const glm::vec2*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, normal_copy_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+    glGenBuffers(1, &object_id_copy_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, object_id_copy_buffer);
+
+    glBufferStorage(GL_PIXEL_PACK_BUFFER, object_id_copy_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    const uint32_t* object_id_copy_pointer = (const uint32_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, object_id_copy_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (depth_copy_pointer == nullptr || normal_copy_pointer == nullptr || object_id_copy_pointer == nullptr)
+    {
+        spdlog::error("LoopReferenceGenerator: Can't map copy buffers!");
+
+        return nullptr;
+    }
+
+    LoopReferenceGeneratorFrame* reference_frame = new LoopReferenceGeneratorFrame;
+    reference_frame->reference = std::move(reference);
+    reference_frame->resolution = this->resolution;
+    reference_frame->depth_buffer = depth_buffer;
+    reference_frame->normal_buffer = normal_buffer;
+    reference_frame->object_id_buffer = object_id_buffer;
+    reference_frame->depth_copy_buffer = depth_copy_buffer;
+    reference_frame->normal_copy_buffer = normal_copy_buffer;
+    reference_frame->object_id_copy_buffer = object_id_copy_buffer;
+    reference_frame->depth_copy_pointer = depth_copy_pointer;
+    reference_frame->normal_copy_pointer = normal_copy_pointer;
+    reference_frame->object_id_copy_pointer = object_id_copy_pointer;
+
+    return reference_frame;
+}
+
+void LoopReferenceGenerator::destroy_frame(MeshGeneratorFrame* frame)
+{
+    LoopReferenceGeneratorFrame* reference_frame = (LoopReferenceGeneratorFrame*)frame;
+
+    glDeleteTextures(1, &reference_frame->depth_buffer);
+    glDeleteTextures(1, &reference_frame->normal_buffer);
+    glDeleteTextures(1, &reference_frame->object_id_buffer);
+    glDeleteBuffers(1, &reference_frame->depth_copy_buffer);
+    glDeleteBuffers(1, &reference_frame->normal_copy_buffer);
+    glDeleteBuffers(1, &reference_frame->object_id_copy_buffer);
+
+    reference_frame->depth_buffer = 0;
+    reference_frame->normal_buffer = 0;
+    reference_frame->object_id_buffer = 0;
+    reference_frame->depth_copy_buffer = 0;
+    reference_frame->normal_copy_buffer = 0;
+    reference_frame->object_id_copy_buffer = 0;
+    reference_frame->depth_copy_pointer = nullptr;
+    reference_frame->normal_copy_pointer = nullptr;
+    reference_frame->object_id_copy_pointer = nullptr;
+
+    glDeleteSync(reference_frame->fence);
+
+    reference_frame->fence = 0;
+    reference_frame->reference.destroy();
+
+    delete reference_frame;
+}
+
+bool LoopReferenceGenerator::submit_frame(MeshGeneratorFrame* frame)
+{
+    LoopReferenceGeneratorFrame* reference_frame = (LoopReferenceGeneratorFrame*)frame;
+    reference_frame->reference.apply(this->settings);
+    reference_frame->triangle_scale = this->settings.loop.triangle_scale;
+    reference_frame->sweep_line_profile = this->settings.loop.use_sweep_line_profile;
+
+    glBindTexture(GL_TEXTURE_2D, reference_frame->depth_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, reference_frame->depth_copy_buffer);
+
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+
+    //Normals and object ids are only accessed by the reference if they are enabled
+    if (this->settings.loop.use_normals)
+    {
+        glBindTexture(GL_TEXTURE_2D, reference_frame->normal_buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, reference_frame->normal_copy_buffer);
+
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_FLOAT, nullptr);
+    }
+
+    if (this->settings.loop.use_object_ids)
+    {
+        glBindTexture(GL_TEXTURE_2D, reference_frame->object_id_buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, reference_frame->object_id_copy_buffer);
+
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+
+    reference_frame->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    return true;
+}
+
+bool LoopReferenceGenerator::map_frame(MeshGeneratorFrame* frame)
+{
+    LoopReferenceGeneratorFrame* reference_frame = (LoopReferenceGeneratorFrame*)frame;
+
+    if (reference_frame->fence == 0)
+    {
+        return false;
+    }
+
+    GLenum result = glClientWaitSync(reference_frame->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+    {
+        return false;
+    }
+
+    glDeleteSync(reference_frame->fence);
+    reference_frame->fence = 0;
+
+    return true;
+}
+
+bool LoopReferenceGenerator::unmap_frame(MeshGeneratorFrame* frame)
+{
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef HEADER_LOOP_REFERENCE_GENERATOR
+#define HEADER_LOOP_REFERENCE_GENERATOR
+
+#include "mesh_generator.hpp"
+#include "loop_reference.hpp"
+#include "loop_triangulation.hpp"
+
+// Loop based mesh generator that only uses the gpu to read back the depth, normal and object id buffer.
+// All passes of the loop generator are performed on the cpu by the reference implementation before the loops are triangulated.
+class LoopReferenceGeneratorFrame : public MeshGeneratorFrame
+{
+public:
+    LoopReference reference;
+    LoopTriangulation triangulation;
+    glm::uvec2 resolution = glm::uvec2(0);
+    float triangle_scale = 0.0f;
+    bool sweep_line_profile = false;
+
+    GLuint depth_buffer = 0;
+    GLuint normal_buffer = 0;
+    GLuint object_id_buffer = 0;
+
+    GLuint depth_copy_buffer = 0;
+    GLuint normal_copy_buffer = 0;
+    GLuint object_id_copy_buffer = 0;
+    const float* depth_copy_pointer = nullptr;
+    const glm::vec2* normal_copy_pointer = nullptr;
+    const uint32_t* object_id_copy_pointer = nullptr;
+
+    GLsync fence = 0;
+
+public:
+    LoopReferenceGeneratorFrame() = default;
+
+    bool triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines, const CancelToken* cancel_token, Scheduler* scheduler);
+
+    GLuint get_depth_buffer() const;
+    GLuint get_normal_buffer() const;
+    GLuint get_object_id_buffer() const;
+};
+
+class LoopReferenceGenerator : public MeshGenerator
+{
+private:
+    glm::uvec2 resolution = glm::uvec2(0);
+    shared::MeshSettings settings = shared::MeshSettings(shared::MESH_GENERATOR_TYPE_LOOP);
+
+public:
+    LoopReferenceGenerator() = default;
+
+    bool create(const glm::uvec2& resolution);
+    void destroy();
+    void apply(const shared::MeshSettings& settings);
+
+    MeshGeneratorFrame* create_frame();
+    void destroy_frame(MeshGeneratorFrame* frame);
+    bool submit_frame(MeshGeneratorFrame* frame);
+    bool map_frame(MeshGeneratorFrame* frame);
+    bool unmap_frame(MeshGeneratorFrame* frame);
+};
+
+#endif
\ No newline at end of file
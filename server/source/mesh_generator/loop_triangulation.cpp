@@ -5,6 +5,37 @@
 #include <algorithm>
 #include <chrono>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+void SweepLineProfile::reset(bool enabled)
+{
+    this->phase_counters.fill(0);
+    this->enabled = enabled;
+}
+
+double SweepLineProfile::get_time(SweepLinePhase phase, double counter_frequency) const
+{
+    if (counter_frequency <= 0.0)
+    {
+        return 0.0;
+    }
+
+    return (double)this->phase_counters[phase] / counter_frequency;
+}
+
+uint64_t SweepLineProfile::read_counter()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
 inline void Contour::push_left(const LoopPoint& point)
 {
     ContourPoint& contour_point = this->left_points.emplace_back();
@@ -45,7 +76,7 @@ LoopTriangulation::~LoopTriangulation()
     this->contour_cache.clear();
 }
 
-void LoopTriangulation::process(const glm::uvec2& resolution, float triangle_scale, const glsl::Loop* loop_pointer, const glsl::LoopCount* loop_count_pointer, const glsl::LoopSegment* loop_segment_pointer, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines, bool export_feature_lines)
+bool LoopTriangulation::process(const glm::uvec2& resolution, float triangle_scale, const glsl::Loop* loop_pointer, const glsl::LoopCount* loop_count_pointer, const glsl::LoopSegment* loop_segment_pointer, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines, bool export_feature_lines, bool sweep_line_profile, const CancelToken* cancel_token)
 {
     this->clear_state();
         
@@ -59,7 +90,7 @@ void LoopTriangulation::process(const glm::uvec2& resolution, float triangle_sca
 
         spdlog::error("LoopTriangulation: Loop count exceeds buffer limit!");
 
-        return;
+        return false;
     }
 
     if (segment_count > LOOP_GENERATOR_MAX_LOOP_SEGMENT_COUNT)
@@ -69,7 +100,7 @@ void LoopTriangulation::process(const glm::uvec2& resolution, float triangle_sca
 
         spdlog::error("LoopTriangulation: Loop segement count exceeds buffer limit!");
 
-        return;
+        return false;
     }
 
     double time_loop_simplification = 0.0;
@@ -77,6 +108,14 @@ void LoopTriangulation::process(const glm::uvec2& resolution, float triangle_sca
 
     for (uint32_t loop_index = 0; loop_index < loop_count; loop_index++)
     {
+        if (CancelToken::check(cancel_token))
+        {
+            vertices.clear();
+            indices.clear();
+
+            return false;
+        }
+
         const glsl::Loop* loop = loop_pointer + loop_index;
         const glsl::LoopSegment* segment_pointer = loop_segment_pointer + loop->segment_offset;
         uint32_t segment_count = loop->segment_count;
@@ -113,13 +152,23 @@ void LoopTriangulation::process(const glm::uvec2& resolution, float triangle_sca
     metadata.loop.time_loop_simplification = time_loop_simplification;
 
     std::chrono::high_resolution_clock::time_point triangulation_start = std::chrono::high_resolution_clock::now();
-    this->compute_triangulation(resolution, triangle_scale, loop_pointer, loop_segment_pointer, vertices, indices, metadata, features_lines);
+    bool complete = this->compute_triangulation(resolution, triangle_scale, loop_pointer, loop_segment_pointer, vertices, indices, metadata, features_lines, sweep_line_profile, cancel_token);
     std::chrono::high_resolution_clock::time_point triangulation_end = std::chrono::high_resolution_clock::now();
     metadata.loop.time_triangulation = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(triangulation_end - triangulation_start).count();
 
+    if (!complete)
+    {
+        vertices.clear();
+        indices.clear();
+
+        return false;
+    }
+
     metadata.loop.loop_count = loop_count;
     metadata.loop.segment_count = segment_count;
     metadata.loop.point_count = point_count;
+
+    return true;
 }
 
 bool skip_invalid_segments(const glsl::LoopSegment* segment_pointer, uint32_t segment_count, uint32_t start_offset, uint32_t& index)
@@ -390,7 +439,7 @@ void LoopTriangulation::compute_segment(const glm::ivec2& last_coord, const glm:
     segment_length = glm::max(glm::abs(direction.x), glm::abs(direction.y));
 }
 
-void LoopTriangulation::compute_triangulation(const glm::uvec2& resolution, float triangle_scale, const glsl::Loop* loop_pointer, const glsl::LoopSegment* loop_segment_pointer, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines)
+bool LoopTriangulation::compute_triangulation(const glm::uvec2& resolution, float triangle_scale, const glsl::Loop* loop_pointer, const glsl::LoopSegment* loop_segment_pointer, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines, bool sweep_line_profile, const CancelToken* cancel_token)
 {
     //Related to "CMSC 754: Lecture 5 Polygon Triangulation" by "Dave Mount"
 
@@ -432,77 +481,66 @@ void LoopTriangulation::compute_triangulation(const glm::uvec2& resolution, floa
     std::chrono::high_resolution_clock::time_point loop_sort_end = std::chrono::high_resolution_clock::now();
     metadata.loop.time_loop_sort = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(loop_sort_end - loop_sort_start).count();
 
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-    double time_adjacent_two = 0.0;
-    double time_adjacent_one = 0.0;
-    double time_inside_outside = 0.0;
-    double time_interval_search = 0.0;
-    double time_interval_update = 0.0;
-#endif
+    this->sweep_line_profile.reset(sweep_line_profile);
 
+    uint64_t sweep_line_counter_start = SweepLineProfile::read_counter();
     std::chrono::high_resolution_clock::time_point sweep_line_start = std::chrono::high_resolution_clock::now();
-    for(const LoopPointHandle& point_handle : this->loop_point_handles)
+    for (uint32_t handle_index = 0; handle_index < this->loop_point_handles.size(); handle_index++)
     {
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-        std::chrono::high_resolution_clock::time_point interval_search_start = std::chrono::high_resolution_clock::now();
-#endif
+        //Also check the token in between the points, since the sweep line is the most expensive part of the triangulation
+        if (handle_index % LOOP_TRIANGULATION_CANCEL_INTERVAL == 0 && CancelToken::check(cancel_token))
+        {
+            return false;
+        }
+
+        const LoopPointHandle& point_handle = this->loop_point_handles[handle_index];
         AdjacentIntervals adjacent_intervals;
-        this->check_intervals(point_handle, adjacent_intervals);
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-        std::chrono::high_resolution_clock::time_point interval_search_end = std::chrono::high_resolution_clock::now();
-        time_interval_search += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(interval_search_end - interval_search_start).count();
-#endif
+
+        {
+            SweepLineScope interval_search_scope(this->sweep_line_profile, SWEEP_LINE_PHASE_INTERVAL_SEARCH);
+            this->check_intervals(point_handle, adjacent_intervals);
+        }
 
         const LoopPoint& point = this->loop_points[point_handle.loop_index][point_handle.point_index];
             
         if (point.is_edge)
         {
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point adjacent_two_start = std::chrono::high_resolution_clock::now();
-#endif
-            if (adjacent_intervals.middle_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
             {
-                this->process_adjacent_one_interval_middle(point_handle, point, adjacent_intervals.middle_index);
-                this->process_adjacent_two_intervals(point_handle, point, adjacent_intervals.left_index, adjacent_intervals.right_index);
+                SweepLineScope adjacent_two_scope(this->sweep_line_profile, SWEEP_LINE_PHASE_ADJACENT_TWO);
 
-                this->remove_intervals(adjacent_intervals);
+                if (adjacent_intervals.middle_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
+                {
+                    this->process_adjacent_one_interval_middle(point_handle, point, adjacent_intervals.middle_index);
+                    this->process_adjacent_two_intervals(point_handle, point, adjacent_intervals.left_index, adjacent_intervals.right_index);
 
-                continue;
+                    this->remove_intervals(adjacent_intervals);
+
+                    continue;
+                }
             }
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point adjacent_two_end = std::chrono::high_resolution_clock::now();
-            time_adjacent_two += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(adjacent_two_end - adjacent_two_start).count();
-#endif
 
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point adjacent_one_start = std::chrono::high_resolution_clock::now();
-#endif
-            if (adjacent_intervals.left_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
             {
-                this->process_adjacent_one_interval_left(point_handle, point, adjacent_intervals.left_index);
-                this->process_adjacent_one_interval_right(point_handle, point, adjacent_intervals.right_index);
+                SweepLineScope adjacent_one_scope(this->sweep_line_profile, SWEEP_LINE_PHASE_ADJACENT_ONE);
 
-                continue;
+                if (adjacent_intervals.left_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
+                {
+                    this->process_adjacent_one_interval_left(point_handle, point, adjacent_intervals.left_index);
+                    this->process_adjacent_one_interval_right(point_handle, point, adjacent_intervals.right_index);
+
+                    continue;
+                }
             }
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point adjacent_one_end = std::chrono::high_resolution_clock::now();
-            time_adjacent_one += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(adjacent_one_end - adjacent_one_start).count();
-#endif
 
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point interval_update_start = std::chrono::high_resolution_clock::now();
-#endif
             uint32_t interval_index = 0;
 
-            if (!this->check_inside(point, loop_pointer, loop_segment_pointer, interval_index))
             {
-                spdlog::error("LoopTriangulation: Error during triangulation");
-            }
+                SweepLineScope interval_update_scope(this->sweep_line_profile, SWEEP_LINE_PHASE_INTERVAL_UPDATE);
 
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point interval_update_end = std::chrono::high_resolution_clock::now();
-            time_interval_update += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(interval_update_end - interval_update_start).count();
-#endif
+                if (!this->check_inside(point, loop_pointer, loop_segment_pointer, interval_index))
+                {
+                    spdlog::error("LoopTriangulation: Error during triangulation");
+                }
+            }
 
             LoopWinding local_winding = this->check_winding_local(point_handle, point, loop_pointer, loop_segment_pointer);
             bool winding_reverse = false;
@@ -512,115 +550,89 @@ void LoopTriangulation::compute_triangulation(const glm::uvec2& resolution, floa
                 winding_reverse = true;
             }
 
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point inside_outside_start = std::chrono::high_resolution_clock::now();
-#endif
+            SweepLineScope inside_outside_scope(this->sweep_line_profile, SWEEP_LINE_PHASE_INSIDE_OUTSIDE);
             this->process_inside_interval(point_handle, point, interval_index, !winding_reverse);
             this->process_outside_interval(point_handle, point, winding_reverse);
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point inside_outside_end = std::chrono::high_resolution_clock::now();
-            time_inside_outside += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(inside_outside_end - inside_outside_start).count();
-#endif
         }
 
         else
         {
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point adjacent_two_start = std::chrono::high_resolution_clock::now();
-#endif
-            if (adjacent_intervals.middle_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
             {
-                this->process_adjacent_one_interval_middle(point_handle, point, adjacent_intervals.middle_index);
+                SweepLineScope adjacent_two_scope(this->sweep_line_profile, SWEEP_LINE_PHASE_ADJACENT_TWO);
 
-                this->remove_intervals(adjacent_intervals);
+                if (adjacent_intervals.middle_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
+                {
+                    this->process_adjacent_one_interval_middle(point_handle, point, adjacent_intervals.middle_index);
 
-                continue;
-            }
+                    this->remove_intervals(adjacent_intervals);
 
-            if (adjacent_intervals.left_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX && adjacent_intervals.right_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
-            {
-                this->process_adjacent_two_intervals(point_handle, point, adjacent_intervals.left_index, adjacent_intervals.right_index);
+                    continue;
+                }
+
+                if (adjacent_intervals.left_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX && adjacent_intervals.right_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
+                {
+                    this->process_adjacent_two_intervals(point_handle, point, adjacent_intervals.left_index, adjacent_intervals.right_index);
 
-                this->remove_intervals(adjacent_intervals);
+                    this->remove_intervals(adjacent_intervals);
 
-                continue;
+                    continue;
+                }
             }
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point adjacent_two_end = std::chrono::high_resolution_clock::now();
-            time_adjacent_two += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(adjacent_two_end - adjacent_two_start).count();
-#endif
 
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point adjacent_one_start = std::chrono::high_resolution_clock::now();
-#endif
-            if (adjacent_intervals.left_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
             {
-                this->process_adjacent_one_interval_left(point_handle, point, adjacent_intervals.left_index);
+                SweepLineScope adjacent_one_scope(this->sweep_line_profile, SWEEP_LINE_PHASE_ADJACENT_ONE);
 
-                continue;
-            }
+                if (adjacent_intervals.left_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
+                {
+                    this->process_adjacent_one_interval_left(point_handle, point, adjacent_intervals.left_index);
 
-            if (adjacent_intervals.right_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
-            {
-                this->process_adjacent_one_interval_right(point_handle, point, adjacent_intervals.right_index);
+                    continue;
+                }
 
-                continue;
+                if (adjacent_intervals.right_index != LOOP_GENERATOR_INVALID_INTERVAL_INDEX)
+                {
+                    this->process_adjacent_one_interval_right(point_handle, point, adjacent_intervals.right_index);
+
+                    continue;
+                }
             }
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            std::chrono::high_resolution_clock::time_point adjacent_one_end = std::chrono::high_resolution_clock::now();
-            time_adjacent_one += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(adjacent_one_end - adjacent_one_start).count();
 
-            std::chrono::high_resolution_clock::time_point interval_update_start = std::chrono::high_resolution_clock::now();
-            std::chrono::high_resolution_clock::time_point interval_update_end;
-#endif
             uint32_t interval_index = 0;
+            bool inside = false;
 
-            if (this->check_inside(point, loop_pointer, loop_segment_pointer, interval_index))
             {
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-                interval_update_end = std::chrono::high_resolution_clock::now();
+                SweepLineScope interval_update_scope(this->sweep_line_profile, SWEEP_LINE_PHASE_INTERVAL_UPDATE);
+                inside = this->check_inside(point, loop_pointer, loop_segment_pointer, interval_index);
+            }
 
-                std::chrono::high_resolution_clock::time_point inside_outside_start = std::chrono::high_resolution_clock::now();
-#endif
-                this->process_inside_interval(point_handle, point, interval_index, false);
+            SweepLineScope inside_outside_scope(this->sweep_line_profile, SWEEP_LINE_PHASE_INSIDE_OUTSIDE);
 
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-                std::chrono::high_resolution_clock::time_point inside_outside_end = std::chrono::high_resolution_clock::now();
-                time_inside_outside += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(inside_outside_end - inside_outside_start).count();
-#endif
+            if (inside)
+            {
+                this->process_inside_interval(point_handle, point, interval_index, false);
             }
 
             else
             {
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-                interval_update_end = std::chrono::high_resolution_clock::now();
-
-                std::chrono::high_resolution_clock::time_point inside_outside_start = std::chrono::high_resolution_clock::now();
-#endif
-
                 this->process_outside_interval(point_handle, point, false);
-
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-                std::chrono::high_resolution_clock::time_point inside_outside_end = std::chrono::high_resolution_clock::now();
-                time_inside_outside += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(inside_outside_end - inside_outside_start).count();
-#endif
             }
-
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-            time_interval_update += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(interval_update_end - interval_update_start).count();
-#endif
         }
     }
     std::chrono::high_resolution_clock::time_point sweep_line_end = std::chrono::high_resolution_clock::now();
+    uint64_t sweep_line_counter_end = SweepLineProfile::read_counter();
     metadata.loop.time_sweep_line = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(sweep_line_end - sweep_line_start).count();
 
-#if LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE
-    metadata.loop.time_adjacent_two = time_adjacent_two;
-    metadata.loop.time_adjacent_one = time_adjacent_one;
-    metadata.loop.time_interval_search = time_interval_search;
-    metadata.loop.time_interval_update = time_interval_update;
-    metadata.loop.time_inside_outside = time_inside_outside;
-#endif
+    if (this->sweep_line_profile.is_enabled() && metadata.loop.time_sweep_line > 0.0f)
+    {
+        //Calibrate the counter against the wall clock time of the entire sweep instead of relying on a fixed counter frequency
+        double counter_frequency = (double)(sweep_line_counter_end - sweep_line_counter_start) / metadata.loop.time_sweep_line;
+
+        metadata.loop.time_adjacent_two = this->sweep_line_profile.get_time(SWEEP_LINE_PHASE_ADJACENT_TWO, counter_frequency);
+        metadata.loop.time_adjacent_one = this->sweep_line_profile.get_time(SWEEP_LINE_PHASE_ADJACENT_ONE, counter_frequency);
+        metadata.loop.time_interval_search = this->sweep_line_profile.get_time(SWEEP_LINE_PHASE_INTERVAL_SEARCH, counter_frequency);
+        metadata.loop.time_interval_update = this->sweep_line_profile.get_time(SWEEP_LINE_PHASE_INTERVAL_UPDATE, counter_frequency);
+        metadata.loop.time_inside_outside = this->sweep_line_profile.get_time(SWEEP_LINE_PHASE_INSIDE_OUTSIDE, counter_frequency);
+    }
 
     indices.clear();
     vertices.clear();
@@ -697,6 +709,11 @@ void LoopTriangulation::compute_triangulation(const glm::uvec2& resolution, floa
         }
     }
 
+    if (CancelToken::check(cancel_token))
+    {
+        return false;
+    }
+
     std::chrono::high_resolution_clock::time_point contour_split_start = std::chrono::high_resolution_clock::now();
     this->split_contours();
     std::chrono::high_resolution_clock::time_point contour_split_end = std::chrono::high_resolution_clock::now();
@@ -705,10 +722,17 @@ void LoopTriangulation::compute_triangulation(const glm::uvec2& resolution, floa
     std::chrono::high_resolution_clock::time_point contour_start = std::chrono::high_resolution_clock::now();
     for (Contour* contour : this->contours)
     {
+        if (CancelToken::check(cancel_token))
+        {
+            return false;
+        }
+
         this->triangulate_contour(contour, indices);
     }
     std::chrono::high_resolution_clock::time_point contour_end = std::chrono::high_resolution_clock::now();
     metadata.loop.time_contour = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(contour_end - contour_start).count();
+
+    return true;
 }
 
 bool LoopTriangulation::check_inside(const LoopPoint& point, const glsl::Loop* loop_pointer, const glsl::LoopSegment* loop_segment_pointer, uint32_t& inside_index)
@@ -8,8 +8,8 @@
 
 #include "mesh_generator.hpp"
 
-#define LOOP_GENERATOR_ENABLE_SWEEP_LINE_PROFILE 0
 #define LOOP_GENERATOR_INVALID_INTERVAL_INDEX    0xFFFFFFFF
+#define LOOP_TRIANGULATION_CANCEL_INTERVAL       1024 // Number of points of the sweep line after which the cancel token is checked again
 
 namespace glsl
 {
@@ -105,6 +105,66 @@ struct AdjacentIntervals
     uint32_t middle_index = LOOP_GENERATOR_INVALID_INTERVAL_INDEX;
 };
 
+enum SweepLinePhase
+{
+    SWEEP_LINE_PHASE_INTERVAL_SEARCH,
+    SWEEP_LINE_PHASE_ADJACENT_TWO,
+    SWEEP_LINE_PHASE_ADJACENT_ONE,
+    SWEEP_LINE_PHASE_INTERVAL_UPDATE,
+    SWEEP_LINE_PHASE_INSIDE_OUTSIDE,
+    SWEEP_LINE_PHASE_COUNT
+};
+
+class SweepLineProfile
+{
+private:
+    std::array<uint64_t, SWEEP_LINE_PHASE_COUNT> phase_counters = {};
+    bool enabled = false;
+
+public:
+    SweepLineProfile() = default;
+
+    void reset(bool enabled);
+    double get_time(SweepLinePhase phase, double counter_frequency) const; //Counter frequency in ticks per millisecond
+
+    inline void add(SweepLinePhase phase, uint64_t counter)
+    {
+        this->phase_counters[phase] += counter;
+    }
+
+    inline bool is_enabled() const
+    {
+        return this->enabled;
+    }
+
+    static uint64_t read_counter(); //Time stamp counter if available
+};
+
+class SweepLineScope //Accumulates the counter ticks between construction and destruction if profiling is enabled
+{
+private:
+    SweepLineProfile& profile;
+    SweepLinePhase phase;
+    uint64_t counter_start = 0;
+
+public:
+    inline SweepLineScope(SweepLineProfile& profile, SweepLinePhase phase) : profile(profile), phase(phase)
+    {
+        if (this->profile.is_enabled())
+        {
+            this->counter_start = SweepLineProfile::read_counter();
+        }
+    }
+
+    inline ~SweepLineScope()
+    {
+        if (this->profile.is_enabled())
+        {
+            this->profile.add(this->phase, SweepLineProfile::read_counter() - this->counter_start);
+        }
+    }
+};
+
 class LoopTriangulation
 {
 private:
@@ -120,17 +180,20 @@ private:
 
     uint32_t vertex_counter = 0;
 
+    SweepLineProfile sweep_line_profile;
+
 public:
     LoopTriangulation() = default;
     ~LoopTriangulation();
 
-    void process(const glm::uvec2& resolution, float triangle_scale, const glsl::Loop* loop_pointer, const glsl::LoopCount* loop_count_pointer, const glsl::LoopSegment* loop_segment_pointer, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines, bool export_feature_lines);
+    // Returns false if the triangulation failed or was cancelled, in which case the mesh is empty
+    bool process(const glm::uvec2& resolution, float triangle_scale, const glsl::Loop* loop_pointer, const glsl::LoopCount* loop_count_pointer, const glsl::LoopSegment* loop_segment_pointer, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines, bool export_feature_lines, bool sweep_line_profile, const CancelToken* cancel_token);
 
 private:
     void compute_loop_points(uint32_t segment_count, const glsl::LoopSegment* segment_pointer, bool is_edge, std::vector<LoopPoint>& points);
     static void compute_segment(const glm::ivec2& last_coord, const glm::ivec2& current_coord, glm::ivec2& segment_direction, uint32_t& segment_length);
 
-    void compute_triangulation(const glm::uvec2& resolution, float triangle_scale, const glsl::Loop* loop_pointer, const glsl::LoopSegment* loop_segment_pointer, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines);
+    bool compute_triangulation(const glm::uvec2& resolution, float triangle_scale, const glsl::Loop* loop_pointer, const glsl::LoopSegment* loop_segment_pointer, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& features_lines, bool sweep_line_profile, const CancelToken* cancel_token);
     bool check_inside(const LoopPoint& point, const glsl::Loop* loop_pointer, const glsl::LoopSegment* loop_segment_pointer, uint32_t& inside_index);
     LoopWinding check_winding_local(const LoopPointHandle& point_handle, const LoopPoint& point, const glsl::Loop* loop_pointer, const glsl::LoopSegment* loop_segment_pointer);
 
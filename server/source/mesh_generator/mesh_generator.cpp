@@ -1,7 +1,14 @@
 #include "mesh_generator.hpp"
 #include "quad_generator.hpp"
+#include "quad_reference_generator.hpp"
 #include "line_generator.hpp"
 #include "loop_generator.hpp"
+#include "loop_reference_generator.hpp"
+
+bool MeshGeneratorFrame::map_mesh(std::span<const shared::Vertex>& vertices, std::span<const shared::Index>& indices, shared::ViewMetadata& metadata)
+{
+	return false;
+}
 
 MeshGenerator* make_mesh_generator(MeshGeneratorType type)
 {
@@ -13,6 +20,10 @@ MeshGenerator* make_mesh_generator(MeshGeneratorType type)
 		return new LineGenerator;
 	case MESH_GENERATOR_TYPE_LOOP_BASED:
 		return new LoopGenerator;
+	case MESH_GENERATOR_TYPE_QUAD_REFERENCE:
+		return new QuadReferenceGenerator;
+	case MESH_GENERATOR_TYPE_LOOP_REFERENCE:
+		return new LoopReferenceGenerator;
 	default:
 		break;
 	}
@@ -4,13 +4,20 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <vector>
+#include <span>
 #include <types.hpp>
 
+#include "../cancel_token.hpp"
+
+class Scheduler;
+
 enum MeshGeneratorType
 {
     MESH_GENERATOR_TYPE_QUAD_BASED,
     MESH_GENERATOR_TYPE_LINE_BASED,
-    MESH_GENERATOR_TYPE_LOOP_BASED
+    MESH_GENERATOR_TYPE_LOOP_BASED,
+    MESH_GENERATOR_TYPE_QUAD_REFERENCE, // Cpu implementation of the quad based mesh generator
+    MESH_GENERATOR_TYPE_LOOP_REFERENCE  // Cpu implementation of the loop based mesh generator
 };
 
 struct MeshFeatureLine
@@ -26,7 +33,12 @@ public:
     MeshGeneratorFrame() = default;
     virtual ~MeshGeneratorFrame() = default;
     
-    virtual bool triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines = false) = 0;
+    // Returns false if the triangulation failed or was cancelled through the token, in which case the mesh is empty.
+    // Parallel parts of the triangulation are executed as tasks of the given scheduler. If no scheduler is given, the triangulation runs on the calling thread.
+    virtual bool triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines = false, const CancelToken* cancel_token = nullptr, Scheduler* scheduler = nullptr) = 0;
+    // Provides views of the mesh that point directly into the mapped output of the frame and remain valid until the frame is unmapped.
+    // Returns false if the mesh can't be accessed in place, in which case it has to be copied using triangulate().
+    virtual bool map_mesh(std::span<const shared::Vertex>& vertices, std::span<const shared::Index>& indices, shared::ViewMetadata& metadata);
 
     virtual GLuint get_depth_buffer() const = 0;
     virtual GLuint get_normal_buffer() const = 0;
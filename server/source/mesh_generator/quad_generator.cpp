@@ -1,33 +1,100 @@
 #include "quad_generator.hpp"
 #include <spdlog/spdlog.h>
 
-bool QuadGeneratorFrame::triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines)
+bool QuadGeneratorFrame::triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines, const CancelToken* cancel_token, Scheduler* scheduler)
 {
-    metadata.quad.time_copy = this->time_copy;
-    metadata.quad.time_delta = this->time_delta;
-    metadata.quad.time_refine = this->time_refine;
-    metadata.quad.time_corner = this->time_corner;
-    metadata.quad.time_write = this->time_write;
+    this->write_metadata(metadata);
 
-    if (this->count_pointer->vertex_count > QUAD_GENERATOR_MAX_VERTEX_COUNT)
+    uint32_t vertex_count = glm::min(this->count_pointer->vertex_count, this->vertex_capacity);
+    uint32_t index_count = glm::min(this->count_pointer->index_count, this->index_capacity);
+    index_count -= index_count % 6; //The write pass only writes complete quads
+
+    vertices.resize(vertex_count);
+    memcpy(vertices.data(), this->vertex_pointer, vertices.size() * sizeof(shared::Vertex));
+
+    if (this->count_pointer->vertex_count <= this->vertex_capacity && this->count_pointer->index_count <= this->index_capacity)
     {
-        spdlog::error("QuadGeneratorFrame: Vertex count exceeds buffer limit!");
+        indices.resize(index_count);
+        memcpy(indices.data(), this->index_pointer, indices.size() * sizeof(shared::Index));
+
+#if QUAD_GENERATOR_VALIDATE_REFERENCE
+        this->validate_reference(vertices, indices);
+#endif
+
+        return true;
     }
 
-    vertices.resize(this->count_pointer->vertex_count);
-    memcpy(vertices.data(), this->vertex_pointer, vertices.size() * sizeof(shared::Vertex));
+    spdlog::warn("QuadGeneratorFrame: Mesh exceeds buffer capacity! Buffers are regrown for the next frame.");
+
+    //Only keep the triangles of which all vertices have been written
+    indices.clear();
+
+    for (uint32_t index = 0; index + 3 <= index_count; index += 3)
+    {
+        if (this->index_pointer[index + 0] >= vertex_count || this->index_pointer[index + 1] >= vertex_count || this->index_pointer[index + 2] >= vertex_count)
+        {
+            continue;
+        }
+
+        indices.push_back(this->index_pointer[index + 0]);
+        indices.push_back(this->index_pointer[index + 1]);
+        indices.push_back(this->index_pointer[index + 2]);
+    }
 
-    if (this->count_pointer->index_count > QUAD_GENERATOR_MAX_INDEX_COUNT)
+    return true;
+}
+
+bool QuadGeneratorFrame::map_mesh(std::span<const shared::Vertex>& vertices, std::span<const shared::Index>& indices, shared::ViewMetadata& metadata)
+{
+    //If the buffers overflowed, the mesh needs to be filtered and can't be used in place
+    if (this->count_pointer->vertex_count > this->vertex_capacity || this->count_pointer->index_count > this->index_capacity)
     {
-        spdlog::error("QuadGeneratorFrame: Index count exceeds buffer limit!");
+        return false;
     }
 
-    indices.resize(this->count_pointer->index_count);
-    memcpy(indices.data(), this->index_pointer, indices.size() * sizeof(shared::Index));
+    this->write_metadata(metadata);
+
+    vertices = std::span<const shared::Vertex>((const shared::Vertex*)this->vertex_pointer, this->count_pointer->vertex_count);
+    indices = std::span<const shared::Index>(this->index_pointer, this->count_pointer->index_count);
+
+#if QUAD_GENERATOR_VALIDATE_REFERENCE
+    this->validate_reference(vertices, indices);
+#endif
 
     return true;
 }
 
+void QuadGeneratorFrame::write_metadata(shared::ViewMetadata& metadata) const
+{
+    metadata.quad.time_copy = this->time_copy;
+    metadata.quad.time_delta = this->time_delta;
+    metadata.quad.time_refine = this->time_refine;
+    metadata.quad.time_corner = this->time_corner;
+    metadata.quad.time_write = this->time_write;
+
+    metadata.quad.vertex_count = this->count_pointer->vertex_count;
+    metadata.quad.index_count = this->count_pointer->index_count;
+    metadata.quad.vertex_capacity = this->vertex_capacity;
+    metadata.quad.index_capacity = this->index_capacity;
+}
+
+#if QUAD_GENERATOR_VALIDATE_REFERENCE
+void QuadGeneratorFrame::validate_reference(std::span<const shared::Vertex> vertices, std::span<const shared::Index> indices)
+{
+    std::vector<shared::Vertex> reference_vertices;
+    std::vector<shared::Index> reference_indices;
+    shared::QuadViewMetadata reference_metadata;
+
+    //The validation runs on the calling thread, since the mesh can also be validated outside of the triangulation
+    this->reference.process(this->depth_copy_pointer, this->depth_max, this->depth_threshold, reference_vertices, reference_indices, reference_metadata, nullptr);
+
+    if (!QuadReference::compare(reference_vertices, reference_indices, vertices, indices))
+    {
+        spdlog::error("QuadGeneratorFrame: Output of the shaders does not match the reference implementation!");
+    }
+}
+#endif
+
 GLuint QuadGeneratorFrame::get_depth_buffer() const
 {
     return this->depth_buffer;
@@ -156,42 +223,43 @@ MeshGeneratorFrame* QuadGenerator::create_frame()
 
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
-    GLuint vertex_buffer = 0;
-
-    glGenBuffers(1, &vertex_buffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, vertex_buffer);
-
-    glBufferStorage(GL_SHADER_STORAGE_BUFFER, QUAD_GENERATOR_MAX_VERTEX_COUNT * sizeof(glsl::QuadVertex), nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-    glsl::QuadVertex* vertex_pointer = (glsl::QuadVertex*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, QUAD_GENERATOR_MAX_VERTEX_COUNT * sizeof(glsl::QuadVertex), GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-
-    GLuint index_buffer = 0;
-
-    glGenBuffers(1, &index_buffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, index_buffer);
-
-    glBufferStorage(GL_SHADER_STORAGE_BUFFER, QUAD_GENERATOR_MAX_INDEX_COUNT * sizeof(uint32_t), nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-    uint32_t* index_pointer = (uint32_t*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, QUAD_GENERATOR_MAX_INDEX_COUNT * sizeof(uint32_t), GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-
     QuadGeneratorFrame* quad_frame = new QuadGeneratorFrame;
     quad_frame->depth_buffer = depth_buffer;
     quad_frame->normal_buffer = normal_buffer;
     quad_frame->object_id_buffer = object_id_buffer;
     quad_frame->count_buffer = count_buffer;
-    quad_frame->vertex_buffer = vertex_buffer;
-    quad_frame->index_buffer = index_buffer;
     quad_frame->count_pointer = count_pointer;
-    quad_frame->vertex_pointer = vertex_pointer;
-    quad_frame->index_pointer = index_pointer;
     quad_frame->copy_timer = copy_timer;
     quad_frame->delta_timer = delta_timer;
     quad_frame->refine_timer = refine_timer;
     quad_frame->corner_timer = corner_timer;
     quad_frame->write_timer = write_timer;
 
+    uint32_t vertex_capacity = QuadGenerator::compute_capacity(this->vertex_count_peak, QUAD_GENERATOR_INITIAL_VERTEX_COUNT, QUAD_GENERATOR_MAX_VERTEX_COUNT);
+    uint32_t index_capacity = QuadGenerator::compute_capacity(this->index_count_peak, QUAD_GENERATOR_INITIAL_INDEX_COUNT, QUAD_GENERATOR_MAX_INDEX_COUNT);
+
+    if (!this->create_frame_buffers(quad_frame, vertex_capacity, index_capacity))
+    {
+        return nullptr;
+    }
+
+#if QUAD_GENERATOR_VALIDATE_REFERENCE
+    if (!quad_frame->reference.create(this->resolution))
+    {
+        return nullptr;
+    }
+
+    uint32_t depth_copy_buffer_size = this->resolution.x * this->resolution.y * sizeof(float);
+
+    glGenBuffers(1, &quad_frame->depth_copy_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, quad_frame->depth_copy_buffer);
+
+    glBufferStorage(GL_PIXEL_PACK_BUFFER, depth_copy_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    quad_frame->depth_copy_pointer = (const float*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, depth_copy_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#endif
+
     return quad_frame;
 }
 
@@ -208,15 +276,19 @@ void QuadGenerator::destroy_frame(MeshGeneratorFrame* frame)
     quad_frame->object_id_buffer = 0;
 
     glDeleteBuffers(1, &quad_frame->count_buffer);
-    glDeleteBuffers(1, &quad_frame->vertex_buffer);
-    glDeleteBuffers(1, &quad_frame->index_buffer);
 
     quad_frame->count_buffer = 0;
-    quad_frame->vertex_buffer = 0;
-    quad_frame->index_buffer = 0;
     quad_frame->count_pointer = nullptr;
-    quad_frame->vertex_pointer = nullptr;
-    quad_frame->index_pointer = nullptr;
+
+    this->destroy_frame_buffers(quad_frame);
+
+#if QUAD_GENERATOR_VALIDATE_REFERENCE
+    glDeleteBuffers(1, &quad_frame->depth_copy_buffer);
+
+    quad_frame->depth_copy_buffer = 0;
+    quad_frame->depth_copy_pointer = nullptr;
+    quad_frame->reference.destroy();
+#endif
 
     glDeleteSync(quad_frame->fence);
 
@@ -235,6 +307,23 @@ bool QuadGenerator::submit_frame(MeshGeneratorFrame* frame)
 {
     QuadGeneratorFrame* quad_frame = (QuadGeneratorFrame*)frame;
 
+    //Regrow the buffers of the frame if an other frame required more space than available
+    uint32_t vertex_capacity = QuadGenerator::compute_capacity(this->vertex_count_peak, QUAD_GENERATOR_INITIAL_VERTEX_COUNT, QUAD_GENERATOR_MAX_VERTEX_COUNT);
+    uint32_t index_capacity = QuadGenerator::compute_capacity(this->index_count_peak, QUAD_GENERATOR_INITIAL_INDEX_COUNT, QUAD_GENERATOR_MAX_INDEX_COUNT);
+
+    if (quad_frame->vertex_capacity < glm::min(this->vertex_count_peak, vertex_capacity) || quad_frame->index_capacity < glm::min(this->index_count_peak, index_capacity))
+    {
+        vertex_capacity = glm::max(vertex_capacity, quad_frame->vertex_capacity);
+        index_capacity = glm::max(index_capacity, quad_frame->index_capacity);
+
+        this->destroy_frame_buffers(quad_frame);
+
+        if (!this->create_frame_buffers(quad_frame, vertex_capacity, index_capacity))
+        {
+            return false;
+        }
+    }
+
     glsl::QuadIndirect indirect;
     indirect.group_count_x = 0;
     indirect.group_count_y = 1;
@@ -283,6 +372,19 @@ bool QuadGenerator::submit_frame(MeshGeneratorFrame* frame)
 
     this->perform_write_pass(quad_frame);
 
+#if QUAD_GENERATOR_VALIDATE_REFERENCE
+    quad_frame->depth_max = this->depth_max;
+    quad_frame->depth_threshold = this->depth_threshold;
+
+    glBindTexture(GL_TEXTURE_2D, quad_frame->depth_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, quad_frame->depth_copy_buffer);
+
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#endif
+
     quad_frame->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
     return true;
@@ -332,6 +434,9 @@ bool QuadGenerator::map_frame(MeshGeneratorFrame* frame)
     glDeleteSync(quad_frame->fence);
     quad_frame->fence = 0;
 
+    this->vertex_count_peak = glm::max(this->vertex_count_peak, quad_frame->count_pointer->vertex_count);
+    this->index_count_peak = glm::max(this->index_count_peak, quad_frame->count_pointer->index_count);
+
     return true;
 }
 
@@ -513,6 +618,65 @@ void QuadGenerator::destroy_buffers()
     this->corner_buffer = 0;
 }
 
+bool QuadGenerator::create_frame_buffers(QuadGeneratorFrame* quad_frame, uint32_t vertex_capacity, uint32_t index_capacity)
+{
+    GLuint vertex_buffer = 0;
+
+    glGenBuffers(1, &vertex_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, vertex_buffer);
+
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, vertex_capacity * sizeof(glsl::QuadVertex), nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    glsl::QuadVertex* vertex_pointer = (glsl::QuadVertex*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, vertex_capacity * sizeof(glsl::QuadVertex), GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    GLuint index_buffer = 0;
+
+    glGenBuffers(1, &index_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, index_buffer);
+
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, index_capacity * sizeof(uint32_t), nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    uint32_t* index_pointer = (uint32_t*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, index_capacity * sizeof(uint32_t), GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    quad_frame->vertex_buffer = vertex_buffer;
+    quad_frame->index_buffer = index_buffer;
+    quad_frame->vertex_pointer = vertex_pointer;
+    quad_frame->index_pointer = index_pointer;
+    quad_frame->vertex_capacity = vertex_capacity;
+    quad_frame->index_capacity = index_capacity;
+
+    if (vertex_pointer == nullptr || index_pointer == nullptr)
+    {
+        spdlog::error("QuadGenerator: Can't map vertex or index buffer!");
+
+        return false;
+    }
+
+    return true;
+}
+
+void QuadGenerator::destroy_frame_buffers(QuadGeneratorFrame* quad_frame)
+{
+    glDeleteBuffers(1, &quad_frame->vertex_buffer);
+    glDeleteBuffers(1, &quad_frame->index_buffer);
+
+    quad_frame->vertex_buffer = 0;
+    quad_frame->index_buffer = 0;
+    quad_frame->vertex_pointer = nullptr;
+    quad_frame->index_pointer = nullptr;
+    quad_frame->vertex_capacity = 0;
+    quad_frame->index_capacity = 0;
+}
+
+uint32_t QuadGenerator::compute_capacity(uint32_t count_peak, uint32_t capacity_min, uint32_t capacity_max)
+{
+    uint32_t capacity = (uint32_t)glm::ceil(count_peak * QUAD_GENERATOR_CAPACITY_GROWTH);
+
+    return glm::clamp(capacity, capacity_min, capacity_max);
+}
+
 void QuadGenerator::perform_copy_pass(QuadGeneratorFrame* quad_frame)
 {
     std::string pass_label = "quad_copy_pass";
@@ -647,6 +811,7 @@ void QuadGenerator::perform_corner_pass(QuadGeneratorFrame* quad_frame)
     glBindImageTexture(0, this->corner_buffer, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
 
     this->corner_shader.use_shader();
+    this->corner_shader["vertex_capacity"] = quad_frame->vertex_capacity;
 
     glm::uvec2 work_group_size = glm::uvec2(QUAD_GENERATOR_CORNER_WORK_GROUP_SIZE_X, QUAD_GENERATOR_CORNER_WORK_GROUP_SIZE_Y);
     glm::uvec2 work_group_count = ((this->resolution + glm::uvec2(1)) + work_group_size - glm::uvec2(1)) / work_group_size;
@@ -681,6 +846,7 @@ void QuadGenerator::perform_write_pass(QuadGeneratorFrame* quad_frame)
     glBindTexture(GL_TEXTURE_2D, this->corner_buffer);
 
     this->write_shader.use_shader();
+    this->write_shader["index_capacity"] = quad_frame->index_capacity;
 
     glDispatchComputeIndirect(0);
 
@@ -5,6 +5,16 @@
 #include "shader.hpp"
 #include "timer.hpp"
 
+#define QUAD_GENERATOR_VALIDATE_REFERENCE 0 // Compare the output of the shaders against the cpu reference implementation
+
+#if QUAD_GENERATOR_VALIDATE_REFERENCE
+#include "quad_reference.hpp"
+#endif
+
+#define QUAD_GENERATOR_INITIAL_VERTEX_COUNT 65536  // Initial capacity of the vertex buffer of a frame
+#define QUAD_GENERATOR_INITIAL_INDEX_COUNT  262144 // Initial capacity of the index buffer of a frame
+#define QUAD_GENERATOR_CAPACITY_GROWTH      1.5f   // Headroom that is added to the observed peak when a buffer is regrown
+
 namespace glsl
 {
     using namespace glm;
@@ -12,6 +22,8 @@ namespace glsl
 #include "../shaders/shared_defines.glsl"
 }
 
+static_assert(sizeof(glsl::QuadVertex) == sizeof(shared::Vertex), "The vertex buffer is handed out as shared::Vertex");
+
 class QuadGeneratorFrame : public MeshGeneratorFrame
 {
 public:
@@ -27,8 +39,19 @@ public:
     const glsl::QuadVertex* vertex_pointer = nullptr;
     const uint32_t* index_pointer = nullptr;
 
+    uint32_t vertex_capacity = 0;
+    uint32_t index_capacity = 0;
+
     GLsync fence = 0;
 
+#if QUAD_GENERATOR_VALIDATE_REFERENCE
+    QuadReference reference;
+    GLuint depth_copy_buffer = 0;
+    const float* depth_copy_pointer = nullptr;
+    float depth_max = 0.0f;
+    float depth_threshold = 0.0f;
+#endif
+
     Timer copy_timer;
     Timer delta_timer;
     Timer refine_timer;
@@ -45,11 +68,19 @@ public:
 public:
     QuadGeneratorFrame() = default;
 
-    bool triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines);
+    bool triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines, const CancelToken* cancel_token, Scheduler* scheduler);
+    bool map_mesh(std::span<const shared::Vertex>& vertices, std::span<const shared::Index>& indices, shared::ViewMetadata& metadata);
 
     GLuint get_depth_buffer() const;
     GLuint get_normal_buffer() const;
     GLuint get_object_id_buffer() const;
+
+private:
+    void write_metadata(shared::ViewMetadata& metadata) const;
+
+#if QUAD_GENERATOR_VALIDATE_REFERENCE
+    void validate_reference(std::span<const shared::Vertex> vertices, std::span<const shared::Index> indices);
+#endif
 };
 
 class QuadGenerator : public MeshGenerator
@@ -74,6 +105,10 @@ private:
     uint32_t setup_buffer_count = 0;
     float depth_max = 0.995f;
     float depth_threshold = 0.001f;
+
+    // Largest vertex and index count that was requested by any frame so far
+    uint32_t vertex_count_peak = 0;
+    uint32_t index_count_peak = 0;
     
 public:
     QuadGenerator() = default;
@@ -93,6 +128,11 @@ private:
     bool create_shaders();
     void destroy_buffers();
 
+    bool create_frame_buffers(QuadGeneratorFrame* quad_frame, uint32_t vertex_capacity, uint32_t index_capacity);
+    void destroy_frame_buffers(QuadGeneratorFrame* quad_frame);
+
+    static uint32_t compute_capacity(uint32_t count_peak, uint32_t capacity_min, uint32_t capacity_max);
+
     void perform_copy_pass(QuadGeneratorFrame* quad_frame);
     void perform_delta_pass(QuadGeneratorFrame* quad_frame);
     void perform_refine_pass(QuadGeneratorFrame* quad_frame);
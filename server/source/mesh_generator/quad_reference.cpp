@@ -0,0 +1,498 @@
+#include "quad_reference.hpp"
+#include "../scheduler.hpp"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <array>
+
+bool QuadReference::create(const glm::uvec2& resolution)
+{
+    this->resolution = resolution;
+
+    glm::uvec2 level_resolution = resolution;
+    uint32_t level_count = 1;
+
+    while (level_resolution.x > 32 || level_resolution.y > 32)
+    {
+        level_count++;
+
+        level_resolution = glm::max(glm::uvec2(1), level_resolution / glm::uvec2(2));
+    }
+
+    this->levels.resize(level_count);
+
+    for (uint32_t index = 0; index < level_count; index++)
+    {
+        QuadReferenceLevel& level = this->levels[index];
+        level.resolution = glm::max(glm::uvec2(1), resolution >> index);
+        level.depth_min.resize(level.resolution.x * level.resolution.y);
+        level.depth_max.resize(level.resolution.x * level.resolution.y);
+    }
+
+    this->setup_quads.clear();
+
+    for (uint32_t coord_y = 0; coord_y < level_resolution.y; coord_y++)
+    {
+        for (uint32_t coord_x = 0; coord_x < level_resolution.x; coord_x++)
+        {
+            glsl::Quad quad;
+            quad.coord = glm::u16vec2(coord_x, coord_y);
+            quad.level = level_count - 1;
+
+            this->setup_quads.push_back(quad);
+        }
+    }
+
+    this->thread_count = QUAD_REFERENCE_THREAD_COUNT;
+
+    if (this->thread_count == 0)
+    {
+        this->thread_count = glm::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    this->thread_quads.resize(this->thread_count);
+    this->thread_stacks.resize(this->thread_count);
+    this->thread_offsets.resize(this->thread_count + 1);
+    this->corner_buffer.resize((resolution.x + 1) * (resolution.y + 1));
+
+    return true;
+}
+
+void QuadReference::destroy()
+{
+    this->levels.clear();
+    this->setup_quads.clear();
+    this->thread_quads.clear();
+    this->thread_stacks.clear();
+    this->thread_offsets.clear();
+    this->corner_buffer.clear();
+}
+
+void QuadReference::process(const float* depth_pointer, float depth_max, float depth_threshold, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::QuadViewMetadata& metadata, Scheduler* scheduler)
+{
+    this->scheduler = scheduler;
+
+    std::chrono::high_resolution_clock::time_point copy_start = std::chrono::high_resolution_clock::now();
+    this->perform_copy_pass(depth_pointer, depth_max);
+    std::chrono::high_resolution_clock::time_point delta_start = std::chrono::high_resolution_clock::now();
+    this->perform_delta_pass();
+    std::chrono::high_resolution_clock::time_point refine_start = std::chrono::high_resolution_clock::now();
+    this->perform_refine_pass(depth_threshold);
+    std::chrono::high_resolution_clock::time_point corner_start = std::chrono::high_resolution_clock::now();
+    this->perform_corner_pass(depth_pointer, vertices);
+    std::chrono::high_resolution_clock::time_point write_start = std::chrono::high_resolution_clock::now();
+    this->perform_write_pass(indices);
+    std::chrono::high_resolution_clock::time_point write_end = std::chrono::high_resolution_clock::now();
+
+    metadata.time_copy = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(delta_start - copy_start).count();
+    metadata.time_delta = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(refine_start - delta_start).count();
+    metadata.time_refine = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(corner_start - refine_start).count();
+    metadata.time_corner = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(write_start - corner_start).count();
+    metadata.time_write = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(write_end - write_start).count();
+
+    this->scheduler = nullptr;
+}
+
+bool QuadReference::compare(std::span<const shared::Vertex> reference_vertices, std::span<const shared::Index> reference_indices, std::span<const shared::Vertex> vertices, std::span<const shared::Index> indices)
+{
+    if (reference_vertices.size() != vertices.size())
+    {
+        spdlog::error("QuadReference: Vertex count differs! Expected {} but got {}.", reference_vertices.size(), vertices.size());
+
+        return false;
+    }
+
+    if (reference_indices.size() != indices.size())
+    {
+        spdlog::error("QuadReference: Index count differs! Expected {} but got {}.", reference_indices.size(), indices.size());
+
+        return false;
+    }
+
+    //Identify vertices by their coordinate and triangles by the coordinates of their corners, since the order of both is not defined on the gpu
+    auto collect_vertices = [](std::span<const shared::Vertex> vertices)
+    {
+        std::vector<std::pair<uint32_t, float>> vertex_keys;
+        vertex_keys.reserve(vertices.size());
+
+        for (const shared::Vertex& vertex : vertices)
+        {
+            vertex_keys.push_back(std::make_pair((vertex.y << 16) | vertex.x, vertex.z));
+        }
+
+        std::sort(vertex_keys.begin(), vertex_keys.end());
+
+        return vertex_keys;
+    };
+
+    auto collect_triangles = [](std::span<const shared::Vertex> vertices, std::span<const shared::Index> indices, std::vector<std::array<uint32_t, 3>>& triangle_keys)
+    {
+        triangle_keys.reserve(indices.size() / 3);
+
+        for (uint32_t index = 0; index + 2 < indices.size(); index += 3)
+        {
+            std::array<uint32_t, 3> triangle_key;
+
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                if (indices[index + corner] >= vertices.size())
+                {
+                    return false;
+                }
+
+                const shared::Vertex& vertex = vertices[indices[index + corner]];
+                triangle_key[corner] = (vertex.y << 16) | vertex.x;
+            }
+
+            //Rotate the corners so that the orientation of the triangle is kept
+            std::rotate(triangle_key.begin(), std::min_element(triangle_key.begin(), triangle_key.end()), triangle_key.end());
+
+            triangle_keys.push_back(triangle_key);
+        }
+
+        std::sort(triangle_keys.begin(), triangle_keys.end());
+
+        return true;
+    };
+
+    if (collect_vertices(reference_vertices) != collect_vertices(vertices))
+    {
+        spdlog::error("QuadReference: Vertices differ!");
+
+        return false;
+    }
+
+    std::vector<std::array<uint32_t, 3>> reference_triangle_keys;
+    std::vector<std::array<uint32_t, 3>> triangle_keys;
+
+    if (!collect_triangles(reference_vertices, reference_indices, reference_triangle_keys) || !collect_triangles(vertices, indices, triangle_keys))
+    {
+        spdlog::error("QuadReference: Index out of range!");
+
+        return false;
+    }
+
+    if (reference_triangle_keys != triangle_keys)
+    {
+        spdlog::error("QuadReference: Triangles differ!");
+
+        return false;
+    }
+
+    return true;
+}
+
+void QuadReference::perform_copy_pass(const float* depth_pointer, float depth_max)
+{
+    QuadReferenceLevel& level = this->levels.front();
+
+    this->run_parallel(this->resolution.y, [&](uint32_t thread, uint32_t row_begin, uint32_t row_end)
+    {
+        uint32_t begin = row_begin * this->resolution.x;
+        uint32_t end = row_end * this->resolution.x;
+
+        for (uint32_t index = begin; index < end; index++)
+        {
+            float depth = glm::min(depth_pointer[index], depth_max);
+
+            level.depth_min[index] = depth;
+            level.depth_max[index] = depth;
+        }
+    });
+}
+
+void QuadReference::perform_delta_pass()
+{
+    for (uint32_t index = 1; index < this->levels.size(); index++)
+    {
+        const QuadReferenceLevel& src_level = this->levels[index - 1];
+        QuadReferenceLevel& dst_level = this->levels[index];
+
+        this->run_parallel(dst_level.resolution.y, [&](uint32_t thread, uint32_t row_begin, uint32_t row_end)
+        {
+            for (uint32_t coord_y = row_begin; coord_y < row_end; coord_y++)
+            {
+                float* dst_min = dst_level.depth_min.data() + coord_y * dst_level.resolution.x;
+                float* dst_max = dst_level.depth_max.data() + coord_y * dst_level.resolution.x;
+                uint32_t coord_x = 0;
+
+                //Fast path for destination pixels of which all four source pixels are inside of the source level
+                if (2 * coord_y + 1 < src_level.resolution.y)
+                {
+                    const float* src_min0 = src_level.depth_min.data() + (2 * coord_y + 0) * src_level.resolution.x;
+                    const float* src_min1 = src_level.depth_min.data() + (2 * coord_y + 1) * src_level.resolution.x;
+                    const float* src_max0 = src_level.depth_max.data() + (2 * coord_y + 0) * src_level.resolution.x;
+                    const float* src_max1 = src_level.depth_max.data() + (2 * coord_y + 1) * src_level.resolution.x;
+
+                    uint32_t inside_count = glm::min(dst_level.resolution.x, src_level.resolution.x / 2);
+
+                    for (; coord_x < inside_count; coord_x++)
+                    {
+                        float value_min = glm::min(glm::min(src_min0[2 * coord_x], src_min0[2 * coord_x + 1]), glm::min(src_min1[2 * coord_x], src_min1[2 * coord_x + 1]));
+                        float value_max = glm::max(glm::max(src_max0[2 * coord_x], src_max0[2 * coord_x + 1]), glm::max(src_max1[2 * coord_x], src_max1[2 * coord_x + 1]));
+
+                        dst_min[coord_x] = glm::min(1.0f, value_min);
+                        dst_max[coord_x] = glm::max(0.0f, value_max);
+                    }
+                }
+
+                //Source pixels outside of the source level are read as zero, the same way as image loads on the gpu
+                for (; coord_x < dst_level.resolution.x; coord_x++)
+                {
+                    glm::vec2 dst_delta = glm::vec2(1.0f, 0.0f);
+
+                    for (uint32_t offset_y = 0; offset_y < 2; offset_y++)
+                    {
+                        for (uint32_t offset_x = 0; offset_x < 2; offset_x++)
+                        {
+                            glm::ivec2 src_coord = 2 * glm::ivec2(coord_x, coord_y) + glm::ivec2(offset_x, offset_y);
+                            glm::vec2 src_delta = this->fetch_delta(src_coord, index - 1);
+
+                            dst_delta.x = glm::min(dst_delta.x, src_delta.x);
+                            dst_delta.y = glm::max(dst_delta.y, src_delta.y);
+                        }
+                    }
+
+                    dst_min[coord_x] = dst_delta.x;
+                    dst_max[coord_x] = dst_delta.y;
+                }
+            }
+        });
+    }
+}
+
+void QuadReference::perform_refine_pass(float depth_threshold)
+{
+    glm::ivec2 corner_resolution = glm::ivec2(this->resolution) + glm::ivec2(1);
+
+    for (std::vector<glsl::Quad>& quads : this->thread_quads)
+    {
+        quads.clear();
+    }
+
+    //Each thread refines a continuous range of the setup quads depth first, which keeps the order of the quads deterministic
+    this->run_parallel(this->setup_quads.size(), [&](uint32_t thread, uint32_t begin, uint32_t end)
+    {
+        std::vector<glsl::Quad>& quads = this->thread_quads[thread];
+        std::vector<glsl::Quad>& stack = this->thread_stacks[thread];
+
+        for (uint32_t index = begin; index < end; index++)
+        {
+            stack.push_back(this->setup_quads[index]);
+
+            while (!stack.empty())
+            {
+                glsl::Quad quad = stack.back();
+                stack.pop_back();
+
+                glm::ivec2 coord = glm::ivec2(quad.coord);
+                glm::vec2 delta = this->fetch_delta(coord, quad.level);
+                float depth_delta = delta.y - delta.x;
+
+                if (depth_delta > depth_threshold && quad.level > 0)
+                {
+                    for (int32_t offset = 3; offset >= 0; offset--)
+                    {
+                        glsl::Quad child_quad;
+                        child_quad.coord = glm::u16vec2(coord * 2 + glm::ivec2(offset % 2, offset / 2));
+                        child_quad.level = quad.level - 1;
+
+                        stack.push_back(child_quad);
+                    }
+                }
+
+                else
+                {
+                    glm::ivec2 quad_coord = coord * (1 << quad.level);
+
+                    if (glm::all(glm::lessThan(quad_coord, corner_resolution)))
+                    {
+                        quads.push_back(quad);
+                    }
+                }
+            }
+        }
+    });
+
+    std::fill(this->corner_buffer.begin(), this->corner_buffer.end(), 0);
+
+    for (const std::vector<glsl::Quad>& quads : this->thread_quads)
+    {
+        for (const glsl::Quad& quad : quads)
+        {
+            int32_t quad_size = (1 << quad.level);
+            glm::ivec2 quad_coord = quad_size * glm::ivec2(quad.coord);
+
+            for (uint32_t offset_y = 0; offset_y < 2; offset_y++)
+            {
+                for (uint32_t offset_x = 0; offset_x < 2; offset_x++)
+                {
+                    glm::ivec2 corner_coord = quad_coord + quad_size * glm::ivec2(offset_x, offset_y);
+                    corner_coord = glm::clamp(corner_coord, glm::ivec2(0), corner_resolution - glm::ivec2(1));
+
+                    this->corner_buffer[corner_coord.y * corner_resolution.x + corner_coord.x] = QUAD_GENERATOR_CORNER_ALLOCATE_FLAG;
+                }
+            }
+        }
+    }
+}
+
+void QuadReference::perform_corner_pass(const float* depth_pointer, std::vector<shared::Vertex>& vertices)
+{
+    glm::uvec2 corner_resolution = this->resolution + glm::uvec2(1);
+
+    //Count the allocated corners of each thread first, so that the vertices can be written in the order of the rows
+    std::fill(this->thread_offsets.begin(), this->thread_offsets.end(), 0);
+
+    this->run_parallel(corner_resolution.y, [&](uint32_t thread, uint32_t row_begin, uint32_t row_end)
+    {
+        uint32_t begin = row_begin * corner_resolution.x;
+        uint32_t end = row_end * corner_resolution.x;
+        uint32_t corner_count = 0;
+
+        for (uint32_t index = begin; index < end; index++)
+        {
+            corner_count += (this->corner_buffer[index] == QUAD_GENERATOR_CORNER_ALLOCATE_FLAG) ? 1 : 0;
+        }
+
+        this->thread_offsets[thread + 1] = corner_count;
+    });
+
+    for (uint32_t thread = 0; thread < this->thread_count; thread++)
+    {
+        this->thread_offsets[thread + 1] += this->thread_offsets[thread];
+    }
+
+    vertices.resize(this->thread_offsets.back());
+
+    this->run_parallel(corner_resolution.y, [&](uint32_t thread, uint32_t row_begin, uint32_t row_end)
+    {
+        uint32_t vertex_index = this->thread_offsets[thread];
+
+        for (uint32_t coord_y = row_begin; coord_y < row_end; coord_y++)
+        {
+            for (uint32_t coord_x = 0; coord_x < corner_resolution.x; coord_x++)
+            {
+                uint32_t& corner = this->corner_buffer[coord_y * corner_resolution.x + coord_x];
+
+                if (corner != QUAD_GENERATOR_CORNER_ALLOCATE_FLAG)
+                {
+                    continue;
+                }
+
+                float depth_min = 1.0f;
+
+                for (uint32_t offset_y = 0; offset_y < 2; offset_y++)
+                {
+                    for (uint32_t offset_x = 0; offset_x < 2; offset_x++)
+                    {
+                        glm::ivec2 depth_coord = glm::ivec2(coord_x, coord_y) - glm::ivec2(1) + glm::ivec2(offset_x, offset_y);
+
+                        if (glm::any(glm::lessThan(depth_coord, glm::ivec2(0))) || glm::any(glm::greaterThanEqual(depth_coord, glm::ivec2(this->resolution))))
+                        {
+                            continue;
+                        }
+
+                        depth_min = glm::min(depth_min, depth_pointer[depth_coord.y * this->resolution.x + depth_coord.x]);
+                    }
+                }
+
+                shared::Vertex& vertex = vertices[vertex_index];
+                vertex.x = coord_x;
+                vertex.y = coord_y;
+                vertex.z = depth_min;
+
+                corner = vertex_index;
+                vertex_index++;
+            }
+        }
+    });
+}
+
+void QuadReference::perform_write_pass(std::vector<shared::Index>& indices)
+{
+    this->thread_offsets[0] = 0;
+
+    for (uint32_t thread = 0; thread < this->thread_count; thread++)
+    {
+        this->thread_offsets[thread + 1] = this->thread_offsets[thread] + this->thread_quads[thread].size() * 6;
+    }
+
+    indices.resize(this->thread_offsets.back());
+
+    this->run_parallel(this->thread_count, [&](uint32_t thread, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t index = begin; index < end; index++)
+        {
+            uint32_t offset = this->thread_offsets[index];
+
+            for (const glsl::Quad& quad : this->thread_quads[index])
+            {
+                int32_t quad_size = (1 << quad.level);
+                glm::ivec2 quad_coord = quad_size * glm::ivec2(quad.coord);
+
+                indices[offset + 0] = this->corner_index(quad_coord);
+                indices[offset + 1] = this->corner_index(quad_coord + glm::ivec2(quad_size, 0));
+                indices[offset + 2] = this->corner_index(quad_coord + glm::ivec2(quad_size, quad_size));
+
+                indices[offset + 3] = this->corner_index(quad_coord + glm::ivec2(quad_size, quad_size));
+                indices[offset + 4] = this->corner_index(quad_coord + glm::ivec2(0, quad_size));
+                indices[offset + 5] = this->corner_index(quad_coord);
+
+                offset += 6;
+            }
+        }
+    });
+}
+
+template<typename Function>
+void QuadReference::run_parallel(uint32_t count, const Function& function)
+{
+    //Without a scheduler, the first part covers the whole range
+    if (this->scheduler == nullptr)
+    {
+        function(0, 0, count);
+
+        return;
+    }
+
+    uint32_t thread_count = glm::clamp(count, 1u, this->thread_count);
+
+    //Capture the function by reference and the counts by value, so that the lambda fits into the std::function without an allocation
+    this->scheduler->run_parallel(thread_count, [&function, count, thread_count](uint32_t thread)
+    {
+        uint32_t begin = ((uint64_t)count * thread) / thread_count;
+        uint32_t end = ((uint64_t)count * (thread + 1)) / thread_count;
+
+        function(thread, begin, end);
+    });
+}
+
+glm::vec2 QuadReference::fetch_delta(const glm::ivec2& coord, uint32_t level) const
+{
+    if (level >= this->levels.size())
+    {
+        return glm::vec2(0.0f);
+    }
+
+    const QuadReferenceLevel& delta_level = this->levels[level];
+
+    if (glm::any(glm::lessThan(coord, glm::ivec2(0))) || glm::any(glm::greaterThanEqual(coord, glm::ivec2(delta_level.resolution))))
+    {
+        return glm::vec2(0.0f);
+    }
+
+    uint32_t index = coord.y * delta_level.resolution.x + coord.x;
+
+    return glm::vec2(delta_level.depth_min[index], delta_level.depth_max[index]);
+}
+
+uint32_t QuadReference::corner_index(const glm::ivec2& coord) const
+{
+    glm::ivec2 corner_resolution = glm::ivec2(this->resolution) + glm::ivec2(1);
+    glm::ivec2 corner_coord = glm::clamp(coord, glm::ivec2(0), corner_resolution - glm::ivec2(1));
+
+    return this->corner_buffer[corner_coord.y * corner_resolution.x + corner_coord.x];
+}
\ No newline at end of file
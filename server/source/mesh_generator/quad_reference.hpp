@@ -0,0 +1,75 @@
+#ifndef HEADER_QUAD_REFERENCE
+#define HEADER_QUAD_REFERENCE
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <span>
+#include <types.hpp>
+
+class Scheduler;
+
+#define QUAD_REFERENCE_THREAD_COUNT 0 // Number of parts into which each pass of the reference implementation is split. If zero, one part for each hardware thread is used.
+
+namespace glsl
+{
+    using namespace glm;
+    typedef uint32_t uint;
+#include "../shaders/shared_defines.glsl"
+}
+
+struct QuadReferenceLevel
+{
+    glm::uvec2 resolution = glm::uvec2(0);
+
+    std::vector<float> depth_min; // Equivalent to the first channel of the delta buffer
+    std::vector<float> depth_max; // Equivalent to the second channel of the delta buffer
+};
+
+// CPU implementation of the copy, delta, refine, corner and write pass of the quad generator.
+// The result matches the output of the compute shaders except for the order of the vertices and quads, which is deterministic here.
+// Can be used as fallback if no compute capable gpu is available and as reference for the output of the shaders.
+class QuadReference
+{
+private:
+    std::vector<QuadReferenceLevel> levels;
+    std::vector<glsl::Quad> setup_quads;
+
+    std::vector<std::vector<glsl::Quad>> thread_quads; // Quads that are emitted by the refine pass of each thread
+    std::vector<std::vector<glsl::Quad>> thread_stacks;
+    std::vector<uint32_t> thread_offsets;
+    std::vector<uint32_t> corner_buffer;
+
+    glm::uvec2 resolution = glm::uvec2(0);
+    uint32_t thread_count = 1;
+    Scheduler* scheduler = nullptr; // Only set during the processing
+
+public:
+    QuadReference() = default;
+
+    bool create(const glm::uvec2& resolution);
+    void destroy();
+
+    // The depth image is expected to be stored row by row, starting with the row at coordinate zero.
+    // The time measurements of the passes are written to the metadata.
+    // The passes are split into tasks of the given scheduler. If no scheduler is given, the passes run on the calling thread.
+    void process(const float* depth_pointer, float depth_max, float depth_threshold, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::QuadViewMetadata& metadata, Scheduler* scheduler);
+
+    // Returns true if both meshes contain the same vertices and triangles independent of their order
+    static bool compare(std::span<const shared::Vertex> reference_vertices, std::span<const shared::Index> reference_indices, std::span<const shared::Vertex> vertices, std::span<const shared::Index> indices);
+
+private:
+    void perform_copy_pass(const float* depth_pointer, float depth_max);
+    void perform_delta_pass();
+    void perform_refine_pass(float depth_threshold);
+    void perform_corner_pass(const float* depth_pointer, std::vector<shared::Vertex>& vertices);
+    void perform_write_pass(std::vector<shared::Index>& indices);
+
+    // Splits the range [0, count) into one continuous part for each thread and calls function(thread, begin, end) for each part as a task of the scheduler
+    template<typename Function>
+    void run_parallel(uint32_t count, const Function& function);
+
+    glm::vec2 fetch_delta(const glm::ivec2& coord, uint32_t level) const;
+    uint32_t corner_index(const glm::ivec2& coord) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "quad_reference_generator.hpp"
+#include <spdlog/spdlog.h>
+
+bool QuadReferenceGeneratorFrame::triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines, const CancelToken* cancel_token, Scheduler* scheduler)
+{
+    this->reference.process(this->depth_copy_pointer, this->depth_max, this->depth_threshold, vertices, indices, metadata.quad, scheduler);
+
+    metadata.quad.vertex_count = vertices.size();
+    metadata.quad.index_count = indices.size();
+    metadata.quad.vertex_capacity = vertices.capacity();
+    metadata.quad.index_capacity = indices.capacity();
+
+    return true;
+}
+
+GLuint QuadReferenceGeneratorFrame::get_depth_buffer() const
+{
+    return this->depth_buffer;
+}
+
+GLuint QuadReferenceGeneratorFrame::get_normal_buffer() const
+{
+    return this->normal_buffer;
+}
+
+GLuint QuadReferenceGeneratorFrame::get_object_id_buffer() const
+{
+    return this->object_id_buffer;
+}
+
+bool QuadReferenceGenerator::create(const glm::uvec2& resolution)
+{
+    this->resolution = resolution;
+
+    return true;
+}
+
+void QuadReferenceGenerator::destroy()
+{
+    this->resolution = glm::uvec2(0);
+}
+
+void QuadReferenceGenerator::apply(const shared::MeshSettings& settings)
+{
+    this->depth_max = settings.depth_max;
+    this->depth_threshold = settings.quad.depth_threshold;
+}
+
+MeshGeneratorFrame* QuadReferenceGenerator::create_frame()
+{
+    QuadReference reference;
+
+    if (!reference.create(this->resolution))
+    {
+        return nullptr;
+    }
+
+    GLuint depth_buffer = 0;
+
+    glGenTextures(1, &depth_buffer);
+    glBindTexture(GL_TEXTURE_2D, depth_buffer);
+
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32, this->resolution.x, this->resolution.y);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLuint normal_buffer = 0;
+
+    glGenTextures(1, &normal_buffer);
+    glBindTexture(GL_TEXTURE_2D, normal_buffer);
+
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG8, this->resolution.x, this->resolution.y);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLuint object_id_buffer = 0;
+
+    glGenTextures(1, &object_id_buffer);
+    glBindTexture(GL_TEXTURE_2D, object_id_buffer);
+
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, this->resolution.x, this->resolution.y);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    uint32_t depth_copy_buffer_size = this->resolution.x * this->resolution.y * sizeof(float);
+
+    GLuint depth_copy_buffer = 0;
+
+    glGenBuffers(1, &depth_copy_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, depth_copy_buffer);
+
+    glBufferStorage(GL_PIXEL_PACK_BUFFER, depth_copy_buffer_size, nullptr, GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    float* depth_copy_pointer = (float*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, depth_copy_buffer_size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (depth_copy_pointer == nullptr)
+    {
+        spdlog::error("QuadReferenceGenerator: Can't map depth copy buffer!");
+
+        return nullptr;
+    }
+
+    QuadReferenceGeneratorFrame* reference_frame = new QuadReferenceGeneratorFrame;
+    reference_frame->reference = std::move(reference);
+    reference_frame->depth_buffer = depth_buffer;
+    reference_frame->normal_buffer = normal_buffer;
+    reference_frame->object_id_buffer = object_id_buffer;
+    reference_frame->depth_copy_buffer = depth_copy_buffer;
+    reference_frame->depth_copy_pointer = depth_copy_pointer;
+
+    return reference_frame;
+}
+
+void QuadReferenceGenerator::destroy_frame(MeshGeneratorFrame* frame)
+{
+    QuadReferenceGeneratorFrame* reference_frame = (QuadReferenceGeneratorFrame*)frame;
+
+    glDeleteTextures(1, &reference_frame->depth_buffer);
+    glDeleteTextures(1, &reference_frame->normal_buffer);
+    glDeleteTextures(1, &reference_frame->object_id_buffer);
+    glDeleteBuffers(1, &reference_frame->depth_copy_buffer);
+
+    reference_frame->depth_buffer = 0;
+    reference_frame->normal_buffer = 0;
+    reference_frame->object_id_buffer = 0;
+    reference_frame->depth_copy_buffer = 0;
+    reference_frame->depth_copy_pointer = nullptr;
+
+    glDeleteSync(reference_frame->fence);
+
+    reference_frame->fence = 0;
+    reference_frame->reference.destroy();
+
+    delete reference_frame;
+}
+
+bool QuadReferenceGenerator::submit_frame(MeshGeneratorFrame* frame)
+{
+    QuadReferenceGeneratorFrame* reference_frame = (QuadReferenceGeneratorFrame*)frame;
+    reference_frame->depth_max = this->depth_max;
+    reference_frame->depth_threshold = this->depth_threshold;
+
+    glBindTexture(GL_TEXTURE_2D, reference_frame->depth_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, reference_frame->depth_copy_buffer);
+
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+
+    reference_frame->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    return true;
+}
+
+bool QuadReferenceGenerator::map_frame(MeshGeneratorFrame* frame)
+{
+    QuadReferenceGeneratorFrame* reference_frame = (QuadReferenceGeneratorFrame*)frame;
+
+    if (reference_frame->fence == 0)
+    {
+        return false;
+    }
+
+    GLenum result = glClientWaitSync(reference_frame->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+    {
+        return false;
+    }
+
+    glDeleteSync(reference_frame->fence);
+    reference_frame->fence = 0;
+
+    return true;
+}
+
+bool QuadReferenceGenerator::unmap_frame(MeshGeneratorFrame* frame)
+{
+    return true;
+}
\ No newline at end of file
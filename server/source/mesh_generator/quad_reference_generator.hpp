@@ -0,0 +1,57 @@
+#ifndef HEADER_QUAD_REFERENCE_GENERATOR
+#define HEADER_QUAD_REFERENCE_GENERATOR
+
+#include "mesh_generator.hpp"
+#include "quad_reference.hpp"
+
+// Quad based mesh generator that only uses the gpu to read back the depth buffer.
+// All passes of the quad generator are performed on the cpu by the reference implementation.
+class QuadReferenceGeneratorFrame : public MeshGeneratorFrame
+{
+public:
+    QuadReference reference;
+
+    GLuint depth_buffer = 0;
+    GLuint normal_buffer = 0;
+    GLuint object_id_buffer = 0;
+
+    GLuint depth_copy_buffer = 0;
+    const float* depth_copy_pointer = nullptr;
+
+    GLsync fence = 0;
+
+    float depth_max = 0.995f;
+    float depth_threshold = 0.001f;
+
+public:
+    QuadReferenceGeneratorFrame() = default;
+
+    bool triangulate(std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices, shared::ViewMetadata& metadata, std::vector<MeshFeatureLine>& feature_lines, bool export_feature_lines, const CancelToken* cancel_token, Scheduler* scheduler);
+
+    GLuint get_depth_buffer() const;
+    GLuint get_normal_buffer() const;
+    GLuint get_object_id_buffer() const;
+};
+
+class QuadReferenceGenerator : public MeshGenerator
+{
+private:
+    glm::uvec2 resolution = glm::uvec2(0);
+    float depth_max = 0.995f;
+    float depth_threshold = 0.001f;
+
+public:
+    QuadReferenceGenerator() = default;
+
+    bool create(const glm::uvec2& resolution);
+    void destroy();
+    void apply(const shared::MeshSettings& settings);
+
+    MeshGeneratorFrame* create_frame();
+    void destroy_frame(MeshGeneratorFrame* frame);
+    bool submit_frame(MeshGeneratorFrame* frame);
+    bool map_frame(MeshGeneratorFrame* frame);
+    bool unmap_frame(MeshGeneratorFrame* frame);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,133 @@
+#ifndef HEADER_RING_QUEUE
+#define HEADER_RING_QUEUE
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+// Bounded lock-free queue that can be used by multiple producers and multiple consumers at the same time.
+// Each slot carries a sequence number which tells producers and consumers whether the slot is currently free or occupied.
+template<typename Type>
+class RingQueue
+{
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence = 0;
+        Type value = {};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    uint64_t capacity = 0;
+    uint64_t mask = 0;
+
+    alignas(64) std::atomic<uint64_t> head = 0; // Next slot to pop from
+    alignas(64) std::atomic<uint64_t> tail = 0; // Next slot to push to
+
+public:
+    RingQueue() = default;
+
+    // The capacity is rounded up to the next power of two
+    void create(uint32_t capacity)
+    {
+        this->capacity = 1;
+
+        while (this->capacity < capacity)
+        {
+            this->capacity <<= 1;
+        }
+
+        this->mask = this->capacity - 1;
+        this->slots = std::make_unique<Slot[]>(this->capacity);
+
+        for (uint64_t index = 0; index < this->capacity; index++)
+        {
+            this->slots[index].sequence.store(index, std::memory_order_relaxed);
+        }
+
+        this->head.store(0, std::memory_order_relaxed);
+        this->tail.store(0, std::memory_order_relaxed);
+    }
+
+    void destroy()
+    {
+        this->slots.reset();
+        this->capacity = 0;
+        this->mask = 0;
+    }
+
+    // Returns false if the queue is full
+    bool push(const Type& value)
+    {
+        uint64_t position = this->tail.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            Slot& slot = this->slots[position & this->mask];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            int64_t difference = (int64_t)sequence - (int64_t)position;
+
+            if (difference == 0)
+            {
+                if (this->tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.value = value;
+                    slot.sequence.store(position + 1, std::memory_order_release);
+
+                    return true;
+                }
+            }
+
+            else if (difference < 0)
+            {
+                return false;
+            }
+
+            else
+            {
+                position = this->tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns false if the queue is empty
+    bool pop(Type& value)
+    {
+        uint64_t position = this->head.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            Slot& slot = this->slots[position & this->mask];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            int64_t difference = (int64_t)sequence - (int64_t)(position + 1);
+
+            if (difference == 0)
+            {
+                if (this->head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    value = slot.value;
+                    slot.sequence.store(position + this->capacity, std::memory_order_release);
+
+                    return true;
+                }
+            }
+
+            else if (difference < 0)
+            {
+                return false;
+            }
+
+            else
+            {
+                position = this->head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    uint32_t get_capacity() const
+    {
+        return this->capacity;
+    }
+};
+
+#endif
\ No newline at end of file
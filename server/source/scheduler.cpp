@@ -0,0 +1,367 @@
+#include "scheduler.hpp"
+#include <algorithm>
+
+static thread_local Scheduler* current_scheduler = nullptr;
+static thread_local uint32_t current_thread_index = 0;
+
+SchedulerTask::SchedulerTask()
+{
+    this->successors.reserve(SCHEDULER_SUCCESSOR_CAPACITY);
+}
+
+SchedulerQueue::SchedulerQueue()
+{
+    this->tasks = std::make_unique<std::atomic<SchedulerTask*>[]>(SCHEDULER_QUEUE_CAPACITY);
+}
+
+bool SchedulerQueue::push(SchedulerTask* task)
+{
+    int64_t bottom = this->bottom.load(std::memory_order_relaxed);
+    int64_t top = this->top.load(std::memory_order_acquire);
+
+    if (bottom - top >= SCHEDULER_QUEUE_CAPACITY)
+    {
+        return false;
+    }
+
+    this->tasks[bottom % SCHEDULER_QUEUE_CAPACITY].store(task, std::memory_order_relaxed);
+    this->bottom.store(bottom + 1, std::memory_order_seq_cst);
+
+    return true;
+}
+
+SchedulerTask* SchedulerQueue::pop()
+{
+    int64_t bottom = this->bottom.load(std::memory_order_relaxed) - 1;
+    this->bottom.store(bottom, std::memory_order_seq_cst);
+    int64_t top = this->top.load(std::memory_order_seq_cst);
+
+    if (top > bottom)
+    {
+        this->bottom.store(bottom + 1, std::memory_order_relaxed);
+
+        return nullptr;
+    }
+
+    SchedulerTask* task = this->tasks[bottom % SCHEDULER_QUEUE_CAPACITY].load(std::memory_order_relaxed);
+
+    //The last task in the queue could be stolen at the same time
+    if (top == bottom)
+    {
+        if (!this->top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            task = nullptr;
+        }
+
+        this->bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return task;
+}
+
+SchedulerTask* SchedulerQueue::steal()
+{
+    int64_t top = this->top.load(std::memory_order_seq_cst);
+    int64_t bottom = this->bottom.load(std::memory_order_seq_cst);
+
+    if (top >= bottom)
+    {
+        return nullptr;
+    }
+
+    SchedulerTask* task = this->tasks[top % SCHEDULER_QUEUE_CAPACITY].load(std::memory_order_relaxed);
+
+    if (!this->top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr;
+    }
+
+    return task;
+}
+
+bool Scheduler::create(ThreadPlacement* thread_placement, uint32_t thread_count)
+{
+    if (thread_count == 0)
+    {
+        thread_count = thread_placement->get_worker_count();
+    }
+
+    this->external_queue.create(SCHEDULER_QUEUE_CAPACITY);
+    this->task_pool.create(SCHEDULER_POOL_CAPACITY);
+    this->active = true;
+
+    //Allocate the tasks up front, so that creating tasks does not allocate while frames are processed
+    for (uint32_t index = 0; index < SCHEDULER_POOL_CAPACITY; index++)
+    {
+        this->task_pool.push(new SchedulerTask);
+    }
+
+    for (uint32_t thread_index = 0; thread_index < thread_count; thread_index++)
+    {
+        this->queues.push_back(new SchedulerQueue);
+    }
+
+    for (uint32_t thread_index = 0; thread_index < thread_count; thread_index++)
+    {
+        std::vector<uint32_t> steal_order;
+        uint32_t thread_node = thread_placement->get_worker_node(thread_index);
+
+        //Prefer the threads of the same node and otherwise keep the order of the neighbouring threads
+        for (uint32_t offset = 1; offset < thread_count; offset++)
+        {
+            steal_order.push_back((thread_index + offset) % thread_count);
+        }
+
+        std::stable_sort(steal_order.begin(), steal_order.end(), [=](uint32_t first, uint32_t second)
+        {
+            return (thread_placement->get_worker_node(first) == thread_node) > (thread_placement->get_worker_node(second) == thread_node);
+        });
+
+        this->steal_orders.push_back(steal_order);
+    }
+
+    for (uint32_t thread_index = 0; thread_index < thread_count; thread_index++)
+    {
+        std::thread thread = std::thread([this, thread_placement, thread_index]()
+        {
+            this->worker(thread_placement, thread_index);
+        });
+
+        this->threads.push_back(std::move(thread));
+    }
+
+    return true;
+}
+
+void Scheduler::destroy()
+{
+    std::unique_lock<std::mutex> sleep_lock(this->sleep_mutex);
+    this->active = false;
+    this->sleep_condition.notify_all();
+    sleep_lock.unlock();
+
+    for (std::thread& thread : this->threads)
+    {
+        thread.join();
+    }
+
+    for (SchedulerQueue* queue : this->queues)
+    {
+        delete queue;
+    }
+
+    SchedulerTask* task = nullptr;
+
+    while (this->task_pool.pop(task))
+    {
+        delete task;
+    }
+
+    this->threads.clear();
+    this->queues.clear();
+    this->steal_orders.clear();
+    this->external_queue.destroy();
+    this->task_pool.destroy();
+}
+
+SchedulerTask* Scheduler::create_task(std::function<void()> function)
+{
+    SchedulerTask* task = nullptr;
+
+    if (!this->task_pool.pop(task))
+    {
+        task = new SchedulerTask;
+    }
+
+    task->function = std::move(function);
+    task->dependency_count = 1; //Hold the task back until it is submitted
+
+    return task;
+}
+
+void Scheduler::add_dependency(SchedulerTask* task, SchedulerTask* dependency)
+{
+    task->dependency_count++;
+    dependency->successors.push_back(task);
+}
+
+void Scheduler::submit(SchedulerTask* task)
+{
+    this->release(task);
+}
+
+void Scheduler::run_parallel(uint32_t part_count, const std::function<void(uint32_t part)>& function)
+{
+    struct ParallelState
+    {
+        const std::function<void(uint32_t part)>* function = nullptr;
+        std::atomic<uint32_t> remaining_count = 0;
+    };
+
+    ParallelState state;
+    state.function = &function;
+
+    //Capture a single pointer to the state, so that the function of each task does not need to be allocated
+    ParallelState* state_pointer = &state;
+
+    for (uint32_t part = 1; part < part_count; part++)
+    {
+        state.remaining_count++;
+
+        SchedulerTask* task = this->create_task([state_pointer, part]()
+        {
+            (*state_pointer->function)(part);
+
+            state_pointer->remaining_count--;
+        });
+
+        this->submit(task);
+    }
+
+    function(0);
+
+    //Don't block the thread while waiting, since the remaining parts could be queued behind the task that called this function
+    while (state.remaining_count > 0)
+    {
+        SchedulerTask* task = nullptr;
+
+        if (current_scheduler == this)
+        {
+            task = this->find_task(current_thread_index);
+        }
+
+        if (task != nullptr)
+        {
+            this->execute(task);
+        }
+
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+uint32_t Scheduler::get_thread_count() const
+{
+    return this->threads.size();
+}
+
+void Scheduler::worker(ThreadPlacement* thread_placement, uint32_t thread_index)
+{
+    thread_placement->place_thread(THREAD_ROLE_WORKER, "Worker " + std::to_string(thread_index), thread_index);
+
+    current_scheduler = this;
+    current_thread_index = thread_index;
+
+    while (true)
+    {
+        SchedulerTask* task = this->find_task(thread_index);
+
+        if (task != nullptr)
+        {
+            this->execute(task);
+
+            continue;
+        }
+
+        //Announce that the thread wants to sleep before checking for ready tasks, so that either this thread sees the task or the releasing thread sees the sleeping thread
+        std::unique_lock<std::mutex> sleep_lock(this->sleep_mutex);
+        this->sleep_count++;
+
+        if (this->ready_count > 0)
+        {
+            this->sleep_count--;
+
+            continue;
+        }
+
+        if (!this->active)
+        {
+            this->sleep_count--;
+
+            break;
+        }
+
+        this->sleep_condition.wait(sleep_lock);
+        this->sleep_count--;
+    }
+
+    current_scheduler = nullptr;
+
+    thread_placement->remove_thread();
+}
+
+void Scheduler::execute(SchedulerTask* task)
+{
+    task->function();
+
+    for (SchedulerTask* successor : task->successors)
+    {
+        this->release(successor);
+    }
+
+    task->function = nullptr;
+    task->successors.clear();
+
+    if (!this->task_pool.push(task))
+    {
+        delete task;
+    }
+}
+
+void Scheduler::release(SchedulerTask* task)
+{
+    if (--task->dependency_count > 0)
+    {
+        return;
+    }
+
+    this->ready_count++;
+
+    //Keep tasks that become ready on a scheduler thread local to that thread so that they are executed while the data is still in the cache
+    bool pushed = false;
+
+    if (current_scheduler == this)
+    {
+        pushed = this->queues[current_thread_index]->push(task);
+    }
+
+    while (!pushed)
+    {
+        pushed = this->external_queue.push(task);
+
+        if (!pushed)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    if (this->sleep_count > 0)
+    {
+        std::unique_lock<std::mutex> sleep_lock(this->sleep_mutex);
+        this->sleep_condition.notify_one();
+    }
+}
+
+SchedulerTask* Scheduler::find_task(uint32_t thread_index)
+{
+    SchedulerTask* task = this->queues[thread_index]->pop();
+
+    if (task == nullptr)
+    {
+        this->external_queue.pop(task);
+    }
+
+    for (uint32_t index = 0; index < this->steal_orders[thread_index].size() && task == nullptr; index++)
+    {
+        task = this->queues[this->steal_orders[thread_index][index]]->steal();
+    }
+
+    if (task != nullptr)
+    {
+        this->ready_count--;
+    }
+
+    return task;
+}
\ No newline at end of file
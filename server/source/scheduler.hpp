@@ -0,0 +1,96 @@
+#ifndef HEADER_SCHEDULER
+#define HEADER_SCHEDULER
+
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <vector>
+
+#include "ring_queue.hpp"
+#include "thread_placement.hpp"
+
+#define SCHEDULER_THREAD_COUNT        0    // Number of threads used by the scheduler. If zero, one thread for each core that is available to worker threads is used.
+#define SCHEDULER_QUEUE_CAPACITY      1024 // Maximum number of ready tasks in the queue of each thread
+#define SCHEDULER_POOL_CAPACITY       1024 // Maximum number of unused tasks that are kept for reuse. The pool is filled when the scheduler is created.
+#define SCHEDULER_SUCCESSOR_CAPACITY  8    // Number of successors for which each task reserves memory when it is allocated
+
+class SchedulerTask
+{
+private:
+    std::function<void()> function;
+    std::vector<SchedulerTask*> successors;
+    std::atomic<uint32_t> dependency_count = 0;
+
+public:
+    SchedulerTask();
+
+    friend class Scheduler;
+};
+
+// Lock-free work-stealing deque of ready tasks with a fixed capacity.
+// Only the owning thread pushes and pops at the bottom, while all other threads steal from the top.
+class SchedulerQueue
+{
+private:
+    std::unique_ptr<std::atomic<SchedulerTask*>[]> tasks;
+
+    alignas(64) std::atomic<int64_t> top = 0;
+    alignas(64) std::atomic<int64_t> bottom = 0;
+
+public:
+    SchedulerQueue();
+
+    bool push(SchedulerTask* task); // Returns false if the queue is full
+    SchedulerTask* pop();
+    SchedulerTask* steal();
+};
+
+// Work-stealing task scheduler with one task queue per thread.
+// Tasks can depend on other tasks and are only executed once all of their dependencies are complete.
+// Idle threads steal from threads on the same NUMA node first, so that the data of a task tends to stay on the node that created it.
+class Scheduler
+{
+private:
+    std::vector<std::thread> threads;
+    std::vector<SchedulerQueue*> queues;
+    std::vector<std::vector<uint32_t>> steal_orders; // Order in which each thread tries to steal from the other threads
+    RingQueue<SchedulerTask*> external_queue; // Queue for tasks that become ready on a thread that does not belong to the scheduler or when the queue of the thread is full
+    RingQueue<SchedulerTask*> task_pool;
+
+    std::mutex sleep_mutex; // Only used when threads go to sleep or need to be woken up
+    std::condition_variable sleep_condition;
+    std::atomic<uint32_t> ready_count = 0;
+    std::atomic<uint32_t> sleep_count = 0;
+    std::atomic<bool> active = false;
+
+public:
+    Scheduler() = default;
+
+    bool create(ThreadPlacement* thread_placement, uint32_t thread_count = SCHEDULER_THREAD_COUNT);
+    // Executes all tasks that are already submitted and stops the threads
+    void destroy();
+
+    // The returned task is not executed before it is submitted. All dependencies of a task have to be added before the task or the dependency is submitted.
+    // The function is stored without an allocation if its captures are not larger than two pointers.
+    SchedulerTask* create_task(std::function<void()> function);
+    void add_dependency(SchedulerTask* task, SchedulerTask* dependency);
+    void submit(SchedulerTask* task);
+
+    // Calls function(part) for each part as a separate task and returns once all parts are complete.
+    // The calling thread executes the first part and, if it belongs to the scheduler, other ready tasks while it waits, so that it can be used inside of a task.
+    void run_parallel(uint32_t part_count, const std::function<void(uint32_t part)>& function);
+
+    uint32_t get_thread_count() const;
+
+private:
+    void worker(ThreadPlacement* thread_placement, uint32_t thread_index);
+
+    void execute(SchedulerTask* task);
+    void release(SchedulerTask* task);
+    SchedulerTask* find_task(uint32_t thread_index);
+};
+
+#endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <boost/json.hpp>
 #include <spdlog/spdlog.h>
 #include <App.h>
+#include <layer_response_codec.hpp>
 #include <filesystem>
 #include <fstream>
 
@@ -18,12 +19,14 @@ Server::~Server()
     this->destroy();
 }
 
-bool Server::create(uint32_t port)
+bool Server::create(ThreadPlacement* thread_placement, uint32_t connection_limit, uint32_t port)
 {
+    this->connection_limit = connection_limit;
+
     std::promise<uWS::Loop*> loop_promise;
     std::future<uWS::Loop*> loop_future = loop_promise.get_future();
 
-    this->thread = std::thread(&Server::worker, this, port, std::move(loop_promise));
+    this->thread = std::thread(&Server::worker, this, thread_placement, port, std::move(loop_promise));
     this->loop = loop_future.get();
 
     return true;
@@ -35,10 +38,17 @@ void Server::destroy()
     {
         this->loop->defer([this]()
         {
-            if (this->web_socket != nullptr)
+            //Closing a socket removes it from the connections
+            std::vector<WebSocket*> sockets;
+
+            for (const auto& [connection, connection_state] : this->connections)
+            {
+                sockets.push_back(connection_state.socket);
+            }
+
+            for (WebSocket* socket : sockets)
             {
-                this->web_socket->close();
-                this->web_socket = nullptr;
+                socket->close();
             }
 
             if (this->listen_socket != nullptr)
@@ -65,24 +75,32 @@ void Server::destroy()
     this->layer_data_pool.clear();
 }
 
-LayerData* Server::allocate_layer_data()
+LayerData* Server::allocate_layer_data(uint32_t connection, uint32_t layer_index)
 {
     std::unique_lock<std::mutex> lock(this->layer_data_mutex);
     LayerData* layer_data = nullptr;
 
-    if (this->layer_data_pool.empty())
+    if (layer_index >= this->layer_data_pool.size())
+    {
+        this->layer_data_pool.resize(layer_index + 1);
+    }
+
+    if (this->layer_data_pool[layer_index].empty())
     {
         layer_data = new LayerData;
+        layer_data->layer_index = layer_index;
 
         this->layer_data_list.push_back(layer_data);
     }
 
     else
     {
-        layer_data = this->layer_data_pool.back();
-        this->layer_data_pool.pop_back();
+        layer_data = this->layer_data_pool[layer_index].back();
+        this->layer_data_pool[layer_index].pop_back();
     }
 
+    layer_data->connection = connection;
+
     return layer_data;
 }
 
@@ -97,52 +115,105 @@ void Server::submit_layer_data(LayerData* layer_data)
 
     this->loop->defer([this, layer_data]
     {
-        uint32_t buffer_size = sizeof(shared::LayerResponsePacket);
-        buffer_size += layer_data->geometry.size();
-        buffer_size += layer_data->image.size();
+        //The connection could have been closed while the layer was processed. Since only this thread modifies the connections, the socket can be used without holding the lock.
+        if (this->connections.contains(layer_data->connection))
+        {
+            shared::LayerResponsePacket packet;
+            packet.type = shared::PACKET_TYPE_LAYER_RESPONSE;
+            packet.request_id = layer_data->request_id;
+            packet.layer_index = layer_data->layer_index;
+            packet.view_count = layer_data->view_count;
+            packet.mesh_generator = layer_data->mesh_generator;
+            packet.view_metadata_enabled = layer_data->view_metadata_enabled;
+            packet.geometry_bytes = layer_data->geometry.size();
+            packet.image_bytes = layer_data->image.size();
+            packet.geometry_dropped = layer_data->geometry_dropped;
+            packet.dropped_frames = layer_data->dropped_frames;
+
+            packet.view_metadata = layer_data->view_metadata;
+            packet.view_matrices = layer_data->view_matrices;
+
+            for (uint32_t index = 0; index < SHARED_VIEW_COUNT_MAX; index++)
+            {
+                packet.vertex_counts[index] = layer_data->vertex_views[index].size();
+                packet.index_counts[index] = layer_data->index_views[index].size();
+            }
 
-        this->send_buffer.resize(buffer_size);
+            std::string_view geometry_view = std::string_view((const char*)layer_data->geometry.data(), layer_data->geometry.size());
+            std::string_view image_view = std::string_view((const char*)layer_data->image.data(), layer_data->image.size());
 
-        shared::LayerResponsePacket* packet = (shared::LayerResponsePacket*)this->send_buffer.data();
-        packet->type = shared::PACKET_TYPE_LAYER_RESPONSE;
-        packet->request_id = layer_data->request_id;
-        packet->layer_index = layer_data->layer_index;
-        packet->geometry_bytes = layer_data->geometry.size();
-        packet->image_bytes = layer_data->image.size();
+            WebSocket* socket = this->connections[layer_data->connection].socket;
 
-        packet->view_metadata = layer_data->view_metadata;
-        packet->view_matrices = layer_data->view_matrices;
+            //Send the image before the geometry, so that the client can already decode the image while the geometry is still in transit
+            if (layer_data->split_response && !layer_data->geometry_dropped)
+            {
+                packet.geometry_omitted = true;
 
-        for (uint32_t index = 0; index < SHARED_VIEW_COUNT_MAX; index++)
-        {
-            packet->vertex_counts[index] = layer_data->vertices[index].size();
-            packet->index_counts[index] = layer_data->indices[index].size();
-        }
+                //Check the space for both messages before the first one is sent, so that the layer is either sent completely or not at all. Both headers have the same size.
+                shared::LayerResponseCodec::encode(packet, this->header_buffer);
+                uint64_t response_bytes = 2 * (this->header_buffer.size() + 3 * SERVER_FRAME_HEADER_BYTES) + geometry_view.size() + image_view.size();
 
-        uint8_t* geometry_pointer = this->send_buffer.data() + sizeof(shared::LayerResponsePacket);
-        uint8_t* image_pointer = geometry_pointer + layer_data->geometry.size();
+                if (this->check_backpressure(socket, response_bytes) && this->send_layer_response(socket, packet, {}, image_view))
+                {
+                    packet.geometry_omitted = false;
+                    packet.image_omitted = true;
+                    this->send_layer_response(socket, packet, geometry_view, {});
+                }
+            }
 
-        memcpy(geometry_pointer, layer_data->geometry.data(), layer_data->geometry.size());
-        memcpy(image_pointer, layer_data->image.data(), layer_data->image.size());
+            else
+            {
+                this->send_layer_response(socket, packet, geometry_view, image_view);
+            }
 
-        std::string_view packet_view = std::string_view((const char*)this->send_buffer.data(), this->send_buffer.size());
+            std::unique_lock<std::mutex> lock(this->connection_mutex);
 
-        if (this->web_socket != nullptr)
-        {
-            this->web_socket->send(packet_view);
+            if (this->connections.contains(layer_data->connection))
+            {
+                this->connections[layer_data->connection].buffered_amount = socket->getBufferedAmount();
+            }
         }
 
-        for (uint32_t index = 0; index < SHARED_VIEW_COUNT_MAX; index++)
-        {
-            layer_data->vertices[index].clear();
-            layer_data->indices[index].clear();
-        }
+        this->release_layer_data(layer_data);
+    });
+}
+
+void Server::release_layer_data(LayerData* layer_data)
+{
+    //Reset everything that the worker only writes if the frame is not stale, since the layer data is reused for later frames
+    for (uint32_t index = 0; index < SHARED_VIEW_COUNT_MAX; index++)
+    {
+        layer_data->vertices[index].clear();
+        layer_data->indices[index].clear();
+        layer_data->vertex_views[index] = {};
+        layer_data->index_views[index] = {};
+        layer_data->view_metadata[index] = shared::ViewMetadata();
+    }
+
+    layer_data->geometry.clear();
+    layer_data->image.clear();
+    layer_data->geometry_dropped = false;
+
+    std::unique_lock<std::mutex> lock(this->layer_data_mutex);
+    this->layer_data_pool[layer_data->layer_index].push_back(layer_data);
+}
+
+void Server::close_connection(uint32_t connection)
+{
+    if (this->loop == nullptr)
+    {
+        spdlog::error("Server: Can't close connection since server is not running!");
 
-        layer_data->geometry.clear();
-        layer_data->image.clear();
+        return;
+    }
 
-        std::unique_lock<std::mutex> lock(this->layer_data_mutex);
-        this->layer_data_pool.push_back(layer_data);
+    this->loop->defer([this, connection]
+    {
+        //The connection could have been closed already. Since only this thread modifies the connections, the socket can be used without holding the lock.
+        if (this->connections.contains(connection))
+        {
+            this->connections[connection].socket->close();
+        }
     });
 }
 
@@ -191,14 +262,28 @@ const std::string& Server::get_study_directory() const
     return this->study_directory;
 }
 
-void Server::worker(uint32_t port, std::promise<uWS::Loop*> loop_promise)
+uint32_t Server::get_buffered_amount(uint32_t connection)
+{
+    std::unique_lock<std::mutex> lock(this->connection_mutex);
+
+    if (!this->connections.contains(connection))
+    {
+        return 0;
+    }
+
+    return this->connections[connection].buffered_amount;
+}
+
+void Server::worker(ThreadPlacement* thread_placement, uint32_t port, std::promise<uWS::Loop*> loop_promise)
 {
+    thread_placement->place_thread(THREAD_ROLE_NETWORK, "Network");
     loop_promise.set_value(uWS::Loop::get());
 
-    uWS::App::WebSocketBehavior<uint8_t> behaviour;
-    behaviour.maxBackpressure = 100 * 1024 * 1024;
+    uWS::App::WebSocketBehavior<ServerSocketData> behaviour;
+    behaviour.maxBackpressure = SERVER_MAX_BACKPRESSURE;
     behaviour.upgrade = std::bind_front(&Server::process_upgrade, this);
     behaviour.open = std::bind_front(&Server::process_open, this);
+    behaviour.drain = std::bind_front(&Server::process_drain, this);
     behaviour.message = std::bind_front(&Server::process_message, this);
     behaviour.close = std::bind_front(&Server::process_close, this);
 
@@ -209,6 +294,8 @@ void Server::worker(uint32_t port, std::promise<uWS::Loop*> loop_promise)
         .ws("/*", std::move(behaviour))
         .listen(port, std::bind_front(&Server::process_listen, this, port))
         .run();
+
+    thread_placement->remove_thread();
 }
 
 void Server::process_listen(uint32_t port, ListenSocket* socket)
@@ -220,9 +307,10 @@ void Server::process_listen(uint32_t port, ListenSocket* socket)
 
 void Server::process_upgrade(HttpResponse* response, HttpRequest* request, SocketContext* context)
 {
-    if (this->web_socket != nullptr)
+    //The upgrade opens the socket immediately, so that the number of connections is always up to date
+    if (this->connections.size() >= this->connection_limit)
     {
-        spdlog::error("Server: Already connected!");
+        spdlog::error("Server: Connection limit of {} reached!", this->connection_limit);
         response->writeStatus("529 Site is overloaded")->end();
         return;
     }
@@ -231,19 +319,34 @@ void Server::process_upgrade(HttpResponse* response, HttpRequest* request, Socke
     std::string_view websocket_protocol = request->getHeader("sec-websocket-protocol");
     std::string_view websocket_extensions = request->getHeader("sec-websocket-extensions");
 
-    response->upgrade<uint8_t>(0, websocket_key, websocket_protocol, websocket_extensions, context);
+    ServerSocketData socket_data;
+    socket_data.connection = this->connection_counter++;
+
+    response->upgrade<ServerSocketData>(std::move(socket_data), websocket_key, websocket_protocol, websocket_extensions, context);
 }
 
 void Server::process_open(WebSocket* socket)
 {
-    if (this->web_socket != nullptr)
-    {
-        spdlog::error("Server: Already connected!");
+    uint32_t connection = socket->getUserData()->connection;
 
-        return;
-    }
+    std::unique_lock<std::mutex> lock(this->connection_mutex);
+    this->connections[connection].socket = socket;
+    this->connections[connection].buffered_amount = 0;
+    lock.unlock();
+
+    spdlog::info("Server: Connection {} opened", connection);
+}
+
+void Server::process_drain(WebSocket* socket)
+{
+    uint32_t connection = socket->getUserData()->connection;
 
-    this->web_socket = socket;
+    std::unique_lock<std::mutex> lock(this->connection_mutex);
+
+    if (this->connections.contains(connection))
+    {
+        this->connections[connection].buffered_amount = socket->getBufferedAmount();
+    }
 }
 
 void Server::process_message(WebSocket* socket, std::string_view message, uWS::OpCode opcode)
@@ -263,35 +366,36 @@ void Server::process_message(WebSocket* socket, std::string_view message, uWS::O
     }
 
     shared::PacketType type = *(shared::PacketType*)message.data();
+    uint32_t connection = socket->getUserData()->connection;
 
     switch (type)
     {
     case shared::PACKET_TYPE_SESSION_CREATE:
-        if (!Server::parse_packet(message, this->on_session_create))
+        if (!Server::parse_packet(connection, message, this->on_session_create))
         {
             spdlog::error("Server: Can't parse session create packet!");
         }
         break;
     case shared::PACKET_TYPE_SESSION_DESTROY:
-        if (!Server::parse_packet(message, this->on_session_destroy))
+        if (!Server::parse_packet(connection, message, this->on_session_destroy))
         {
             spdlog::error("Server: Can't parse session destroy packet!");
         }
         break;
     case shared::PACKET_TYPE_RENDER_REQUEST:
-        if (!Server::parse_packet(message, this->on_render_request))
+        if (!Server::parse_packet(connection, message, this->on_render_request))
         {
             spdlog::error("Server: Can't parse render request packet!");
         }
         break;
     case shared::PACKET_TYPE_MESH_SETTINGS:
-        if (!Server::parse_packet(message, this->on_mesh_settings_change))
+        if (!Server::parse_packet(connection, message, this->on_mesh_settings_change))
         {
             spdlog::error("Server: Can't parse mesh settings packet!");
         }
         break;
     case shared::PACKET_TYPE_VIDEO_SETTINGS:
-        if (!Server::parse_packet(message, this->on_video_settings_change))
+        if (!Server::parse_packet(connection, message, this->on_video_settings_change))
         {
             spdlog::error("Server: Can't parse video settings packet!");
         }
@@ -304,14 +408,21 @@ void Server::process_message(WebSocket* socket, std::string_view message, uWS::O
 
 void Server::process_close(WebSocket* socket, int code, std::string_view message)
 {
-    if (socket != this->web_socket)
+    uint32_t connection = socket->getUserData()->connection;
+
+    std::unique_lock<std::mutex> connection_lock(this->connection_mutex);
+
+    if (!this->connections.contains(connection))
     {
         spdlog::error("Server: Invalid socket!");
 
         return;
     }
 
-    this->web_socket = nullptr;
+    this->connections.erase(connection);
+    connection_lock.unlock();
+
+    spdlog::info("Server: Connection {} closed", connection);
 
     std::unique_lock<std::mutex> lock(this->callback_mutex);
 
@@ -325,7 +436,57 @@ void Server::process_close(WebSocket* socket, int code, std::string_view message
     shared::SessionDestroyPacket packet;
     packet.type = shared::PACKET_TYPE_SESSION_DESTROY;
 
-    this->on_session_destroy(packet);
+    this->on_session_destroy(connection, packet);
+}
+
+bool Server::send_layer_response(WebSocket* socket, const shared::LayerResponsePacket& packet, std::string_view geometry, std::string_view image)
+{
+    shared::LayerResponseCodec::encode(packet, this->header_buffer);
+
+    std::string_view packet_view = std::string_view((const char*)this->header_buffer.data(), this->header_buffer.size());
+
+    //The socket drops every fragment that exceeds the backpressure limit. Only start the message if all fragments fit, since a message that is missing its last fragment would corrupt the websocket stream.
+    uint64_t message_bytes = packet_view.size() + geometry.size() + image.size() + 3 * SERVER_FRAME_HEADER_BYTES;
+
+    if (!this->check_backpressure(socket, message_bytes))
+    {
+        return false;
+    }
+
+    bool dropped = false;
+
+    //Send the header, the geometry and the image as fragments of a single message, so that the buffers of the layer data are written to the socket directly instead of being assembled in a separate buffer first.
+    //The socket is corked, so that small fragments are combined into a single write.
+    socket->cork([&]()
+    {
+        dropped |= socket->sendFirstFragment(packet_view, uWS::OpCode::BINARY) == WebSocket::DROPPED;
+        dropped |= socket->sendFragment(geometry) == WebSocket::DROPPED;
+        dropped |= socket->sendLastFragment(image) == WebSocket::DROPPED;
+    });
+
+    //The stream can't be recovered once a fragment of a started message is missing
+    if (dropped)
+    {
+        spdlog::error("Server: Fragment of layer response dropped! Closing connection {}", socket->getUserData()->connection);
+
+        socket->close();
+
+        return false;
+    }
+
+    return true;
+}
+
+bool Server::check_backpressure(WebSocket* socket, uint64_t message_bytes)
+{
+    if (socket->getBufferedAmount() + message_bytes > SERVER_MAX_BACKPRESSURE)
+    {
+        spdlog::error("Server: Can't send layer response since the send queue of the socket is full!");
+
+        return false;
+    }
+
+    return true;
 }
 
 void Server::process_get_scenes(HttpResponse* response, HttpRequest* request)
@@ -548,7 +709,7 @@ void Server::process_post_files(HttpResponse* response, HttpRequest* request)
 }
 
 template<class PacketType>
-bool Server::parse_packet(const std::string_view& message, std::function<void(const PacketType& packet)>& callback)
+bool Server::parse_packet(uint32_t connection, const std::string_view& message, std::function<void(uint32_t connection, const PacketType& packet)>& callback)
 {
     std::unique_lock<std::mutex> lock(this->callback_mutex);
 
@@ -566,7 +727,7 @@ bool Server::parse_packet(const std::string_view& message, std::function<void(co
         return false;
     }
 
-    callback(*(PacketType*)message.data());
+    callback(connection, *(PacketType*)message.data());
 
     return true;
 }
\ No newline at end of file
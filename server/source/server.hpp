@@ -7,34 +7,60 @@
 
 #include <functional>
 #include <thread>
+#include <map>
+#include <atomic>
 #include <mutex>
 #include <future>
+#include <span>
+
+#include "thread_placement.hpp"
+
+#define SERVER_MAX_BACKPRESSURE    (100 * 1024 * 1024) // Number of bytes that can be queued on a socket before further messages are dropped by the socket
+#define SERVER_FRAME_HEADER_BYTES  10                  // Maximum size of the header of an unmasked websocket frame
 
 struct LayerData
 {
+    uint32_t connection = 0; // Connection to which the layer data is sent
     uint32_t request_id = 0;
     uint32_t layer_index = 0;
+    uint32_t view_count = 0;
+    shared::MeshGeneratorType mesh_generator = shared::MESH_GENERATOR_TYPE_QUAD; // Mesh generator that produced the view metadata
+    bool view_metadata_enabled = true;                                          // Set if the view metadata is sent to the client
+    bool split_response = false;                                                // Set if the image and the geometry are sent as separate messages
+    bool geometry_dropped = false;
+    uint32_t dropped_frames = 0;
     
     std::array<shared::ViewMetadata, SHARED_VIEW_COUNT_MAX> view_metadata;
     std::array<shared::Matrix, SHARED_VIEW_COUNT_MAX> view_matrices;
 
-    std::array<std::vector<shared::Vertex>, SHARED_VIEW_COUNT_MAX> vertices;
+    std::array<std::vector<shared::Vertex>, SHARED_VIEW_COUNT_MAX> vertices; // Storage for mesh generators that can't provide their mesh in place
     std::array<std::vector<shared::Index>, SHARED_VIEW_COUNT_MAX> indices;
 
+    // Mesh of each view. Either points into vertices and indices or directly into the mapped output of the mesh generator.
+    // The data behind the views is only valid until the layer data is submitted to the server.
+    std::array<std::span<const shared::Vertex>, SHARED_VIEW_COUNT_MAX> vertex_views;
+    std::array<std::span<const shared::Index>, SHARED_VIEW_COUNT_MAX> index_views;
+
     std::vector<uint8_t> geometry;
     std::vector<uint8_t> image;
 };
 
+struct ServerSocketData
+{
+    uint32_t connection = 0;
+};
+
+// Each websocket connection is identified by a unique id, which is passed to the callbacks together with the packets of the connection
 class Server
 {
 public:
-    typedef std::function<void (const shared::SessionCreatePacket& packet)> OnSessionCreate;
-    typedef std::function<void (const shared::SessionDestroyPacket& packet)> OnSessionDestroy;
-    typedef std::function<void (const shared::RenderRequestPacket& packet)> OnRenderRequest;
-    typedef std::function<void (const shared::MeshSettingsPacket& packet)> OnMeshSettingsChange;
-    typedef std::function<void (const shared::VideoSettingsPacket& packet)> OnVideoSettingsChange;
+    typedef std::function<void (uint32_t connection, const shared::SessionCreatePacket& packet)> OnSessionCreate;
+    typedef std::function<void (uint32_t connection, const shared::SessionDestroyPacket& packet)> OnSessionDestroy;
+    typedef std::function<void (uint32_t connection, const shared::RenderRequestPacket& packet)> OnRenderRequest;
+    typedef std::function<void (uint32_t connection, const shared::MeshSettingsPacket& packet)> OnMeshSettingsChange;
+    typedef std::function<void (uint32_t connection, const shared::VideoSettingsPacket& packet)> OnVideoSettingsChange;
 
-    typedef uWS::WebSocket<false, true, uint8_t> WebSocket;
+    typedef uWS::WebSocket<false, true, ServerSocketData> WebSocket;
     typedef uWS::HttpResponse<false> HttpResponse;
     typedef uWS::HttpRequest HttpRequest;
 
@@ -42,14 +68,24 @@ public:
     typedef us_socket_context_t SocketContext;
 
 private:
+    struct Connection
+    {
+        WebSocket* socket = nullptr;
+        uint32_t buffered_amount = 0; // Number of bytes that the socket could not send yet
+    };
+
     const std::string scene_directory = "./scene";
     const std::string study_directory = "./study";
 
     std::thread thread;
     uWS::Loop* loop = nullptr;             // Owned by main thread
-    WebSocket* web_socket = nullptr;       // Owned by thread
     ListenSocket* listen_socket = nullptr; // Owned by thread
-    std::vector<uint8_t> send_buffer;      // Owned by thread
+    std::vector<uint8_t> header_buffer;    // Owned by thread
+    uint32_t connection_limit = 0;
+    uint32_t connection_counter = 0;       // Owned by thread. Used to assign a unique id to each connection
+
+    std::mutex connection_mutex;
+    std::map<uint32_t, Connection> connections; // Protected by connection_mutex. Only modified by thread
 
     std::mutex callback_mutex;
     OnSessionCreate on_session_create;              // Protected by callback_mutex
@@ -60,17 +96,21 @@ private:
 
     std::mutex layer_data_mutex;
     std::vector<LayerData*> layer_data_list; // Protected by layer_data_mutex
-    std::vector<LayerData*> layer_data_pool; // Protected by layer_data_mutex
+    std::vector<std::vector<LayerData*>> layer_data_pool; // Protected by layer_data_mutex. Separate pool for each layer index, so that the capacity of the buffers fits the size of the layer
 
 public:
     Server(std::string scene_directory, std::string study_directory);
     ~Server();
 
-    bool create(uint32_t port = 9000);
+    // Connections beyond the connection limit are rejected
+    bool create(ThreadPlacement* thread_placement, uint32_t connection_limit, uint32_t port = 9000);
     void destroy();
 
-    LayerData* allocate_layer_data();
+    LayerData* allocate_layer_data(uint32_t connection, uint32_t layer_index);
     void submit_layer_data(LayerData* layer_data);
+    void release_layer_data(LayerData* layer_data); // Returns the layer data to the pool without sending it
+
+    void close_connection(uint32_t connection); // Closes the connection asynchronously. The session destroy callback is called once it is closed.
 
     void set_on_session_create(OnSessionCreate callback);
     void set_on_session_destroy(OnSessionDestroy callback);
@@ -81,21 +121,28 @@ public:
     const std::string& get_scene_directory() const;
     const std::string& get_study_directory() const;
 
+    // Can be used by other threads to check if the connection is saturated. Returns zero for connections that are already closed.
+    uint32_t get_buffered_amount(uint32_t connection);
+
 private:
-    void worker(uint32_t port, std::promise<uWS::Loop*> loop_promise);
+    void worker(ThreadPlacement* thread_placement, uint32_t port, std::promise<uWS::Loop*> loop_promise);
 
     void process_listen(uint32_t port, ListenSocket* socket);
     void process_upgrade(HttpResponse* response, HttpRequest* request, SocketContext* context);
     void process_open(WebSocket* socket);
+    void process_drain(WebSocket* socket);
     void process_message(WebSocket* socket, std::string_view message, uWS::OpCode opcode);
     void process_close(WebSocket* socket, int code, std::string_view message);
 
+    bool send_layer_response(WebSocket* socket, const shared::LayerResponsePacket& packet, std::string_view geometry, std::string_view image); // Returns false if the message could not be sent
+    bool check_backpressure(WebSocket* socket, uint64_t message_bytes); // Returns false if the given number of bytes does not fit into the send queue of the socket
+
     void process_get_scenes(HttpResponse* response, HttpRequest* request);
     void process_get_files(HttpResponse* response, HttpRequest* request);
     void process_post_files(HttpResponse* response, HttpRequest* request);
     
     template<class PacketType>
-    bool parse_packet(const std::string_view& message, std::function<void(const PacketType& packet)>& callback);
+    bool parse_packet(uint32_t connection, const std::string_view& message, std::function<void(uint32_t connection, const PacketType& packet)>& callback);
 };
 
 #endif
\ No newline at end of file
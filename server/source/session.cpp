@@ -1,8 +1,28 @@
 #include "session.hpp"
 
-bool Session::create(Server* server, MeshGeneratorType mesh_generator_type, EncoderCodec codec, const glm::uvec2& resolution, uint32_t layer_count, uint32_t view_count, bool chroma_subsampling, bool export_enabled)
+bool Session::create(Server* server, uint32_t connection, ThreadPlacement* thread_placement, Scheduler* scheduler, MeshGeneratorType mesh_generator_type, EncoderCodec codec, const glm::uvec2& resolution, uint32_t layer_count, uint32_t view_count, bool chroma_subsampling, bool export_enabled, bool drop_stale_frames, float latency_budget, bool view_metadata_enabled, bool split_response)
 {
-    if (!this->worker_pool.create(server, view_count, export_enabled))
+    //The reference implementations produce the same view metadata as the mesh generators they replace
+    shared::MeshGeneratorType metadata_type = shared::MESH_GENERATOR_TYPE_QUAD;
+
+    switch (mesh_generator_type)
+    {
+    case MESH_GENERATOR_TYPE_QUAD_BASED:
+    case MESH_GENERATOR_TYPE_QUAD_REFERENCE:
+        metadata_type = shared::MESH_GENERATOR_TYPE_QUAD;
+        break;
+    case MESH_GENERATOR_TYPE_LINE_BASED:
+        metadata_type = shared::MESH_GENERATOR_TYPE_LINE;
+        break;
+    case MESH_GENERATOR_TYPE_LOOP_BASED:
+    case MESH_GENERATOR_TYPE_LOOP_REFERENCE:
+        metadata_type = shared::MESH_GENERATOR_TYPE_LOOP;
+        break;
+    default:
+        break;
+    }
+
+    if (!this->worker_pool.create(server, connection, thread_placement, scheduler, metadata_type, view_count, layer_count, SESSION_FRAME_COUNT, export_enabled, drop_stale_frames, latency_budget, view_metadata_enabled, split_response))
     {
         return false;
     }
@@ -35,7 +55,7 @@ bool Session::create(Server* server, MeshGeneratorType mesh_generator_type, Enco
     {
         Encoder* encoder = new Encoder();
 
-        if (!encoder->create(&this->encoder_context, codec, encoder_resolution, chroma_subsampling))
+        if (!encoder->create(&this->encoder_context, thread_placement, codec, encoder_resolution, chroma_subsampling))
         {
             return false;
         }
@@ -63,6 +83,12 @@ bool Session::create(Server* server, MeshGeneratorType mesh_generator_type, Enco
 
 void Session::destroy()
 {
+    //Cancel the encoders and the worker pool before anything else is released, so that the session is closed in bounded time
+    for (Encoder* encoder : this->encoders)
+    {
+        encoder->cancel();
+    }
+
     std::vector<Frame*> aborted_frames;
     this->worker_pool.destroy(aborted_frames);
 
@@ -114,6 +140,7 @@ bool Session::render_frame(const Camera& camera, const Scene& scene, uint32_t re
     }
 
     Frame* previous_layer = nullptr;
+    std::chrono::high_resolution_clock::time_point time_point_request = std::chrono::high_resolution_clock::now();
 
     for (uint32_t layer = 0; layer < this->layer_count; layer++)
     {
@@ -121,6 +148,7 @@ bool Session::render_frame(const Camera& camera, const Scene& scene, uint32_t re
         this->empty_frames[layer].pop_back();
 
         current_layer->request_id = request_id;
+        current_layer->time_point_request = time_point_request;
         current_layer->export_request = export_request;
         current_layer->projection_matrix = camera.get_projection_matrix();
         
@@ -282,10 +310,10 @@ void Session::check_frames()
         }
     }
 
-    std::vector<Frame*> complete_frames;
-    this->worker_pool.reclaim(complete_frames);
+    this->reclaimed_frames.clear();
+    this->worker_pool.reclaim(this->reclaimed_frames);
 
-    for (Frame* frame : complete_frames)
+    for (Frame* frame : this->reclaimed_frames)
     {
         uint32_t layer = frame->layer_index;
 
@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <types.hpp>
 
@@ -53,6 +54,8 @@ struct Frame
     glm::uvec2 resolution = glm::uvec2(0);
     uint32_t request_id = 0;
     uint32_t layer_index = 0;
+
+    std::chrono::high_resolution_clock::time_point time_point_request; // Used to decide if the frame exceeded its latency budget
 };
 
 class Session
@@ -67,6 +70,7 @@ private:
 
     std::vector<std::vector<Frame*>> empty_frames;
     std::vector<std::vector<Frame*>> active_frames;
+    std::vector<Frame*> reclaimed_frames; // Reused for each check, so that reclaiming frames does not allocate
 
     glm::uvec2 resolution = glm::uvec2(0);
     uint32_t layer_count = 0;
@@ -80,7 +84,7 @@ private:
 public:
     Session() = default;
 
-    bool create(Server* server, MeshGeneratorType mesh_generator_type, EncoderCodec codec, const glm::uvec2& resolution, uint32_t layer_count, uint32_t view_count, bool chroma_subsampling, bool export_enabled);
+    bool create(Server* server, uint32_t connection, ThreadPlacement* thread_placement, Scheduler* scheduler, MeshGeneratorType mesh_generator_type, EncoderCodec codec, const glm::uvec2& resolution, uint32_t layer_count, uint32_t view_count, bool chroma_subsampling, bool export_enabled, bool drop_stale_frames, float latency_budget, bool view_metadata_enabled, bool split_response);
     void destroy();
 
     bool render_frame(const Camera& camera, const Scene& scene, uint32_t request_id, ExportRequest& export_request);
@@ -0,0 +1,423 @@
+#include "thread_placement.hpp"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <cctype>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__unix__)
+#include <sched.h>
+#endif
+
+bool ThreadPlacement::create(ThreadPlacementPolicy policy, std::optional<uint32_t> numa_node, float report_interval)
+{
+    this->policy = policy;
+    this->report_interval = report_interval;
+    this->report_last = std::chrono::high_resolution_clock::now();
+
+    if (!this->detect_cores(numa_node))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void ThreadPlacement::destroy()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+#if defined(_WIN32)
+    for (ThreadPlacementEntry& entry : this->entries)
+    {
+        CloseHandle(entry.thread_handle);
+    }
+#endif
+
+    this->entries.clear();
+    this->cores.clear();
+}
+
+void ThreadPlacement::place_thread(ThreadRole role, const std::string& name, uint32_t worker_index)
+{
+    ThreadPlacementEntry entry;
+    entry.thread_id = std::this_thread::get_id();
+    entry.name = name;
+    entry.role = role;
+
+    if (this->policy != THREAD_PLACEMENT_POLICY_NONE && !this->cores.empty())
+    {
+        std::vector<uint32_t> cpus;
+
+        //Allow the encoder and export threads to use every core of the node of the render thread, since they only wait for the gpu or the disk
+        if (role == THREAD_ROLE_ENCODER || role == THREAD_ROLE_EXPORT)
+        {
+            for (const ThreadPlacementCore& core : this->cores)
+            {
+                if (core.node == this->cores.front().node)
+                {
+                    cpus.push_back(core.cpu);
+                }
+            }
+        }
+
+        else
+        {
+            entry.cpu = this->cores[this->get_core_index(role, worker_index).value()].cpu;
+            cpus.push_back(entry.cpu.value());
+        }
+
+        if (!ThreadPlacement::set_affinity(cpus))
+        {
+            spdlog::warn("ThreadPlacement: Can't set affinity of thread {}!", name);
+
+            entry.cpu.reset();
+        }
+    }
+
+#if defined(_WIN32)
+    DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), (HANDLE*)&entry.thread_handle, 0, FALSE, DUPLICATE_SAME_ACCESS);
+#elif defined(__unix__)
+    pthread_getcpuclockid(pthread_self(), &entry.clock_id);
+#endif
+
+    entry.cpu_time_last = ThreadPlacement::get_cpu_time(entry);
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->entries.push_back(entry);
+}
+
+void ThreadPlacement::remove_thread()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    std::thread::id thread_id = std::this_thread::get_id();
+
+    for (uint32_t index = 0; index < this->entries.size(); index++)
+    {
+        if (this->entries[index].thread_id == thread_id)
+        {
+#if defined(_WIN32)
+            CloseHandle(this->entries[index].thread_handle);
+#endif
+            this->entries.erase(this->entries.begin() + index);
+
+            break;
+        }
+    }
+}
+
+void ThreadPlacement::report()
+{
+    if (this->report_interval <= 0.0)
+    {
+        return;
+    }
+
+    std::chrono::high_resolution_clock::time_point report_current = std::chrono::high_resolution_clock::now();
+    double wall_time = std::chrono::duration_cast<std::chrono::duration<double>>(report_current - this->report_last).count();
+
+    if (wall_time < this->report_interval)
+    {
+        return;
+    }
+
+    this->report_last = report_current;
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    for (ThreadPlacementEntry& entry : this->entries)
+    {
+        double cpu_time = ThreadPlacement::get_cpu_time(entry);
+        double utilisation = (cpu_time - entry.cpu_time_last) / wall_time;
+        entry.cpu_time_last = cpu_time;
+
+        std::string cpu = entry.cpu.has_value() ? std::to_string(entry.cpu.value()) : "any";
+
+        spdlog::info("ThreadPlacement: Thread {} on cpu {} utilisation {:.1f}%", entry.name, cpu, utilisation * 100.0);
+    }
+}
+
+uint32_t ThreadPlacement::get_worker_count() const
+{
+    if (this->policy == THREAD_PLACEMENT_POLICY_NONE)
+    {
+        return std::max((uint32_t)this->cores.size(), 1u);
+    }
+
+    if (this->cores.size() <= THREAD_PLACEMENT_RESERVED_COUNT)
+    {
+        return 1;
+    }
+
+    return this->cores.size() - THREAD_PLACEMENT_RESERVED_COUNT;
+}
+
+uint32_t ThreadPlacement::get_worker_node(uint32_t worker_index) const
+{
+    std::optional<uint32_t> core_index = this->get_core_index(THREAD_ROLE_WORKER, worker_index);
+
+    if (this->policy == THREAD_PLACEMENT_POLICY_NONE || !core_index.has_value())
+    {
+        return 0;
+    }
+
+    return this->cores[core_index.value()].node;
+}
+
+bool ThreadPlacement::detect_cores(std::optional<uint32_t> numa_node)
+{
+    std::map<uint32_t, std::vector<uint32_t>> node_cpus;
+
+#if defined(_WIN32)
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask = 0;
+
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+    {
+        spdlog::error("ThreadPlacement: Can't get process affinity!");
+
+        return false;
+    }
+
+    ULONG highest_node = 0;
+    GetNumaHighestNodeNumber(&highest_node);
+
+    for (ULONG node = 0; node <= highest_node; node++)
+    {
+        ULONGLONG node_mask = 0;
+
+        if (!GetNumaNodeProcessorMask((UCHAR)node, &node_mask))
+        {
+            continue;
+        }
+
+        for (uint32_t cpu = 0; cpu < sizeof(DWORD_PTR) * 8; cpu++)
+        {
+            DWORD_PTR cpu_mask = (DWORD_PTR)1 << cpu;
+
+            if ((node_mask & cpu_mask) != 0 && (process_mask & cpu_mask) != 0)
+            {
+                node_cpus[node].push_back(cpu);
+            }
+        }
+    }
+#elif defined(__unix__)
+    cpu_set_t process_set;
+    CPU_ZERO(&process_set);
+
+    if (sched_getaffinity(0, sizeof(process_set), &process_set) != 0)
+    {
+        spdlog::error("ThreadPlacement: Can't get process affinity!");
+
+        return false;
+    }
+
+    std::error_code error;
+
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error))
+    {
+        std::string directory_name = entry.path().filename().string();
+
+        if (directory_name.substr(0, 4) != "node" || directory_name.size() <= 4 || !std::isdigit(directory_name[4]))
+        {
+            continue;
+        }
+
+        uint32_t node = std::stoul(directory_name.substr(4));
+        std::ifstream file(entry.path() / "cpulist");
+        std::string range;
+
+        //The cpu list consists of comma separated ranges such as 0-3,8-11
+        while (std::getline(file, range, ','))
+        {
+            uint32_t first = 0;
+            uint32_t last = 0;
+            char separator = 0;
+
+            std::istringstream stream(range);
+            stream >> first;
+            last = first;
+
+            if (stream >> separator && separator == '-')
+            {
+                stream >> last;
+            }
+
+            for (uint32_t cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+            {
+                if (CPU_ISSET(cpu, &process_set))
+                {
+                    node_cpus[node].push_back(cpu);
+                }
+            }
+        }
+    }
+
+    //Systems without NUMA support don't provide the node directory
+    if (node_cpus.empty())
+    {
+        for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &process_set))
+            {
+                node_cpus[0].push_back(cpu);
+            }
+        }
+    }
+#else
+    for (uint32_t cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++)
+    {
+        node_cpus[0].push_back(cpu);
+    }
+#endif
+
+    if (numa_node.has_value())
+    {
+        if (!node_cpus.contains(numa_node.value()) || node_cpus[numa_node.value()].empty())
+        {
+            spdlog::error("ThreadPlacement: Numa node {} has no usable cores!", numa_node.value());
+
+            return false;
+        }
+
+        std::vector<uint32_t> cpus = node_cpus[numa_node.value()];
+        node_cpus.clear();
+        node_cpus[numa_node.value()] = cpus;
+    }
+
+    this->cores.clear();
+
+    if (this->policy == THREAD_PLACEMENT_POLICY_SCATTER)
+    {
+        for (uint32_t index = 0; true; index++)
+        {
+            bool found = false;
+
+            for (const auto& [node, cpus] : node_cpus)
+            {
+                if (index < cpus.size())
+                {
+                    this->cores.push_back({ cpus[index], node });
+                    found = true;
+                }
+            }
+
+            if (!found)
+            {
+                break;
+            }
+        }
+    }
+
+    else
+    {
+        for (const auto& [node, cpus] : node_cpus)
+        {
+            for (uint32_t cpu : cpus)
+            {
+                this->cores.push_back({ cpu, node });
+            }
+        }
+    }
+
+    if (this->cores.empty())
+    {
+        spdlog::error("ThreadPlacement: Can't find any usable cores!");
+
+        return false;
+    }
+
+    spdlog::info("ThreadPlacement: Found {} usable cores on {} numa nodes", this->cores.size(), node_cpus.size());
+
+    return true;
+}
+
+std::optional<uint32_t> ThreadPlacement::get_core_index(ThreadRole role, uint32_t worker_index) const
+{
+    if (this->cores.empty())
+    {
+        return {};
+    }
+
+    switch (role)
+    {
+    case THREAD_ROLE_RENDER:
+        return 0;
+    case THREAD_ROLE_NETWORK:
+        return 1 % this->cores.size();
+    case THREAD_ROLE_WORKER:
+        if (this->cores.size() <= THREAD_PLACEMENT_RESERVED_COUNT)
+        {
+            return worker_index % this->cores.size();
+        }
+
+        return THREAD_PLACEMENT_RESERVED_COUNT + worker_index % (this->cores.size() - THREAD_PLACEMENT_RESERVED_COUNT);
+    default:
+        break;
+    }
+
+    return {};
+}
+
+bool ThreadPlacement::set_affinity(const std::vector<uint32_t>& cpus)
+{
+#if defined(_WIN32)
+    DWORD_PTR mask = 0;
+
+    for (uint32_t cpu : cpus)
+    {
+        mask |= (DWORD_PTR)1 << cpu;
+    }
+
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__unix__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    for (uint32_t cpu : cpus)
+    {
+        CPU_SET(cpu, &set);
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+double ThreadPlacement::get_cpu_time(const ThreadPlacementEntry& entry)
+{
+#if defined(_WIN32)
+    FILETIME creation_time;
+    FILETIME exit_time;
+    FILETIME kernel_time;
+    FILETIME user_time;
+
+    if (!GetThreadTimes(entry.thread_handle, &creation_time, &exit_time, &kernel_time, &user_time))
+    {
+        return 0.0;
+    }
+
+    uint64_t kernel_ticks = ((uint64_t)kernel_time.dwHighDateTime << 32) | kernel_time.dwLowDateTime;
+    uint64_t user_ticks = ((uint64_t)user_time.dwHighDateTime << 32) | user_time.dwLowDateTime;
+
+    return (kernel_ticks + user_ticks) * 100.0e-9; //Ticks are in units of 100 nanoseconds
+#elif defined(__unix__)
+    timespec time;
+
+    if (clock_gettime(entry.clock_id, &time) != 0)
+    {
+        return 0.0;
+    }
+
+    return time.tv_sec + time.tv_nsec * 1.0e-9;
+#else
+    return 0.0;
+#endif
+}
\ No newline at end of file
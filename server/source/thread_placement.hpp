@@ -0,0 +1,101 @@
+#ifndef HEADER_THREAD_PLACEMENT
+#define HEADER_THREAD_PLACEMENT
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <cstdint>
+
+#if defined(__unix__)
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#define THREAD_PLACEMENT_RESERVED_COUNT 2 // Number of cores that are reserved for the render and the network thread
+
+enum ThreadPlacementPolicy
+{
+    THREAD_PLACEMENT_POLICY_NONE,    // Threads are not pinned and can be moved by the operating system
+    THREAD_PLACEMENT_POLICY_COMPACT, // Threads are pinned to consecutive cores, so that a NUMA node is filled before the next one is used
+    THREAD_PLACEMENT_POLICY_SCATTER  // Threads are pinned to cores of alternating NUMA nodes, so that the memory bandwidth of all nodes is used
+};
+
+enum ThreadRole
+{
+    THREAD_ROLE_RENDER,  // Thread that owns the OpenGL context
+    THREAD_ROLE_NETWORK, // Thread of the websocket loop
+    THREAD_ROLE_ENCODER, // Threads that wait for the output of the video encoder
+    THREAD_ROLE_EXPORT,  // Threads that write the exported files
+    THREAD_ROLE_WORKER   // Threads of the scheduler that triangulate and encode the geometry
+};
+
+struct ThreadPlacementCore
+{
+    uint32_t cpu = 0;
+    uint32_t node = 0;
+};
+
+struct ThreadPlacementEntry
+{
+    std::thread::id thread_id;
+    std::string name;
+    ThreadRole role = THREAD_ROLE_WORKER;
+    std::optional<uint32_t> cpu;
+
+#if defined(_WIN32)
+    void* thread_handle = nullptr; // Handle of the thread that can be used by other threads
+#elif defined(__unix__)
+    clockid_t clock_id = 0;
+#endif
+
+    double cpu_time_last = 0.0; // In seconds
+};
+
+// Pins the threads of the server to cores according to the placement policy and measures the cpu utilisation of each thread.
+// The render and the network thread get a dedicated core each, the worker threads get one of the remaining cores each.
+// The encoder and export threads mostly wait for the gpu or the disk and are therefore only restricted to the node of the render thread.
+// Memory is placed on the node of the thread that first touches it, so that the mesh buffers written by a pinned worker stay local to its node.
+class ThreadPlacement
+{
+private:
+    ThreadPlacementPolicy policy = THREAD_PLACEMENT_POLICY_NONE;
+    std::vector<ThreadPlacementCore> cores; // Usable cores in the order in which they are assigned to threads
+
+    std::mutex mutex;
+    std::vector<ThreadPlacementEntry> entries; // Protected by mutex
+
+    double report_interval = 0.0; // In seconds
+    std::chrono::high_resolution_clock::time_point report_last;
+
+public:
+    ThreadPlacement() = default;
+
+    // If a node is given, only the cores of that node are used. A report interval of zero disables the utilisation reports.
+    bool create(ThreadPlacementPolicy policy, std::optional<uint32_t> numa_node, float report_interval);
+    void destroy();
+
+    // Has to be called by the thread itself. The worker index is only used for worker threads.
+    void place_thread(ThreadRole role, const std::string& name, uint32_t worker_index = 0);
+    // Has to be called by the thread itself before it exits
+    void remove_thread();
+
+    // Logs the utilisation of all threads if the report interval elapsed since the last report
+    void report();
+
+    // Number of worker threads that fit onto the usable cores next to the reserved cores
+    uint32_t get_worker_count() const;
+    // Node of the core that is assigned to the given worker thread
+    uint32_t get_worker_node(uint32_t worker_index) const;
+
+private:
+    bool detect_cores(std::optional<uint32_t> numa_node);
+    std::optional<uint32_t> get_core_index(ThreadRole role, uint32_t worker_index) const;
+
+    static bool set_affinity(const std::vector<uint32_t>& cpus);
+    static double get_cpu_time(const ThreadPlacementEntry& entry);
+};
+
+#endif
\ No newline at end of file
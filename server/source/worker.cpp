@@ -5,270 +5,495 @@
 #include "mesh_generator/mesh_generator.hpp"
 
 #include <geometry_codec.hpp>
+#include <spdlog/spdlog.h>
 #include <filesystem>
 #include <chrono>
 
-bool WorkerPool::create(Server* server, uint32_t view_count, bool export_enabled)
+bool WorkerPool::create(Server* server, uint32_t connection, ThreadPlacement* thread_placement, Scheduler* scheduler, shared::MeshGeneratorType mesh_generator, uint32_t view_count, uint32_t layer_count, uint32_t frame_count, bool export_enabled, bool drop_stale_frames, float latency_budget, bool view_metadata_enabled, bool split_response)
 {
+    this->scheduler = scheduler;
     this->server = server;
-    this->state = WORKER_STATE_ACTIVE;
+    this->connection = connection;
+    this->mesh_generator = mesh_generator;
     this->view_count = view_count;
     this->export_enabled = export_enabled;
+    this->drop_stale_frames = drop_stale_frames;
+    this->latency_budget = latency_budget;
+    this->view_metadata_enabled = view_metadata_enabled;
+    this->split_response = split_response;
+    this->cancel_token.reset();
 
-    for (uint32_t view = 0; view < view_count; view++)
+    for (uint32_t layer = 0; layer < layer_count; layer++)
     {
-        std::thread mesh_thread = std::thread([this, view]()
+        WorkerLayer* worker_layer = new WorkerLayer;
+        worker_layer->input_frames = std::vector<std::atomic<WorkerFrame*>>(frame_count);
+
+        this->layers.push_back(worker_layer);
+    }
+
+    this->frame_pool.create(layer_count * frame_count);
+    this->output_queue.create(layer_count * frame_count);
+
+    for (uint32_t index = 0; index < layer_count * frame_count; index++)
+    {
+        WorkerFrame* worker_frame = new WorkerFrame;
+
+        for (uint32_t view = 0; view < SHARED_VIEW_COUNT_MAX; view++)
         {
-            this->worker_mesh(view);
-        });
+            worker_frame->views[view].worker_frame = worker_frame;
+            worker_frame->views[view].view = view;
+        }
 
-        this->mesh_threads.push_back(std::move(mesh_thread));
+        this->frames.push_back(worker_frame);
+        this->frame_pool.push(worker_frame);
     }
 
-    this->submit_thread = std::thread([this]()
+    if (export_enabled)
     {
-        this->worker_submit();
-    });
+        if (!this->export_pool.create(thread_placement))
+        {
+            return false;
+        }
+    }
     
     return true;
 }
 
 void WorkerPool::destroy(std::vector<Frame*>& frames)
 {
-    this->state = WORKER_STATE_INACTIVE;
-    this->input_condition.notify_all();
-    this->mesh_condition.notify_all();
+    //Let the tasks of the submitted frames skip their remaining work, but still wait for them, since the frames can only be reclaimed once all of their tasks are complete
+    this->cancel_token.cancel();
+
+    //The scheduler is shared with the other sessions and keeps running, so wait until the last task of each frame has returned
+    std::unique_lock<std::mutex> active_lock(this->active_mutex);
 
-    for (std::thread& mesh_thread : this->mesh_threads)
+    this->active_condition.wait(active_lock, [this]()
     {
-        mesh_thread.join();
-    }
+        return this->active_count == 0;
+    });
 
-    this->submit_thread.join();
-    this->mesh_threads.clear();
+    active_lock.unlock();
 
-    for (WorkerFrame* worker_frame : this->input_queue)
+    this->export_pool.destroy();
+
+    WorkerFrame* worker_frame = nullptr;
+
+    while (this->output_queue.pop(worker_frame))
     {
         frames.push_back(worker_frame->frame);
-
-        delete worker_frame;
     }
 
-    for (WorkerFrame* worker_frame : this->output_queue)
+    for (WorkerLayer* worker_layer : this->layers)
     {
-        frames.push_back(worker_frame->frame);
+        delete worker_layer;
+    }
 
+    for (WorkerFrame* worker_frame : this->frames)
+    {
         delete worker_frame;
     }
 
-    this->input_queue.clear();
-    this->output_queue.clear();
+    this->layers.clear();
+    this->frames.clear();
+    this->frame_pool.destroy();
+    this->output_queue.destroy();
 }
 
 void WorkerPool::submit(Frame* frame)
 {
-    std::unique_lock<std::mutex> lock(this->input_mutex);
+    WorkerFrame* worker_frame = nullptr;
+
+    if (!this->frame_pool.pop(worker_frame))
+    {
+        spdlog::error("WorkerPool: More frames submitted than the pool was created for!");
+
+        return;
+    }
 
-    WorkerFrame* worker_frame = new WorkerFrame;
     worker_frame->frame = frame;
-    worker_frame->layer_data = this->server->allocate_layer_data();
-    worker_frame->complete.fill(false);
+    worker_frame->layer_data = this->server->allocate_layer_data(this->connection, frame->layer_index);
+    worker_frame->layer_data->view_count = this->view_count;
+    worker_frame->layer_data->mesh_generator = this->mesh_generator;
+    worker_frame->layer_data->view_metadata_enabled = this->view_metadata_enabled;
+    worker_frame->layer_data->split_response = this->split_response;
+    worker_frame->dropped = false;
+    worker_frame->complete = false;
+
+    std::unique_lock<std::mutex> active_lock(this->active_mutex);
+    this->active_count++;
+    active_lock.unlock();
+
+    WorkerLayer* worker_layer = this->layers[frame->layer_index];
+    worker_frame->input_index = worker_layer->input_index;
+    worker_layer->input_frames[worker_frame->input_index % worker_layer->input_frames.size()] = worker_frame;
+    worker_layer->input_index++;
+
+    SchedulerTask* encode_task = this->scheduler->create_task([this, worker_frame]()
+    {
+        this->task_encode(worker_frame);
+    });
+
+    SchedulerTask* complete_task = this->scheduler->create_task([this, worker_frame]()
+    {
+        this->task_complete(worker_frame);
+
+        //Notify while holding the lock, since the pool can be destroyed as soon as the lock is released
+        std::unique_lock<std::mutex> active_lock(this->active_mutex);
+        this->active_count--;
+        this->active_condition.notify_all();
+    });
+
+    this->scheduler->add_dependency(complete_task, encode_task);
+
+    for (uint32_t view = 0; view < this->view_count; view++)
+    {
+        WorkerView* worker_view = &worker_frame->views[view];
+
+        SchedulerTask* mesh_task = this->scheduler->create_task([this, worker_view]()
+        {
+            this->task_mesh(worker_view);
+        });
+
+        SchedulerTask* geometry_task = this->scheduler->create_task([this, worker_view]()
+        {
+            this->task_geometry(worker_view);
+        });
+
+        this->scheduler->add_dependency(geometry_task, mesh_task);
+        this->scheduler->add_dependency(encode_task, geometry_task);
+        this->scheduler->submit(geometry_task);
+
+        if (this->export_enabled)
+        {
+            SchedulerTask* export_task = this->scheduler->create_task([this, worker_view]()
+            {
+                this->task_export(worker_view);
+            });
+
+            this->scheduler->add_dependency(export_task, mesh_task);
+            this->scheduler->add_dependency(complete_task, export_task);
+            this->scheduler->submit(export_task);
+        }
+
+        this->scheduler->submit(mesh_task);
+    }
 
-    this->input_queue.push_back(worker_frame);
-    this->input_condition.notify_all();
+    this->scheduler->submit(encode_task);
+    this->scheduler->submit(complete_task);
 }
 
 void WorkerPool::reclaim(std::vector<Frame*>& frames)
 {
-    std::unique_lock<std::mutex> lock(this->output_mutex);
+    WorkerFrame* worker_frame = nullptr;
 
-    for (WorkerFrame* worker_frame : this->output_queue)
+    while (this->output_queue.pop(worker_frame))
     {
         frames.push_back(worker_frame->frame);
 
-        delete worker_frame;
+        worker_frame->frame = nullptr;
+        this->frame_pool.push(worker_frame);
+    }
+}
+
+void WorkerPool::task_mesh(WorkerView* worker_view)
+{
+    WorkerFrame* worker_frame = worker_view->worker_frame;
+    uint32_t view = worker_view->view;
+    const Frame* frame = worker_frame->frame;
+    MeshGeneratorFrame* mesh_generator_frame = frame->mesh_generator_frame[view];
+    LayerData* layer_data = worker_frame->layer_data;
+
+    layer_data->view_metadata[view].time_layer = frame->time_layer[view];
+    layer_data->view_metadata[view].time_image_encode = frame->encoder_frame->time_encode;
+    memcpy(layer_data->view_matrices[view].data(), glm::value_ptr(frame->view_matrix[view]), sizeof(glm::mat4));
+
+    //Skip the triangulation, which is the most expensive part of a frame, if a newer frame is already waiting
+    if (this->cancel_token.is_cancelled() || this->check_stale(worker_frame))
+    {
+        return;
+    }
+
+    //Use the output of the mesh generator in place if possible, since the frame is not reclaimed before the geometry is encoded
+    bool mapped = mesh_generator_frame->map_mesh(layer_data->vertex_views[view], layer_data->index_views[view], layer_data->view_metadata[view]);
+
+    if (!mapped)
+    {
+        mesh_generator_frame->triangulate(layer_data->vertices[view], layer_data->indices[view], layer_data->view_metadata[view], worker_frame->feature_lines[view], this->export_enabled, &this->cancel_token, this->scheduler);
+
+        layer_data->vertex_views[view] = layer_data->vertices[view];
+        layer_data->index_views[view] = layer_data->indices[view];
+    }
+}
+
+void WorkerPool::task_geometry(WorkerView* worker_view)
+{
+    WorkerFrame* worker_frame = worker_view->worker_frame;
+    uint32_t view = worker_view->view;
+    LayerData* layer_data = worker_frame->layer_data;
+
+    if (this->cancel_token.is_cancelled() || this->check_stale(worker_frame))
+    {
+        return;
     }
 
-    this->output_queue.clear();
+    std::chrono::high_resolution_clock::time_point geometry_encode_start = std::chrono::high_resolution_clock::now();
+    shared::GeometryCodec::encode_chunk(layer_data->index_views[view], layer_data->vertex_views[view], worker_frame->geometry_chunks[view]);
+    std::chrono::high_resolution_clock::time_point geometry_encode_end = std::chrono::high_resolution_clock::now();
+
+    layer_data->view_metadata[view].time_geometry_encode = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(geometry_encode_end - geometry_encode_start).count();
 }
 
-void WorkerPool::worker_mesh(uint32_t view)
+void WorkerPool::task_export(WorkerView* worker_view)
 {
-    std::vector<MeshFeatureLine> feature_lines;
+    WorkerFrame* worker_frame = worker_view->worker_frame;
+    uint32_t view = worker_view->view;
+    const Frame* frame = worker_frame->frame;
+    const ExportRequest& export_request = frame->export_request;
+    const LayerData* layer_data = worker_frame->layer_data;
+    std::vector<MeshFeatureLine>& feature_lines = worker_frame->feature_lines[view];
+
+    //The mesh of a cancelled frame is incomplete and not worth exporting
+    if (this->cancel_token.is_cancelled())
+    {
+        feature_lines.clear();
 
-    while (true)
+        return;
+    }
+
+    //Only copy the data of the exports, since the files are written by the export pool after the frame was reused
+    if (export_request.color_file_name.has_value())
     {
-        std::unique_lock<std::mutex> input_lock(this->input_mutex);
-        WorkerFrame* worker_frame = nullptr;
+        uint32_t image_size = frame->resolution.x * frame->resolution.y * sizeof(glm::u8vec4);
 
-        while (true)
+        ExportJob* job = this->export_pool.allocate_job();
+
+        if (job != nullptr)
         {
-            for (WorkerFrame* input_frame : this->input_queue)
-            {
-                if (!input_frame->complete[view])
-                {
-                    worker_frame = input_frame;
+            job->type = EXPORT_JOB_TYPE_COLOR_IMAGE;
+            job->file_name = this->get_export_file_name(export_request.color_file_name.value(), frame->layer_index, view);
+            job->resolution = frame->resolution;
+            job->image.assign(frame->color_export_pointers[view], frame->color_export_pointers[view] + image_size);
 
-                    break;
-                }
-            }
+            this->export_pool.submit_job(job);
+        }
+    }
 
-            if (worker_frame != nullptr)
-            {
-                break;
-            }
+    if (export_request.depth_file_name.has_value())
+    {
+        uint32_t image_size = frame->resolution.x * frame->resolution.y * sizeof(float);
 
-            if (this->state == WORKER_STATE_INACTIVE)
-            {
-                return;
-            }
+        ExportJob* job = this->export_pool.allocate_job();
+
+        if (job != nullptr)
+        {
+            job->type = EXPORT_JOB_TYPE_DEPTH_IMAGE;
+            job->file_name = this->get_export_file_name(export_request.depth_file_name.value(), frame->layer_index, view);
+            job->resolution = frame->resolution;
+            job->image.assign(frame->depth_export_pointers[view], frame->depth_export_pointers[view] + image_size);
 
-            this->input_condition.wait(input_lock);
+            this->export_pool.submit_job(job);
         }
-        input_lock.unlock();
+    }
+
+    if (export_request.mesh_file_name.has_value())
+    {
+        ExportJob* job = this->export_pool.allocate_job();
 
-        const Frame* frame = worker_frame->frame;
-        const ExportRequest& export_request = frame->export_request;
-        MeshGeneratorFrame* mesh_generator_frame = frame->mesh_generator_frame[view];
-        LayerData* layer_data = worker_frame->layer_data;
+        if (job != nullptr)
+        {
+            job->type = EXPORT_JOB_TYPE_MESH;
+            job->file_name = this->get_export_file_name(export_request.mesh_file_name.value(), frame->layer_index, view);
+            job->resolution = frame->resolution + glm::uvec2(1);
+            job->vertices.assign(layer_data->vertex_views[view].begin(), layer_data->vertex_views[view].end());
+            job->indices.assign(layer_data->index_views[view].begin(), layer_data->index_views[view].end());
+            job->view_matrix = frame->view_matrix[view];
+            job->projection_matrix = frame->projection_matrix;
+
+            this->export_pool.submit_job(job);
+        }
+    }
 
-        mesh_generator_frame->triangulate(layer_data->vertices[view], layer_data->indices[view], layer_data->view_metadata[view], feature_lines, this->export_enabled);
+    if (export_request.feature_lines_file_name.has_value())
+    {
+        ExportJob* job = this->export_pool.allocate_job();
 
-        layer_data->view_metadata[view].time_layer = frame->time_layer[view];
-        layer_data->view_metadata[view].time_image_encode = frame->encoder_frame->time_encode;
-        memcpy(layer_data->view_matrices[view].data(), glm::value_ptr(frame->view_matrix[view]), sizeof(glm::mat4));
-        
-        if (this->export_enabled)
+        if (job != nullptr)
         {
-            if (export_request.color_file_name.has_value())
-            {
-                std::string file_name = this->get_export_file_name(export_request.color_file_name.value(), frame->layer_index, view);
+            job->type = EXPORT_JOB_TYPE_FEATURE_LINES;
+            job->file_name = this->get_export_file_name(export_request.feature_lines_file_name.value(), frame->layer_index, view);
+            job->resolution = frame->resolution + glm::uvec2(1);
+            job->feature_lines.swap(feature_lines); //The feature lines are not needed by the frame anymore
 
-                glm::uvec2 image_resolution = frame->resolution;
-                uint32_t image_size = image_resolution.x * image_resolution.y * sizeof(glm::u8vec4);
+            this->export_pool.submit_job(job);
+        }
+    }
 
-                export_color_image(file_name, image_resolution, frame->color_export_pointers[view], image_size);
-            }
+    feature_lines.clear();
+}
 
-            if (export_request.depth_file_name.has_value())
-            {
-                std::string file_name = this->get_export_file_name(export_request.depth_file_name.value(), frame->layer_index, view);
+void WorkerPool::task_encode(WorkerFrame* worker_frame)
+{
+    const Frame* frame = worker_frame->frame;
+    const EncoderFrame* encoder_frame = frame->encoder_frame;
+    LayerData* layer_data = worker_frame->layer_data;
 
-                glm::uvec2 image_resolution = frame->resolution;
-                uint32_t image_size = image_resolution.x * image_resolution.y * sizeof(float);
+    layer_data->geometry.clear();
 
-                export_depth_image(file_name, image_resolution, frame->depth_export_pointers[view], image_size);
-            }
+    if (this->cancel_token.is_cancelled())
+    {
+        return;
+    }
 
-            if (export_request.mesh_file_name.has_value())
-            {
-                std::string file_name = this->get_export_file_name(export_request.mesh_file_name.value(), frame->layer_index, view);
+    double time_geometry_assemble = 0.0;
 
-                export_mesh(file_name, layer_data->vertices[view], layer_data->indices[view], frame->view_matrix[view], frame->projection_matrix, frame->resolution + glm::uvec2(1));
-            }
+    if (!this->check_stale(worker_frame))
+    {
+        std::span<shared::GeometryChunk> geometry_chunks(worker_frame->geometry_chunks.data(), this->view_count);
 
-            if (export_request.feature_lines_file_name.has_value())
-            {
-                std::string file_name = this->get_export_file_name(export_request.feature_lines_file_name.value(), frame->layer_index, view);
+        //Only the assembly of the chunks remains, since the chunks of the views were already encoded by the geometry tasks
+        std::chrono::high_resolution_clock::time_point geometry_encode_start = std::chrono::high_resolution_clock::now();
+        shared::GeometryCodec::encode(geometry_chunks, worker_frame->geometry_buffers, layer_data->geometry);
+        std::chrono::high_resolution_clock::time_point geometry_encode_end = std::chrono::high_resolution_clock::now();
+        time_geometry_assemble = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(geometry_encode_end - geometry_encode_start).count();
+    }
 
-                export_feature_lines(file_name, feature_lines, frame->resolution + glm::uvec2(1));
-            }
+    uint32_t image_buffer_size = encoder_frame->output_buffer_size + encoder_frame->output_parameter_buffer.size();
+    uint32_t image_buffer_offset = 0;
 
-            feature_lines.clear();
-        }
+    layer_data->image.resize(image_buffer_size);
+
+    if (encoder_frame->config_changed)
+    {
+        memcpy(layer_data->image.data(), encoder_frame->output_parameter_buffer.data(), encoder_frame->output_parameter_buffer.size());
+        image_buffer_offset += encoder_frame->output_parameter_buffer.size();
+    }
+
+    memcpy(layer_data->image.data() + image_buffer_offset, encoder_frame->output_buffer, encoder_frame->output_buffer_size);
+
+    layer_data->request_id = frame->request_id;
+    layer_data->layer_index = frame->layer_index;
 
-        input_lock.lock();
-        worker_frame->complete[view] = true;
-        this->mesh_condition.notify_all();
-        input_lock.unlock();
+    for (uint32_t view = 0; view < this->view_count; view++)
+    {
+        layer_data->view_metadata[view].time_geometry_encode += time_geometry_assemble;
     }
 }
 
-void WorkerPool::worker_submit()
+void WorkerPool::task_complete(WorkerFrame* worker_frame)
 {
-    std::vector<shared::Vertex> vertices;
-    std::vector<shared::Index> indices;
+    WorkerLayer* worker_layer = this->layers[worker_frame->frame->layer_index];
+    worker_frame->complete = true;
+
+    //Only the thread that increments the counter from zero submits frames to the server, all other threads just leave their frame to that thread
+    if (worker_layer->output_counter++ > 0)
+    {
+        return;
+    }
+
+    uint32_t output_count = 1;
 
     while (true)
     {
-        std::unique_lock<std::mutex> input_lock(this->input_mutex);
+        //Submit the layer data in the order of the frames of the layer even if a later frame completes first
         while (true)
         {
-            if (!this->input_queue.empty())
+            std::atomic<WorkerFrame*>& input_frame = worker_layer->input_frames[worker_layer->output_index % worker_layer->input_frames.size()];
+            WorkerFrame* front_frame = input_frame;
+
+            if (front_frame == nullptr || !front_frame->complete)
             {
-                WorkerFrame* worker_frame = this->input_queue.front();
-                bool complete = true;
+                break;
+            }
 
-                for (uint32_t view = 0; view < this->view_count; view++)
-                {
-                    complete = complete && worker_frame->complete[view];
-                }
+            input_frame = nullptr;
 
-                if (complete)
-                {
-                    break;
-                }
-            }
+            LayerData* layer_data = front_frame->layer_data;
+            front_frame->layer_data = nullptr;
 
-            if (this->state == WORKER_STATE_INACTIVE)
+            //The frames that are left once the pool is destroyed belong to a session that is already closed
+            if (this->cancel_token.is_cancelled())
             {
-                return;
+                this->server->release_layer_data(layer_data);
             }
 
-            this->mesh_condition.wait(input_lock);
-        }
+            else
+            {
+                //Drop the geometry of frames that became stale while waiting for previous frames, since sending it would only delay the next frame
+                if (this->check_stale(front_frame))
+                {
+                    for (uint32_t view = 0; view < SHARED_VIEW_COUNT_MAX; view++)
+                    {
+                        layer_data->vertex_views[view] = {};
+                        layer_data->index_views[view] = {};
+                    }
+
+                    layer_data->geometry.clear();
+                    layer_data->geometry_dropped = true;
+                    worker_layer->dropped_count++;
+                }
 
-        WorkerFrame* worker_frame = this->input_queue.front();
-        this->input_queue.erase(this->input_queue.begin());
-        input_lock.unlock();
+                layer_data->dropped_frames = worker_layer->dropped_count;
 
-        const Frame* frame = worker_frame->frame;
-        const EncoderFrame* encoder_frame = frame->encoder_frame;
-        LayerData* layer_data = worker_frame->layer_data;
+                this->server->submit_layer_data(layer_data);
+            }
+            
+            this->output_queue.push(front_frame);
+            worker_layer->output_index++;
+            worker_layer->output_index.notify_all();
+        }
 
-        vertices.clear();
-        indices.clear();
-        layer_data->geometry.clear();
+        //Check again if other threads completed frames in the meantime
+        uint32_t previous_count = worker_layer->output_counter.fetch_sub(output_count);
 
-        for (uint32_t view = 0; view < this->view_count; view++)
+        if (previous_count == output_count)
         {
-            vertices.insert(vertices.end(), layer_data->vertices[view].begin(), layer_data->vertices[view].end());
-            indices.insert(indices.end(), layer_data->indices[view].begin(), layer_data->indices[view].end());
+            break;
         }
 
-        std::chrono::high_resolution_clock::time_point geometry_encode_start = std::chrono::high_resolution_clock::now();
-        shared::GeometryCodec::encode(indices, vertices, layer_data->geometry);
-        std::chrono::high_resolution_clock::time_point geometry_encode_end = std::chrono::high_resolution_clock::now();
-        double time_geometry_encode = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(geometry_encode_end - geometry_encode_start).count();
+        output_count = previous_count - output_count;
+    }
+}
 
-        uint32_t image_buffer_size = encoder_frame->output_buffer_size + encoder_frame->output_parameter_buffer.size();
-        uint32_t image_buffer_offset = 0;
+bool WorkerPool::check_stale(WorkerFrame* worker_frame)
+{
+    if (!this->drop_stale_frames)
+    {
+        return false;
+    }
 
-        layer_data->image.resize(image_buffer_size);
+    if (worker_frame->dropped)
+    {
+        return true;
+    }
 
-        if (encoder_frame->config_changed)
-        {
-            memcpy(layer_data->image.data(), encoder_frame->output_parameter_buffer.data(), encoder_frame->output_parameter_buffer.size());
-            image_buffer_offset += encoder_frame->output_parameter_buffer.size();
-        }
+    const Frame* frame = worker_frame->frame;
+    const ExportRequest& export_request = frame->export_request;
 
-        memcpy(layer_data->image.data() + image_buffer_offset, encoder_frame->output_buffer, encoder_frame->output_buffer_size);
+    //Never drop frames that need to be exported
+    if (export_request.color_file_name.has_value() || export_request.depth_file_name.has_value() || export_request.mesh_file_name.has_value() || export_request.feature_lines_file_name.has_value())
+    {
+        return false;
+    }
 
-        layer_data->request_id = frame->request_id;
-        layer_data->layer_index = frame->layer_index;
+    //Only drop frames that are superseded by a newer frame of the same layer, so that the latest frame is always complete
+    WorkerLayer* worker_layer = this->layers[frame->layer_index];
 
-        for (uint32_t view = 0; view < this->view_count; view++)
-        {
-            layer_data->view_metadata[view].time_geometry_encode = time_geometry_encode;
-        }
+    if (worker_frame->input_index + 1 >= worker_layer->input_index)
+    {
+        return false;
+    }
 
-        this->server->submit_layer_data(layer_data);
-        worker_frame->layer_data = nullptr;
+    std::chrono::high_resolution_clock::time_point current_time = std::chrono::high_resolution_clock::now();
+    double frame_age = std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(current_time - frame->time_point_request).count();
 
-        std::unique_lock<std::mutex> output_lock(this->output_mutex);
-        this->output_queue.push_back(worker_frame);
-        output_lock.unlock();
+    if (frame_age <= this->latency_budget)
+    {
+        return false;
     }
+
+    worker_frame->dropped = true;
+
+    return true;
 }
 
 std::string WorkerPool::get_export_file_name(const std::string& request_file_name, uint32_t layer, uint32_t view)
@@ -2,21 +2,34 @@
 #define HEADER_WORKER
 
 #include <condition_variable>
-#include <thread>
+#include <atomic>
 #include <mutex>
 #include <vector>
 #include <array>
 
+#include "mesh_generator/mesh_generator.hpp"
+#include "scheduler.hpp"
+#include "export.hpp"
+#include "ring_queue.hpp"
+#include "cancel_token.hpp"
 #include "server.hpp"
 #include "camera.hpp"
 
+#include <geometry_codec.hpp>
+
 struct Frame;
 class Statistic;
+class WorkerFrame;
 
-enum WorkerState
+class WorkerView
 {
-    WORKER_STATE_ACTIVE,
-    WORKER_STATE_INACTIVE
+public:
+    WorkerFrame* worker_frame = nullptr;
+    uint32_t view = 0;
+
+public:
+    WorkerView() = default;
+    ~WorkerView() = default;
 };
 
 class WorkerFrame
@@ -25,45 +38,90 @@ public:
     Frame* frame = nullptr;
     LayerData* layer_data = nullptr;
 
-    std::array<bool, SHARED_VIEW_COUNT_MAX> complete;
+    std::array<WorkerView, SHARED_VIEW_COUNT_MAX> views; // Passed to the tasks of each view, so that the tasks don't need to store the frame and the view separately
+
+    std::array<std::vector<MeshFeatureLine>, SHARED_VIEW_COUNT_MAX> feature_lines;
+    std::array<shared::GeometryChunk, SHARED_VIEW_COUNT_MAX> geometry_chunks; // Geometry of each view that is encoded as soon as the view is triangulated
+    shared::GeometryEncodeBuffers geometry_buffers;                           // Reused by the assembly of the geometry chunks, so that the encoding does not allocate
+    uint64_t input_index = 0;                                                 // Submission index of the frame within its layer
+    std::atomic<bool> dropped = false;                                        // Set once the frame is stale, so that the remaining tasks of the frame skip the geometry
+    std::atomic<bool> complete = false;
 
 public:
     WorkerFrame() = default;
     ~WorkerFrame() = default;
 };
 
+// Frames of one layer that are not yet submitted to the server
+class WorkerLayer
+{
+public:
+    std::vector<std::atomic<WorkerFrame*>> input_frames; // Indexed by the submission index modulo the frame count
+
+    std::atomic<uint64_t> input_index = 0;               // Number of frames that were submitted to the pool. Only written by the thread that submits the frames
+    std::atomic<uint64_t> output_index = 0;              // Number of frames that were submitted to the server. Only written by the thread that holds the output counter
+    std::atomic<uint32_t> output_counter = 0;            // Number of completed frames that still need to be checked for submission to the server
+    uint32_t dropped_count = 0;                          // Number of frames of which the geometry was dropped. Only accessed by the thread that holds the output counter
+
+public:
+    WorkerLayer() = default;
+    ~WorkerLayer() = default;
+};
+
+// Processes the frames using tasks that are executed by a scheduler, which is shared with the pools of the other sessions.
+// Each frame is split into one mesh, geometry and export task per view, one encode task and one complete task.
+// The export tasks only take a snapshot of the data, while the files are written by a separate export pool.
+// The geometry of a view is delta coded as soon as its mesh is available, so that only the assembly of the layer waits for the slowest view.
+// The layer data of each layer is submitted to the server in the order in which the frames were submitted to the pool.
+// Different layers are independent, so that a slow frame of one layer does not delay the frames of the other layers.
+// The hand-off between the stages is lock-free. Completed frames are tracked by counters instead of scanning the frames.
+// If enabled, the geometry of a frame is dropped once a newer frame of the same layer was submitted and the latency budget of the frame is exceeded.
+// The image of a dropped frame is still submitted, since the images of a layer are encoded as a single video stream.
+// When the pool is destroyed, running triangulations are cancelled and the remaining frames are discarded instead of submitted, so that the pool stops in bounded time.
 class WorkerPool
 {
 private:
-    std::vector<std::thread> mesh_threads;
-    std::thread submit_thread;
-
-    std::mutex input_mutex;
-    std::mutex output_mutex;
+    Scheduler* scheduler = nullptr; // Shared with the pools of the other sessions
+    ExportPool export_pool; // Only used if the export is enabled
 
-    std::condition_variable input_condition;
-    std::condition_variable mesh_condition;
+    std::vector<WorkerLayer*> layers;
+    std::vector<WorkerFrame*> frames;     // All frames of the pool, which are created once and reused, so that no allocations are needed for each frame
+    RingQueue<WorkerFrame*> frame_pool;   // Frames that are not in use
+    RingQueue<WorkerFrame*> output_queue; // Frames that can be reclaimed
+    CancelToken cancel_token;             // Cancelled once the pool is destroyed
 
-    std::vector<WorkerFrame*> input_queue;  //Protected by input_mutex
-    std::vector<WorkerFrame*> output_queue; //Protected by output_mutex
+    std::mutex active_mutex;
+    std::condition_variable active_condition;
+    uint32_t active_count = 0; // Number of submitted frames of which the complete task has not returned yet. Protected by active_mutex
 
     Server* server = nullptr;
-    WorkerState state = WORKER_STATE_INACTIVE;
+    uint32_t connection = 0; // Connection to which the layer data of the frames is sent
+    shared::MeshGeneratorType mesh_generator = shared::MESH_GENERATOR_TYPE_QUAD; // Mesh generator that produced the view metadata of the frames
     uint32_t view_count = 0;
     bool export_enabled = false;
+    bool drop_stale_frames = false;
+    double latency_budget = 0.0; // In milliseconds
+    bool view_metadata_enabled = true;
+    bool split_response = false;
     
 public:
     WorkerPool() = default;
 
-    bool create(Server* server, uint32_t view_count, bool export_enabled);
+    // The frame count is the maximum number of frames of each layer that can be submitted to the pool and not yet reclaimed.
+    bool create(Server* server, uint32_t connection, ThreadPlacement* thread_placement, Scheduler* scheduler, shared::MeshGeneratorType mesh_generator, uint32_t view_count, uint32_t layer_count, uint32_t frame_count, bool export_enabled, bool drop_stale_frames, float latency_budget, bool view_metadata_enabled, bool split_response);
     void destroy(std::vector<Frame*>& frames);
 
     void submit(Frame* frame);
     void reclaim(std::vector<Frame*>& frames);
 
 private:
-    void worker_mesh(uint32_t view);
-    void worker_submit();
+    void task_mesh(WorkerView* worker_view);
+    void task_geometry(WorkerView* worker_view);
+    void task_export(WorkerView* worker_view);
+    void task_encode(WorkerFrame* worker_frame);
+    void task_complete(WorkerFrame* worker_frame);
+
+    bool check_stale(WorkerFrame* worker_frame); // Marks the frame as dropped if it is stale
 
     std::string get_export_file_name(const std::string& request_file_name, uint32_t layer, uint32_t view);
 };
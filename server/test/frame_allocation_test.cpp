@@ -0,0 +1,367 @@
+#include "scheduler.hpp"
+#include "ring_queue.hpp"
+#include "thread_placement.hpp"
+
+#include <geometry_codec.hpp>
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <cstdlib>
+#include <cmath>
+#include <array>
+#include <new>
+
+#define FRAME_ALLOCATION_TEST_VIEW_COUNT     6    // Number of views of each frame
+#define FRAME_ALLOCATION_TEST_FRAME_COUNT    8    // Number of frames that are in flight at the same time
+#define FRAME_ALLOCATION_TEST_THREAD_COUNT   4    // Number of threads of the scheduler
+#define FRAME_ALLOCATION_TEST_PART_COUNT     4    // Number of parts into which the mesh task of each view is split with run_parallel
+#define FRAME_ALLOCATION_TEST_GRID_SIZE      64   // Number of vertices along each side of the mesh of a view
+#define FRAME_ALLOCATION_TEST_PATTERN_COUNT  4    // Number of different meshes. Each frame always creates the same mesh, so that its buffers reach their size during the warmup
+#define FRAME_ALLOCATION_TEST_WARMUP_COUNT   64   // Number of frames after which the buffers of the frames and the tasks of the scheduler need to have reached their size
+#define FRAME_ALLOCATION_TEST_STEP_COUNT     2000 // Number of frames that are processed after the warmup
+
+//Counts every allocation of the process, including the allocations of the threads of the scheduler
+std::atomic<uint64_t> allocation_count = 0;
+
+void* operator new(std::size_t size)
+{
+    allocation_count++;
+
+    void* pointer = std::malloc((size > 0) ? size : 1);
+
+    if (pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t size) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t size) noexcept
+{
+    std::free(pointer);
+}
+
+struct TestFrame;
+
+struct TestView
+{
+    TestFrame* frame = nullptr;
+    uint32_t view = 0;
+
+    std::vector<shared::Index> indices;
+    std::vector<shared::Vertex> vertices;
+    float export_depth = 0.0f;
+};
+
+//Same buffers that the worker keeps for each frame
+struct TestFrame
+{
+    uint32_t step = 0;
+    uint32_t pattern = 0;
+    std::array<TestView, FRAME_ALLOCATION_TEST_VIEW_COUNT> views;
+
+    std::array<shared::GeometryChunk, FRAME_ALLOCATION_TEST_VIEW_COUNT> geometry_chunks;
+    shared::GeometryEncodeBuffers geometry_buffers;
+    std::vector<uint8_t> geometry;
+    bool encoded = false;
+};
+
+//Writes the rows [row_begin, row_end) of a grid mesh of which the depth depends on the pattern and the view
+void test_mesh_rows(uint32_t pattern, uint32_t view, uint32_t row_begin, uint32_t row_end, std::vector<shared::Index>& indices, std::vector<shared::Vertex>& vertices)
+{
+    for (uint32_t y = row_begin; y < row_end; y++)
+    {
+        for (uint32_t x = 0; x < FRAME_ALLOCATION_TEST_GRID_SIZE; x++)
+        {
+            shared::Vertex& vertex = vertices[y * FRAME_ALLOCATION_TEST_GRID_SIZE + x];
+            vertex.x = x * 8;
+            vertex.y = y * 8;
+            vertex.z = 0.5f + 0.25f * std::sin(0.1f * (x + 7 * pattern) + 0.2f * (y + view));
+        }
+
+        if (y + 1 >= FRAME_ALLOCATION_TEST_GRID_SIZE)
+        {
+            continue;
+        }
+
+        for (uint32_t x = 0; x + 1 < FRAME_ALLOCATION_TEST_GRID_SIZE; x++)
+        {
+            shared::Index index = y * FRAME_ALLOCATION_TEST_GRID_SIZE + x;
+            shared::Index* triangles = indices.data() + (y * (FRAME_ALLOCATION_TEST_GRID_SIZE - 1) + x) * 6;
+
+            triangles[0] = index;
+            triangles[1] = index + 1;
+            triangles[2] = index + FRAME_ALLOCATION_TEST_GRID_SIZE;
+
+            triangles[3] = index + 1;
+            triangles[4] = index + FRAME_ALLOCATION_TEST_GRID_SIZE + 1;
+            triangles[5] = index + FRAME_ALLOCATION_TEST_GRID_SIZE;
+        }
+    }
+}
+
+void test_mesh_resize(std::vector<shared::Index>& indices, std::vector<shared::Vertex>& vertices)
+{
+    indices.resize((FRAME_ALLOCATION_TEST_GRID_SIZE - 1) * (FRAME_ALLOCATION_TEST_GRID_SIZE - 1) * 6);
+    vertices.resize(FRAME_ALLOCATION_TEST_GRID_SIZE * FRAME_ALLOCATION_TEST_GRID_SIZE);
+}
+
+//Encodes the geometry of each pattern on the calling thread
+bool test_expected_geometry(std::array<std::vector<uint8_t>, FRAME_ALLOCATION_TEST_PATTERN_COUNT>& expected_geometry)
+{
+    for (uint32_t pattern = 0; pattern < FRAME_ALLOCATION_TEST_PATTERN_COUNT; pattern++)
+    {
+        std::array<shared::GeometryChunk, FRAME_ALLOCATION_TEST_VIEW_COUNT> geometry_chunks;
+        uint32_t index_count = 0;
+
+        for (uint32_t view = 0; view < FRAME_ALLOCATION_TEST_VIEW_COUNT; view++)
+        {
+            std::vector<shared::Index> indices;
+            std::vector<shared::Vertex> vertices;
+
+            test_mesh_resize(indices, vertices);
+            test_mesh_rows(pattern, view, 0, FRAME_ALLOCATION_TEST_GRID_SIZE, indices, vertices);
+
+            shared::GeometryCodec::encode_chunk(indices, vertices, geometry_chunks[view]);
+            index_count += indices.size();
+        }
+
+        if (!shared::GeometryCodec::encode(geometry_chunks, expected_geometry[pattern]))
+        {
+            return false;
+        }
+
+        std::vector<shared::Index> indices;
+        std::vector<shared::Vertex> vertices;
+
+        if (!shared::GeometryCodec::decode(expected_geometry[pattern], indices, vertices) || indices.size() != index_count)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//Same tasks and dependencies as WorkerPool::submit with the export enabled
+void test_submit(Scheduler& scheduler, RingQueue<TestFrame*>& output_queue, TestFrame* frame)
+{
+    SchedulerTask* encode_task = scheduler.create_task([frame]()
+    {
+        frame->encoded = shared::GeometryCodec::encode(frame->geometry_chunks, frame->geometry_buffers, frame->geometry);
+    });
+
+    SchedulerTask* complete_task = scheduler.create_task([frame, &output_queue]()
+    {
+        while (!output_queue.push(frame))
+        {
+            std::this_thread::yield();
+        }
+    });
+
+    scheduler.add_dependency(complete_task, encode_task);
+
+    for (TestView& test_view : frame->views)
+    {
+        TestView* view = &test_view;
+
+        SchedulerTask* mesh_task = scheduler.create_task([view, &scheduler]()
+        {
+            test_mesh_resize(view->indices, view->vertices);
+
+            scheduler.run_parallel(FRAME_ALLOCATION_TEST_PART_COUNT, [view](uint32_t part)
+            {
+                uint32_t row_begin = (FRAME_ALLOCATION_TEST_GRID_SIZE * part) / FRAME_ALLOCATION_TEST_PART_COUNT;
+                uint32_t row_end = (FRAME_ALLOCATION_TEST_GRID_SIZE * (part + 1)) / FRAME_ALLOCATION_TEST_PART_COUNT;
+
+                test_mesh_rows(view->frame->pattern, view->view, row_begin, row_end, view->indices, view->vertices);
+            });
+        });
+
+        SchedulerTask* geometry_task = scheduler.create_task([view]()
+        {
+            shared::GeometryCodec::encode_chunk(view->indices, view->vertices, view->frame->geometry_chunks[view->view]);
+        });
+
+        //Stands in for the export task, which adds a second successor to the mesh task
+        SchedulerTask* export_task = scheduler.create_task([view]()
+        {
+            view->export_depth = view->vertices.front().z;
+        });
+
+        scheduler.add_dependency(geometry_task, mesh_task);
+        scheduler.add_dependency(encode_task, geometry_task);
+        scheduler.add_dependency(export_task, mesh_task);
+        scheduler.add_dependency(complete_task, export_task);
+
+        scheduler.submit(geometry_task);
+        scheduler.submit(export_task);
+        scheduler.submit(mesh_task);
+    }
+
+    scheduler.submit(encode_task);
+    scheduler.submit(complete_task);
+}
+
+//Blocks every thread of the scheduler in a task once, so that the allocations of the thread setup happen before the warmup
+void test_start_threads(Scheduler& scheduler)
+{
+    std::atomic<uint32_t> started_count = 0;
+    std::atomic<uint32_t> finished_count = 0;
+
+    for (uint32_t thread = 0; thread < scheduler.get_thread_count(); thread++)
+    {
+        SchedulerTask* task = scheduler.create_task([&started_count, &finished_count]()
+        {
+            started_count++;
+
+            while (started_count < FRAME_ALLOCATION_TEST_THREAD_COUNT)
+            {
+                std::this_thread::yield();
+            }
+
+            finished_count++;
+        });
+
+        scheduler.submit(task);
+    }
+
+    while (finished_count < scheduler.get_thread_count())
+    {
+        std::this_thread::yield();
+    }
+}
+
+int main()
+{
+    ThreadPlacement thread_placement;
+
+    if (!thread_placement.create(THREAD_PLACEMENT_POLICY_NONE, std::nullopt, 0.0f))
+    {
+        return 1;
+    }
+
+    Scheduler scheduler;
+
+    if (!scheduler.create(&thread_placement, FRAME_ALLOCATION_TEST_THREAD_COUNT))
+    {
+        return 1;
+    }
+
+    test_start_threads(scheduler);
+
+    uint32_t failed_count = 0;
+    std::array<std::vector<uint8_t>, FRAME_ALLOCATION_TEST_PATTERN_COUNT> expected_geometry;
+
+    if (!test_expected_geometry(expected_geometry))
+    {
+        spdlog::error("FrameAllocationTest: Expected geometry could not be encoded");
+        failed_count++;
+    }
+
+    std::vector<TestFrame*> frames;
+    RingQueue<TestFrame*> frame_pool;
+    RingQueue<TestFrame*> output_queue;
+    frame_pool.create(FRAME_ALLOCATION_TEST_FRAME_COUNT);
+    output_queue.create(FRAME_ALLOCATION_TEST_FRAME_COUNT);
+
+    for (uint32_t index = 0; index < FRAME_ALLOCATION_TEST_FRAME_COUNT; index++)
+    {
+        TestFrame* frame = new TestFrame;
+        frame->pattern = index % FRAME_ALLOCATION_TEST_PATTERN_COUNT;
+
+        for (uint32_t view = 0; view < FRAME_ALLOCATION_TEST_VIEW_COUNT; view++)
+        {
+            frame->views[view].frame = frame;
+            frame->views[view].view = view;
+        }
+
+        frames.push_back(frame);
+        frame_pool.push(frame);
+    }
+
+    //Same round trip of the frames as WorkerPool::submit and WorkerPool::reclaim
+    uint32_t total_count = FRAME_ALLOCATION_TEST_WARMUP_COUNT + FRAME_ALLOCATION_TEST_STEP_COUNT;
+    uint32_t submit_count = 0;
+    uint32_t complete_count = 0;
+    uint64_t steady_allocation_count = 0;
+
+    while (complete_count < total_count)
+    {
+        bool idle = true;
+        TestFrame* frame = nullptr;
+
+        while (output_queue.pop(frame))
+        {
+            if (!frame->encoded || frame->geometry != expected_geometry[frame->pattern])
+            {
+                spdlog::error("FrameAllocationTest: Frame {} has the wrong geometry", frame->step);
+                failed_count++;
+            }
+
+            complete_count++;
+            frame_pool.push(frame);
+            idle = false;
+        }
+
+        if (submit_count < total_count && frame_pool.pop(frame))
+        {
+            if (submit_count == FRAME_ALLOCATION_TEST_WARMUP_COUNT)
+            {
+                steady_allocation_count = allocation_count;
+            }
+
+            frame->step = submit_count++;
+            test_submit(scheduler, output_queue, frame);
+            idle = false;
+        }
+
+        if (idle)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    steady_allocation_count = allocation_count - steady_allocation_count;
+
+    if (steady_allocation_count > 0)
+    {
+        spdlog::error("FrameAllocationTest: {} frames allocated {} times after the warmup", FRAME_ALLOCATION_TEST_STEP_COUNT, steady_allocation_count);
+        failed_count++;
+    }
+
+    scheduler.destroy();
+    thread_placement.destroy();
+
+    for (TestFrame* frame : frames)
+    {
+        delete frame;
+    }
+
+    frame_pool.destroy();
+    output_queue.destroy();
+
+    spdlog::info("FrameAllocationTest: Failed checks {}", failed_count);
+
+    return (failed_count == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,529 @@
+#include "mesh_generator/line_delaunay.hpp"
+
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Triangulation_vertex_base_with_info_2.h>
+#include <CGAL/Triangulation_face_base_with_info_2.h>
+#include <CGAL/Constrained_Delaunay_triangulation_2.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <iterator>
+#include <chrono>
+#include <random>
+#include <array>
+#include <queue>
+#include <cmath>
+#include <map>
+
+#define LINE_DELAUNAY_TEST_SCENE_COUNT      64   // Number of random scenes that are compared against CGAL
+#define LINE_DELAUNAY_TEST_POINT_COUNT      1024 // Number of free points of each scene
+#define LINE_DELAUNAY_TEST_CONSTRAINT_COUNT 256  // Number of constraint candidates of each scene
+#define LINE_DELAUNAY_TEST_CROSSING_COUNT   64   // Number of constraints of each scene with crossing constraints
+#define LINE_DELAUNAY_TEST_GRID_SIZE        16   // Grid on which the points of every second scene are placed to provoke collinear and cocircular points
+#define LINE_DELAUNAY_TEST_SPLIT_TOLERANCE  4.0  // Maximum distance between the parts of a split constraint and its original line in pixels, since every split is rounded
+
+typedef CGAL::Exact_predicates_inexact_constructions_kernel Kernel;
+typedef CGAL::Triangulation_vertex_base_with_info_2<uint32_t, Kernel> VertexBase;
+typedef CGAL::Triangulation_face_base_with_info_2<uint32_t, Kernel> FaceBase;
+typedef CGAL::Constrained_triangulation_face_base_2<Kernel, FaceBase> ConstraintFaceBase;
+typedef CGAL::Triangulation_data_structure_2<VertexBase, ConstraintFaceBase> TriangulationDataStructure;
+typedef CGAL::Constrained_Delaunay_triangulation_2<Kernel, TriangulationDataStructure, CGAL::Exact_predicates_tag> ConstrainedTriangulation;
+typedef ConstrainedTriangulation::Point_2 Point;
+typedef ConstrainedTriangulation::Vertex_handle VertexHandle;
+typedef ConstrainedTriangulation::Face_handle FaceHandle;
+
+typedef std::array<glm::ivec2, 2> TestConstraint;
+typedef std::array<uint32_t, 3> TestTriangle;
+
+struct TestScene
+{
+    glm::ivec2 domain_max = glm::ivec2(0);
+    std::vector<glm::ivec2> points;
+    std::vector<TestConstraint> constraints;
+    bool crossing = false;
+};
+
+int64_t test_orientation(const glm::ivec2& point1, const glm::ivec2& point2, const glm::ivec2& point3)
+{
+    return (int64_t)(point2.x - point1.x) * (int64_t)(point3.y - point1.y) - (int64_t)(point2.y - point1.y) * (int64_t)(point3.x - point1.x);
+}
+
+int64_t test_in_circle(const glm::ivec2& point1, const glm::ivec2& point2, const glm::ivec2& point3, const glm::ivec2& point4)
+{
+    int64_t delta1_x = point1.x - point4.x;
+    int64_t delta1_y = point1.y - point4.y;
+    int64_t delta2_x = point2.x - point4.x;
+    int64_t delta2_y = point2.y - point4.y;
+    int64_t delta3_x = point3.x - point4.x;
+    int64_t delta3_y = point3.y - point4.y;
+
+    int64_t length1 = delta1_x * delta1_x + delta1_y * delta1_y;
+    int64_t length2 = delta2_x * delta2_x + delta2_y * delta2_y;
+    int64_t length3 = delta3_x * delta3_x + delta3_y * delta3_y;
+
+    return delta1_x * (delta2_y * length3 - length2 * delta3_y) - delta1_y * (delta2_x * length3 - length2 * delta3_x) + length1 * (delta2_x * delta3_y - delta2_y * delta3_x);
+}
+
+uint32_t test_key(const glm::ivec2& point)
+{
+    return (point.y << 16) | point.x;
+}
+
+//Checks if the point lies on the constraint within the given distance.
+//Both tests are scaled by the length of the constraint so that they stay exact for a distance of zero.
+bool test_on_constraint(const TestConstraint& constraint, const glm::ivec2& point, double tolerance)
+{
+    glm::ivec2 direction = constraint[1] - constraint[0];
+    glm::ivec2 offset = point - constraint[0];
+
+    int64_t length_square = (int64_t)direction.x * (int64_t)direction.x + (int64_t)direction.y * (int64_t)direction.y;
+    int64_t projection = (int64_t)offset.x * (int64_t)direction.x + (int64_t)offset.y * (int64_t)direction.y;
+    int64_t distance = std::abs(test_orientation(constraint[0], constraint[1], point));
+
+    double length = std::sqrt((double)length_square);
+
+    return distance <= tolerance * length && projection >= -tolerance * length && projection <= length_square + tolerance * length;
+}
+
+//Checks if two constraints share more than a common end point
+bool test_touches(const TestConstraint& constraint1, const TestConstraint& constraint2)
+{
+    for (const glm::ivec2& point1 : constraint1)
+    {
+        for (const glm::ivec2& point2 : constraint2)
+        {
+            if (point1 == point2)
+            {
+                return test_orientation(constraint1[0], constraint1[1], constraint2[0]) == 0 && test_orientation(constraint1[0], constraint1[1], constraint2[1]) == 0;
+            }
+        }
+    }
+
+    int64_t side1 = test_orientation(constraint1[0], constraint1[1], constraint2[0]);
+    int64_t side2 = test_orientation(constraint1[0], constraint1[1], constraint2[1]);
+    int64_t side3 = test_orientation(constraint2[0], constraint2[1], constraint1[0]);
+    int64_t side4 = test_orientation(constraint2[0], constraint2[1], constraint1[1]);
+
+    if (side1 == 0 && test_on_constraint(constraint1, constraint2[0], 0.0))
+    {
+        return true;
+    }
+
+    if (side2 == 0 && test_on_constraint(constraint1, constraint2[1], 0.0))
+    {
+        return true;
+    }
+
+    if (side3 == 0 && test_on_constraint(constraint2, constraint1[0], 0.0))
+    {
+        return true;
+    }
+
+    if (side4 == 0 && test_on_constraint(constraint2, constraint1[1], 0.0))
+    {
+        return true;
+    }
+
+    return ((side1 < 0 && side2 > 0) || (side1 > 0 && side2 < 0)) && ((side3 < 0 && side4 > 0) || (side3 > 0 && side4 < 0));
+}
+
+TestScene test_create_scene(std::mt19937& generator, uint32_t scene_index)
+{
+    TestScene scene;
+    scene.domain_max = glm::ivec2(64 + generator() % 1984, 64 + generator() % 1984);
+    scene.crossing = (scene_index % 4) == 3;
+
+    uint32_t grid_size = (scene_index % 2 == 0) ? LINE_DELAUNAY_TEST_GRID_SIZE : 1;
+
+    auto create_point = [&]()
+    {
+        glm::ivec2 point = glm::ivec2(generator() % (scene.domain_max.x + 1), generator() % (scene.domain_max.y + 1));
+
+        return (point / (int32_t)grid_size) * (int32_t)grid_size;
+    };
+
+    for (uint32_t index = 0; index < LINE_DELAUNAY_TEST_POINT_COUNT; index++)
+    {
+        scene.points.push_back(create_point());
+    }
+
+    uint32_t constraint_count = scene.crossing ? LINE_DELAUNAY_TEST_CROSSING_COUNT : LINE_DELAUNAY_TEST_CONSTRAINT_COUNT;
+
+    for (uint32_t index = 0; index < constraint_count; index++)
+    {
+        TestConstraint constraint = { create_point(), create_point() };
+
+        if (constraint[0] == constraint[1])
+        {
+            continue;
+        }
+
+        //Without crossings the integer triangulation has to produce the same result as CGAL
+        if (!scene.crossing)
+        {
+            bool touches = std::any_of(scene.constraints.begin(), scene.constraints.end(), [&](const TestConstraint& other)
+            {
+                return test_touches(constraint, other);
+            });
+
+            if (touches)
+            {
+                continue;
+            }
+        }
+
+        scene.constraints.push_back(constraint);
+    }
+
+    return scene;
+}
+
+bool test_triangulate_delaunay(const TestScene& scene, LineDelaunay& delaunay, std::vector<TestTriangle>& triangles, double& time)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    delaunay.clear(glm::ivec2(0), scene.domain_max);
+
+    for (const glm::ivec2& point : scene.points)
+    {
+        delaunay.insert_point(point);
+    }
+
+    bool inserted = true;
+
+    for (const TestConstraint& constraint : scene.constraints)
+    {
+        uint32_t point_index1 = delaunay.insert_point(constraint[0]);
+        uint32_t point_index2 = delaunay.insert_point(constraint[1]);
+
+        if (!delaunay.insert_constraint(point_index1, point_index2))
+        {
+            spdlog::error("LineDelaunayTest: Constraint ({}, {}) - ({}, {}) could not be inserted", constraint[0].x, constraint[0].y, constraint[1].x, constraint[1].y);
+            inserted = false;
+        }
+    }
+
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    time += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(end - start).count();
+
+    triangles.clear();
+
+    for (uint32_t index = 0; index < delaunay.get_triangle_count(); index++)
+    {
+        glm::uvec3 triangle = delaunay.get_triangle(index);
+
+        triangles.push_back({ triangle.x, triangle.y, triangle.z });
+    }
+
+    return inserted;
+}
+
+void test_triangulate_cgal(const TestScene& scene, std::vector<glm::ivec2>& points, std::vector<TestTriangle>& triangles, double& time)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    ConstrainedTriangulation triangulation;
+
+    std::array<VertexHandle, 4> corners;
+    corners[0] = triangulation.insert(Point(0, 0));
+    corners[1] = triangulation.insert(Point(scene.domain_max.x, 0));
+    corners[2] = triangulation.insert(Point(scene.domain_max.x, scene.domain_max.y));
+    corners[3] = triangulation.insert(Point(0, scene.domain_max.y));
+
+    for (uint32_t index = 0; index < corners.size(); index++)
+    {
+        triangulation.insert_constraint(corners[index], corners[(index + 1) % corners.size()]);
+    }
+
+    for (const glm::ivec2& point : scene.points)
+    {
+        triangulation.insert(Point(point.x, point.y));
+    }
+
+    for (const TestConstraint& constraint : scene.constraints)
+    {
+        triangulation.insert_constraint(Point(constraint[0].x, constraint[0].y), Point(constraint[1].x, constraint[1].y));
+    }
+
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    time += std::chrono::duration_cast<std::chrono::duration<double, std::chrono::milliseconds::period>>(end - start).count();
+
+    points.clear();
+    triangles.clear();
+
+    for (VertexHandle vertex_handle : triangulation.finite_vertex_handles())
+    {
+        vertex_handle->info() = points.size();
+        points.push_back(glm::ivec2(vertex_handle->point().x(), vertex_handle->point().y()));
+    }
+
+    for (FaceHandle face_handle : triangulation.finite_face_handles())
+    {
+        triangles.push_back({ face_handle->vertex(0)->info(), face_handle->vertex(1)->info(), face_handle->vertex(2)->info() });
+    }
+}
+
+//Checks if the edge between both points belongs to a constraint or to the border of the domain
+bool test_is_constrained(const TestScene& scene, const glm::ivec2& point1, const glm::ivec2& point2)
+{
+    if ((point1.x == point2.x && (point1.x == 0 || point1.x == scene.domain_max.x)) || (point1.y == point2.y && (point1.y == 0 || point1.y == scene.domain_max.y)))
+    {
+        return true;
+    }
+
+    double tolerance = scene.crossing ? LINE_DELAUNAY_TEST_SPLIT_TOLERANCE : 0.0;
+
+    for (const TestConstraint& constraint : scene.constraints)
+    {
+        if (test_on_constraint(constraint, point1, tolerance) && test_on_constraint(constraint, point2, tolerance))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool test_validate(const TestScene& scene, const std::vector<glm::ivec2>& points, const std::vector<TestTriangle>& triangles)
+{
+    uint32_t error_count = 0;
+    int64_t area = 0;
+
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> edge_opposites;
+
+    for (const TestTriangle& triangle : triangles)
+    {
+        int64_t orientation = test_orientation(points[triangle[0]], points[triangle[1]], points[triangle[2]]);
+
+        if (orientation <= 0)
+        {
+            error_count++;
+        }
+
+        area += orientation;
+
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+            edge_opposites[std::make_pair(triangle[corner], triangle[(corner + 1) % 3])] = triangle[(corner + 2) % 3];
+        }
+    }
+
+    if (area != 2 * (int64_t)scene.domain_max.x * (int64_t)scene.domain_max.y)
+    {
+        spdlog::error("LineDelaunayTest: Triangles do not cover the domain");
+        error_count++;
+    }
+
+    for (const std::pair<const std::pair<uint32_t, uint32_t>, uint32_t>& edge : edge_opposites)
+    {
+        const glm::ivec2& point1 = points[edge.first.first];
+        const glm::ivec2& point2 = points[edge.first.second];
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t>::const_iterator twin = edge_opposites.find(std::make_pair(edge.first.second, edge.first.first));
+
+        if (twin == edge_opposites.end())
+        {
+            bool border = (point1.x == point2.x && (point1.x == 0 || point1.x == scene.domain_max.x)) || (point1.y == point2.y && (point1.y == 0 || point1.y == scene.domain_max.y));
+
+            if (!border)
+            {
+                error_count++;
+            }
+        }
+
+        else if (!test_is_constrained(scene, point1, point2) && test_in_circle(point1, point2, points[edge.second], points[twin->second]) > 0)
+        {
+            error_count++;
+        }
+    }
+
+    if (error_count > 0)
+    {
+        spdlog::error("LineDelaunayTest: Triangulation has {} invalid triangles or edges", error_count);
+
+        return false;
+    }
+
+    //Every constraint has to be reachable along edges that follow the constraint
+    double tolerance = scene.crossing ? LINE_DELAUNAY_TEST_SPLIT_TOLERANCE : 0.0;
+
+    std::map<uint32_t, uint32_t> point_indices;
+    std::vector<std::vector<uint32_t>> point_neighbours(points.size());
+
+    for (uint32_t index = 0; index < points.size(); index++)
+    {
+        point_indices[test_key(points[index])] = index;
+    }
+
+    //Border edges only exist in one direction, so the neighbours are collected for both directions
+    for (const std::pair<const std::pair<uint32_t, uint32_t>, uint32_t>& edge : edge_opposites)
+    {
+        point_neighbours[edge.first.first].push_back(edge.first.second);
+        point_neighbours[edge.first.second].push_back(edge.first.first);
+    }
+
+    for (const TestConstraint& constraint : scene.constraints)
+    {
+        uint32_t start_point = point_indices[test_key(constraint[0])];
+        uint32_t end_point = point_indices[test_key(constraint[1])];
+
+        std::vector<bool> visited(points.size(), false);
+        std::queue<uint32_t> queue;
+
+        visited[start_point] = true;
+        queue.push(start_point);
+
+        while (!queue.empty() && !visited[end_point])
+        {
+            uint32_t point = queue.front();
+            queue.pop();
+
+            for (uint32_t next_point : point_neighbours[point])
+            {
+                if (!visited[next_point] && test_on_constraint(constraint, points[next_point], tolerance))
+                {
+                    visited[next_point] = true;
+                    queue.push(next_point);
+                }
+            }
+        }
+
+        if (!visited[end_point])
+        {
+            spdlog::error("LineDelaunayTest: Constraint ({}, {}) - ({}, {}) is missing", constraint[0].x, constraint[0].y, constraint[1].x, constraint[1].y);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//Compare the triangles by position, since the point order of both triangulations differ.
+//Each triangle is rotated so that it starts with its smallest point, which keeps the winding order intact.
+std::vector<std::array<uint32_t, 3>> test_collect_triangles(const std::vector<glm::ivec2>& points, const std::vector<TestTriangle>& triangles)
+{
+    std::vector<std::array<uint32_t, 3>> keys;
+
+    for (const TestTriangle& triangle : triangles)
+    {
+        std::array<uint32_t, 3> key = { test_key(points[triangle[0]]), test_key(points[triangle[1]]), test_key(points[triangle[2]]) };
+
+        std::rotate(key.begin(), std::min_element(key.begin(), key.end()), key.end());
+        keys.push_back(key);
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    return keys;
+}
+
+//Cocircular points on the integer grid have no unique delaunay triangulation.
+//A differing triangle is only accepted if it shares an unconstrained edge with a triangle whose opposite point lies on its circumcircle.
+bool test_compare(const TestScene& scene, const std::vector<glm::ivec2>& delaunay_points, const std::vector<TestTriangle>& delaunay_triangles, const std::vector<glm::ivec2>& cgal_points, const std::vector<TestTriangle>& cgal_triangles)
+{
+    std::vector<std::array<uint32_t, 3>> delaunay_keys = test_collect_triangles(delaunay_points, delaunay_triangles);
+    std::vector<std::array<uint32_t, 3>> cgal_keys = test_collect_triangles(cgal_points, cgal_triangles);
+    std::vector<std::array<uint32_t, 3>> differing_keys;
+
+    if (delaunay_keys.size() != cgal_keys.size())
+    {
+        spdlog::error("LineDelaunayTest: Triangle count {} differs from CGAL triangle count {}", delaunay_keys.size(), cgal_keys.size());
+
+        return false;
+    }
+
+    std::set_difference(delaunay_keys.begin(), delaunay_keys.end(), cgal_keys.begin(), cgal_keys.end(), std::back_inserter(differing_keys));
+
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> edge_opposites;
+
+    for (const std::array<uint32_t, 3>& key : delaunay_keys)
+    {
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+            edge_opposites[std::make_pair(key[corner], key[(corner + 1) % 3])] = key[(corner + 2) % 3];
+        }
+    }
+
+    auto key_point = [](uint32_t key)
+    {
+        return glm::ivec2(key & 0xFFFF, key >> 16);
+    };
+
+    uint32_t mismatch_count = 0;
+
+    for (const std::array<uint32_t, 3>& key : differing_keys)
+    {
+        bool cocircular = false;
+
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+            std::map<std::pair<uint32_t, uint32_t>, uint32_t>::const_iterator twin = edge_opposites.find(std::make_pair(key[(corner + 1) % 3], key[corner]));
+
+            if (twin == edge_opposites.end() || test_is_constrained(scene, key_point(key[corner]), key_point(key[(corner + 1) % 3])))
+            {
+                continue;
+            }
+
+            if (test_in_circle(key_point(key[0]), key_point(key[1]), key_point(key[2]), key_point(twin->second)) == 0)
+            {
+                cocircular = true;
+            }
+        }
+
+        if (!cocircular)
+        {
+            mismatch_count++;
+        }
+    }
+
+    if (mismatch_count > 0)
+    {
+        spdlog::error("LineDelaunayTest: {} triangles differ from CGAL", mismatch_count);
+
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    std::mt19937 generator(7);
+
+    LineDelaunay delaunay;
+    double time_delaunay = 0.0;
+    double time_cgal = 0.0;
+    uint32_t failed_count = 0;
+
+    std::vector<TestTriangle> delaunay_triangles;
+    std::vector<glm::ivec2> cgal_points;
+    std::vector<TestTriangle> cgal_triangles;
+
+    for (uint32_t scene_index = 0; scene_index < LINE_DELAUNAY_TEST_SCENE_COUNT; scene_index++)
+    {
+        TestScene scene = test_create_scene(generator, scene_index);
+
+        double time_scene = 0.0;
+
+        bool success = test_triangulate_delaunay(scene, delaunay, delaunay_triangles, time_scene);
+        success = success && test_validate(scene, delaunay.get_points(), delaunay_triangles);
+
+        //CGAL inserts the intersections of crossing constraints without rounding, which can not be compared
+        if (success && !scene.crossing)
+        {
+            time_delaunay += time_scene;
+
+            test_triangulate_cgal(scene, cgal_points, cgal_triangles, time_cgal);
+            success = test_compare(scene, delaunay.get_points(), delaunay_triangles, cgal_points, cgal_triangles);
+        }
+
+        if (!success)
+        {
+            spdlog::error("LineDelaunayTest: Scene {} failed", scene_index);
+            failed_count++;
+        }
+    }
+
+    spdlog::info("LineDelaunayTest: Delaunay {} ms, CGAL {} ms, Failed scenes {} / {}", time_delaunay, time_cgal, failed_count, LINE_DELAUNAY_TEST_SCENE_COUNT);
+
+    return (failed_count == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,484 @@
+#include "mesh_generator/loop_reference.hpp"
+#include "mesh_generator/loop_triangulation.hpp"
+#include "export.hpp"
+#include "scheduler.hpp"
+#include "thread_placement.hpp"
+
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+#include <set>
+
+#define LOOP_REFERENCE_TEST_SCENE_COUNT   200 // Number of synthetic scenes that are checked against a global trace of the vector field
+#define LOOP_REFERENCE_TEST_SHAPE_COUNT   12  // Maximum number of shapes of each synthetic scene
+#define LOOP_REFERENCE_TEST_THREAD_COUNT  4   // Number of threads of the scheduler whose result has to be identical to the result of the calling thread
+#define LOOP_REFERENCE_TEST_TRACE_LENGTH  10000000 // Number of steps after which the global trace assumes that the vector field contains an infinite path
+
+struct TestScene
+{
+    glm::uvec2 resolution = glm::uvec2(0);
+    std::vector<float> depth;
+    std::vector<glm::vec2> normals;
+    std::vector<uint32_t> object_ids;
+};
+
+bool test_equal_loop(const glsl::Loop& loop1, const glsl::Loop& loop2)
+{
+    return loop1.segment_count == loop2.segment_count && loop1.segment_offset == loop2.segment_offset && loop1.loop_length == loop2.loop_length && loop1.loop_flag == loop2.loop_flag;
+}
+
+bool test_equal_segment(const glsl::LoopSegment& segment1, const glsl::LoopSegment& segment2)
+{
+    return segment1.end_coord == segment2.end_coord && segment1.end_coord_depth == segment2.end_coord_depth;
+}
+
+//Reads a depth image in the format written by export_depth_image
+bool test_load_depth_image(const std::string& file_name, glm::uvec2& resolution, std::vector<float>& depth)
+{
+    std::ifstream file(file_name, std::ios::in | std::ios::binary);
+
+    if (!file.good())
+    {
+        spdlog::error("LoopReferenceTest: Can't open depth image {}", file_name);
+
+        return false;
+    }
+
+    std::string format;
+    float scale = 0.0f;
+    file >> format >> resolution.x >> resolution.y >> scale;
+    file.get(); //Single whitespace in front of the data
+
+    if (!file.good() || format != "Pf" || scale >= 0.0f)
+    {
+        spdlog::error("LoopReferenceTest: Depth image {} is not a little endian pfm file", file_name);
+
+        return false;
+    }
+
+    depth.resize(resolution.x * resolution.y);
+    file.read((char*)depth.data(), depth.size() * sizeof(float));
+
+    if (!file.good())
+    {
+        spdlog::error("LoopReferenceTest: Depth image {} is truncated", file_name);
+
+        return false;
+    }
+
+    return true;
+}
+
+//Overlapping rectangles and ellipses with random depth, normal and object id. Every second scene has a background and shapes at the same depth, so that only normals and object ids separate them.
+TestScene test_create_scene(uint32_t scene_index)
+{
+    std::mt19937 generator(scene_index);
+
+    TestScene scene;
+    scene.resolution = glm::uvec2(17 + generator() % 150, 9 + generator() % 120);
+
+    //Degenerate resolutions that are smaller than a cell of the base pass
+    if (scene_index == 0)
+    {
+        scene.resolution = glm::uvec2(1, 1);
+    }
+
+    else if (scene_index == 1)
+    {
+        scene.resolution = glm::uvec2(3, 2);
+    }
+
+    uint32_t pixel_count = scene.resolution.x * scene.resolution.y;
+    scene.depth.assign(pixel_count, (scene_index % 2 == 0) ? 0.5f : 1.0f);
+    scene.normals.assign(pixel_count, glm::vec2(0.5f, 0.5f));
+    scene.object_ids.assign(pixel_count, 0);
+
+    uint32_t shape_count = 1 + generator() % LOOP_REFERENCE_TEST_SHAPE_COUNT;
+
+    for (uint32_t shape = 0; shape < shape_count; shape++)
+    {
+        int32_t center_x = generator() % scene.resolution.x;
+        int32_t center_y = generator() % scene.resolution.y;
+        int32_t radius_x = 1 + generator() % std::max(1u, scene.resolution.x / 3);
+        int32_t radius_y = 1 + generator() % std::max(1u, scene.resolution.y / 3);
+        float depth = 0.1f + 0.8f * (generator() % 1000) / 1000.0f;
+        bool ellipse = (generator() % 2) == 0;
+        glm::vec2 normal = glm::vec2((generator() % 256) / 255.0f, (generator() % 256) / 255.0f);
+
+        if (scene_index % 2 == 0 && shape % 2 == 0)
+        {
+            depth = 0.5f;
+        }
+
+        for (int32_t y = 0; y < (int32_t)scene.resolution.y; y++)
+        {
+            for (int32_t x = 0; x < (int32_t)scene.resolution.x; x++)
+            {
+                int64_t delta_x = x - center_x;
+                int64_t delta_y = y - center_y;
+                bool inside = false;
+
+                if (ellipse)
+                {
+                    inside = delta_x * delta_x * radius_y * radius_y + delta_y * delta_y * radius_x * radius_x <= (int64_t)radius_x * radius_x * radius_y * radius_y;
+                }
+
+                else
+                {
+                    inside = std::abs(delta_x) <= radius_x && std::abs(delta_y) <= radius_y;
+                }
+
+                uint32_t index = y * scene.resolution.x + x;
+
+                if (inside && depth <= scene.depth[index])
+                {
+                    scene.depth[index] = depth;
+                    scene.normals[index] = normal;
+                    scene.object_ids[index] = shape + 1;
+                }
+            }
+        }
+    }
+
+    return scene;
+}
+
+//Follows the vector field from every vector of the base cells without the cell hierarchy of the reference and checks that both find the same loops
+bool test_trace(const LoopReference& reference, uint32_t loop_length_min)
+{
+    const uint8_t* vector_pointer = reference.get_vector_pointer();
+    glm::uvec2 vector_resolution = reference.get_vector_resolution();
+    glm::ivec2 coverage = glm::ivec2((vector_resolution / glm::uvec2(LOOP_GENERATOR_BASE_CELL_SIZE)) * glm::uvec2(LOOP_GENERATOR_BASE_CELL_SIZE));
+
+    const glsl::LoopCount& loop_count = *reference.get_loop_count_pointer();
+    const glsl::Loop* loops = reference.get_loop_pointer();
+    const glsl::LoopSegment* segments = reference.get_loop_segment_pointer();
+
+    auto fetch_vector = [&](const glm::ivec2& coord) -> uint32_t
+    {
+        if (coord.x < 0 || coord.y < 0 || coord.x >= coverage.x || coord.y >= coverage.y)
+        {
+            return 0;
+        }
+
+        return vector_pointer[coord.y * vector_resolution.x + coord.x];
+    };
+
+    //Loops are identified by their length and whether they contain a cut
+    std::multiset<std::pair<uint32_t, uint32_t>> trace_loops;
+    std::vector<uint8_t> visited(vector_resolution.x * vector_resolution.y, 0);
+
+    for (int32_t y = 0; y < coverage.y; y++)
+    {
+        for (int32_t x = 0; x < coverage.x; x++)
+        {
+            if (visited[y * vector_resolution.x + x] != 0 || fetch_vector(glm::ivec2(x, y)) == 0)
+            {
+                continue;
+            }
+
+            glm::ivec2 coord = glm::ivec2(x, y);
+            uint32_t length = 0;
+            uint32_t bitfield = 0;
+            bool outside = false;
+
+            while (true)
+            {
+                if (coord.x < 0 || coord.y < 0 || coord.x >= coverage.x || coord.y >= coverage.y)
+                {
+                    outside = true;
+
+                    break;
+                }
+
+                if (visited[coord.y * vector_resolution.x + coord.x] != 0)
+                {
+                    break;
+                }
+
+                if (length >= LOOP_REFERENCE_TEST_TRACE_LENGTH)
+                {
+                    spdlog::error("LoopReferenceTest: Vector field contains an infinite path");
+
+                    return false;
+                }
+
+                visited[coord.y * vector_resolution.x + coord.x] = 1;
+
+                uint32_t vector = fetch_vector(coord);
+                bitfield |= vector;
+                coord += LoopReference::decode_direction(vector);
+                length++;
+            }
+
+            //Open paths and paths that run into a loop that was already traced are not loops
+            if (outside || coord != glm::ivec2(x, y))
+            {
+                continue;
+            }
+
+            bool is_cut = (bitfield & LOOP_GENERATOR_VECTOR_CUT) != 0;
+
+            if (is_cut || length >= loop_length_min)
+            {
+                trace_loops.insert(std::make_pair(length, is_cut ? 1u : 0u));
+            }
+        }
+    }
+
+    std::multiset<std::pair<uint32_t, uint32_t>> reference_loops;
+
+    for (uint32_t loop_index = 0; loop_index < loop_count.loop_counter; loop_index++)
+    {
+        reference_loops.insert(std::make_pair(loops[loop_index].loop_length, loops[loop_index].loop_flag & LOOP_GENERATOR_LOOP_CUT));
+    }
+
+    if (trace_loops != reference_loops)
+    {
+        spdlog::error("LoopReferenceTest: Reference found {} loops but the global trace found {} loops", reference_loops.size(), trace_loops.size());
+
+        return false;
+    }
+
+    //The segments of a loop have to lie on its path in order and end exactly where the direction changes or a bridge starts
+    for (uint32_t loop_index = 0; loop_index < loop_count.loop_counter; loop_index++)
+    {
+        const glsl::Loop& loop = loops[loop_index];
+
+        if (loop.segment_count == 0 || loop.segment_offset + loop.segment_count > loop_count.segment_counter)
+        {
+            spdlog::error("LoopReferenceTest: Segments of loop {} are out of bounds", loop_index);
+
+            return false;
+        }
+
+        const glsl::LoopSegment* loop_segments = segments + loop.segment_offset;
+        glm::ivec2 start_coord = glm::ivec2(loop_segments[0].end_coord);
+        glm::ivec2 coord = start_coord;
+
+        std::vector<glm::ivec2> path;
+
+        for (uint32_t step = 0; step < loop.loop_length; step++)
+        {
+            path.push_back(coord);
+            coord += LoopReference::decode_direction(fetch_vector(coord));
+        }
+
+        if (coord != start_coord)
+        {
+            spdlog::error("LoopReferenceTest: Loop {} is not closed after its length", loop_index);
+
+            return false;
+        }
+
+        uint32_t path_index = 0;
+
+        for (uint32_t segment = 0; segment < loop.segment_count; segment++)
+        {
+            while (path_index < path.size() && path[path_index] != glm::ivec2(loop_segments[segment].end_coord))
+            {
+                path_index++;
+            }
+
+            if (path_index == path.size())
+            {
+                spdlog::error("LoopReferenceTest: Segments of loop {} are not on its path", loop_index);
+
+                return false;
+            }
+        }
+
+        uint32_t change_count = 0;
+
+        for (uint32_t step = 0; step < path.size(); step++)
+        {
+            uint32_t vector = fetch_vector(path[step]);
+            uint32_t previous_vector = fetch_vector(path[(step + path.size() - 1) % path.size()]);
+
+            if ((vector & 0x03) != (previous_vector & 0x03) || (vector & LOOP_GENERATOR_VECTOR_BRIDGE) != 0)
+            {
+                change_count++;
+            }
+        }
+
+        if (change_count != loop.segment_count)
+        {
+            spdlog::error("LoopReferenceTest: Loop {} has {} segments but {} changes of direction", loop_index, loop.segment_count, change_count);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//Triangulates the loops of the reference like the reference generator and checks that the mesh is consistent
+bool test_triangulate(const LoopReference& reference, const glm::uvec2& resolution, float triangle_scale, LoopTriangulation& triangulation)
+{
+    std::vector<shared::Vertex> vertices;
+    std::vector<shared::Index> indices;
+    std::vector<MeshFeatureLine> feature_lines;
+    shared::ViewMetadata metadata;
+
+    if (!triangulation.process(resolution, triangle_scale, reference.get_loop_pointer(), reference.get_loop_count_pointer(), reference.get_loop_segment_pointer(), vertices, indices, metadata, feature_lines, false, false, nullptr))
+    {
+        spdlog::error("LoopReferenceTest: Triangulation failed");
+
+        return false;
+    }
+
+    if (indices.size() % 3 != 0)
+    {
+        spdlog::error("LoopReferenceTest: Triangulation produced an incomplete triangle");
+
+        return false;
+    }
+
+    for (shared::Index index : indices)
+    {
+        if (index >= vertices.size())
+        {
+            spdlog::error("LoopReferenceTest: Triangulation produced an index out of bounds");
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//Processes the image with every combination of settings and checks the result against the global trace, the triangulation and the result of the scheduler
+bool test_image(const glm::uvec2& resolution, const std::vector<float>& depth, const std::vector<glm::vec2>* normals, const std::vector<uint32_t>* object_ids, Scheduler& scheduler)
+{
+    const glm::vec2* normal_pointer = (normals != nullptr) ? normals->data() : nullptr;
+    const uint32_t* object_id_pointer = (object_ids != nullptr) ? object_ids->data() : nullptr;
+
+    LoopReference reference;
+    LoopReference parallel_reference;
+    LoopTriangulation triangulation;
+
+    if (!reference.create(resolution) || !parallel_reference.create(resolution))
+    {
+        return false;
+    }
+
+    bool success = true;
+
+    for (uint32_t loop_length_min : { 0u, 20u, 100u })
+    {
+        shared::MeshSettings settings(shared::MESH_GENERATOR_TYPE_LOOP);
+        settings.loop.loop_length_min = loop_length_min;
+        settings.loop.use_normals = (normal_pointer != nullptr) && loop_length_min == 100;
+        settings.loop.use_object_ids = (object_id_pointer != nullptr) && loop_length_min > 0;
+
+        reference.apply(settings);
+        parallel_reference.apply(settings);
+
+        shared::LoopViewMetadata metadata;
+        reference.process(depth.data(), normal_pointer, object_id_pointer, metadata, nullptr);
+        parallel_reference.process(depth.data(), normal_pointer, object_id_pointer, metadata, &scheduler);
+
+        const glsl::LoopCount& loop_count = *reference.get_loop_count_pointer();
+        const glsl::LoopCount& parallel_loop_count = *parallel_reference.get_loop_count_pointer();
+
+        bool identical = loop_count.loop_counter == parallel_loop_count.loop_counter && loop_count.segment_counter == parallel_loop_count.segment_counter;
+        identical = identical && std::equal(reference.get_loop_pointer(), reference.get_loop_pointer() + loop_count.loop_counter, parallel_reference.get_loop_pointer(), test_equal_loop);
+        identical = identical && std::equal(reference.get_loop_segment_pointer(), reference.get_loop_segment_pointer() + loop_count.segment_counter, parallel_reference.get_loop_segment_pointer(), test_equal_segment);
+
+        if (!identical)
+        {
+            spdlog::error("LoopReferenceTest: Result depends on the scheduler with minimum loop length {}", loop_length_min);
+            success = false;
+        }
+
+        if (!test_trace(reference, loop_length_min) || !test_triangulate(reference, resolution, settings.loop.triangle_scale, triangulation))
+        {
+            spdlog::error("LoopReferenceTest: Check failed with minimum loop length {}", loop_length_min);
+            success = false;
+        }
+    }
+
+    reference.destroy();
+    parallel_reference.destroy();
+
+    return success;
+}
+
+//Without arguments the synthetic scenes are checked. Otherwise each argument is a depth image exported by the server, which is checked with normals and object ids disabled.
+int main(int argc, char** argv)
+{
+    ThreadPlacement thread_placement;
+
+    if (!thread_placement.create(THREAD_PLACEMENT_POLICY_NONE, std::nullopt, 0.0f))
+    {
+        return 1;
+    }
+
+    Scheduler scheduler;
+
+    if (!scheduler.create(&thread_placement, LOOP_REFERENCE_TEST_THREAD_COUNT))
+    {
+        return 1;
+    }
+
+    uint32_t image_count = 0;
+    uint32_t failed_count = 0;
+
+    if (argc > 1)
+    {
+        for (int32_t argument = 1; argument < argc; argument++)
+        {
+            glm::uvec2 resolution = glm::uvec2(0);
+            std::vector<float> depth;
+
+            if (!test_load_depth_image(argv[argument], resolution, depth) || !test_image(resolution, depth, nullptr, nullptr, scheduler))
+            {
+                spdlog::error("LoopReferenceTest: Image {} failed", argv[argument]);
+                failed_count++;
+            }
+
+            image_count++;
+        }
+    }
+
+    else
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "loop_reference_test";
+        std::filesystem::remove_all(directory);
+
+        for (uint32_t scene_index = 0; scene_index < LOOP_REFERENCE_TEST_SCENE_COUNT; scene_index++)
+        {
+            TestScene scene = test_create_scene(scene_index);
+
+            //Read the depth through the same file format that the server exports, so that exported images of real frames can be checked the same way
+            std::string file_name = (directory / ("scene_" + std::to_string(scene_index) + ".pfm")).string();
+            glm::uvec2 resolution = glm::uvec2(0);
+            std::vector<float> depth;
+
+            bool success = export_depth_image(file_name, scene.resolution, (uint8_t*)scene.depth.data(), scene.depth.size() * sizeof(float));
+            success = success && test_load_depth_image(file_name, resolution, depth);
+            success = success && resolution == scene.resolution && depth == scene.depth;
+            success = success && test_image(resolution, depth, &scene.normals, &scene.object_ids, scheduler);
+
+            if (!success)
+            {
+                spdlog::error("LoopReferenceTest: Scene {} with resolution {}x{} failed", scene_index, scene.resolution.x, scene.resolution.y);
+                failed_count++;
+            }
+
+            image_count++;
+        }
+
+        std::filesystem::remove_all(directory);
+    }
+
+    scheduler.destroy();
+    thread_placement.destroy();
+
+    spdlog::info("LoopReferenceTest: Failed images {} / {}", failed_count, image_count);
+
+    return (failed_count == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,368 @@
+#include "mesh_generator/quad_reference.hpp"
+#include "scheduler.hpp"
+#include "thread_placement.hpp"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <array>
+#include <random>
+
+#define QUAD_REFERENCE_TEST_PATTERN_COUNT    5      // Number of depth patterns that are checked for each resolution
+#define QUAD_REFERENCE_TEST_THREAD_COUNT     4      // Number of threads of the scheduler whose result has to match the simulation of the shaders
+#define QUAD_REFERENCE_TEST_DEPTH_MAX        0.995f // Depth at which the depth is clamped by the copy pass
+#define QUAD_REFERENCE_TEST_DEPTH_THRESHOLD  0.001f // Depth difference above which a quad is refined
+
+//Direct simulation of the copy, delta, refine, corner and write shader of the quad generator.
+//The refine pass is processed breadth first like the sequence of shader dispatches, and each atomic counter is replaced by the order of the invocations.
+struct TestSimulation
+{
+    std::vector<glm::uvec2> level_resolutions;
+    std::vector<std::vector<glm::vec2>> level_deltas;
+
+    //Image loads and texel fetches outside of the image return zero
+    glm::vec2 load_delta(const glm::ivec2& coord, uint32_t level) const
+    {
+        const glm::uvec2& resolution = this->level_resolutions[level];
+
+        if (coord.x < 0 || coord.y < 0 || coord.x >= (int32_t)resolution.x || coord.y >= (int32_t)resolution.y)
+        {
+            return glm::vec2(0.0f);
+        }
+
+        return this->level_deltas[level][coord.y * resolution.x + coord.x];
+    }
+
+    void process(const glm::uvec2& resolution, const std::vector<float>& depth, float depth_max, float depth_threshold, std::vector<shared::Vertex>& vertices, std::vector<shared::Index>& indices)
+    {
+        //Same levels and setup quads as in QuadGenerator::create_buffers
+        glm::uvec2 level_resolution = resolution;
+        uint32_t level_count = 1;
+
+        while (level_resolution.x > 32 || level_resolution.y > 32)
+        {
+            level_count++;
+
+            level_resolution = glm::max(glm::uvec2(1), level_resolution / glm::uvec2(2));
+        }
+
+        this->level_resolutions.clear();
+        this->level_deltas.clear();
+
+        for (uint32_t level = 0; level < level_count; level++)
+        {
+            glm::uvec2 delta_resolution = glm::max(glm::uvec2(1), resolution >> level);
+
+            this->level_resolutions.push_back(delta_resolution);
+            this->level_deltas.emplace_back(delta_resolution.x * delta_resolution.y);
+        }
+
+        //Copy pass
+        for (uint32_t index = 0; index < resolution.x * resolution.y; index++)
+        {
+            float value = glm::min(depth[index], depth_max);
+
+            this->level_deltas[0][index] = glm::vec2(value, value);
+        }
+
+        //Delta pass
+        for (uint32_t level = 1; level < level_count; level++)
+        {
+            const glm::uvec2& dst_resolution = this->level_resolutions[level];
+
+            for (uint32_t coord_y = 0; coord_y < dst_resolution.y; coord_y++)
+            {
+                for (uint32_t coord_x = 0; coord_x < dst_resolution.x; coord_x++)
+                {
+                    glm::vec2 dst_delta = glm::vec2(1.0f, 0.0f);
+
+                    for (uint32_t offset_y = 0; offset_y < 2; offset_y++)
+                    {
+                        for (uint32_t offset_x = 0; offset_x < 2; offset_x++)
+                        {
+                            glm::vec2 src_delta = this->load_delta(2 * glm::ivec2(coord_x, coord_y) + glm::ivec2(offset_x, offset_y), level - 1);
+
+                            dst_delta.x = glm::min(dst_delta.x, src_delta.x);
+                            dst_delta.y = glm::max(dst_delta.y, src_delta.y);
+                        }
+                    }
+
+                    this->level_deltas[level][coord_y * dst_resolution.x + coord_x] = dst_delta;
+                }
+            }
+        }
+
+        //Refine pass, one dispatch for each level
+        glm::ivec2 corner_resolution = glm::ivec2(resolution) + glm::ivec2(1);
+        std::vector<uint32_t> corner_buffer(corner_resolution.x * corner_resolution.y, 0);
+
+        std::vector<glsl::Quad> quads;
+        std::vector<glsl::Quad> src_refine_quads;
+        std::vector<glsl::Quad> dst_refine_quads;
+
+        for (uint32_t coord_y = 0; coord_y < level_resolution.y; coord_y++)
+        {
+            for (uint32_t coord_x = 0; coord_x < level_resolution.x; coord_x++)
+            {
+                glsl::Quad quad;
+                quad.coord = glm::u16vec2(coord_x, coord_y);
+                quad.level = level_count - 1;
+
+                src_refine_quads.push_back(quad);
+            }
+        }
+
+        for (int32_t level = level_count - 1; level >= 0; level--)
+        {
+            dst_refine_quads.clear();
+
+            for (const glsl::Quad& src_quad : src_refine_quads)
+            {
+                glm::ivec2 src_coord = glm::ivec2(src_quad.coord);
+                glm::vec2 delta = this->load_delta(src_coord, src_quad.level);
+
+                if (delta.y - delta.x > depth_threshold)
+                {
+                    for (uint32_t offset_y = 0; offset_y < 2; offset_y++)
+                    {
+                        for (uint32_t offset_x = 0; offset_x < 2; offset_x++)
+                        {
+                            glsl::Quad dst_quad;
+                            dst_quad.coord = glm::u16vec2(src_coord * 2 + glm::ivec2(offset_x, offset_y));
+                            dst_quad.level = src_quad.level - 1;
+
+                            dst_refine_quads.push_back(dst_quad);
+                        }
+                    }
+                }
+
+                else
+                {
+                    int32_t quad_size = (1 << src_quad.level);
+                    glm::ivec2 quad_coord = src_coord * quad_size;
+
+                    if (quad_coord.x >= corner_resolution.x || quad_coord.y >= corner_resolution.y)
+                    {
+                        continue;
+                    }
+
+                    for (uint32_t offset_y = 0; offset_y < 2; offset_y++)
+                    {
+                        for (uint32_t offset_x = 0; offset_x < 2; offset_x++)
+                        {
+                            glm::ivec2 corner_coord = quad_coord + quad_size * glm::ivec2(offset_x, offset_y);
+                            corner_coord = glm::clamp(corner_coord, glm::ivec2(0), corner_resolution - glm::ivec2(1));
+
+                            corner_buffer[corner_coord.y * corner_resolution.x + corner_coord.x] = QUAD_GENERATOR_CORNER_ALLOCATE_FLAG;
+                        }
+                    }
+
+                    quads.push_back(src_quad);
+                }
+            }
+
+            std::swap(src_refine_quads, dst_refine_quads);
+        }
+
+        //Corner pass, visited column by column so that the order of the vertices differs from the reference
+        vertices.clear();
+
+        for (int32_t coord_x = 0; coord_x < corner_resolution.x; coord_x++)
+        {
+            for (int32_t coord_y = 0; coord_y < corner_resolution.y; coord_y++)
+            {
+                uint32_t& corner = corner_buffer[coord_y * corner_resolution.x + coord_x];
+
+                if (corner != QUAD_GENERATOR_CORNER_ALLOCATE_FLAG)
+                {
+                    continue;
+                }
+
+                float depth_min = 1.0f;
+
+                for (int32_t offset_y = 0; offset_y < 2; offset_y++)
+                {
+                    for (int32_t offset_x = 0; offset_x < 2; offset_x++)
+                    {
+                        glm::ivec2 depth_coord = glm::ivec2(coord_x - 1 + offset_x, coord_y - 1 + offset_y);
+
+                        if (depth_coord.x < 0 || depth_coord.y < 0 || depth_coord.x >= (int32_t)resolution.x || depth_coord.y >= (int32_t)resolution.y)
+                        {
+                            continue;
+                        }
+
+                        depth_min = glm::min(depth_min, depth[depth_coord.y * resolution.x + depth_coord.x]);
+                    }
+                }
+
+                shared::Vertex vertex;
+                vertex.x = coord_x;
+                vertex.y = coord_y;
+                vertex.z = depth_min;
+
+                corner = vertices.size();
+                vertices.push_back(vertex);
+            }
+        }
+
+        //Write pass
+        auto corner_index = [&](const glm::ivec2& coord)
+        {
+            glm::ivec2 corner_coord = glm::clamp(coord, glm::ivec2(0), corner_resolution - glm::ivec2(1));
+
+            return corner_buffer[corner_coord.y * corner_resolution.x + corner_coord.x];
+        };
+
+        indices.clear();
+
+        for (const glsl::Quad& quad : quads)
+        {
+            int32_t quad_size = (1 << quad.level);
+            glm::ivec2 quad_coord = quad_size * glm::ivec2(quad.coord);
+
+            indices.push_back(corner_index(quad_coord));
+            indices.push_back(corner_index(quad_coord + glm::ivec2(quad_size, 0)));
+            indices.push_back(corner_index(quad_coord + glm::ivec2(quad_size, quad_size)));
+
+            indices.push_back(corner_index(quad_coord + glm::ivec2(quad_size, quad_size)));
+            indices.push_back(corner_index(quad_coord + glm::ivec2(0, quad_size)));
+            indices.push_back(corner_index(quad_coord));
+        }
+    }
+};
+
+std::vector<float> test_create_depth(const glm::uvec2& resolution, uint32_t pattern, std::mt19937& generator)
+{
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    std::vector<float> depth(resolution.x * resolution.y);
+
+    float slope_x = distribution(generator);
+    float slope_y = distribution(generator);
+
+    for (uint32_t coord_y = 0; coord_y < resolution.y; coord_y++)
+    {
+        for (uint32_t coord_x = 0; coord_x < resolution.x; coord_x++)
+        {
+            float value = 0.0f;
+
+            switch (pattern)
+            {
+            case 0: //Noise, which refines every quad down to the pixels
+                value = distribution(generator);
+                break;
+            case 1: //Constant depth, which keeps the setup quads
+                value = 0.5f;
+                break;
+            case 2: //Blocks of constant depth whose edges are not aligned with the quads
+                value = ((coord_x / 17 + coord_y / 13) % 3) * 0.3f;
+                break;
+            case 3: //Slope with a disc in front of it
+                value = (coord_x * slope_x + coord_y * slope_y) / (resolution.x + resolution.y);
+                value += (coord_x * coord_x + coord_y * coord_y < resolution.x * resolution.x / 4) ? 0.2f : 0.0f;
+                break;
+            default: //Background, which is clamped by the copy pass
+                value = (distribution(generator) < 0.5f) ? 1.0f : 0.25f;
+                break;
+            }
+
+            depth[coord_y * resolution.x + coord_x] = value;
+        }
+    }
+
+    return depth;
+}
+
+bool test_resolution(const glm::uvec2& resolution, std::mt19937& generator, Scheduler& scheduler)
+{
+    QuadReference reference;
+
+    if (!reference.create(resolution))
+    {
+        return false;
+    }
+
+    TestSimulation simulation;
+    bool success = true;
+
+    for (uint32_t pattern = 0; pattern < QUAD_REFERENCE_TEST_PATTERN_COUNT; pattern++)
+    {
+        std::vector<float> depth = test_create_depth(resolution, pattern, generator);
+
+        std::vector<shared::Vertex> simulation_vertices;
+        std::vector<shared::Index> simulation_indices;
+        simulation.process(resolution, depth, QUAD_REFERENCE_TEST_DEPTH_MAX, QUAD_REFERENCE_TEST_DEPTH_THRESHOLD, simulation_vertices, simulation_indices);
+
+        //The reference is processed on the calling thread, with the scheduler and again on the calling thread, so that the reuse of its buffers is covered
+        std::array<Scheduler*, 3> schedulers = { nullptr, &scheduler, nullptr };
+
+        for (uint32_t index = 0; index < schedulers.size(); index++)
+        {
+            std::vector<shared::Vertex> vertices;
+            std::vector<shared::Index> indices;
+            shared::QuadViewMetadata metadata;
+
+            reference.process(depth.data(), QUAD_REFERENCE_TEST_DEPTH_MAX, QUAD_REFERENCE_TEST_DEPTH_THRESHOLD, vertices, indices, metadata, schedulers[index]);
+
+            if (!QuadReference::compare(simulation_vertices, simulation_indices, vertices, indices))
+            {
+                spdlog::error("QuadReferenceTest: Pattern {} of run {} differs from the simulation of the shaders", pattern, index);
+                success = false;
+            }
+        }
+    }
+
+    reference.destroy();
+
+    return success;
+}
+
+int main()
+{
+    ThreadPlacement thread_placement;
+
+    if (!thread_placement.create(THREAD_PLACEMENT_POLICY_NONE, std::nullopt, 0.0f))
+    {
+        return 1;
+    }
+
+    Scheduler scheduler;
+
+    if (!scheduler.create(&thread_placement, QUAD_REFERENCE_TEST_THREAD_COUNT))
+    {
+        return 1;
+    }
+
+    //Degenerate resolutions and resolutions of which the levels are not a multiple of two
+    std::vector<glm::uvec2> resolutions =
+    {
+        glm::uvec2(1, 1),
+        glm::uvec2(1, 97),
+        glm::uvec2(97, 1),
+        glm::uvec2(2, 3),
+        glm::uvec2(31, 5),
+        glm::uvec2(33, 33),
+        glm::uvec2(64, 48),
+        glm::uvec2(100, 77),
+        glm::uvec2(257, 129),
+        glm::uvec2(333, 211),
+        glm::uvec2(640, 480)
+    };
+
+    std::mt19937 generator(0);
+    uint32_t failed_count = 0;
+
+    for (const glm::uvec2& resolution : resolutions)
+    {
+        if (!test_resolution(resolution, generator, scheduler))
+        {
+            spdlog::error("QuadReferenceTest: Resolution {}x{} failed", resolution.x, resolution.y);
+            failed_count++;
+        }
+    }
+
+    scheduler.destroy();
+    thread_placement.destroy();
+
+    spdlog::info("QuadReferenceTest: Failed resolutions {} / {}", failed_count, resolutions.size());
+
+    return (failed_count == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,618 @@
+#include "scheduler.hpp"
+#include "ring_queue.hpp"
+#include "thread_placement.hpp"
+
+#include <spdlog/spdlog.h>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <array>
+#include <mutex>
+
+#define SCHEDULER_TEST_VIEW_COUNT     6     // Number of views of each frame
+#define SCHEDULER_TEST_FRAME_COUNT    8     // Number of frames that are in flight at the same time
+#define SCHEDULER_TEST_STEP_COUNT     20000 // Number of frames that are pushed through each scheduler
+#define SCHEDULER_TEST_TASK_WORK      256   // Number of iterations of each task, which is roughly one microsecond of work
+
+// Scheduler as it was before the lock-free queues, so that both hand-offs can be compared on the same frame graph.
+// Every queue is a std::deque behind a mutex and every release notifies a sleeping thread.
+class MutexSchedulerTask
+{
+private:
+    std::function<void()> function;
+    std::vector<MutexSchedulerTask*> successors;
+    std::atomic<uint32_t> dependency_count = 0;
+
+public:
+    MutexSchedulerTask() = default;
+
+    friend class MutexScheduler;
+};
+
+class MutexSchedulerQueue
+{
+private:
+    std::mutex mutex;
+    std::deque<MutexSchedulerTask*> tasks;
+
+public:
+    MutexSchedulerQueue() = default;
+
+    friend class MutexScheduler;
+};
+
+class MutexScheduler
+{
+private:
+    std::vector<std::thread> threads;
+    std::vector<MutexSchedulerQueue*> queues;
+    MutexSchedulerQueue external_queue;
+
+    std::mutex task_mutex;
+    std::vector<MutexSchedulerTask*> task_pool;
+
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_condition;
+    std::atomic<uint32_t> ready_count = 0;
+    std::atomic<bool> active = false;
+
+public:
+    MutexScheduler() = default;
+
+    bool create(uint32_t thread_count);
+    void destroy();
+
+    MutexSchedulerTask* create_task(std::function<void()> function);
+    void add_dependency(MutexSchedulerTask* task, MutexSchedulerTask* dependency);
+    void submit(MutexSchedulerTask* task);
+
+private:
+    void worker(uint32_t thread_index);
+
+    void execute(MutexSchedulerTask* task);
+    void release(MutexSchedulerTask* task);
+    MutexSchedulerTask* find_task(uint32_t thread_index);
+};
+
+static thread_local MutexScheduler* current_mutex_scheduler = nullptr;
+static thread_local uint32_t current_mutex_thread_index = 0;
+
+bool MutexScheduler::create(uint32_t thread_count)
+{
+    this->active = true;
+
+    for (uint32_t thread_index = 0; thread_index < thread_count; thread_index++)
+    {
+        this->queues.push_back(new MutexSchedulerQueue);
+    }
+
+    for (uint32_t thread_index = 0; thread_index < thread_count; thread_index++)
+    {
+        std::thread thread = std::thread([this, thread_index]()
+        {
+            this->worker(thread_index);
+        });
+
+        this->threads.push_back(std::move(thread));
+    }
+
+    return true;
+}
+
+void MutexScheduler::destroy()
+{
+    std::unique_lock<std::mutex> sleep_lock(this->sleep_mutex);
+    this->active = false;
+    this->sleep_condition.notify_all();
+    sleep_lock.unlock();
+
+    for (std::thread& thread : this->threads)
+    {
+        thread.join();
+    }
+
+    for (MutexSchedulerQueue* queue : this->queues)
+    {
+        delete queue;
+    }
+
+    for (MutexSchedulerTask* task : this->task_pool)
+    {
+        delete task;
+    }
+
+    this->threads.clear();
+    this->queues.clear();
+    this->task_pool.clear();
+}
+
+MutexSchedulerTask* MutexScheduler::create_task(std::function<void()> function)
+{
+    std::unique_lock<std::mutex> lock(this->task_mutex);
+    MutexSchedulerTask* task = nullptr;
+
+    if (this->task_pool.empty())
+    {
+        task = new MutexSchedulerTask;
+    }
+
+    else
+    {
+        task = this->task_pool.back();
+        this->task_pool.pop_back();
+    }
+
+    lock.unlock();
+
+    task->function = std::move(function);
+    task->dependency_count = 1;
+
+    return task;
+}
+
+void MutexScheduler::add_dependency(MutexSchedulerTask* task, MutexSchedulerTask* dependency)
+{
+    task->dependency_count++;
+    dependency->successors.push_back(task);
+}
+
+void MutexScheduler::submit(MutexSchedulerTask* task)
+{
+    this->release(task);
+}
+
+void MutexScheduler::worker(uint32_t thread_index)
+{
+    current_mutex_scheduler = this;
+    current_mutex_thread_index = thread_index;
+
+    while (true)
+    {
+        MutexSchedulerTask* task = this->find_task(thread_index);
+
+        if (task != nullptr)
+        {
+            this->execute(task);
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> sleep_lock(this->sleep_mutex);
+
+        if (this->ready_count > 0)
+        {
+            continue;
+        }
+
+        if (!this->active)
+        {
+            break;
+        }
+
+        this->sleep_condition.wait(sleep_lock);
+    }
+
+    current_mutex_scheduler = nullptr;
+}
+
+void MutexScheduler::execute(MutexSchedulerTask* task)
+{
+    task->function();
+
+    for (MutexSchedulerTask* successor : task->successors)
+    {
+        this->release(successor);
+    }
+
+    task->function = nullptr;
+    task->successors.clear();
+
+    std::unique_lock<std::mutex> lock(this->task_mutex);
+    this->task_pool.push_back(task);
+}
+
+void MutexScheduler::release(MutexSchedulerTask* task)
+{
+    if (--task->dependency_count > 0)
+    {
+        return;
+    }
+
+    MutexSchedulerQueue* queue = &this->external_queue;
+
+    if (current_mutex_scheduler == this)
+    {
+        queue = this->queues[current_mutex_thread_index];
+    }
+
+    this->ready_count++;
+
+    std::unique_lock<std::mutex> queue_lock(queue->mutex);
+    queue->tasks.push_back(task);
+    queue_lock.unlock();
+
+    std::unique_lock<std::mutex> sleep_lock(this->sleep_mutex);
+    this->sleep_condition.notify_one();
+}
+
+MutexSchedulerTask* MutexScheduler::find_task(uint32_t thread_index)
+{
+    MutexSchedulerQueue* own_queue = this->queues[thread_index];
+    std::unique_lock<std::mutex> own_lock(own_queue->mutex);
+
+    if (!own_queue->tasks.empty())
+    {
+        MutexSchedulerTask* task = own_queue->tasks.back();
+        own_queue->tasks.pop_back();
+        this->ready_count--;
+
+        return task;
+    }
+
+    own_lock.unlock();
+
+    std::unique_lock<std::mutex> external_lock(this->external_queue.mutex);
+
+    if (!this->external_queue.tasks.empty())
+    {
+        MutexSchedulerTask* task = this->external_queue.tasks.front();
+        this->external_queue.tasks.pop_front();
+        this->ready_count--;
+
+        return task;
+    }
+
+    external_lock.unlock();
+
+    for (uint32_t offset = 1; offset < this->queues.size(); offset++)
+    {
+        MutexSchedulerQueue* queue = this->queues[(thread_index + offset) % this->queues.size()];
+        std::unique_lock<std::mutex> lock(queue->mutex);
+
+        if (!queue->tasks.empty())
+        {
+            MutexSchedulerTask* task = queue->tasks.front();
+            queue->tasks.pop_front();
+            this->ready_count--;
+
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+// Queue with the interface of the RingQueue, which hands the frames over behind a mutex as the worker pool did before
+template<typename Type>
+class MutexQueue
+{
+private:
+    std::mutex mutex;
+    std::vector<Type> values;
+
+public:
+    MutexQueue() = default;
+
+    void create(uint32_t capacity)
+    {
+        this->values.reserve(capacity);
+    }
+
+    void destroy()
+    {
+        this->values.clear();
+    }
+
+    bool push(const Type& value)
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->values.push_back(value);
+
+        return true;
+    }
+
+    bool pop(Type& value)
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+
+        if (this->values.empty())
+        {
+            return false;
+        }
+
+        value = this->values.front();
+        this->values.erase(this->values.begin());
+
+        return true;
+    }
+};
+
+struct TestFrame;
+
+struct TestView
+{
+    TestFrame* frame = nullptr;
+    uint32_t view = 0;
+
+    uint64_t mesh = 0;
+    uint64_t geometry = 0;
+    uint64_t export_value = 0;
+};
+
+struct TestFrame
+{
+    uint32_t step = 0;
+    std::array<TestView, SCHEDULER_TEST_VIEW_COUNT> views;
+
+    uint64_t encode = 0;
+    uint64_t checksum = 0;
+};
+
+//Stands in for the work of a task and makes the result depend on every input, so that a task that runs before its dependencies changes the checksum
+uint64_t test_work(uint64_t value)
+{
+    for (uint32_t iteration = 0; iteration < SCHEDULER_TEST_TASK_WORK; iteration++)
+    {
+        value = value * 6364136223846793005ull + 1442695040888963407ull;
+    }
+
+    return value;
+}
+
+uint64_t test_mesh(uint32_t step, uint32_t view)
+{
+    return test_work(((uint64_t)step << 8) | view);
+}
+
+uint64_t test_geometry(uint64_t mesh)
+{
+    return test_work(mesh ^ 0x9E3779B97F4A7C15ull);
+}
+
+uint64_t test_export(uint64_t mesh)
+{
+    return test_work(mesh ^ 0xC2B2AE3D27D4EB4Full);
+}
+
+uint64_t test_encode(const std::array<uint64_t, SCHEDULER_TEST_VIEW_COUNT>& geometry)
+{
+    uint64_t value = 0;
+
+    for (uint64_t view_geometry : geometry)
+    {
+        value = test_work(value ^ view_geometry);
+    }
+
+    return value;
+}
+
+uint64_t test_complete(uint64_t encode, const std::array<uint64_t, SCHEDULER_TEST_VIEW_COUNT>& exports)
+{
+    uint64_t value = encode;
+
+    for (uint64_t view_export : exports)
+    {
+        value = test_work(value ^ view_export);
+    }
+
+    return value;
+}
+
+//Computes the checksum of a frame without any scheduler
+uint64_t test_expected_checksum(uint32_t step)
+{
+    std::array<uint64_t, SCHEDULER_TEST_VIEW_COUNT> geometry;
+    std::array<uint64_t, SCHEDULER_TEST_VIEW_COUNT> exports;
+
+    for (uint32_t view = 0; view < SCHEDULER_TEST_VIEW_COUNT; view++)
+    {
+        uint64_t mesh = test_mesh(step, view);
+
+        geometry[view] = test_geometry(mesh);
+        exports[view] = test_export(mesh);
+    }
+
+    return test_complete(test_encode(geometry), exports);
+}
+
+//Submits the same graph as the worker pool, which is a mesh, geometry and export task per view followed by an encode and a complete task per frame
+template<typename SchedulerType, typename QueueType>
+void test_submit(SchedulerType& scheduler, QueueType& output_queue, TestFrame* frame)
+{
+    auto* encode_task = scheduler.create_task([frame]()
+    {
+        std::array<uint64_t, SCHEDULER_TEST_VIEW_COUNT> geometry;
+
+        for (uint32_t view = 0; view < SCHEDULER_TEST_VIEW_COUNT; view++)
+        {
+            geometry[view] = frame->views[view].geometry;
+        }
+
+        frame->encode = test_encode(geometry);
+    });
+
+    auto* complete_task = scheduler.create_task([frame, &output_queue]()
+    {
+        std::array<uint64_t, SCHEDULER_TEST_VIEW_COUNT> exports;
+
+        for (uint32_t view = 0; view < SCHEDULER_TEST_VIEW_COUNT; view++)
+        {
+            exports[view] = frame->views[view].export_value;
+        }
+
+        frame->checksum = test_complete(frame->encode, exports);
+
+        while (!output_queue.push(frame))
+        {
+            std::this_thread::yield();
+        }
+    });
+
+    scheduler.add_dependency(complete_task, encode_task);
+
+    for (TestView& test_view : frame->views)
+    {
+        TestView* view = &test_view;
+
+        auto* mesh_task = scheduler.create_task([view]()
+        {
+            view->mesh = test_mesh(view->frame->step, view->view);
+        });
+
+        auto* geometry_task = scheduler.create_task([view]()
+        {
+            view->geometry = test_geometry(view->mesh);
+        });
+
+        auto* export_task = scheduler.create_task([view]()
+        {
+            view->export_value = test_export(view->mesh);
+        });
+
+        scheduler.add_dependency(geometry_task, mesh_task);
+        scheduler.add_dependency(encode_task, geometry_task);
+        scheduler.add_dependency(export_task, mesh_task);
+        scheduler.add_dependency(complete_task, export_task);
+
+        scheduler.submit(geometry_task);
+        scheduler.submit(export_task);
+        scheduler.submit(mesh_task);
+    }
+
+    scheduler.submit(encode_task);
+    scheduler.submit(complete_task);
+}
+
+//Keeps the given number of frames in flight and reuses the frames through a frame pool and an output queue like the worker pool
+template<typename SchedulerType, typename QueueType>
+bool test_run(SchedulerType& scheduler, const std::vector<uint64_t>& expected_checksums, double& frames_per_second)
+{
+    std::array<TestFrame, SCHEDULER_TEST_FRAME_COUNT> frames;
+    QueueType frame_pool;
+    QueueType output_queue;
+    frame_pool.create(SCHEDULER_TEST_FRAME_COUNT);
+    output_queue.create(SCHEDULER_TEST_FRAME_COUNT);
+
+    for (TestFrame& frame : frames)
+    {
+        for (uint32_t view = 0; view < SCHEDULER_TEST_VIEW_COUNT; view++)
+        {
+            frame.views[view].frame = &frame;
+            frame.views[view].view = view;
+        }
+
+        frame_pool.push(&frame);
+    }
+
+    uint32_t submitted_count = 0;
+    uint32_t completed_count = 0;
+    uint32_t failed_count = 0;
+
+    std::chrono::steady_clock::time_point time_start = std::chrono::steady_clock::now();
+
+    while (completed_count < SCHEDULER_TEST_STEP_COUNT)
+    {
+        TestFrame* frame = nullptr;
+        bool idle = true;
+
+        while (output_queue.pop(frame))
+        {
+            if (frame->checksum != expected_checksums[frame->step])
+            {
+                spdlog::error("SchedulerTest: Frame {} has the wrong checksum", frame->step);
+                failed_count++;
+            }
+
+            completed_count++;
+            frame_pool.push(frame);
+            idle = false;
+        }
+
+        while (submitted_count < SCHEDULER_TEST_STEP_COUNT && frame_pool.pop(frame))
+        {
+            frame->step = submitted_count++;
+            frame->encode = 0;
+            frame->checksum = 0;
+
+            for (TestView& view : frame->views)
+            {
+                view.mesh = 0;
+                view.geometry = 0;
+                view.export_value = 0;
+            }
+
+            test_submit(scheduler, output_queue, frame);
+            idle = false;
+        }
+
+        if (idle)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    std::chrono::steady_clock::time_point time_end = std::chrono::steady_clock::now();
+    frames_per_second = SCHEDULER_TEST_STEP_COUNT / std::chrono::duration<double>(time_end - time_start).count();
+
+    frame_pool.destroy();
+    output_queue.destroy();
+
+    return failed_count == 0;
+}
+
+int main()
+{
+    ThreadPlacement thread_placement;
+
+    if (!thread_placement.create(THREAD_PLACEMENT_POLICY_NONE, std::nullopt, 0.0f))
+    {
+        return 1;
+    }
+
+    uint32_t thread_count = thread_placement.get_worker_count();
+
+    std::vector<uint64_t> expected_checksums;
+
+    for (uint32_t step = 0; step < SCHEDULER_TEST_STEP_COUNT; step++)
+    {
+        expected_checksums.push_back(test_expected_checksum(step));
+    }
+
+    uint32_t failed_count = 0;
+    double mutex_frames_per_second = 0.0;
+    double frames_per_second = 0.0;
+
+    MutexScheduler mutex_scheduler;
+    mutex_scheduler.create(thread_count);
+
+    if (!test_run<MutexScheduler, MutexQueue<TestFrame*>>(mutex_scheduler, expected_checksums, mutex_frames_per_second))
+    {
+        spdlog::error("SchedulerTest: Mutex scheduler failed");
+        failed_count++;
+    }
+
+    mutex_scheduler.destroy();
+
+    Scheduler scheduler;
+
+    if (!scheduler.create(&thread_placement, thread_count))
+    {
+        return 1;
+    }
+
+    if (!test_run<Scheduler, RingQueue<TestFrame*>>(scheduler, expected_checksums, frames_per_second))
+    {
+        spdlog::error("SchedulerTest: Scheduler failed");
+        failed_count++;
+    }
+
+    scheduler.destroy();
+    thread_placement.destroy();
+
+    spdlog::info("SchedulerTest: Threads {}, Views {}, Frames in flight {}, Mutex scheduler {:.0f} frames/s, Scheduler {:.0f} frames/s, Failed runs {}", thread_count, SCHEDULER_TEST_VIEW_COUNT, SCHEDULER_TEST_FRAME_COUNT, mutex_frames_per_second, frames_per_second, failed_count);
+
+    return (failed_count == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -1,67 +1,123 @@
 #include "geometry_codec.hpp"
-#include "huffman.hpp"
+#include <algorithm>
 #include <limits>
 
 namespace shared
 {
     bool GeometryCodec::encode(std::span<const Index> indices, std::span<const Vertex> vertices, std::vector<uint8_t>& buffer)
     {
-        std::vector<uint32_t> packet_indices;
-        std::vector<uint16_t> packet_vertices;
+        std::array<std::span<const Index>, 1> index_lists = { indices };
+        std::array<std::span<const Vertex>, 1> vertex_lists = { vertices };
+
+        return GeometryCodec::encode(index_lists, vertex_lists, buffer);
+    }
+
+    bool GeometryCodec::encode(std::span<const std::span<const Index>> index_lists, std::span<const std::span<const Vertex>> vertex_lists, std::vector<uint8_t>& buffer)
+    {
+        std::vector<GeometryChunk> chunks;
+        chunks.resize(std::max(index_lists.size(), vertex_lists.size()));
+
+        for (uint32_t index = 0; index < chunks.size(); index++)
+        {
+            std::span<const Index> indices;
+            std::span<const Vertex> vertices;
+
+            if (index < index_lists.size())
+            {
+                indices = index_lists[index];
+            }
+
+            if (index < vertex_lists.size())
+            {
+                vertices = vertex_lists[index];
+            }
+
+            GeometryCodec::encode_chunk(indices, vertices, chunks[index]);
+        }
+
+        return GeometryCodec::encode(chunks, buffer);
+    }
+
+    bool GeometryCodec::encode(std::span<GeometryChunk> chunks, std::vector<uint8_t>& buffer)
+    {
+        GeometryEncodeBuffers encode_buffers;
+
+        return GeometryCodec::encode(chunks, encode_buffers, buffer);
+    }
+
+    bool GeometryCodec::encode(std::span<GeometryChunk> chunks, GeometryEncodeBuffers& encode_buffers, std::vector<uint8_t>& buffer)
+    {
+        std::array<uint64_t, 256> histogram;
+        histogram.fill(0);
+
+        std::vector<std::span<const uint8_t>>& index_lists = encode_buffers.index_lists;
+        std::vector<std::span<const uint8_t>>& vertex_lists = encode_buffers.vertex_lists;
+        index_lists.clear();
+        vertex_lists.clear();
+
+        uint32_t index_count = 0;
+        uint32_t vertex_count = 0;
 
         uint32_t last_index = 0;
         uint16_t last_vertex_x = 0;
         uint16_t last_vertex_y = 0;
         uint16_t last_vertex_depth = 0;
 
-        for (const Index& index : indices)
+        for (GeometryChunk& chunk : chunks)
         {
-            uint32_t encoded_index = GeometryCodec::encode_delta((int32_t)index - (int32_t)last_index);
+            //Code the first index and vertex relative to the last index and vertex of the previous chunks
+            if (!chunk.packet_indices.empty())
+            {
+                uint32_t encoded_index = GeometryCodec::encode_delta((int32_t)chunk.first_index - (int32_t)last_index);
 
-            packet_indices.push_back(encoded_index);
+                GeometryCodec::replace_value(chunk, (uint8_t*)&chunk.packet_indices[0], sizeof(uint32_t), (const uint8_t*)&encoded_index);
 
-            last_index = index;
-        }
+                last_index = chunk.last_index;
+            }
 
-        for (const Vertex& vertex : vertices)
-        {
-            uint16_t vertex_depth = (uint16_t)(vertex.z * 0x7FFF);
+            if (!chunk.packet_vertices.empty())
+            {
+                uint16_t encoded_vertex_x = GeometryCodec::encode_delta((int16_t)chunk.first_vertex[0] - (int16_t)last_vertex_x);
+                uint16_t encoded_vertex_y = GeometryCodec::encode_delta((int16_t)chunk.first_vertex[1] - (int16_t)last_vertex_y);
+                uint16_t encoded_vertex_depth = GeometryCodec::encode_delta((int16_t)chunk.first_vertex[2] - (int16_t)last_vertex_depth);
 
-            uint16_t encoded_vertex_x = GeometryCodec::encode_delta((int16_t)vertex.x - (int16_t) last_vertex_x);
-            uint16_t encoded_vertex_y = GeometryCodec::encode_delta((int16_t)vertex.y - (int16_t) last_vertex_y);
-            uint16_t encoded_vertex_depth = GeometryCodec::encode_delta((int16_t)vertex_depth - (int16_t) last_vertex_depth);
+                GeometryCodec::replace_value(chunk, (uint8_t*)&chunk.packet_vertices[0], sizeof(uint16_t), (const uint8_t*)&encoded_vertex_x);
+                GeometryCodec::replace_value(chunk, (uint8_t*)&chunk.packet_vertices[1], sizeof(uint16_t), (const uint8_t*)&encoded_vertex_y);
+                GeometryCodec::replace_value(chunk, (uint8_t*)&chunk.packet_vertices[2], sizeof(uint16_t), (const uint8_t*)&encoded_vertex_depth);
 
-            packet_vertices.push_back(encoded_vertex_x);
-            packet_vertices.push_back(encoded_vertex_y);
-            packet_vertices.push_back(encoded_vertex_depth);
+                last_vertex_x = chunk.last_vertex[0];
+                last_vertex_y = chunk.last_vertex[1];
+                last_vertex_depth = chunk.last_vertex[2];
+            }
 
-            last_vertex_x = vertex.x;
-            last_vertex_y = vertex.y;
-            last_vertex_depth = vertex_depth;
-        }
+            for (uint32_t symbol = 0; symbol < histogram.size(); symbol++)
+            {
+                histogram[symbol] += chunk.histogram[symbol];
+            }
 
-        std::vector<std::span<const uint8_t>> input_lists =
-        {
-            std::span<uint8_t>((uint8_t*)packet_indices.data(), packet_indices.size() * sizeof(uint32_t)),
-            std::span<uint8_t>((uint8_t*)packet_vertices.data(), packet_vertices.size() * sizeof(uint16_t))
-        };
+            index_lists.push_back(std::span<uint8_t>((uint8_t*)chunk.packet_indices.data(), chunk.packet_indices.size() * sizeof(uint32_t)));
+            vertex_lists.push_back(std::span<uint8_t>((uint8_t*)chunk.packet_vertices.data(), chunk.packet_vertices.size() * sizeof(uint16_t)));
 
-        HuffmanCode huffman_code;
+            index_count += chunk.packet_indices.size();
+            vertex_count += chunk.packet_vertices.size() / 3;
+        }
+
+        HuffmanCode& huffman_code = encode_buffers.huffman_code;
 
-        if (!huffman_code.create(input_lists))
+        if (!huffman_code.create(histogram))
         {
             return false;
         }
 
-        std::vector<uint8_t> index_bytes;
-        std::vector<uint8_t> vertex_bytes;
+        std::vector<uint8_t>& index_bytes = encode_buffers.index_bytes;
+        std::vector<uint8_t>& vertex_bytes = encode_buffers.vertex_bytes;
 
-        if (!huffman_code.encode(input_lists[0], index_bytes))
+        if (!huffman_code.encode(index_lists, index_bytes))
         {
             return false;
         }
 
-        if (!huffman_code.encode(input_lists[1], vertex_bytes))
+        if (!huffman_code.encode(vertex_lists, vertex_bytes))
         {
             return false;
         }
@@ -74,9 +130,9 @@ namespace shared
         buffer.resize(buffer_size);
 
         GeometryHeader* header = (GeometryHeader*)(buffer.data() + header_offset);
-        header->index_count = indices.size();
+        header->index_count = index_count;
         header->index_bytes = index_bytes.size();
-        header->vertex_count = vertices.size();
+        header->vertex_count = vertex_count;
         header->vertex_bytes = vertex_bytes.size();
         huffman_code.export_code(header->huffman_lengths);
 
@@ -86,6 +142,78 @@ namespace shared
         return true;
     }
 
+    void GeometryCodec::encode_chunk(std::span<const Index> indices, std::span<const Vertex> vertices, GeometryChunk& chunk)
+    {
+        chunk.packet_indices.clear();
+        chunk.packet_vertices.clear();
+        chunk.histogram.fill(0);
+
+        chunk.packet_indices.reserve(indices.size());
+        chunk.packet_vertices.reserve(vertices.size() * 3);
+
+        uint32_t last_index = 0;
+        uint16_t last_vertex_x = 0;
+        uint16_t last_vertex_y = 0;
+        uint16_t last_vertex_depth = 0;
+
+        for (const Index& index : indices)
+        {
+            uint32_t encoded_index = GeometryCodec::encode_delta((int32_t)index - (int32_t)last_index);
+
+            chunk.packet_indices.push_back(encoded_index);
+
+            last_index = index;
+        }
+
+        chunk.first_index = 0;
+        chunk.last_index = last_index;
+
+        if (!indices.empty())
+        {
+            chunk.first_index = indices.front();
+        }
+
+        chunk.first_vertex.fill(0);
+        chunk.last_vertex.fill(0);
+
+        for (const Vertex& vertex : vertices)
+        {
+            uint16_t vertex_depth = (uint16_t)(vertex.z * 0x7FFF);
+
+            uint16_t encoded_vertex_x = GeometryCodec::encode_delta((int16_t)vertex.x - (int16_t) last_vertex_x);
+            uint16_t encoded_vertex_y = GeometryCodec::encode_delta((int16_t)vertex.y - (int16_t) last_vertex_y);
+            uint16_t encoded_vertex_depth = GeometryCodec::encode_delta((int16_t)vertex_depth - (int16_t) last_vertex_depth);
+
+            if (chunk.packet_vertices.empty())
+            {
+                chunk.first_vertex = { vertex.x, vertex.y, vertex_depth };
+            }
+
+            chunk.packet_vertices.push_back(encoded_vertex_x);
+            chunk.packet_vertices.push_back(encoded_vertex_y);
+            chunk.packet_vertices.push_back(encoded_vertex_depth);
+
+            last_vertex_x = vertex.x;
+            last_vertex_y = vertex.y;
+            last_vertex_depth = vertex_depth;
+        }
+
+        chunk.last_vertex = { last_vertex_x, last_vertex_y, last_vertex_depth };
+
+        const uint8_t* index_bytes = (const uint8_t*)chunk.packet_indices.data();
+        const uint8_t* vertex_bytes = (const uint8_t*)chunk.packet_vertices.data();
+
+        for (uint32_t offset = 0; offset < chunk.packet_indices.size() * sizeof(uint32_t); offset++)
+        {
+            chunk.histogram[index_bytes[offset]] += 1;
+        }
+
+        for (uint32_t offset = 0; offset < chunk.packet_vertices.size() * sizeof(uint16_t); offset++)
+        {
+            chunk.histogram[vertex_bytes[offset]] += 1;
+        }
+    }
+
     bool GeometryCodec::decode(std::span<const uint8_t> buffer, std::vector<Index>& indices, std::vector<Vertex>& vertices)
     {
         GeometryHeader* header = (GeometryHeader*)buffer.data();
@@ -165,6 +293,17 @@ namespace shared
         return true;
     }
 
+    void GeometryCodec::replace_value(GeometryChunk& chunk, uint8_t* value, uint32_t value_size, const uint8_t* new_value)
+    {
+        for (uint32_t offset = 0; offset < value_size; offset++)
+        {
+            chunk.histogram[value[offset]] -= 1;
+            chunk.histogram[new_value[offset]] += 1;
+
+            value[offset] = new_value[offset];
+        }
+    }
+
     uint16_t GeometryCodec::encode_delta(int16_t delta)
     {
         uint16_t encoded_delta = 0;
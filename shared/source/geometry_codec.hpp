@@ -5,6 +5,7 @@
 #include <span>
 #include <array>
 #include "protocol.hpp"
+#include "huffman.hpp"
 
 namespace shared
 {
@@ -17,15 +18,46 @@ namespace shared
         uint32_t vertex_bytes = 0;
     };
 
+    // Delta coded part of the geometry that can be prepared independently of the other parts.
+    // The first index and vertex are coded relative to zero and corrected once the chunks are assembled.
+    struct GeometryChunk
+    {
+        std::vector<uint32_t> packet_indices;
+        std::vector<uint16_t> packet_vertices;
+        std::array<uint64_t, 256> histogram;  // Number of occurrences of each byte in the packet indices and vertices
+
+        uint32_t first_index = 0;
+        uint32_t last_index = 0;
+        std::array<uint16_t, 3> first_vertex; // Position and quantized depth of the first vertex
+        std::array<uint16_t, 3> last_vertex;  // Position and quantized depth of the last vertex
+    };
+
+    // Intermediate buffers of the assembly of the chunks.
+    // Can be kept between calls of encode, so that the assembly of a frame does not allocate once the buffers reached their size.
+    struct GeometryEncodeBuffers
+    {
+        HuffmanCode huffman_code;
+        std::vector<std::span<const uint8_t>> index_lists;
+        std::vector<std::span<const uint8_t>> vertex_lists;
+        std::vector<uint8_t> index_bytes;
+        std::vector<uint8_t> vertex_bytes;
+    };
+
     class GeometryCodec
     {
     public:
         GeometryCodec() = delete;
 
         static bool encode(std::span<const Index> indices, std::span<const Vertex> vertices, std::vector<uint8_t>& buffer);
+        static bool encode(std::span<const std::span<const Index>> index_lists, std::span<const std::span<const Vertex>> vertex_lists, std::vector<uint8_t>& buffer); // Encodes the lists as if they were concatenated
+        static bool encode(std::span<GeometryChunk> chunks, std::vector<uint8_t>& buffer); // Assembles the chunks as if their lists were concatenated
+        static bool encode(std::span<GeometryChunk> chunks, GeometryEncodeBuffers& encode_buffers, std::vector<uint8_t>& buffer);
+        static void encode_chunk(std::span<const Index> indices, std::span<const Vertex> vertices, GeometryChunk& chunk); // Can be called in parallel for different chunks
         static bool decode(std::span<const uint8_t> buffer, std::vector<Index>& indices, std::vector<Vertex>& vertices);
 
     private:
+        static void replace_value(GeometryChunk& chunk, uint8_t* value, uint32_t value_size, const uint8_t* new_value);
+
         static uint16_t encode_delta(int16_t delta);
         static uint32_t encode_delta(int32_t delta);
         static int16_t decode_delta(uint16_t encoded_delta);
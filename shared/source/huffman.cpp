@@ -8,46 +8,52 @@ namespace shared
         this->destroy();
     }
 
-    bool HuffmanCode::create(const std::vector<std::span<const uint8_t>>& input_lists)
+    bool HuffmanCode::create(std::span<const std::span<const uint8_t>> input_lists)
     {
-        if (this->root_node != nullptr)
+        std::array<uint64_t, 256> histogram;
+        histogram.fill(0);
+
+        for (const std::span<const uint8_t>& input_list : input_lists)
         {
-            this->destroy();
+            for (uint32_t index = 0; index < input_list.size(); index++)
+            {
+                uint8_t input = input_list[index];
+
+                histogram[input] += 1;
+            } 
         }
 
-        std::vector<HuffmanNode*> node_list;
-        node_list.resize(256, nullptr);
+        return this->create(histogram);
+    }
+
+    bool HuffmanCode::create(const std::array<uint64_t, 256>& histogram)
+    {
+        this->destroy();
+
+        std::vector<HuffmanNode*>& node_list = this->sorted_nodes;
+        node_list.clear();
+        node_list.reserve(256);
 
         for (uint32_t index = 0; index < 256; index++)
         {
-            HuffmanNode* node = new HuffmanNode;
+            HuffmanNode* node = this->create_node();
             node->symbol = index;
 
-            node_list[index] = node;
+            node_list.push_back(node);
         }
 
-        uint32_t input_count = 0;
+        uint64_t input_count = 0;
 
-        for (uint32_t index = 0; index < input_lists.size(); index++)
+        for (uint32_t index = 0; index < histogram.size(); index++)
         {
-            input_count += input_lists[index].size();
+            input_count += histogram[index];
         }
 
         if (input_count > 0)
         {
-            for (const std::span<const uint8_t>& input_list : input_lists)
-            {
-                for (uint32_t index = 0; index < input_list.size(); index++)
-                {
-                    uint8_t input = input_list[index];
-
-                    node_list[input]->probability += 1.0f;
-                } 
-            }
-       
             for (HuffmanNode* node : node_list)
             {
-                node->probability /= (float)input_count;
+                node->probability = (float)histogram[node->symbol] / (float)input_count;
             }
         }
 
@@ -73,7 +79,7 @@ namespace shared
             HuffmanNode* node1 = node_list.back(); 
             node_list.pop_back();
 
-            HuffmanNode* node = new HuffmanNode;
+            HuffmanNode* node = this->create_node();
             node->probability = node1->probability + node2->probability;
             node->left = node1;
             node->right = node2;
@@ -115,19 +121,15 @@ namespace shared
 
     void HuffmanCode::destroy()
     {
-        this->destroy(this->root_node);
-
         this->root_node = nullptr;
+        this->nodes.clear();
         this->leave_nodes.clear();
     }
 
     // Huffman tree encoding taken from https://www.w3.org/Graphics/PNG/RFC-1951
     bool HuffmanCode::import_code(const std::array<uint8_t, 256>& huffman_lengths)
     {
-        if (this->root_node != nullptr)
-        {
-            this->destroy();
-        }
+        this->destroy();
 
         std::array<uint32_t, 256> length_count;
         length_count.fill(0);
@@ -146,7 +148,7 @@ namespace shared
         }
 
         this->leave_nodes.resize(256, nullptr);
-        this->root_node = new HuffmanNode;
+        this->root_node = this->create_node();
 
         for (uint32_t index = 0; index < this->leave_nodes.size(); index++)
         {
@@ -162,7 +164,12 @@ namespace shared
                 {
                     if (node->left == nullptr)
                     {
-                        node->left = new HuffmanNode;
+                        node->left = this->create_node();
+
+                        if (node->left == nullptr)
+                        {
+                            return false;
+                        }
                     }
 
                     node = node->left;
@@ -172,7 +179,12 @@ namespace shared
                 {
                     if (node->right == nullptr)
                     {
-                        node->right = new HuffmanNode;
+                        node->right = this->create_node();
+
+                        if (node->right == nullptr)
+                        {
+                            return false;
+                        }
                     }
 
                     node = node->right;
@@ -204,26 +216,43 @@ namespace shared
 
     bool HuffmanCode::encode(std::span<const uint8_t> input_list, std::vector<uint8_t>& output_list) const
     {
+        std::array<std::span<const uint8_t>, 1> input_lists = { input_list };
+
+        return this->encode(input_lists, output_list);
+    }
+
+    bool HuffmanCode::encode(std::span<const std::span<const uint8_t>> input_lists, std::vector<uint8_t>& output_list) const
+    {
+        uint32_t input_count = 0;
+
+        for (const std::span<const uint8_t>& input_list : input_lists)
+        {
+            input_count += input_list.size();
+        }
+
         output_list.clear();
-        output_list.reserve(input_list.size());
+        output_list.reserve(input_count);
 
         uint64_t code_buffer = 0;
         uint32_t code_buffer_size = 0;
 
-        for (uint32_t index = 0; index < input_list.size(); index++)
+        for (const std::span<const uint8_t>& input_list : input_lists)
         {
-            uint32_t input = input_list[index];
-            HuffmanNode* node = this->leave_nodes[input];
+            for (uint32_t index = 0; index < input_list.size(); index++)
+            {
+                uint32_t input = input_list[index];
+                HuffmanNode* node = this->leave_nodes[input];
 
-            code_buffer = (code_buffer << node->code_length) | node->code;
-            code_buffer_size += node->code_length;
+                code_buffer = (code_buffer << node->code_length) | node->code;
+                code_buffer_size += node->code_length;
 
-            while (code_buffer_size >= 8)
-            {
-                uint8_t output = (code_buffer >> (code_buffer_size - 8)) & 0xFF;
-                code_buffer_size -= 8;
+                while (code_buffer_size >= 8)
+                {
+                    uint8_t output = (code_buffer >> (code_buffer_size - 8)) & 0xFF;
+                    code_buffer_size -= 8;
 
-                output_list.push_back(output);
+                    output_list.push_back(output);
+                }
             }
         }
 
@@ -282,17 +311,20 @@ namespace shared
         return true;
     }
 
-    void HuffmanCode::destroy(HuffmanNode* node)
+    HuffmanNode* HuffmanCode::create_node()
     {
-        if (node == nullptr)
+        //The tree references the nodes by pointer, so the buffer must never be reallocated while a code exists
+        if (this->nodes.capacity() < HUFFMAN_NODE_COUNT_MAX)
         {
-            return;
+            this->nodes.reserve(HUFFMAN_NODE_COUNT_MAX);
         }
 
-        this->destroy(node->left);
-        this->destroy(node->right);
+        if (this->nodes.size() >= HUFFMAN_NODE_COUNT_MAX)
+        {
+            return nullptr;
+        }
 
-        delete node;
+        return &this->nodes.emplace_back();
     }
 
     bool HuffmanCode::assign_codes(HuffmanNode* node, uint64_t code, uint32_t code_length)
@@ -6,6 +6,8 @@
 #include <memory>
 #include <cstdint>
 
+#define HUFFMAN_NODE_COUNT_MAX 511 // Number of nodes of a complete code with 256 symbols
+
 namespace shared
 {
     struct HuffmanNode
@@ -19,27 +21,32 @@ namespace shared
         HuffmanNode* right = nullptr;
     };
 
+    // The nodes are kept in a buffer with fixed capacity, so that creating a new code reuses the memory of the previous code.
     class HuffmanCode
     {
     private:
         HuffmanNode* root_node = nullptr;
+        std::vector<HuffmanNode> nodes;
         std::vector<HuffmanNode*> leave_nodes;
+        std::vector<HuffmanNode*> sorted_nodes;
 
     public:
         HuffmanCode() = default;
         ~HuffmanCode();
 
-        bool create(const std::vector<std::span<const uint8_t>>& input_lists);
+        bool create(std::span<const std::span<const uint8_t>> input_lists);
+        bool create(const std::array<uint64_t, 256>& histogram); // Creates the code from the number of occurrences of each symbol
         void destroy();
 
         bool import_code(const std::array<uint8_t, 256>& huffman_lengths);
         void export_code(std::array<uint8_t, 256>& huffman_lengths) const;
 
         bool encode(std::span<const uint8_t> input_list, std::vector<uint8_t>& output_list) const;
+        bool encode(std::span<const std::span<const uint8_t>> input_lists, std::vector<uint8_t>& output_list) const; // Encodes the lists as if they were concatenated
         bool decode(std::span<const uint8_t> input_list, std::span<uint8_t> output_list) const;
 
     private:
-        void destroy(HuffmanNode* node);
+        HuffmanNode* create_node(); // Returns nullptr if the code has more nodes than a complete code
         bool assign_codes(HuffmanNode* node, uint64_t code, uint32_t code_length);
     };
 }
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "layer_response_codec.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace shared
+{
+    //Each member of the metadata is serialised as a single 32-bit value
+    static_assert(sizeof(float) == sizeof(uint32_t));
+    static_assert(sizeof(QuadViewMetadata) % sizeof(uint32_t) == 0);
+    static_assert(sizeof(LineViewMetadata) % sizeof(uint32_t) == 0);
+    static_assert(sizeof(LoopViewMetadata) % sizeof(uint32_t) == 0);
+
+    //The sizes have to match encode(), which writes six 32-bit values and four bytes before the views
+    static_assert(LAYER_RESPONSE_CODEC_FIXED_BYTES == 6 * sizeof(uint32_t) + 4 * sizeof(uint8_t));
+    static_assert(LAYER_RESPONSE_CODEC_VIEW_BYTES == sizeof(Matrix) + 2 * sizeof(uint32_t));
+    static_assert(LAYER_RESPONSE_CODEC_FIXED_BYTES + LAYER_RESPONSE_CODEC_VIEW_BYTES <= LAYER_RESPONSE_CODEC_SINGLE_VIEW_BYTES);
+
+    void LayerResponseCodec::encode(const LayerResponsePacket& packet, std::vector<uint8_t>& buffer)
+    {
+        uint32_t view_count = std::min(packet.view_count, (uint32_t)SHARED_VIEW_COUNT_MAX);
+        uint8_t flags = 0;
+
+        if (packet.geometry_dropped)
+        {
+            flags |= LAYER_RESPONSE_FLAG_GEOMETRY_DROPPED;
+        }
+
+        if (packet.view_metadata_enabled)
+        {
+            flags |= LAYER_RESPONSE_FLAG_VIEW_METADATA;
+        }
+
+        if (packet.geometry_omitted)
+        {
+            flags |= LAYER_RESPONSE_FLAG_GEOMETRY_OMITTED;
+        }
+
+        if (packet.image_omitted)
+        {
+            flags |= LAYER_RESPONSE_FLAG_IMAGE_OMITTED;
+        }
+
+        buffer.clear();
+
+        LayerResponseCodec::write_uint32(buffer, packet.type);
+        LayerResponseCodec::write_uint8(buffer, SHARED_LAYER_RESPONSE_VERSION);
+        LayerResponseCodec::write_uint8(buffer, flags);
+        LayerResponseCodec::write_uint8(buffer, view_count);
+        LayerResponseCodec::write_uint8(buffer, packet.mesh_generator);
+        LayerResponseCodec::write_uint32(buffer, packet.request_id);
+        LayerResponseCodec::write_uint32(buffer, packet.layer_index);
+        LayerResponseCodec::write_uint32(buffer, packet.geometry_bytes);
+        LayerResponseCodec::write_uint32(buffer, packet.image_bytes);
+        LayerResponseCodec::write_uint32(buffer, packet.dropped_frames);
+
+        for (uint32_t view = 0; view < view_count; view++)
+        {
+            LayerResponseCodec::write_words(buffer, packet.view_matrices[view].data(), packet.view_matrices[view].size());
+            LayerResponseCodec::write_uint32(buffer, packet.vertex_counts[view]);
+            LayerResponseCodec::write_uint32(buffer, packet.index_counts[view]);
+        }
+
+        if (!packet.view_metadata_enabled)
+        {
+            return;
+        }
+
+        for (uint32_t view = 0; view < view_count; view++)
+        {
+            ViewMetadata metadata = packet.view_metadata[view];
+
+            LayerResponseCodec::write_words(buffer, &metadata.time_layer, 1);
+            LayerResponseCodec::write_words(buffer, &metadata.time_image_encode, 1);
+            LayerResponseCodec::write_words(buffer, &metadata.time_geometry_encode, 1);
+            LayerResponseCodec::write_words(buffer, LayerResponseCodec::get_metadata_pointer(metadata, packet.mesh_generator), LayerResponseCodec::get_metadata_words(packet.mesh_generator));
+        }
+    }
+
+    bool LayerResponseCodec::decode(std::span<const uint8_t> buffer, LayerResponsePacket& packet, uint32_t& header_bytes)
+    {
+        uint32_t offset = 0;
+        uint32_t type = 0;
+        uint8_t version = 0;
+        uint8_t flags = 0;
+        uint8_t view_count = 0;
+        uint8_t mesh_generator = 0;
+
+        if (!LayerResponseCodec::read_uint32(buffer, offset, type) || type != PACKET_TYPE_LAYER_RESPONSE)
+        {
+            return false;
+        }
+
+        if (!LayerResponseCodec::read_uint8(buffer, offset, version) || version != SHARED_LAYER_RESPONSE_VERSION)
+        {
+            return false;
+        }
+
+        if (!LayerResponseCodec::read_uint8(buffer, offset, flags) || !LayerResponseCodec::read_uint8(buffer, offset, view_count) || !LayerResponseCodec::read_uint8(buffer, offset, mesh_generator))
+        {
+            return false;
+        }
+
+        if (view_count > SHARED_VIEW_COUNT_MAX || mesh_generator > MESH_GENERATOR_TYPE_LOOP)
+        {
+            return false;
+        }
+
+        packet = LayerResponsePacket();
+        packet.type = PACKET_TYPE_LAYER_RESPONSE;
+        packet.view_count = view_count;
+        packet.mesh_generator = (MeshGeneratorType)mesh_generator;
+        packet.geometry_dropped = (flags & LAYER_RESPONSE_FLAG_GEOMETRY_DROPPED) != 0;
+        packet.view_metadata_enabled = (flags & LAYER_RESPONSE_FLAG_VIEW_METADATA) != 0;
+        packet.geometry_omitted = (flags & LAYER_RESPONSE_FLAG_GEOMETRY_OMITTED) != 0;
+        packet.image_omitted = (flags & LAYER_RESPONSE_FLAG_IMAGE_OMITTED) != 0;
+
+        bool valid = true;
+        valid = valid && LayerResponseCodec::read_uint32(buffer, offset, packet.request_id);
+        valid = valid && LayerResponseCodec::read_uint32(buffer, offset, packet.layer_index);
+        valid = valid && LayerResponseCodec::read_uint32(buffer, offset, packet.geometry_bytes);
+        valid = valid && LayerResponseCodec::read_uint32(buffer, offset, packet.image_bytes);
+        valid = valid && LayerResponseCodec::read_uint32(buffer, offset, packet.dropped_frames);
+
+        for (uint32_t view = 0; view < view_count && valid; view++)
+        {
+            valid = valid && LayerResponseCodec::read_words(buffer, offset, packet.view_matrices[view].data(), packet.view_matrices[view].size());
+            valid = valid && LayerResponseCodec::read_uint32(buffer, offset, packet.vertex_counts[view]);
+            valid = valid && LayerResponseCodec::read_uint32(buffer, offset, packet.index_counts[view]);
+        }
+
+        for (uint32_t view = 0; view < view_count && valid && packet.view_metadata_enabled; view++)
+        {
+            ViewMetadata& metadata = packet.view_metadata[view];
+
+            valid = valid && LayerResponseCodec::read_words(buffer, offset, &metadata.time_layer, 1);
+            valid = valid && LayerResponseCodec::read_words(buffer, offset, &metadata.time_image_encode, 1);
+            valid = valid && LayerResponseCodec::read_words(buffer, offset, &metadata.time_geometry_encode, 1);
+            valid = valid && LayerResponseCodec::read_words(buffer, offset, LayerResponseCodec::get_metadata_pointer(metadata, packet.mesh_generator), LayerResponseCodec::get_metadata_words(packet.mesh_generator));
+        }
+
+        if (!valid)
+        {
+            return false;
+        }
+
+        header_bytes = offset;
+
+        return true;
+    }
+
+    uint32_t LayerResponseCodec::get_header_bytes_max()
+    {
+        uint32_t metadata_words = std::max({ LayerResponseCodec::get_metadata_words(MESH_GENERATOR_TYPE_QUAD), LayerResponseCodec::get_metadata_words(MESH_GENERATOR_TYPE_LINE), LayerResponseCodec::get_metadata_words(MESH_GENERATOR_TYPE_LOOP) });
+        uint32_t view_bytes = LAYER_RESPONSE_CODEC_VIEW_BYTES + (3 + metadata_words) * sizeof(uint32_t);
+
+        return LAYER_RESPONSE_CODEC_FIXED_BYTES + SHARED_VIEW_COUNT_MAX * view_bytes;
+    }
+
+    uint32_t LayerResponseCodec::get_metadata_words(MeshGeneratorType mesh_generator)
+    {
+        switch (mesh_generator)
+        {
+        case MESH_GENERATOR_TYPE_QUAD:
+            return sizeof(QuadViewMetadata) / sizeof(uint32_t);
+        case MESH_GENERATOR_TYPE_LINE:
+            return sizeof(LineViewMetadata) / sizeof(uint32_t);
+        case MESH_GENERATOR_TYPE_LOOP:
+            return sizeof(LoopViewMetadata) / sizeof(uint32_t);
+        default:
+            break;
+        }
+
+        return 0;
+    }
+
+    void* LayerResponseCodec::get_metadata_pointer(ViewMetadata& metadata, MeshGeneratorType mesh_generator)
+    {
+        switch (mesh_generator)
+        {
+        case MESH_GENERATOR_TYPE_QUAD:
+            return &metadata.quad;
+        case MESH_GENERATOR_TYPE_LINE:
+            return &metadata.line;
+        case MESH_GENERATOR_TYPE_LOOP:
+            return &metadata.loop;
+        default:
+            break;
+        }
+
+        return nullptr;
+    }
+
+    void LayerResponseCodec::write_uint8(std::vector<uint8_t>& buffer, uint8_t value)
+    {
+        buffer.push_back(value);
+    }
+
+    void LayerResponseCodec::write_uint32(std::vector<uint8_t>& buffer, uint32_t value)
+    {
+        //Write the bytes explicitly in little-endian order, so that the format does not depend on the platform of the server
+        buffer.push_back((value >> 0) & 0xFF);
+        buffer.push_back((value >> 8) & 0xFF);
+        buffer.push_back((value >> 16) & 0xFF);
+        buffer.push_back((value >> 24) & 0xFF);
+    }
+
+    void LayerResponseCodec::write_words(std::vector<uint8_t>& buffer, const void* words, uint32_t word_count)
+    {
+        for (uint32_t index = 0; index < word_count; index++)
+        {
+            uint32_t value = 0;
+            memcpy(&value, (const uint8_t*)words + index * sizeof(uint32_t), sizeof(uint32_t));
+
+            LayerResponseCodec::write_uint32(buffer, value);
+        }
+    }
+
+    bool LayerResponseCodec::read_uint8(std::span<const uint8_t> buffer, uint32_t& offset, uint8_t& value)
+    {
+        if (offset + sizeof(uint8_t) > buffer.size())
+        {
+            return false;
+        }
+
+        value = buffer[offset];
+        offset += sizeof(uint8_t);
+
+        return true;
+    }
+
+    bool LayerResponseCodec::read_uint32(std::span<const uint8_t> buffer, uint32_t& offset, uint32_t& value)
+    {
+        if (offset + sizeof(uint32_t) > buffer.size())
+        {
+            return false;
+        }
+
+        value = (uint32_t)buffer[offset + 0] << 0;
+        value |= (uint32_t)buffer[offset + 1] << 8;
+        value |= (uint32_t)buffer[offset + 2] << 16;
+        value |= (uint32_t)buffer[offset + 3] << 24;
+        offset += sizeof(uint32_t);
+
+        return true;
+    }
+
+    bool LayerResponseCodec::read_words(std::span<const uint8_t> buffer, uint32_t& offset, void* words, uint32_t word_count)
+    {
+        for (uint32_t index = 0; index < word_count; index++)
+        {
+            uint32_t value = 0;
+
+            if (!LayerResponseCodec::read_uint32(buffer, offset, value))
+            {
+                return false;
+            }
+
+            memcpy((uint8_t*)words + index * sizeof(uint32_t), &value, sizeof(uint32_t));
+        }
+
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <span>
+#include "protocol.hpp"
+
+#define LAYER_RESPONSE_CODEC_FIXED_BYTES        28  // Size of the part of the header that does not depend on the number of views
+#define LAYER_RESPONSE_CODEC_VIEW_BYTES         72  // Size of the part of the header that is written for each view, without the view metadata
+#define LAYER_RESPONSE_CODEC_SINGLE_VIEW_BYTES  100 // Upper bound for the header of a single view without view metadata. Use get_header_bytes_max() for any other header.
+
+namespace shared
+{
+    // Serialises the header of a layer response into the packed little-endian format described in protocol.hpp.
+    // Only the views of the session are serialised, so that the header of a single view without metadata is at most one hundred bytes.
+    class LayerResponseCodec
+    {
+    public:
+        LayerResponseCodec() = delete;
+
+        static void encode(const LayerResponsePacket& packet, std::vector<uint8_t>& buffer); // Replaces the content of the buffer with the serialised header
+        static bool decode(std::span<const uint8_t> buffer, LayerResponsePacket& packet, uint32_t& header_bytes); // Returns false if the buffer does not start with a valid header of the supported version
+        static uint32_t get_header_bytes_max(); // Upper bound for the size of any serialised header
+
+    private:
+        static uint32_t get_metadata_words(MeshGeneratorType mesh_generator);
+        static void* get_metadata_pointer(ViewMetadata& metadata, MeshGeneratorType mesh_generator);
+
+        static void write_uint8(std::vector<uint8_t>& buffer, uint8_t value);
+        static void write_uint32(std::vector<uint8_t>& buffer, uint32_t value);
+        static void write_words(std::vector<uint8_t>& buffer, const void* words, uint32_t word_count); // Writes consecutive 32-bit values, such as floats
+
+        static bool read_uint8(std::span<const uint8_t> buffer, uint32_t& offset, uint8_t& value);
+        static bool read_uint32(std::span<const uint8_t> buffer, uint32_t& offset, uint32_t& value);
+        static bool read_words(std::span<const uint8_t> buffer, uint32_t& offset, void* words, uint32_t word_count);
+    };
+}
\ No newline at end of file
@@ -55,6 +55,10 @@ namespace shared
         float sky_intensity = 1.0f;
 
         uint8_t export_enabled = false;
+        uint8_t drop_stale_frames = false;    // Allows the server to drop the geometry of frames that are superseded by a newer frame of the same layer
+        float latency_budget = 0.0f;          // Time in milliseconds after the render request during which the geometry of a superseded frame is still processed
+        uint8_t view_metadata_enabled = true; // Requests the measurements of the server for each view with every layer response
+        uint8_t split_layer_response = false; // Sends the image and the geometry of a layer as separate layer responses, so that the client can decode each of them as soon as it arrived
     };
 
     struct SessionDestroyPacket
@@ -91,23 +95,67 @@ namespace shared
         float quality = 1.0f;
     };
 
+    enum LayerResponseFlags : uint8_t
+    {
+        LAYER_RESPONSE_FLAG_GEOMETRY_DROPPED = 0x01,
+        LAYER_RESPONSE_FLAG_VIEW_METADATA    = 0x02,
+        LAYER_RESPONSE_FLAG_GEOMETRY_OMITTED = 0x04, // The geometry is sent with a separate layer response
+        LAYER_RESPONSE_FLAG_IMAGE_OMITTED    = 0x08  // The image is sent with a separate layer response
+    };
+
+    // In contrast to the other packets, the layer response is not sent as it is laid out in memory.
+    // Instead its header is serialised by the LayerResponseCodec into the following packed format, where all values are little-endian:
+    // uint32_t type
+    // uint8_t  version          > Equal to SHARED_LAYER_RESPONSE_VERSION
+    // uint8_t  flags            > Combination of LayerResponseFlags
+    // uint8_t  view_count
+    // uint8_t  mesh_generator   > Defines the layout of the metadata of the mesh generator
+    // uint32_t request_id
+    // uint32_t layer_index
+    // uint32_t geometry_bytes
+    // uint32_t image_bytes
+    // uint32_t dropped_frames
+    // For each view:
+    //     float    view_matrix[16]
+    //     uint32_t vertex_count
+    //     uint32_t index_count
+    // For each view if LAYER_RESPONSE_FLAG_VIEW_METADATA is set:
+    //     float    time_layer
+    //     float    time_image_encode
+    //     float    time_geometry_encode
+    //     Metadata of the mesh generator, where each member of QuadViewMetadata, LineViewMetadata or LoopViewMetadata is written as a 32-bit value in the order of declaration
     struct LayerResponsePacket
     {
         PacketType type = PACKET_TYPE_LAYER_RESPONSE;
 
         uint32_t request_id = 0;
         uint32_t layer_index = 0;
+        uint32_t view_count = 1;                                     // Number of views for which the view matrices, counts and metadata are valid
+        MeshGeneratorType mesh_generator = MESH_GENERATOR_TYPE_QUAD; // Mesh generator that produced the view metadata
+        uint8_t view_metadata_enabled = true;                        // Set if the packet contains the view metadata
 
         uint32_t geometry_bytes = 0;
         uint32_t image_bytes = 0;
 
+        uint8_t geometry_dropped = false; // Set if the server dropped the geometry of this layer since it was stale. In this case the packet only contains the image of the layer.
+        uint32_t dropped_frames = 0;      // Total number of frames of this layer that were dropped by the server during the session
+
+        uint8_t geometry_omitted = false; // Set if the geometry of this layer is sent with a separate packet. The geometry bytes still state the size of the omitted geometry.
+        uint8_t image_omitted = false;    // Set if the image of this layer is sent with a separate packet. The image bytes still state the size of the omitted image.
+
         std::array<ViewMetadata, SHARED_VIEW_COUNT_MAX> view_metadata; // Measurements taken by the server for each view
         std::array<Matrix, SHARED_VIEW_COUNT_MAX> view_matrices;       // View matrices as received in the request
         std::array<uint32_t, SHARED_VIEW_COUNT_MAX> vertex_counts;     // Number of vertices for each view
         std::array<uint32_t, SHARED_VIEW_COUNT_MAX> index_counts;      // Number of indicies for each view
 
-        // Followed by the encoded geometry of the layer consisting of geometry_bytes
-        // Followed by the encoded image of the layer consisting of image_bytes
+        // Followed by the encoded geometry of the layer consisting of geometry_bytes unless the geometry is omitted
+        // Followed by the encoded image of the layer consisting of image_bytes unless the image is omitted
+
+        // If the session was created with split layer responses, each layer with geometry is sent as two packets that carry the same header except for the omitted flags.
+        // The first packet only contains the image and the second packet only contains the geometry of the layer.
+
+        // The image of a layer is always sent even if its geometry was dropped, since the images of the layer form a single video stream.
+        // The client has to decode the image of a dropped layer but should not display the frame.
 
         // The package combines the geometry of all view into a single vertex array and index array.
         // The vertices and indices of all view are concatenated meaning that the vertex and index 
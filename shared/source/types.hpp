@@ -2,11 +2,13 @@
 
 #include <array>
 #include <cstdint>
+#include <cstring>
 
-#define SHARED_VIEW_COUNT_MAX    6
-#define SHARED_EXPORT_COUNT_MAX  4
-#define SHARED_STRING_LENGTH_MAX 1024
-#define SHARED_PI                3.14159265358f
+#define SHARED_VIEW_COUNT_MAX           6
+#define SHARED_EXPORT_COUNT_MAX         4
+#define SHARED_STRING_LENGTH_MAX        1024
+#define SHARED_PI                       3.14159265358f
+#define SHARED_LAYER_RESPONSE_VERSION   0x01 // Version of the serialised header of the layer response
 
 namespace shared
 {
@@ -77,6 +79,7 @@ namespace shared
         uint32_t loop_length_min = 80;
         std::uint8_t use_normals = true;
         std::uint8_t use_object_ids = true;
+        std::uint8_t use_sweep_line_profile = false; // Measure the individual phases of the sweep line during the triangulation
     };
 
     struct MeshSettings
@@ -118,6 +121,11 @@ namespace shared
         float time_refine = 0.0f;
         float time_corner = 0.0f;
         float time_write = 0.0f;
+
+        uint32_t vertex_count = 0;    // Number of vertices requested by the gpu
+        uint32_t index_count = 0;     // Number of indices requested by the gpu
+        uint32_t vertex_capacity = 0; // Number of vertices that fit into the buffer of the frame
+        uint32_t index_capacity = 0;  // Number of indices that fit into the buffer of the frame
     };
 
     struct LineViewMetadata // All time measurements in milliseconds
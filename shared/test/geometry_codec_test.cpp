@@ -0,0 +1,182 @@
+#include "geometry_codec.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+
+#define GEOMETRY_CODEC_TEST_VIEW_COUNT     6   // Number of views of each frame
+#define GEOMETRY_CODEC_TEST_GRID_SIZE      64  // Number of vertices along each side of the mesh of a view
+#define GEOMETRY_CODEC_TEST_WARMUP_COUNT   4   // Number of frames after which the buffers need to have reached their size
+#define GEOMETRY_CODEC_TEST_FRAME_COUNT    64  // Number of frames that are encoded after the warmup
+
+//Counts every allocation of the process so that the steady state of the encoding can be checked
+std::atomic<uint64_t> allocation_count = 0;
+
+void* operator new(std::size_t size)
+{
+    allocation_count++;
+
+    void* pointer = std::malloc((size > 0) ? size : 1);
+
+    if (pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t size) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t size) noexcept
+{
+    std::free(pointer);
+}
+
+//Grid mesh of which the depth changes with every frame, so that each frame creates a different huffman code
+void create_mesh(uint32_t frame, uint32_t view, std::vector<shared::Index>& indices, std::vector<shared::Vertex>& vertices)
+{
+    indices.clear();
+    vertices.clear();
+
+    for (uint32_t y = 0; y < GEOMETRY_CODEC_TEST_GRID_SIZE; y++)
+    {
+        for (uint32_t x = 0; x < GEOMETRY_CODEC_TEST_GRID_SIZE; x++)
+        {
+            shared::Vertex vertex;
+            vertex.x = x * 8;
+            vertex.y = y * 8;
+            vertex.z = 0.5f + 0.25f * std::sin(0.1f * (x + frame) + 0.2f * (y + view));
+
+            vertices.push_back(vertex);
+        }
+    }
+
+    for (uint32_t y = 0; y + 1 < GEOMETRY_CODEC_TEST_GRID_SIZE; y++)
+    {
+        for (uint32_t x = 0; x + 1 < GEOMETRY_CODEC_TEST_GRID_SIZE; x++)
+        {
+            shared::Index index = y * GEOMETRY_CODEC_TEST_GRID_SIZE + x;
+
+            indices.push_back(index);
+            indices.push_back(index + 1);
+            indices.push_back(index + GEOMETRY_CODEC_TEST_GRID_SIZE);
+
+            indices.push_back(index + 1);
+            indices.push_back(index + GEOMETRY_CODEC_TEST_GRID_SIZE + 1);
+            indices.push_back(index + GEOMETRY_CODEC_TEST_GRID_SIZE);
+        }
+    }
+}
+
+//Checks that the decoded geometry equals the concatenated lists of all views
+bool check_geometry(const std::vector<uint8_t>& geometry, const std::array<std::vector<shared::Index>, GEOMETRY_CODEC_TEST_VIEW_COUNT>& view_indices, const std::array<std::vector<shared::Vertex>, GEOMETRY_CODEC_TEST_VIEW_COUNT>& view_vertices)
+{
+    std::vector<shared::Index> indices;
+    std::vector<shared::Vertex> vertices;
+
+    if (!shared::GeometryCodec::decode(geometry, indices, vertices))
+    {
+        return false;
+    }
+
+    uint32_t index_offset = 0;
+    uint32_t vertex_offset = 0;
+
+    for (uint32_t view = 0; view < GEOMETRY_CODEC_TEST_VIEW_COUNT; view++)
+    {
+        for (shared::Index index : view_indices[view])
+        {
+            if (index_offset >= indices.size() || indices[index_offset++] != index)
+            {
+                return false;
+            }
+        }
+
+        for (const shared::Vertex& vertex : view_vertices[view])
+        {
+            if (vertex_offset >= vertices.size())
+            {
+                return false;
+            }
+
+            const shared::Vertex& decoded_vertex = vertices[vertex_offset++];
+            float vertex_depth = (float)(uint16_t)(vertex.z * 0x7FFF) / (float)0x7FFF;
+
+            if (decoded_vertex.x != vertex.x || decoded_vertex.y != vertex.y || decoded_vertex.z != vertex_depth)
+            {
+                return false;
+            }
+        }
+    }
+
+    return index_offset == indices.size() && vertex_offset == vertices.size();
+}
+
+int main()
+{
+    std::array<std::vector<shared::Index>, GEOMETRY_CODEC_TEST_VIEW_COUNT> view_indices;
+    std::array<std::vector<shared::Vertex>, GEOMETRY_CODEC_TEST_VIEW_COUNT> view_vertices;
+
+    //Same buffers that the worker keeps for each frame
+    std::array<shared::GeometryChunk, GEOMETRY_CODEC_TEST_VIEW_COUNT> chunks;
+    shared::GeometryEncodeBuffers encode_buffers;
+    std::vector<uint8_t> geometry;
+
+    uint32_t failed_count = 0;
+
+    for (uint32_t frame = 0; frame < GEOMETRY_CODEC_TEST_WARMUP_COUNT + GEOMETRY_CODEC_TEST_FRAME_COUNT; frame++)
+    {
+        for (uint32_t view = 0; view < GEOMETRY_CODEC_TEST_VIEW_COUNT; view++)
+        {
+            create_mesh(frame, view, view_indices[view], view_vertices[view]);
+        }
+
+        uint64_t frame_allocation_count = allocation_count;
+
+        for (uint32_t view = 0; view < GEOMETRY_CODEC_TEST_VIEW_COUNT; view++)
+        {
+            shared::GeometryCodec::encode_chunk(view_indices[view], view_vertices[view], chunks[view]);
+        }
+
+        bool encoded = shared::GeometryCodec::encode(chunks, encode_buffers, geometry);
+
+        frame_allocation_count = allocation_count - frame_allocation_count;
+
+        if (!encoded || !check_geometry(geometry, view_indices, view_vertices))
+        {
+            printf("GeometryCodecTest: Frame %u could not be decoded\n", frame);
+            failed_count++;
+        }
+
+        if (frame >= GEOMETRY_CODEC_TEST_WARMUP_COUNT && frame_allocation_count > 0)
+        {
+            printf("GeometryCodecTest: Frame %u allocated %llu times\n", frame, (unsigned long long)frame_allocation_count);
+            failed_count++;
+        }
+    }
+
+    printf("GeometryCodecTest: Failed checks %u\n", failed_count);
+
+    return (failed_count == 0) ? 0 : 1;
+}
\ No newline at end of file
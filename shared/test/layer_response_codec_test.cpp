@@ -0,0 +1,273 @@
+#include "layer_response_codec.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#define LAYER_RESPONSE_CODEC_TEST_METADATA_VALUE  1000 // First value of the members of the view metadata, which are numbered in the order of declaration
+
+uint32_t get_metadata_bytes(shared::MeshGeneratorType mesh_generator)
+{
+    switch (mesh_generator)
+    {
+    case shared::MESH_GENERATOR_TYPE_QUAD:
+        return sizeof(shared::QuadViewMetadata);
+    case shared::MESH_GENERATOR_TYPE_LINE:
+        return sizeof(shared::LineViewMetadata);
+    case shared::MESH_GENERATOR_TYPE_LOOP:
+        return sizeof(shared::LoopViewMetadata);
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+//Numbers the members of the view metadata in the order of declaration and returns the 32-bit values in the order in which protocol.hpp defines the header
+std::vector<uint32_t> fill_metadata(shared::ViewMetadata& metadata, shared::MeshGeneratorType mesh_generator, uint32_t view)
+{
+    std::vector<uint32_t> words;
+    uint32_t value = LAYER_RESPONSE_CODEC_TEST_METADATA_VALUE + 100 * view;
+
+    auto set_float = [&](float& member)
+    {
+        member = (float)value++;
+
+        uint32_t word = 0;
+        memcpy(&word, &member, sizeof(word));
+        words.push_back(word);
+    };
+
+    auto set_uint = [&](uint32_t& member)
+    {
+        member = value++;
+        words.push_back(member);
+    };
+
+    set_float(metadata.time_layer);
+    set_float(metadata.time_image_encode);
+    set_float(metadata.time_geometry_encode);
+
+    switch (mesh_generator)
+    {
+    case shared::MESH_GENERATOR_TYPE_QUAD:
+        set_float(metadata.quad.time_copy);
+        set_float(metadata.quad.time_delta);
+        set_float(metadata.quad.time_refine);
+        set_float(metadata.quad.time_corner);
+        set_float(metadata.quad.time_write);
+        set_uint(metadata.quad.vertex_count);
+        set_uint(metadata.quad.index_count);
+        set_uint(metadata.quad.vertex_capacity);
+        set_uint(metadata.quad.index_capacity);
+        break;
+    case shared::MESH_GENERATOR_TYPE_LINE:
+        set_float(metadata.line.time_edge_detection);
+        set_float(metadata.line.time_quad_tree);
+        set_float(metadata.line.time_cpu);
+        set_float(metadata.line.time_line_trace);
+        set_float(metadata.line.time_triangulation);
+        set_uint(metadata.line.line_count);
+        break;
+    case shared::MESH_GENERATOR_TYPE_LOOP:
+        set_float(metadata.loop.time_vector);
+        set_float(metadata.loop.time_split);
+        set_float(metadata.loop.time_base);
+        set_float(metadata.loop.time_combine);
+        set_float(metadata.loop.time_distribute);
+        set_float(metadata.loop.time_discard);
+        set_float(metadata.loop.time_write);
+        set_float(metadata.loop.time_cpu);
+        set_float(metadata.loop.time_loop_simplification);
+        set_float(metadata.loop.time_triangulation);
+        set_float(metadata.loop.time_loop_info);
+        set_float(metadata.loop.time_loop_sort);
+        set_float(metadata.loop.time_sweep_line);
+        set_float(metadata.loop.time_adjacent_two);
+        set_float(metadata.loop.time_adjacent_one);
+        set_float(metadata.loop.time_interval_search);
+        set_float(metadata.loop.time_interval_update);
+        set_float(metadata.loop.time_inside_outside);
+        set_float(metadata.loop.time_contour_split);
+        set_float(metadata.loop.time_contour);
+        set_uint(metadata.loop.loop_count);
+        set_uint(metadata.loop.segment_count);
+        set_uint(metadata.loop.point_count);
+        break;
+    default:
+        break;
+    }
+
+    return words;
+}
+
+//Packet of which every value differs, so that values that are swapped or written to the wrong view are detected
+shared::LayerResponsePacket create_packet(uint32_t view_count, shared::MeshGeneratorType mesh_generator, bool view_metadata_enabled, std::vector<std::vector<uint32_t>>& metadata_words)
+{
+    shared::LayerResponsePacket packet;
+    packet.request_id = 11;
+    packet.layer_index = 1;
+    packet.view_count = view_count;
+    packet.mesh_generator = mesh_generator;
+    packet.view_metadata_enabled = view_metadata_enabled;
+    packet.geometry_bytes = 123456;
+    packet.image_bytes = 65537;
+    packet.geometry_dropped = true;
+    packet.dropped_frames = 7;
+    packet.geometry_omitted = true;
+    packet.image_omitted = false;
+
+    metadata_words.clear();
+
+    for (uint32_t view = 0; view < view_count; view++)
+    {
+        for (uint32_t index = 0; index < packet.view_matrices[view].size(); index++)
+        {
+            packet.view_matrices[view][index] = 0.5f * index - 3.0f * view;
+        }
+
+        packet.vertex_counts[view] = 1000 + view;
+        packet.index_counts[view] = 3000 + view;
+
+        metadata_words.push_back(fill_metadata(packet.view_metadata[view], mesh_generator, view));
+    }
+
+    return packet;
+}
+
+uint32_t read_word(const std::vector<uint8_t>& buffer, uint32_t offset)
+{
+    return (uint32_t)buffer[offset] | ((uint32_t)buffer[offset + 1] << 8) | ((uint32_t)buffer[offset + 2] << 16) | ((uint32_t)buffer[offset + 3] << 24);
+}
+
+bool check_round_trip(uint32_t view_count, shared::MeshGeneratorType mesh_generator, bool view_metadata_enabled)
+{
+    std::vector<std::vector<uint32_t>> metadata_words;
+    shared::LayerResponsePacket packet = create_packet(view_count, mesh_generator, view_metadata_enabled, metadata_words);
+
+    std::vector<uint8_t> buffer;
+    shared::LayerResponseCodec::encode(packet, buffer);
+
+    uint32_t metadata_bytes = view_metadata_enabled ? (3 * sizeof(uint32_t) + get_metadata_bytes(mesh_generator)) : 0;
+    uint32_t expected_bytes = LAYER_RESPONSE_CODEC_FIXED_BYTES + view_count * (LAYER_RESPONSE_CODEC_VIEW_BYTES + metadata_bytes);
+
+    if (buffer.size() != expected_bytes || buffer.size() > shared::LayerResponseCodec::get_header_bytes_max())
+    {
+        printf("LayerResponseCodecTest: Header has %zu bytes instead of %u\n", buffer.size(), expected_bytes);
+
+        return false;
+    }
+
+    if (view_count == 1 && !view_metadata_enabled && buffer.size() > LAYER_RESPONSE_CODEC_SINGLE_VIEW_BYTES)
+    {
+        printf("LayerResponseCodecTest: Header of a single view exceeds %u bytes\n", LAYER_RESPONSE_CODEC_SINGLE_VIEW_BYTES);
+
+        return false;
+    }
+
+    //The metadata of each view has to follow the layout of protocol.hpp
+    uint32_t offset = LAYER_RESPONSE_CODEC_FIXED_BYTES + view_count * LAYER_RESPONSE_CODEC_VIEW_BYTES;
+
+    for (uint32_t view = 0; view < view_count && view_metadata_enabled; view++)
+    {
+        for (uint32_t word : metadata_words[view])
+        {
+            if (read_word(buffer, offset) != word)
+            {
+                printf("LayerResponseCodecTest: Metadata of view %u differs at offset %u\n", view, offset);
+
+                return false;
+            }
+
+            offset += sizeof(uint32_t);
+        }
+    }
+
+    shared::LayerResponsePacket decoded_packet;
+    uint32_t header_bytes = 0;
+
+    if (!shared::LayerResponseCodec::decode(buffer, decoded_packet, header_bytes) || header_bytes != buffer.size())
+    {
+        printf("LayerResponseCodecTest: Header could not be decoded\n");
+
+        return false;
+    }
+
+    bool equal = decoded_packet.type == packet.type && decoded_packet.request_id == packet.request_id && decoded_packet.layer_index == packet.layer_index;
+    equal = equal && decoded_packet.view_count == packet.view_count && decoded_packet.mesh_generator == packet.mesh_generator && decoded_packet.view_metadata_enabled == packet.view_metadata_enabled;
+    equal = equal && decoded_packet.geometry_bytes == packet.geometry_bytes && decoded_packet.image_bytes == packet.image_bytes;
+    equal = equal && decoded_packet.geometry_dropped == packet.geometry_dropped && decoded_packet.dropped_frames == packet.dropped_frames;
+    equal = equal && decoded_packet.geometry_omitted == packet.geometry_omitted && decoded_packet.image_omitted == packet.image_omitted;
+
+    for (uint32_t view = 0; view < view_count; view++)
+    {
+        equal = equal && decoded_packet.view_matrices[view] == packet.view_matrices[view];
+        equal = equal && decoded_packet.vertex_counts[view] == packet.vertex_counts[view] && decoded_packet.index_counts[view] == packet.index_counts[view];
+
+        //The times of the view are followed by the metadata of the mesh generator without padding
+        if (view_metadata_enabled)
+        {
+            equal = equal && memcmp(&decoded_packet.view_metadata[view], &packet.view_metadata[view], metadata_bytes) == 0;
+        }
+    }
+
+    if (!equal)
+    {
+        printf("LayerResponseCodecTest: Decoded header differs from the encoded header\n");
+
+        return false;
+    }
+
+    //Every shorter prefix of the header has to be rejected
+    for (uint32_t size = 0; size < buffer.size(); size++)
+    {
+        std::span<const uint8_t> prefix(buffer.data(), size);
+
+        if (shared::LayerResponseCodec::decode(prefix, decoded_packet, header_bytes))
+        {
+            printf("LayerResponseCodecTest: Header truncated to %u bytes was decoded\n", size);
+
+            return false;
+        }
+    }
+
+    //Headers of an unknown version have to be rejected
+    std::vector<uint8_t> version_buffer = buffer;
+    version_buffer[sizeof(uint32_t)] = SHARED_LAYER_RESPONSE_VERSION + 1;
+
+    if (shared::LayerResponseCodec::decode(version_buffer, decoded_packet, header_bytes))
+    {
+        printf("LayerResponseCodecTest: Header of an unknown version was decoded\n");
+
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    uint32_t check_count = 0;
+    uint32_t failed_count = 0;
+
+    for (uint32_t view_count : { 1, SHARED_VIEW_COUNT_MAX })
+    {
+        for (shared::MeshGeneratorType mesh_generator : { shared::MESH_GENERATOR_TYPE_QUAD, shared::MESH_GENERATOR_TYPE_LINE, shared::MESH_GENERATOR_TYPE_LOOP })
+        {
+            for (bool view_metadata_enabled : { false, true })
+            {
+                if (!check_round_trip(view_count, mesh_generator, view_metadata_enabled))
+                {
+                    printf("LayerResponseCodecTest: Views %u, mesh generator %u, metadata %u failed\n", view_count, mesh_generator, view_metadata_enabled);
+                    failed_count++;
+                }
+
+                check_count++;
+            }
+        }
+    }
+
+    printf("LayerResponseCodecTest: Failed checks %u / %u\n", failed_count, check_count);
+
+    return (failed_count == 0) ? 0 : 1;
+}
\ No newline at end of file